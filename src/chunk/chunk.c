@@ -10,4 +10,6 @@ void *chunk_offset(struct chunk *c);
 
 size_t chunk_size(struct chunk *c);
 
+size_t chunk_overlap_size(struct chunk *c, size_t width);
+
 int chunk_next(struct chunk *c);
@@ -70,6 +70,25 @@ inline size_t chunk_size(struct chunk *c)
 	return curr_size;
 }
 
+/*
+ * Size of the current chunk extended by up to width - 1 bytes of the next one
+ * so that a value of the given width that starts in the current chunk can be
+ * read whole. Never goes past the end of the block.
+ *
+ * Behavior is left undefined if chunk_finished returns true or width is 0.
+ */
+inline size_t chunk_overlap_size(struct chunk *c, size_t width)
+{
+	size_t curr_size = chunk_size(c) + width - 1;
+	size_t left = c->end - c->curr;
+
+	if (curr_size > left) {
+		curr_size = left;
+	}
+
+	return curr_size;
+}
+
 /*
  * Moves on to the next chunk.
  *
@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "chunk/chunk.h"
+
+int main(void)
+{
+	char block[10];
+
+	struct chunk c;
+	chunk_init(&c, block, block + 10, 4);
+
+	size_t size;
+
+	size = chunk_overlap_size(&c, 1);
+
+	if (size != 4) {
+		fprintf(stderr, "A width of 1 is not supposed to extend the chunk.\n");
+		chunk_deinit(&c);
+		return 1;
+	}
+
+	size = chunk_overlap_size(&c, 3);
+
+	if (size != 6) {
+		fprintf(stderr, "First chunk was supposed to be extended by 2 bytes.\n");
+		fprintf(stderr, "Expected 6, got %d.\n", (int) size);
+		chunk_deinit(&c);
+		return 1;
+	}
+
+	chunk_next(&c);
+
+	size = chunk_overlap_size(&c, 4);
+
+	if (size != 6) {
+		fprintf(stderr, "Middle chunk was supposed to stop at the end of the block.\n");
+		fprintf(stderr, "Expected 6, got %d.\n", (int) size);
+		chunk_deinit(&c);
+		return 1;
+	}
+
+	chunk_next(&c);
+
+	size = chunk_overlap_size(&c, 8);
+
+	if (size != 2) {
+		fprintf(stderr, "Last chunk is not supposed to be extended.\n");
+		fprintf(stderr, "Expected 2, got %d.\n", (int) size);
+		chunk_deinit(&c);
+		return 1;
+	}
+
+	chunk_deinit(&c);
+
+	return 0;
+}
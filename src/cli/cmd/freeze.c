@@ -4,6 +4,7 @@
 #include <fcntl.h>
 #include <signal.h>
 #include <errno.h>
+#include <time.h>
 
 #include "cli/cmd/freeze.h"
 #include "cli/printer.h"
@@ -124,8 +125,19 @@ static void wait_input_or_signal_handler()
 	sigprocmask(SIG_SETMASK, &original, NULL);
 }
 
+/*
+ * Microseconds between two points in time.
+ */
+static double elapsed(struct timespec *start, struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1e6
+		+ (end->tv_nsec - start->tv_nsec) / 1e3;
+}
+
 int cli_cmd_freeze(struct cli_cmd_freeze_arg *arg)
 {
+	struct timespec start, end;
+
 	if (!register_signal_handler()) {
 		fprintf(stderr, "Failed to set up signal handler.\n");
 		return 1;
@@ -141,7 +153,9 @@ int cli_cmd_freeze(struct cli_cmd_freeze_arg *arg)
 
 	proctal_set_pid(p, arg->pid);
 
+	clock_gettime(CLOCK_MONOTONIC, &start);
 	proctal_freeze(p);
+	clock_gettime(CLOCK_MONOTONIC, &end);
 
 	if (proctal_error(p)) {
 		cli_print_proctal_error(p);
@@ -149,13 +163,21 @@ int cli_cmd_freeze(struct cli_cmd_freeze_arg *arg)
 		return 1;
 	}
 
+	size_t thread_count = proctal_freeze_thread_count(p);
+
+	if (arg->latency) {
+		fprintf(stderr, "Froze %zu threads in %.0f microseconds.\n", thread_count, elapsed(&start, &end));
+	}
+
 	if (arg->input) {
 		wait_input_or_signal_handler();
 	} else {
 		wait_signal_handler();
 	}
 
+	clock_gettime(CLOCK_MONOTONIC, &start);
 	proctal_unfreeze(p);
+	clock_gettime(CLOCK_MONOTONIC, &end);
 
 	if (proctal_error(p)) {
 		cli_print_proctal_error(p);
@@ -163,6 +185,10 @@ int cli_cmd_freeze(struct cli_cmd_freeze_arg *arg)
 		return 1;
 	}
 
+	if (arg->latency) {
+		fprintf(stderr, "Unfroze %zu threads in %.0f microseconds.\n", thread_count, elapsed(&start, &end));
+	}
+
 	proctal_destroy(p);
 
 	unregister_signal_handler();
@@ -6,6 +6,9 @@ struct cli_cmd_freeze_arg {
 
 	// Whether to quit when no more input is available.
 	int input;
+
+	// Whether to print how long it took to freeze and unfreeze.
+	int latency;
 };
 
 int cli_cmd_freeze(struct cli_cmd_freeze_arg *arg);
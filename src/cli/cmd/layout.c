@@ -0,0 +1,400 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "cli/cmd/layout.h"
+#include "cli/printer.h"
+#include "cli/val.h"
+#include "cli/val/filter.h"
+#include "lib/include/proctal.h"
+#include "chunk/chunk.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Largest amount of memory read at once.
+#define BUFFER_SIZE (1024 * 1024)
+
+struct layout {
+	struct cli_cmd_layout_arg *arg;
+
+	// Fields in the order they are checked, most selective first.
+	struct cli_cmd_layout_field **order;
+
+	// Bytes that the first field has to be made of when comparing bytes
+	// is enough to tell whether it matches, otherwise NULL.
+	const void *key;
+
+	// Number of bytes from the start of the structure to the end of the
+	// field that ends the farthest.
+	size_t extent;
+
+	// Alignment of the start of the structure.
+	size_t align;
+};
+
+static inline void *align_addr(void *addr, size_t align)
+{
+	ptrdiff_t offset = ((unsigned long) addr % align);
+
+	if (offset != 0) {
+		offset = align - offset;
+	}
+
+	return (void *) ((char *) addr + offset);
+}
+
+/*
+ * Tells whether two values of the type are equal if and only if their bytes
+ * are.
+ */
+static int compares_by_bytes(cli_val v)
+{
+	switch (cli_val_type(v)) {
+	case CLI_VAL_TYPE_BYTE:
+	case CLI_VAL_TYPE_INTEGER:
+	case CLI_VAL_TYPE_ADDRESS:
+		return 1;
+
+	default:
+		// Floating point numbers have 2 zeros and NaNs that are not
+		// equal to themselves.
+		return 0;
+	}
+}
+
+/*
+ * Estimates how few values pass the comparisons of a field. Lower is fewer.
+ */
+static int selectivity(struct cli_cmd_layout_field *f)
+{
+	cli_val nil = cli_val_nil();
+	struct cli_val_filter_compare_arg *c = &f->compare;
+
+	if (c->eq != nil) {
+		return compares_by_bytes(f->value) ? 0 : 1;
+	}
+
+	int lower = c->gt != nil || c->gte != nil;
+	int upper = c->lt != nil || c->lte != nil;
+
+	if (lower && upper) {
+		return 2;
+	}
+
+	if (lower || upper || c->ne != nil) {
+		return 3;
+	}
+
+	return 4;
+}
+
+static int compare_fields(const void *a, const void *b)
+{
+	struct cli_cmd_layout_field *fa = *(struct cli_cmd_layout_field **) a;
+	struct cli_cmd_layout_field *fb = *(struct cli_cmd_layout_field **) b;
+
+	int sa = selectivity(fa);
+	int sb = selectivity(fb);
+
+	if (sa != sb) {
+		return sa < sb ? -1 : 1;
+	}
+
+	// Wider values are less likely to match by chance.
+	size_t za = cli_val_sizeof(fa->value);
+	size_t zb = cli_val_sizeof(fb->value);
+
+	if (za != zb) {
+		return za > zb ? -1 : 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Finds the next position, starting at i and going in steps of align, where
+ * the bytes of the key are stored. Positions from end onwards are not checked
+ * and the bytes of the key at the last position must be available.
+ *
+ * With SSE2, 16 positions are looked at once by comparing the first and the
+ * last byte of the key and only positions where both match are compared in
+ * full. Positions left over are compared as fixed size integers when the key
+ * has the size of one.
+ *
+ * Returns end if there is none.
+ */
+static size_t find_key(const char *data, size_t i, size_t end, size_t align, const void *key, size_t size)
+{
+#ifdef __SSE2__
+	// The same positions are in step with i in every block of 16 bytes
+	// only if the alignment divides 16.
+	if (16 % align == 0) {
+		const char *bytes = key;
+		size_t last = size - 1;
+
+		int positions = 0;
+
+		for (size_t j = 0; j < 16; j += align) {
+			positions |= 1 << j;
+		}
+
+		__m128i first_byte = _mm_set1_epi8(bytes[0]);
+		__m128i last_byte = _mm_set1_epi8(bytes[last]);
+
+		for (; i + 16 <= end; i += 16) {
+			__m128i f = _mm_loadu_si128((const __m128i *) (data + i));
+			__m128i l = _mm_loadu_si128((const __m128i *) (data + i + last));
+
+			int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(f, first_byte), _mm_cmpeq_epi8(l, last_byte)));
+			mask &= positions;
+
+			while (mask) {
+				int bit = __builtin_ctz(mask);
+
+				if (memcmp(data + i + bit, bytes, size) == 0) {
+					return i + bit;
+				}
+
+				mask &= mask - 1;
+			}
+		}
+	}
+#endif
+
+#define FIND(TYPE) \
+	do { \
+		TYPE k; \
+		memcpy(&k, key, sizeof(k)); \
+\
+		for (; i < end; i += align) { \
+			TYPE v; \
+			memcpy(&v, data + i, sizeof(v)); \
+\
+			if (v == k) { \
+				return i; \
+			} \
+		} \
+\
+		return end; \
+	} while (0)
+
+	switch (size) {
+	case 1:
+		FIND(uint8_t);
+
+	case 2:
+		FIND(uint16_t);
+
+	case 4:
+		FIND(uint32_t);
+
+	case 8:
+		FIND(uint64_t);
+	}
+
+#undef FIND
+
+	for (; i < end; i += align) {
+		if (memcmp(data + i, key, size) == 0) {
+			return i;
+		}
+	}
+
+	return end;
+}
+
+/*
+ * Checks the fields of a structure, skipping the given number of fields that
+ * are already known to match.
+ */
+static int matches(struct layout *l, const char *data, size_t skip)
+{
+	for (size_t i = skip; i < l->arg->field_count; ++i) {
+		struct cli_cmd_layout_field *f = l->order[i];
+
+		memcpy(cli_val_raw(f->value), data + f->offset, cli_val_sizeof(f->value));
+
+		if (!cli_val_filter_compare(&f->compare, f->value)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static int layout_init(struct layout *l, struct cli_cmd_layout_arg *arg)
+{
+	l->arg = arg;
+	l->order = malloc(arg->field_count * sizeof(*l->order));
+
+	if (l->order == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		return 0;
+	}
+
+	l->extent = 0;
+	l->align = 1;
+
+	for (size_t i = 0; i < arg->field_count; ++i) {
+		struct cli_cmd_layout_field *f = &arg->fields[i];
+		size_t end = f->offset + cli_val_sizeof(f->value);
+		size_t align = cli_val_alignof(f->value);
+
+		l->order[i] = f;
+
+		if (end > l->extent) {
+			l->extent = end;
+		}
+
+		if (align > l->align) {
+			l->align = align;
+		}
+	}
+
+	qsort(l->order, arg->field_count, sizeof(*l->order), compare_fields);
+
+	struct cli_cmd_layout_field *first = l->order[0];
+
+	l->key = selectivity(first) == 0
+		? cli_val_raw(first->compare.eq)
+		: NULL;
+
+	return 1;
+}
+
+static void layout_deinit(struct layout *l)
+{
+	free(l->order);
+}
+
+/*
+ * Goes over memory once, checking the most selective field first and the
+ * remaining ones only where it matches.
+ */
+static void search(struct layout *l, proctal p)
+{
+	cli_val addr = cli_val_wrap(CLI_VAL_TYPE_ADDRESS, cli_val_address_create());
+	struct cli_cmd_layout_field *first = l->order[0];
+	size_t first_size = cli_val_sizeof(first->value);
+
+	char *buffer = malloc(BUFFER_SIZE + l->extent - 1);
+
+	if (buffer == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		cli_val_destroy(addr);
+		return;
+	}
+
+	proctal_region_set_mask(p, 0);
+
+	proctal_region_new(p);
+
+	void *start, *end;
+	struct chunk chunk;
+
+	while (proctal_region(p, &start, &end)) {
+		char *base = align_addr(start, l->align);
+
+		if (base + l->extent > (char *) end) {
+			continue;
+		}
+
+		chunk_init(&chunk, base, end, BUFFER_SIZE);
+
+		do {
+			char *offset = chunk_offset(&chunk);
+			size_t curr_size = chunk_size(&chunk);
+
+			size_t read_size = chunk_overlap_size(&chunk, l->extent);
+
+			if (read_size < l->extent) {
+				continue;
+			}
+
+			proctal_read(p, offset, buffer, read_size);
+
+			if (proctal_error(p)) {
+				cli_print_proctal_error(p);
+				proctal_error_ack(p);
+				continue;
+			}
+
+			// Structures must fit in what was read.
+			size_t limit = read_size - l->extent + 1;
+
+			if (limit > curr_size) {
+				limit = curr_size;
+			}
+
+			for (size_t i = 0; i < limit; i += l->align) {
+				if (l->key != NULL) {
+					i = find_key(buffer + first->offset, i, limit, l->align, l->key, first_size);
+
+					if (i == limit) {
+						break;
+					}
+				}
+
+				if (!matches(l, buffer + i, l->key != NULL)) {
+					continue;
+				}
+
+				void *a = offset + i;
+				cli_val_parse_bin(addr, (char *) &a, sizeof(a));
+
+				cli_val_print(addr, stdout);
+				printf("\n");
+			}
+		} while (chunk_next(&chunk));
+	}
+
+	proctal_region_new(p);
+
+	free(buffer);
+	cli_val_destroy(addr);
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_error_ack(p);
+	}
+}
+
+int cli_cmd_layout(struct cli_cmd_layout_arg *arg)
+{
+	struct layout l;
+
+	if (!layout_init(&l, arg)) {
+		return 1;
+	}
+
+	proctal p = proctal_create();
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_destroy(p);
+		layout_deinit(&l);
+		return 1;
+	}
+
+	proctal_set_pid(p, arg->pid);
+
+	if (!arg->read && !arg->write && !arg->execute) {
+		// By default will search readable memory.
+		proctal_region_set_read(p, 1);
+		proctal_region_set_write(p, 0);
+		proctal_region_set_execute(p, 0);
+	} else {
+		proctal_region_set_read(p, arg->read);
+		proctal_region_set_write(p, arg->write);
+		proctal_region_set_execute(p, arg->execute);
+	}
+
+	search(&l, p);
+
+	proctal_destroy(p);
+	layout_deinit(&l);
+
+	return 0;
+}
@@ -0,0 +1,42 @@
+#ifndef CLI_CMD_LAYOUT_H
+#define CLI_CMD_LAYOUT_H
+
+#include "cli/val.h"
+#include "cli/val/filter.h"
+
+/*
+ * A field of a structure.
+ */
+struct cli_cmd_layout_field {
+	// Number of bytes between the start of the structure and the field.
+	size_t offset;
+
+	// How we're going to interpret the value of the field.
+	cli_val value;
+
+	// What the value of the field is compared against. Comparisons that
+	// are not performed are nil.
+	struct cli_val_filter_compare_arg compare;
+};
+
+struct cli_cmd_layout_arg {
+	int pid;
+
+	// Fields that the structure has to match, in the order they were
+	// given.
+	struct cli_cmd_layout_field *fields;
+	size_t field_count;
+
+	// Whether to search readable memory addresses.
+	int read;
+
+	// Whether to search writable memory addresses.
+	int write;
+
+	// Whether to search executable memory addresses.
+	int execute;
+};
+
+int cli_cmd_layout(struct cli_cmd_layout_arg *arg);
+
+#endif /* CLI_CMD_LAYOUT_H */
@@ -1,174 +1,134 @@
+#include <stdio.h>
+#include <stdint.h>
 #include <string.h>
-#include <assert.h>
+#include <inttypes.h>
 
 #include "cli/cmd/pattern.h"
 #include "cli/printer.h"
-#include "cli/scanner.h"
-#include "lib/include/proctal.h"
-#include "swbuf/swbuf.h"
-#include "chunk/chunk.h"
+#include "cli/pattern.h"
+#include "cli/finder.h"
 
-static void print_match(void *addr)
+/*
+ * Reads a signed little endian displacement.
+ */
+static intptr_t read_displacement(const unsigned char *bytes, enum cli_pattern_capture_type type)
 {
-	cli_print_address(addr);
-	printf("\n");
+	if (type == CLI_PATTERN_CAPTURE_REL8) {
+		return (int8_t) bytes[0];
+	}
+
+	uint32_t value = (uint32_t) bytes[0]
+		| (uint32_t) bytes[1] << 8
+		| (uint32_t) bytes[2] << 16
+		| (uint32_t) bytes[3] << 24;
+
+	return (int32_t) value;
 }
 
-int cli_cmd_pattern(struct cli_cmd_pattern_arg *arg)
+/*
+ * Appends the captures of a match as name=value. Bytes are written in
+ * hexadecimal and displacements are resolved to the address they point to,
+ * which is relative to the address right after the capture.
+ */
+static void describe_captures(void *data, struct cli_job_output *o, char *address, const char *bytes, size_t size)
 {
-	proctal p = proctal_create();
+	cli_pattern cp = data;
+	size_t count = cli_pattern_capture_count(cp);
+	size_t bounds[CLI_PATTERN_MAX_CAPTURES * 2];
 
-	if (proctal_error(p)) {
-		cli_print_proctal_error(p);
-		proctal_destroy(p);
-		return 1;
+	if (count == 0 || !cli_pattern_captures(cp, bytes, size, bounds)) {
+		return;
 	}
 
-	proctal_set_pid(p, arg->pid);
-
-	if (!arg->read && !arg->write && !arg->execute) {
-		// By default will search readable memory.
-		proctal_region_set_read(p, 1);
-		proctal_region_set_write(p, 0);
-		proctal_region_set_execute(p, 0);
-	} else {
-		proctal_region_set_read(p, arg->read);
-		proctal_region_set_write(p, arg->write);
-		proctal_region_set_execute(p, arg->execute);
-	}
+	for (size_t i = 0; i < count; ++i) {
+		size_t start = bounds[i * 2];
+		size_t end = bounds[i * 2 + 1];
 
-	long mask = 0;
+		if (start == SIZE_MAX) {
+			continue;
+		}
 
-	if (arg->program_code) {
-		mask |= PROCTAL_REGION_PROGRAM_CODE;
-	}
+		const char *name = cli_pattern_capture_name(cp, i);
+		enum cli_pattern_capture_type type = cli_pattern_capture_type(cp, i);
 
-	proctal_region_set_mask(p, mask);
+		cli_job_output_append(o, " ", 1);
+		cli_job_output_append(o, name, strlen(name));
+		cli_job_output_append(o, "=", 1);
 
-	proctal_region_new(p);
+		char s[sizeof(uintptr_t) * 2 + 1];
 
+		if (type == CLI_PATTERN_CAPTURE_BYTES) {
+			for (size_t j = start; j < end; ++j) {
+				snprintf(s, sizeof(s), "%02X", (unsigned char) bytes[j]);
+				cli_job_output_append(o, s, 2);
+			}
+		} else {
+			intptr_t displacement = read_displacement((const unsigned char *) bytes + start, type);
+			uintptr_t target = (uintptr_t) address + end + displacement;
+			int n = snprintf(s, sizeof(s), "%" PRIXPTR, target);
+
+			cli_job_output_append(o, s, n);
+		}
+	}
+}
+
+int cli_cmd_pattern(struct cli_cmd_pattern_arg *arg)
+{
 	cli_pattern cp = cli_pattern_create();
 	cli_pattern_compile(cp, arg->pattern);
 
 	if (cli_pattern_error(cp)) {
 		cli_print_pattern_error(cp);
 		cli_pattern_destroy(cp);
-		proctal_destroy(p);
 		return 1;
 	}
 
-	const size_t buffer_size = 1024 * 1024;
-	struct swbuf buf;
-	swbuf_init(&buf, buffer_size);
+	uint64_t masks[256];
+	size_t length = cli_pattern_positions(cp);
 
-	size_t prev_size, curr_size;
-	void *start, *end;
+	if (arg->approximate) {
+		if (length == 0) {
+			fprintf(stderr, "Mismatches are only allowed in patterns of up to %d bytes without alternatives of more than a byte or gaps of varying size.\n", CLI_PATTERN_MAX_POSITIONS);
+			cli_pattern_destroy(cp);
+			return 1;
+		}
 
-	struct chunk chunk;
+		if ((size_t) arg->max_mismatches >= length) {
+			fprintf(stderr, "Allowing %d mismatches would let a pattern of %zu bytes match anything.\n", arg->max_mismatches, length);
+			cli_pattern_destroy(cp);
+			return 1;
+		}
 
-	while (proctal_region(p, &start, &end)) {
-		// Starting address of the matching pattern.
-		char *pattern_start = start;
-		cli_pattern_new(cp);
+		for (int byte = 0; byte < 256; ++byte) {
+			masks[byte] = 0;
 
-		chunk_init(&chunk, start, end, buffer_size);
-
-		do {
-			char *offset = chunk_offset(&chunk);
-			curr_size = chunk_size(&chunk);
-
-			proctal_read(p, offset, swbuf_address_offset(&buf, 0), curr_size);
-
-			if (proctal_error(p)) {
-				cli_print_proctal_error(p);
-
-				proctal_error_ack(p);
-
-				// Since we cannot read this chunk of memory
-				// we're going to discard any progress there
-				// might have been made in the previous chunk.
-				break;
-			}
-
-			// Remaining characters to read in the current chunk.
-			size_t remaining = curr_size;
-
-			while (remaining) {
-				size_t read = cli_pattern_input(cp, swbuf_address_offset(&buf, curr_size - remaining), remaining);
-
-				if (cli_pattern_finished(cp)) {
-					if (cli_pattern_matched(cp)) {
-						print_match(pattern_start);
-
-						cli_pattern_new(cp);
-						remaining -= read;
-
-						if (pattern_start < offset) {
-							// Count reads from
-							// previous chunk.
-							read += offset - pattern_start;
-						}
-
-						pattern_start = pattern_start + read;
-					} else {
-						cli_pattern_new(cp);
-
-						if (pattern_start < offset) {
-							// The pattern match
-							// started in the
-							// previous chunk.
-							// We're going to have
-							// to backtrack.
-
-							// Start at the next
-							// character now.
-							pattern_start += 1;
-
-							// This calculation can
-							// result in a 0 when
-							// pattern_start equals
-							// offset but
-							// that will do no harm
-							// because it's going
-							// to do nothing.
-							size_t prev_remaining = offset - pattern_start;
-
-							assert(prev_remaining < buffer_size);
-
-							cli_pattern_input(cp, swbuf_address_offset(&buf, prev_size - prev_remaining - buffer_size), prev_remaining);
-						} else {
-							// Start at the next
-							// character now.
-							pattern_start += 1;
-
-							remaining -= 1;
-						}
-					}
-				} else {
-					// Read to the end of the buffer but
-					// wasn't enough.
-					remaining -= read;
+			for (size_t i = 0; i < length; ++i) {
+				if (cli_pattern_position_has_byte(cp, i, byte)) {
+					masks[byte] |= (uint64_t) 1 << i;
 				}
 			}
-
-			swbuf_swap(&buf);
-
-			// Remembering the size of the previous chunk.
-			prev_size = curr_size;
-		} while (chunk_next(&chunk));
+		}
 	}
 
-	swbuf_deinit(&buf);
-
-	if (proctal_error(p)) {
-		cli_print_proctal_error(p);
-		cli_pattern_destroy(cp);
-		proctal_destroy(p);
-		return 1;
-	}
+	struct cli_find_arg find_arg;
+	find_arg.pid = arg->pid;
+	find_arg.read = arg->read;
+	find_arg.write = arg->write;
+	find_arg.execute = arg->execute;
+	find_arg.program_code = arg->program_code;
+	find_arg.threads = arg->threads;
+	find_arg.forward = cli_pattern_forward(cp);
+	find_arg.backward = cli_pattern_backward(cp);
+	find_arg.prefix = cli_pattern_prefix(cp, &find_arg.prefix_size);
+	find_arg.masks = arg->approximate ? masks : NULL;
+	find_arg.length = length;
+	find_arg.max_mismatches = arg->max_mismatches;
+	find_arg.describe = cli_pattern_capture_count(cp) ? describe_captures : NULL;
+	find_arg.describe_data = cp;
+
+	int ok = cli_find(&find_arg);
 
 	cli_pattern_destroy(cp);
-	proctal_destroy(p);
 
-	return 0;
+	return ok ? 0 : 1;
 }
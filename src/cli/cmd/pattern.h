@@ -20,6 +20,15 @@ struct cli_cmd_pattern_arg {
 
 	// Whether to search program code.
 	int program_code;
+
+	// Whether bytes of a match can be different from what the pattern
+	// expects, and at how many positions at most.
+	int approximate;
+	int max_mismatches;
+
+	// Number of threads used to go over memory. 0 means one per
+	// processor.
+	int threads;
 };
 
 int cli_cmd_pattern(struct cli_cmd_pattern_arg *arg);
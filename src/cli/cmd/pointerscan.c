@@ -0,0 +1,332 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "cli/cmd/pointerscan.h"
+#include "cli/printer.h"
+#include "lib/include/proctal.h"
+
+/*
+ * A memory region of the address space.
+ */
+struct region {
+	char *start;
+	char *end;
+
+	// Path of the module the region belongs to or NULL if it does not
+	// belong to one. Regions of the same module share the string.
+	const char *module;
+
+	// Where the first region of the module starts. Offsets of static
+	// addresses are relative to this.
+	char *module_start;
+};
+
+struct region_table {
+	// Sorted by start address.
+	struct region *regions;
+	size_t count;
+};
+
+/*
+ * A step of a pointer chain found while going from the address towards
+ * static memory.
+ */
+struct node {
+	// Where the pointer is stored.
+	char *location;
+
+	// What needs to be added to the pointer to get to the location of the
+	// previous node.
+	size_t offset;
+
+	// Index of the previous node. The first node is the address itself
+	// and is its own parent.
+	size_t parent;
+};
+
+struct node_list {
+	struct node *items;
+	size_t count;
+	size_t capacity;
+};
+
+static int node_list_add(struct node_list *l, char *location, size_t offset, size_t parent)
+{
+	if (l->count == l->capacity) {
+		size_t capacity = l->capacity ? l->capacity * 2 : 1024;
+		struct node *items = realloc(l->items, capacity * sizeof(*items));
+
+		if (items == NULL) {
+			return 0;
+		}
+
+		l->items = items;
+		l->capacity = capacity;
+	}
+
+	struct node *item = &l->items[l->count++];
+	item->location = location;
+	item->offset = offset;
+	item->parent = parent;
+
+	return 1;
+}
+
+/*
+ * Returns the region that contains the address or NULL if none does.
+ */
+static struct region *region_table_find(struct region_table *t, void *addr)
+{
+	size_t lo = 0;
+	size_t hi = t->count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		struct region *r = &t->regions[mid];
+
+		if ((char *) addr < r->start) {
+			hi = mid;
+		} else if ((char *) addr >= r->end) {
+			lo = mid + 1;
+		} else {
+			return r;
+		}
+	}
+
+	return NULL;
+}
+
+static void region_table_deinit(struct region_table *t)
+{
+	for (size_t i = 0; i < t->count; ++i) {
+		struct region *r = &t->regions[i];
+
+		// Only the first region of a module owns the string.
+		if (r->module != NULL && (i == 0 || t->regions[i - 1].module != r->module)) {
+			free((char *) r->module);
+		}
+	}
+
+	free(t->regions);
+}
+
+/*
+ * Fills the table with every memory region of the address space.
+ *
+ * Regions that map a file are static. So are anonymous regions that come
+ * right after them, which is where a module keeps its zero initialized data.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int region_table_init(struct region_table *t, proctal p)
+{
+	size_t capacity = 0;
+
+	t->regions = NULL;
+	t->count = 0;
+
+	proctal_region_set_mask(p, 0);
+	proctal_region_set_read(p, 0);
+	proctal_region_set_write(p, 0);
+	proctal_region_set_execute(p, 0);
+
+	proctal_region_new(p);
+
+	void *start, *end;
+
+	while (proctal_region(p, &start, &end)) {
+		if (t->count == capacity) {
+			capacity = capacity ? capacity * 2 : 256;
+			struct region *regions = realloc(t->regions, capacity * sizeof(*regions));
+
+			if (regions == NULL) {
+				proctal_region_new(p);
+				region_table_deinit(t);
+				fprintf(stderr, "Ran out of memory.\n");
+				return 0;
+			}
+
+			t->regions = regions;
+		}
+
+		struct region *r = &t->regions[t->count];
+		struct region *prev = t->count ? &t->regions[t->count - 1] : NULL;
+		const char *path = proctal_region_path(p);
+
+		r->start = start;
+		r->end = end;
+		r->module = NULL;
+		r->module_start = NULL;
+
+		if (path[0] == '/') {
+			if (prev != NULL && prev->module != NULL && strcmp(prev->module, path) == 0) {
+				r->module = prev->module;
+				r->module_start = prev->module_start;
+			} else {
+				r->module = strdup(path);
+				r->module_start = start;
+
+				if (r->module == NULL) {
+					proctal_region_new(p);
+					region_table_deinit(t);
+					fprintf(stderr, "Ran out of memory.\n");
+					return 0;
+				}
+			}
+		} else if (path[0] == '\0' && prev != NULL && prev->module != NULL && prev->end == r->start) {
+			r->module = prev->module;
+			r->module_start = prev->module_start;
+		}
+
+		t->count += 1;
+	}
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_error_ack(p);
+		region_table_deinit(t);
+		return 0;
+	}
+
+	return 1;
+}
+
+static void print_chain(struct node_list *nodes, size_t i, struct region *root)
+{
+	const char *name = strrchr(root->module, '/');
+	name = name ? name + 1 : root->module;
+
+	struct node *n = &nodes->items[i];
+
+	printf("%s+%" PRIXPTR, name, (uintptr_t) (n->location - root->module_start));
+
+	while (n->parent != (size_t) (n - nodes->items)) {
+		printf(" %zX", n->offset);
+		n = &nodes->items[n->parent];
+	}
+
+	printf("\n");
+}
+
+/*
+ * Walks back from the address one level at a time, looking for pointers that
+ * point close enough before it. Chains are printed as soon as they reach
+ * static memory and are not followed any further.
+ *
+ * Every location is visited at most once, so only the shortest chains through
+ * it are found.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int find_chains(struct cli_cmd_pointerscan_arg *arg, struct region_table *table, proctal_pointer_index index)
+{
+	size_t index_size = proctal_pointer_index_size(index);
+	struct node_list nodes = { NULL, 0, 0 };
+	char *visited = calloc(index_size ? index_size : 1, 1);
+
+	if (visited == NULL || !node_list_add(&nodes, arg->address, 0, 0)) {
+		free(visited);
+		free(nodes.items);
+		fprintf(stderr, "Ran out of memory.\n");
+		return 0;
+	}
+
+	size_t level_start = 0;
+	size_t level_end = 1;
+
+	for (int level = 0; level < arg->depth && level_start < level_end; ++level) {
+		for (size_t i = level_start; i < level_end; ++i) {
+			char *target = nodes.items[i].location;
+			char *lowest = (uintptr_t) target > arg->max_offset
+				? target - arg->max_offset
+				: NULL;
+
+			size_t first;
+			size_t count = proctal_pointer_index_find(index, lowest, target + 1, &first);
+
+			for (size_t j = first; j < first + count; ++j) {
+				if (visited[j]) {
+					continue;
+				}
+
+				visited[j] = 1;
+
+				void *pointee, *location;
+				proctal_pointer_index_get(index, j, &pointee, &location);
+
+				if (!node_list_add(&nodes, location, target - (char *) pointee, i)) {
+					free(visited);
+					free(nodes.items);
+					fprintf(stderr, "Ran out of memory.\n");
+					return 0;
+				}
+
+				struct region *r = region_table_find(table, location);
+
+				if (r != NULL && r->module != NULL) {
+					// Static memory is where chains start. No need
+					// to look any further.
+					print_chain(&nodes, nodes.count - 1, r);
+					nodes.count -= 1;
+				}
+			}
+		}
+
+		level_start = level_end;
+		level_end = nodes.count;
+	}
+
+	free(visited);
+	free(nodes.items);
+
+	return 1;
+}
+
+int cli_cmd_pointerscan(struct cli_cmd_pointerscan_arg *arg)
+{
+	proctal p = proctal_create();
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_destroy(p);
+		return 1;
+	}
+
+	proctal_set_pid(p, arg->pid);
+
+	struct region_table table;
+
+	if (!region_table_init(&table, p)) {
+		proctal_destroy(p);
+		return 1;
+	}
+
+	proctal_pointer_index index = proctal_pointer_index_create(p);
+
+	if (index == NULL) {
+		cli_print_proctal_error(p);
+		region_table_deinit(&table);
+		proctal_destroy(p);
+		return 1;
+	}
+
+	proctal_pointer_index_set_threads(index, arg->threads);
+
+	if (!proctal_pointer_index_build(p, index)) {
+		cli_print_proctal_error(p);
+		proctal_pointer_index_destroy(p, index);
+		region_table_deinit(&table);
+		proctal_destroy(p);
+		return 1;
+	}
+
+	int ok = find_chains(arg, &table, index);
+
+	proctal_pointer_index_destroy(p, index);
+	region_table_deinit(&table);
+	proctal_destroy(p);
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,26 @@
+#ifndef CLI_CMD_POINTERSCAN_H
+#define CLI_CMD_POINTERSCAN_H
+
+#include <stdlib.h>
+
+struct cli_cmd_pointerscan_arg {
+	int pid;
+
+	// Address that the pointer chains lead to.
+	void *address;
+
+	// Largest number of pointers in a chain.
+	int depth;
+
+	// Largest distance between where a pointer points to and the address
+	// where the next step of the chain is.
+	size_t max_offset;
+
+	// Number of threads used to go over memory. 0 means one per
+	// processor.
+	int threads;
+};
+
+int cli_cmd_pointerscan(struct cli_cmd_pointerscan_arg *arg);
+
+#endif /* CLI_CMD_POINTERSCAN_H */
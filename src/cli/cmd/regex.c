@@ -0,0 +1,35 @@
+#include "cli/cmd/regex.h"
+#include "cli/printer.h"
+#include "cli/regex.h"
+#include "cli/finder.h"
+
+int cli_cmd_regex(struct cli_cmd_regex_arg *arg)
+{
+	cli_regex cr = cli_regex_create();
+	cli_regex_compile(cr, arg->regex);
+
+	if (cli_regex_error(cr)) {
+		cli_print_regex_error(cr);
+		cli_regex_destroy(cr);
+		return 1;
+	}
+
+	struct cli_find_arg find_arg;
+	find_arg.pid = arg->pid;
+	find_arg.read = arg->read;
+	find_arg.write = arg->write;
+	find_arg.execute = arg->execute;
+	find_arg.program_code = arg->program_code;
+	find_arg.threads = arg->threads;
+	find_arg.forward = cli_regex_forward(cr);
+	find_arg.backward = cli_regex_backward(cr);
+	find_arg.prefix = cli_regex_prefix(cr, &find_arg.prefix_size);
+	find_arg.masks = NULL;
+	find_arg.describe = NULL;
+
+	int ok = cli_find(&find_arg);
+
+	cli_regex_destroy(cr);
+
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,28 @@
+#ifndef CLI_CMD_REGEX_H
+#define CLI_CMD_REGEX_H
+
+struct cli_cmd_regex_arg {
+	int pid;
+
+	const char *regex;
+
+	// Whether to search readable memory addresses.
+	int read;
+
+	// Whether to search writable memory addresses.
+	int write;
+
+	// Whether to search executable memory addresses.
+	int execute;
+
+	// Whether to search program code.
+	int program_code;
+
+	// Number of threads used to go over memory. 0 means one per
+	// processor.
+	int threads;
+};
+
+int cli_cmd_regex(struct cli_cmd_regex_arg *arg);
+
+#endif /* CLI_CMD_REGEX_H */
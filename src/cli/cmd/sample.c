@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+
+#include "cli/cmd/sample.h"
+#include "cli/printer.h"
+#include "lib/include/proctal.h"
+#include "tally/tally.h"
+
+static int request_quit = 0;
+
+static void quit(int signum)
+{
+	request_quit = 1;
+}
+
+static int register_signal_handler()
+{
+	struct sigaction sa = {
+		.sa_handler = quit,
+		.sa_flags = 0,
+	};
+
+	sigemptyset(&sa.sa_mask);
+
+	return sigaction(SIGINT, &sa, NULL) != -1
+		&& sigaction(SIGTERM, &sa, NULL) != -1;
+}
+
+static void unregister_signal_handler()
+{
+	signal(SIGINT, SIG_DFL);
+	signal(SIGTERM, SIG_DFL);
+}
+
+static double seconds(struct timespec *t)
+{
+	return t->tv_sec + t->tv_nsec / 1e9;
+}
+
+/*
+ * Counts where every thread was in the last sample. Stacks are counted by
+ * their addresses, innermost first.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int count_sample(proctal p, struct tally *stacks, int folded, void **addrs)
+{
+	for (size_t i = 0; i < proctal_sample_thread_count(p); ++i) {
+		size_t depth = folded ? proctal_sample_frame_count(p, i) : 1;
+
+		for (size_t j = 0; j < depth; ++j) {
+			addrs[j] = proctal_sample_frame(p, i, j);
+		}
+
+		size_t position;
+
+		if (!tally_add(stacks, addrs, depth * sizeof(*addrs), &position)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Prints every stack, the most frequent first. Folded stacks go from the
+ * outermost function inwards.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int print_stacks(struct tally *stacks)
+{
+	size_t *sorted = tally_sort(stacks);
+
+	if (sorted == NULL) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < stacks->count; ++i) {
+		struct tally_entry *stack = &stacks->entries[sorted[i]];
+		const char *key = tally_key(stacks, sorted[i]);
+		size_t depth = stack->key_size / sizeof(void *);
+
+		for (size_t j = depth; j > 0; --j) {
+			void *addr;
+			memcpy(&addr, key + (j - 1) * sizeof(addr), sizeof(addr));
+
+			cli_print_address(addr);
+
+			if (j > 1) {
+				printf(";");
+			}
+		}
+
+		printf(" %llu\n", stack->count);
+	}
+
+	free(sorted);
+
+	fflush(stdout);
+
+	return 1;
+}
+
+int cli_cmd_sample(struct cli_cmd_sample_arg *arg)
+{
+	void **addrs = malloc(arg->depth * sizeof(*addrs));
+
+	if (addrs == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		return 1;
+	}
+
+	if (!register_signal_handler()) {
+		fprintf(stderr, "Failed to set up signal handler.\n");
+		free(addrs);
+		return 1;
+	}
+
+	proctal p = proctal_create();
+
+	if (proctal_error(p)) {
+		unregister_signal_handler();
+		cli_print_proctal_error(p);
+		proctal_destroy(p);
+		free(addrs);
+		return 1;
+	}
+
+	proctal_set_pid(p, arg->pid);
+	proctal_sample_set_depth(p, arg->folded ? arg->depth : 1);
+
+	struct tally stacks;
+	tally_init(&stacks, 0);
+
+	// How long the process was stopped for every sample, in seconds.
+	double stopped = 0;
+	double stopped_max = 0;
+	unsigned long long samples = 0;
+
+	int out_of_memory = 0;
+
+	struct timespec start, next;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	next = start;
+
+	long period = 1e9 / arg->hz;
+
+	while (!request_quit) {
+		struct timespec before, after;
+
+		clock_gettime(CLOCK_MONOTONIC, &before);
+
+		if (arg->duration && seconds(&before) - seconds(&start) >= arg->duration) {
+			break;
+		}
+
+		if (!proctal_sample(p)) {
+			break;
+		}
+
+		clock_gettime(CLOCK_MONOTONIC, &after);
+
+		double time = seconds(&after) - seconds(&before);
+
+		stopped += time;
+		++samples;
+
+		if (time > stopped_max) {
+			stopped_max = time;
+		}
+
+		if (!count_sample(p, &stacks, arg->folded, addrs)) {
+			out_of_memory = 1;
+			break;
+		}
+
+		next.tv_sec += (next.tv_nsec + period) / 1000000000;
+		next.tv_nsec = (next.tv_nsec + period) % 1000000000;
+
+		// Samples that could not be taken in time are not made up
+		// for.
+		if (seconds(&next) < seconds(&after)) {
+			next = after;
+		}
+
+		// Interrupted by a signal when asked to quit.
+		clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+	}
+
+	unregister_signal_handler();
+
+	free(addrs);
+
+	if (!out_of_memory && !print_stacks(&stacks)) {
+		out_of_memory = 1;
+	}
+
+	tally_deinit(&stacks);
+
+	if (samples) {
+		fprintf(stderr, "Took %llu samples, stopping the process for %.0f microseconds on average and %.0f at most.\n", samples, stopped / samples * 1e6, stopped_max * 1e6);
+	}
+
+	if (out_of_memory) {
+		fprintf(stderr, "Ran out of memory.\n");
+		proctal_destroy(p);
+		return 1;
+	}
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_destroy(p);
+		return 1;
+	}
+
+	proctal_destroy(p);
+
+	return 0;
+}
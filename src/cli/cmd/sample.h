@@ -0,0 +1,26 @@
+#ifndef CLI_CMD_SAMPLE_H
+#define CLI_CMD_SAMPLE_H
+
+#include <stdlib.h>
+
+struct cli_cmd_sample_arg {
+	int pid;
+
+	// Number of samples taken per second.
+	double hz;
+
+	// Number of seconds to take samples for, or 0 to take them until
+	// interrupted.
+	double duration;
+
+	// Whether to count whole stacks and print them folded instead of
+	// counting instructions.
+	int folded;
+
+	// Largest number of addresses in a stack, counting the instruction.
+	size_t depth;
+};
+
+int cli_cmd_sample(struct cli_cmd_sample_arg *arg);
+
+#endif /* CLI_CMD_SAMPLE_H */
@@ -1,4 +1,6 @@
 #include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
 
 #include "cli/cmd/search.h"
 #include "cli/printer.h"
@@ -8,6 +10,11 @@
 #include "lib/include/proctal.h"
 #include "swbuf/swbuf.h"
 #include "chunk/chunk.h"
+#include "vset/vset.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 static inline struct cli_val_filter_compare_arg *create_filter_compare_arg(struct cli_cmd_search_arg *arg)
 {
@@ -31,6 +38,11 @@ static inline struct cli_val_filter_compare_arg *create_filter_compare_arg(struc
 
 #undef COPY
 
+	if (arg->epsilon || arg->round) {
+		// Checked separately against a range.
+		filter_arg->eq = nil;
+	}
+
 	return filter_arg;
 }
 
@@ -72,6 +84,57 @@ static inline void destroy_filter_compare_prev_arg(struct cli_val_filter_compare
 	free(filter_arg);
 }
 
+/*
+ * Loads the values listed in a file into a set. Values are separated by
+ * whitespace.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int load_value_set(struct cli_cmd_search_arg *arg, struct vset *set)
+{
+	FILE *f = fopen(arg->in_file, "r");
+
+	if (f == NULL) {
+		fprintf(stderr, "Failed to open %s.\n", arg->in_file);
+		return 0;
+	}
+
+	cli_val value = cli_val_create_clone(arg->value);
+
+	vset_init(set, cli_val_sizeof(value));
+
+	for (;;) {
+		cli_scan_skip_chars(f, "\n\t ");
+
+		if (feof(f)) {
+			break;
+		}
+
+		if (!cli_val_scan(value, f)) {
+			fprintf(stderr, "Failed to parse value in %s.\n", arg->in_file);
+			cli_val_destroy(value);
+			vset_deinit(set);
+			fclose(f);
+			return 0;
+		}
+
+		if (!vset_add(set, cli_val_raw(value))) {
+			break;
+		}
+	}
+
+	cli_val_destroy(value);
+	fclose(f);
+
+	if (vset_error(set) || !vset_seal(set)) {
+		fprintf(stderr, "Ran out of memory.\n");
+		vset_deinit(set);
+		return 0;
+	}
+
+	return 1;
+}
+
 static inline void print_search_match(cli_val addr, cli_val value)
 {
 	cli_val_print(addr, stdout);
@@ -91,7 +154,7 @@ static inline void *align_addr(void *addr, size_t align)
 	return (void *) ((char *) addr + offset);
 }
 
-static inline void search_process(struct cli_cmd_search_arg *arg, proctal p)
+static inline void search_process(struct cli_cmd_search_arg *arg, proctal p, struct vset *set)
 {
 	struct cli_val_filter_compare_arg *filter_compare_arg = create_filter_compare_arg(arg);
 
@@ -141,7 +204,8 @@ static inline void search_process(struct cli_cmd_search_arg *arg, proctal p)
 				memcpy(cli_val_raw(value), swbuf_address_offset(&buf, prev_size - leftover - buffer_size), leftover);
 				memcpy((char *) cli_val_raw(value) + leftover, swbuf_address_offset(&buf, rightover), rightover);
 
-				if (cli_val_filter_compare(filter_compare_arg, value)) {
+				if ((set == NULL || vset_contains(set, cli_val_raw(value)))
+					&& cli_val_filter_compare(filter_compare_arg, value)) {
 					void *a = offset - leftover;
 					cli_val_parse_bin(addr, (char *) &a, sizeof(a));
 
@@ -160,7 +224,8 @@ static inline void search_process(struct cli_cmd_search_arg *arg, proctal p)
 
 				memcpy(cli_val_raw(value), swbuf_address_offset(&buf, i), size);
 
-				if (cli_val_filter_compare(filter_compare_arg, value)) {
+				if ((set == NULL || vset_contains(set, cli_val_raw(value)))
+					&& cli_val_filter_compare(filter_compare_arg, value)) {
 					void *a = offset + i;
 					cli_val_parse_bin(addr, (char *) &a, sizeof(a));
 
@@ -192,7 +257,807 @@ static inline void search_process(struct cli_cmd_search_arg *arg, proctal p)
 	}
 }
 
-static inline void search_input(struct cli_cmd_search_arg *arg, proctal p)
+/*
+ * Values an integer has to be between to pass the comparisons, in a form that
+ * is cheap to check against integers of any size. Bounds are inclusive.
+ */
+struct integer_range {
+	int is_signed;
+
+	int64_t slo;
+	int64_t shi;
+	uint64_t ulo;
+	uint64_t uhi;
+
+	// Value to exclude if ne was given.
+	int ne;
+	int64_t sne;
+	uint64_t une;
+
+	// Whether no value passes.
+	int empty;
+};
+
+/*
+ * An integer size along with the range of values its integers can hold,
+ * narrowed down by the comparisons.
+ */
+struct integer_size_filter {
+	size_t size;
+
+	// Tag printed next to matches.
+	const char *name;
+
+	struct integer_range range;
+};
+
+static inline int64_t raw_int64(cli_val v)
+{
+	int64_t n;
+	memcpy(&n, cli_val_raw(v), sizeof(n));
+	return n;
+}
+
+static inline uint64_t raw_uint64(cli_val v)
+{
+	uint64_t n;
+	memcpy(&n, cli_val_raw(v), sizeof(n));
+	return n;
+}
+
+/*
+ * Reads an integer of the given size from memory and widens it to 64 bits.
+ */
+static inline int64_t read_int64(const char *data, size_t size)
+{
+#define READ(TYPE) \
+	do { \
+		TYPE v; \
+		memcpy(&v, data, sizeof(v)); \
+		return v; \
+	} while (0)
+
+	switch (size) {
+	case 1:
+		READ(int8_t);
+
+	case 2:
+		READ(int16_t);
+
+	case 4:
+		READ(int32_t);
+
+	default:
+		READ(int64_t);
+	}
+
+#undef READ
+}
+
+static inline uint64_t read_uint64(const char *data, size_t size)
+{
+#define READ(TYPE) \
+	do { \
+		TYPE v; \
+		memcpy(&v, data, sizeof(v)); \
+		return v; \
+	} while (0)
+
+	switch (size) {
+	case 1:
+		READ(uint8_t);
+
+	case 2:
+		READ(uint16_t);
+
+	case 4:
+		READ(uint32_t);
+
+	default:
+		READ(uint64_t);
+	}
+
+#undef READ
+}
+
+/*
+ * Turns the comparisons into a range. The values being compared against are
+ * expected to be 64-bit integers.
+ */
+static void integer_range_init(struct integer_range *r, struct cli_cmd_search_arg *arg)
+{
+	r->is_signed = arg->integer_sign == CLI_VAL_INTEGER_SIGN_2SCMPL;
+	r->slo = INT64_MIN;
+	r->shi = INT64_MAX;
+	r->ulo = 0;
+	r->uhi = UINT64_MAX;
+	r->ne = 0;
+	r->empty = 0;
+
+#define NARROW(LO, HI, TYPE, READ, MIN, MAX) \
+	if (arg->eq) { \
+		TYPE n = READ(arg->eq_value); \
+		LO = n > LO ? n : LO; \
+		HI = n < HI ? n : HI; \
+	} \
+\
+	if (arg->gte) { \
+		TYPE n = READ(arg->gte_value); \
+		LO = n > LO ? n : LO; \
+	} \
+\
+	if (arg->lte) { \
+		TYPE n = READ(arg->lte_value); \
+		HI = n < HI ? n : HI; \
+	} \
+\
+	if (arg->gt) { \
+		TYPE n = READ(arg->gt_value); \
+\
+		if (n == MAX) { \
+			r->empty = 1; \
+		} else { \
+			LO = n + 1 > LO ? n + 1 : LO; \
+		} \
+	} \
+\
+	if (arg->lt) { \
+		TYPE n = READ(arg->lt_value); \
+\
+		if (n == MIN) { \
+			r->empty = 1; \
+		} else { \
+			HI = n - 1 < HI ? n - 1 : HI; \
+		} \
+	} \
+\
+	if (LO > HI) { \
+		r->empty = 1; \
+	}
+
+	if (r->is_signed) {
+		NARROW(r->slo, r->shi, int64_t, raw_int64, INT64_MIN, INT64_MAX);
+
+		if (arg->ne) {
+			r->ne = 1;
+			r->sne = raw_int64(arg->ne_value);
+		}
+	} else {
+		NARROW(r->ulo, r->uhi, uint64_t, raw_uint64, 0, UINT64_MAX);
+
+		if (arg->ne) {
+			r->ne = 1;
+			r->une = raw_uint64(arg->ne_value);
+		}
+	}
+
+#undef NARROW
+}
+
+/*
+ * Narrows down a range to the values that integers of the given size can
+ * hold.
+ */
+static void integer_range_clamp(struct integer_range *r, size_t size)
+{
+	if (size == sizeof(uint64_t)) {
+		return;
+	}
+
+	if (r->is_signed) {
+		int64_t min = -((int64_t) 1 << (size * 8 - 1));
+		int64_t max = ((int64_t) 1 << (size * 8 - 1)) - 1;
+
+		r->slo = r->slo > min ? r->slo : min;
+		r->shi = r->shi < max ? r->shi : max;
+		r->empty |= r->slo > r->shi;
+	} else {
+		uint64_t max = ((uint64_t) 1 << (size * 8)) - 1;
+
+		r->uhi = r->uhi < max ? r->uhi : max;
+		r->empty |= r->ulo > r->uhi;
+	}
+}
+
+/*
+ * Checks whether an integer stored in memory is within the range. Integers are
+ * widened to 64 bits so that every size can be checked the same way.
+ */
+static inline int integer_range_contains(struct integer_range *r, const char *data, size_t size)
+{
+	if (r->is_signed) {
+		int64_t n = read_int64(data, size);
+
+		return n >= r->slo && n <= r->shi && !(r->ne && n == r->sne);
+	} else {
+		uint64_t n = read_uint64(data, size);
+
+		return n >= r->ulo && n <= r->uhi && !(r->ne && n == r->une);
+	}
+}
+
+static void print_integer_match(struct integer_size_filter *f, cli_val addr, const char *data)
+{
+	cli_val_print(addr, stdout);
+
+	if (f->range.is_signed) {
+		printf(" %" PRIi64, read_int64(data, f->size));
+	} else {
+		printf(" %" PRIu64, read_uint64(data, f->size));
+	}
+
+	printf(" %s\n", f->name);
+}
+
+/*
+ * Searches for integers of every size in a single pass. Each chunk of memory
+ * is read once and every size whose range isn't empty is checked against it.
+ *
+ * Matches are tagged with the size and sign of the integer.
+ */
+static inline void search_process_any_integer_size(struct cli_cmd_search_arg *arg, proctal p)
+{
+	int is_signed = arg->integer_sign == CLI_VAL_INTEGER_SIGN_2SCMPL;
+
+	struct integer_size_filter filters[] = {
+		{ .size = 1, .name = is_signed ? "i8" : "u8" },
+		{ .size = 2, .name = is_signed ? "i16" : "u16" },
+		{ .size = 4, .name = is_signed ? "i32" : "u32" },
+		{ .size = 8, .name = is_signed ? "i64" : "u64" },
+	};
+	size_t filter_count = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(filters); ++i) {
+		struct integer_size_filter *f = &filters[i];
+
+		integer_range_init(&f->range, arg);
+		integer_range_clamp(&f->range, f->size);
+
+		// Sizes that can't hold any of the values are not worth
+		// looking at.
+		if (!f->range.empty) {
+			filters[filter_count++] = *f;
+		}
+	}
+
+	if (filter_count == 0) {
+		return;
+	}
+
+	const size_t buffer_size = 1024 * 1024;
+	const size_t max_size = sizeof(uint64_t);
+
+	char *buffer = malloc(buffer_size + max_size - 1);
+
+	if (buffer == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		return;
+	}
+
+	cli_val addr = cli_val_wrap(CLI_VAL_TYPE_ADDRESS, cli_val_address_create());
+
+	proctal_region_set_mask(p, 0);
+
+	proctal_region_new(p);
+
+	void *start, *end;
+	struct chunk chunk;
+
+	while (proctal_region(p, &start, &end)) {
+		chunk_init(&chunk, start, end, buffer_size);
+
+		do {
+			char *offset = chunk_offset(&chunk);
+			size_t curr_size = chunk_size(&chunk);
+
+			size_t read_size = chunk_overlap_size(&chunk, max_size);
+
+			proctal_read(p, offset, buffer, read_size);
+
+			if (proctal_error(p)) {
+				cli_print_proctal_error(p);
+				proctal_error_ack(p);
+				continue;
+			}
+
+			for (size_t i = 0; i < filter_count; ++i) {
+				struct integer_size_filter *f = &filters[i];
+
+				// Chunks start at the beginning of a region
+				// or at a multiple of the buffer size after
+				// it, so aligning the first address is enough.
+				size_t first = (char *) align_addr(offset, f->size) - offset;
+
+				for (size_t j = first; j < curr_size && j + f->size <= read_size; j += f->size) {
+					if (!integer_range_contains(&f->range, buffer + j, f->size)) {
+						continue;
+					}
+
+					void *a = offset + j;
+					cli_val_parse_bin(addr, (char *) &a, sizeof(a));
+
+					print_integer_match(f, addr, buffer + j);
+				}
+			}
+		} while (chunk_next(&chunk));
+	}
+
+	proctal_region_new(p);
+
+	cli_val_destroy(addr);
+	free(buffer);
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_error_ack(p);
+	}
+}
+
+/*
+ * Floating point numbers that are approximately equal to a value, given as an
+ * inclusive range. NaN is never in the range because every comparison with it
+ * is false.
+ */
+struct ieee754_range {
+	// Either 4 for single or 8 for double precision.
+	size_t size;
+
+	double lo;
+	double hi;
+
+	// Bounds converted to single precision.
+	float flo;
+	float fhi;
+};
+
+static void ieee754_range_init(struct ieee754_range *r, struct cli_cmd_search_arg *arg)
+{
+	double x;
+
+	r->size = cli_val_sizeof(arg->eq_value);
+
+	if (r->size == sizeof(float)) {
+		float f;
+		memcpy(&f, cli_val_raw(arg->eq_value), sizeof(f));
+		x = f;
+	} else {
+		memcpy(&x, cli_val_raw(arg->eq_value), sizeof(x));
+	}
+
+	if (arg->epsilon) {
+		r->lo = x - arg->epsilon_value;
+		r->hi = x + arg->epsilon_value;
+	} else {
+		double scale = 1;
+
+		for (int i = 0; i < arg->round_value; ++i) {
+			scale *= 10;
+		}
+
+		double scaled = x * scale;
+
+		// Past this magnitude there are no decimal places left to
+		// round and the conversion to an integer would overflow.
+		if (scaled > -4e18 && scaled < 4e18) {
+			long long n = scaled < 0 ? -(long long) (-scaled + 0.5) : (long long) (scaled + 0.5);
+			x = n / scale;
+		}
+
+		// Values exactly halfway between two roundings match both.
+		r->lo = x - 0.5 / scale;
+		r->hi = x + 0.5 / scale;
+	}
+
+	r->flo = r->lo;
+	r->fhi = r->hi;
+}
+
+static inline int ieee754_range_contains(struct ieee754_range *r, const char *data)
+{
+	if (r->size == sizeof(float)) {
+		float v;
+		memcpy(&v, data, sizeof(v));
+		return v >= r->flo && v <= r->fhi;
+	} else {
+		double v;
+		memcpy(&v, data, sizeof(v));
+		return v >= r->lo && v <= r->hi;
+	}
+}
+
+/*
+ * Finds the next position, starting at i and going in steps of the size of a
+ * number, of a number within the range. Positions from end onwards are not
+ * checked and the bytes of the last number must be available.
+ *
+ * With SSE2, 16 bytes worth of numbers are compared at once.
+ *
+ * Returns end if there is none.
+ */
+static size_t ieee754_range_find(struct ieee754_range *r, const char *data, size_t i, size_t end)
+{
+	size_t size = r->size;
+
+#ifdef __SSE2__
+	if (size == sizeof(float)) {
+		__m128 lo = _mm_set1_ps(r->flo);
+		__m128 hi = _mm_set1_ps(r->fhi);
+
+		for (; i + 3 * size < end; i += 4 * size) {
+			__m128 v = _mm_loadu_ps((const float *) (data + i));
+			int mask = _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(v, lo), _mm_cmple_ps(v, hi)));
+
+			if (mask) {
+				break;
+			}
+		}
+	} else {
+		__m128d lo = _mm_set1_pd(r->lo);
+		__m128d hi = _mm_set1_pd(r->hi);
+
+		for (; i + size < end; i += 2 * size) {
+			__m128d v = _mm_loadu_pd((const double *) (data + i));
+			int mask = _mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(v, lo), _mm_cmple_pd(v, hi)));
+
+			if (mask) {
+				break;
+			}
+		}
+	}
+#endif
+
+	// Finds the exact position in the block the vectorized loop stopped
+	// at and takes care of whatever is left.
+	for (; i < end; i += size) {
+		if (ieee754_range_contains(r, data + i)) {
+			return i;
+		}
+	}
+
+	return end;
+}
+
+/*
+ * Searches for floating point numbers that are approximately equal to a value.
+ * Numbers within the range are found first and the remaining filters are only
+ * checked on them.
+ */
+static inline void search_process_ieee754_approx(struct cli_cmd_search_arg *arg, proctal p)
+{
+	struct cli_val_filter_compare_arg *filter_compare_arg = create_filter_compare_arg(arg);
+	struct ieee754_range range;
+	ieee754_range_init(&range, arg);
+
+	size_t size = range.size;
+	const size_t buffer_size = 1024 * 1024;
+
+	char *buffer = malloc(buffer_size + size - 1);
+
+	if (buffer == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		destroy_filter_compare_arg(filter_compare_arg);
+		return;
+	}
+
+	cli_val addr = cli_val_wrap(CLI_VAL_TYPE_ADDRESS, cli_val_address_create());
+	cli_val value = arg->value;
+
+	proctal_region_set_mask(p, 0);
+
+	proctal_region_new(p);
+
+	void *start, *end;
+	struct chunk chunk;
+
+	while (proctal_region(p, &start, &end)) {
+		char *first = align_addr(start, size);
+
+		if (first + size > (char *) end) {
+			continue;
+		}
+
+		chunk_init(&chunk, first, end, buffer_size);
+
+		do {
+			char *offset = chunk_offset(&chunk);
+			size_t curr_size = chunk_size(&chunk);
+
+			size_t read_size = chunk_overlap_size(&chunk, size);
+
+			proctal_read(p, offset, buffer, read_size);
+
+			if (proctal_error(p)) {
+				cli_print_proctal_error(p);
+				proctal_error_ack(p);
+				continue;
+			}
+
+			size_t limit = read_size - size + 1;
+
+			if (limit > curr_size) {
+				limit = curr_size;
+			}
+
+			for (size_t i = 0; (i = ieee754_range_find(&range, buffer, i, limit)) < limit; i += size) {
+				memcpy(cli_val_raw(value), buffer + i, size);
+
+				if (!cli_val_filter_compare(filter_compare_arg, value)) {
+					continue;
+				}
+
+				void *a = offset + i;
+				cli_val_parse_bin(addr, (char *) &a, sizeof(a));
+
+				print_search_match(addr, value);
+			}
+		} while (chunk_next(&chunk));
+	}
+
+	proctal_region_new(p);
+
+	cli_val_destroy(addr);
+	free(buffer);
+	destroy_filter_compare_arg(filter_compare_arg);
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_error_ack(p);
+	}
+}
+
+/*
+ * Text to look for with the bits that are ignored when comparing it.
+ */
+struct text_needle {
+	const char *bytes;
+	size_t size;
+
+	// Size of a character. Text only starts at multiples of it.
+	size_t char_size;
+
+	// Bits of every byte that are set before comparing, which is how
+	// letters are made to match regardless of their case. NULL when
+	// bytes must match exactly.
+	char *fold;
+
+	// The needle with the fold bits set.
+	char *folded;
+};
+
+static inline int is_ascii_letter(unsigned char c)
+{
+	return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+/*
+ * A character is an ASCII letter when its first byte is one and the rest are
+ * zero, which holds for both ASCII and UTF-16LE. Upper and lower case letters
+ * only differ by the 0x20 bit, and setting it does not turn anything else into
+ * a letter.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int text_needle_init(struct text_needle *n, struct cli_cmd_search_arg *arg)
+{
+	n->bytes = arg->text;
+	n->size = arg->text_size;
+	n->char_size = cli_val_sizeof(arg->value);
+	n->fold = NULL;
+	n->folded = NULL;
+
+	if (!arg->ignore_case) {
+		return 1;
+	}
+
+	n->fold = calloc(n->size, 1);
+	n->folded = malloc(n->size);
+
+	if (n->fold == NULL || n->folded == NULL) {
+		free(n->fold);
+		free(n->folded);
+		fprintf(stderr, "Ran out of memory.\n");
+		return 0;
+	}
+
+	for (size_t i = 0; i < n->size; i += n->char_size) {
+		int letter = is_ascii_letter(n->bytes[i]);
+
+		for (size_t j = 1; j < n->char_size; ++j) {
+			if (n->bytes[i + j] != 0) {
+				letter = 0;
+			}
+		}
+
+		if (letter) {
+			n->fold[i] = 0x20;
+		}
+	}
+
+	for (size_t i = 0; i < n->size; ++i) {
+		n->folded[i] = n->bytes[i] | n->fold[i];
+	}
+
+	return 1;
+}
+
+static void text_needle_deinit(struct text_needle *n)
+{
+	free(n->fold);
+	free(n->folded);
+}
+
+static inline int text_needle_matches(struct text_needle *n, const char *data)
+{
+	if (n->fold == NULL) {
+		return memcmp(data, n->bytes, n->size) == 0;
+	}
+
+	for (size_t i = 0; i < n->size; ++i) {
+		if ((data[i] | n->fold[i]) != n->folded[i]) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Finds the next position, starting at i and going in steps of the size of a
+ * character, where the text is stored. Positions from end onwards are not
+ * checked and the bytes of the text at the last position must be available.
+ *
+ * With SSE2, 16 positions are filtered at once by their first and last bytes
+ * and only the ones that pass are compared in full.
+ *
+ * Returns end if there is none.
+ */
+static size_t text_needle_find(struct text_needle *n, const char *data, size_t i, size_t end)
+{
+	const char *bytes = n->fold ? n->folded : n->bytes;
+	size_t last = n->size - 1;
+
+#ifdef __SSE2__
+	char first_fold = n->fold ? n->fold[0] : 0;
+	char last_fold = n->fold ? n->fold[last] : 0;
+
+	__m128i first_bits = _mm_set1_epi8(first_fold);
+	__m128i last_bits = _mm_set1_epi8(last_fold);
+	__m128i first_byte = _mm_set1_epi8(bytes[0]);
+	__m128i last_byte = _mm_set1_epi8(bytes[last]);
+
+	// Characters that take up 2 bytes only start at even positions.
+	int positions = n->char_size == 2 ? 0x5555 : 0xFFFF;
+
+	for (; i + 16 <= end; i += 16) {
+		__m128i f = _mm_or_si128(_mm_loadu_si128((const __m128i *) (data + i)), first_bits);
+		__m128i l = _mm_or_si128(_mm_loadu_si128((const __m128i *) (data + i + last)), last_bits);
+
+		int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(f, first_byte), _mm_cmpeq_epi8(l, last_byte)));
+		mask &= positions;
+
+		while (mask) {
+			int bit = __builtin_ctz(mask);
+
+			if (text_needle_matches(n, data + i + bit)) {
+				return i + bit;
+			}
+
+			mask &= mask - 1;
+		}
+	}
+#endif
+
+	// Fewer than 16 positions may be left at the end, or all of them
+	// without SSE2, and those are checked one character at a time.
+	for (; i < end; i += n->char_size) {
+		if (text_needle_matches(n, data + i)) {
+			return i;
+		}
+	}
+
+	return end;
+}
+
+static void print_text_match(cli_val addr, cli_val value, const char *data, size_t size)
+{
+	cli_val_print(addr, stdout);
+	printf(" ");
+
+	for (size_t i = 0; i < size; i += cli_val_sizeof(value)) {
+		cli_val_parse_bin(value, data + i, size - i);
+		cli_val_print(value, stdout);
+	}
+
+	printf("\n");
+}
+
+/*
+ * Searches for text as a whole instead of one character at a time.
+ */
+static inline void search_process_text(struct cli_cmd_search_arg *arg, proctal p)
+{
+	struct text_needle needle;
+
+	if (!text_needle_init(&needle, arg)) {
+		return;
+	}
+
+	size_t size = needle.size;
+	const size_t buffer_size = 1024 * 1024;
+
+	char *buffer = malloc(buffer_size + size - 1);
+
+	if (buffer == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		text_needle_deinit(&needle);
+		return;
+	}
+
+	cli_val addr = cli_val_wrap(CLI_VAL_TYPE_ADDRESS, cli_val_address_create());
+	cli_val value = arg->value;
+
+	proctal_region_set_mask(p, 0);
+
+	proctal_region_new(p);
+
+	void *start, *end;
+	struct chunk chunk;
+
+	while (proctal_region(p, &start, &end)) {
+		char *first = align_addr(start, needle.char_size);
+
+		if (first + size > (char *) end) {
+			continue;
+		}
+
+		chunk_init(&chunk, first, end, buffer_size);
+
+		do {
+			char *offset = chunk_offset(&chunk);
+			size_t curr_size = chunk_size(&chunk);
+
+			size_t read_size = chunk_overlap_size(&chunk, size);
+
+			if (read_size < size) {
+				continue;
+			}
+
+			proctal_read(p, offset, buffer, read_size);
+
+			if (proctal_error(p)) {
+				cli_print_proctal_error(p);
+				proctal_error_ack(p);
+				continue;
+			}
+
+			size_t limit = read_size - size + 1;
+
+			if (limit > curr_size) {
+				limit = curr_size;
+			}
+
+			for (size_t i = 0; (i = text_needle_find(&needle, buffer, i, limit)) < limit; i += needle.char_size) {
+				void *a = offset + i;
+				cli_val_parse_bin(addr, (char *) &a, sizeof(a));
+
+				print_text_match(addr, value, buffer + i, size);
+			}
+		} while (chunk_next(&chunk));
+	}
+
+	proctal_region_new(p);
+
+	cli_val_destroy(addr);
+	free(buffer);
+	text_needle_deinit(&needle);
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_error_ack(p);
+	}
+}
+
+static inline void search_input(struct cli_cmd_search_arg *arg, proctal p, struct vset *set)
 {
 	struct cli_val_filter_compare_arg *filter_compare_arg = create_filter_compare_arg(arg);
 	struct cli_val_filter_compare_prev_arg *filter_compare_prev_arg = create_filter_compare_prev_arg(arg);
@@ -201,6 +1066,13 @@ static inline void search_input(struct cli_cmd_search_arg *arg, proctal p)
 	cli_val value = arg->value;
 	cli_val previous_value = cli_val_create_clone(value);
 
+	int approx = arg->epsilon || arg->round;
+	struct ieee754_range range;
+
+	if (approx) {
+		ieee754_range_init(&range, arg);
+	}
+
 	for (;;) {
 		cli_scan_skip_chars(stdin, "\n ");
 
@@ -250,6 +1122,14 @@ static inline void search_input(struct cli_cmd_search_arg *arg, proctal p)
 			continue;
 		}
 
+		if (set != NULL && !vset_contains(set, cli_val_raw(value))) {
+			continue;
+		}
+
+		if (approx && !ieee754_range_contains(&range, cli_val_raw(value))) {
+			continue;
+		}
+
 		if (!cli_val_filter_compare(filter_compare_arg, value)) {
 			continue;
 		}
@@ -299,10 +1179,29 @@ int cli_cmd_search(struct cli_cmd_search_arg *arg)
 		proctal_region_set_execute(p, arg->execute);
 	}
 
+	struct vset set;
+
+	if (arg->in_file != NULL && !load_value_set(arg, &set)) {
+		proctal_destroy(p);
+		return 1;
+	}
+
+	struct vset *set_arg = arg->in_file != NULL ? &set : NULL;
+
 	if (arg->input) {
-		search_input(arg, p);
+		search_input(arg, p, set_arg);
+	} else if (arg->any_integer_size) {
+		search_process_any_integer_size(arg, p);
+	} else if (arg->epsilon || arg->round) {
+		search_process_ieee754_approx(arg, p);
+	} else if (arg->text != NULL) {
+		search_process_text(arg, p);
 	} else {
-		search_process(arg, p);
+		search_process(arg, p, set_arg);
+	}
+
+	if (set_arg != NULL) {
+		vset_deinit(set_arg);
 	}
 
 	proctal_destroy(p);
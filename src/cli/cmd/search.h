@@ -22,10 +22,39 @@ struct cli_cmd_search_arg {
 	// Whether we're going to read from stdin.
 	int input;
 
+	// Path to a file with values to look for or NULL if there's none.
+	const char *in_file;
+
+	// Whether to search for integers of every size at once. The value and
+	// the values it's compared against are then 64-bit integers.
+	int any_integer_size;
+
+	// Signing notation of the integers when searching for every size.
+	enum cli_val_integer_sign integer_sign;
+
 	// Whether to perform an equality check.
 	int eq;
 	cli_val eq_value;
 
+	// Whether floating point numbers only need to be within a distance of
+	// the value of the equality check.
+	int epsilon;
+	double epsilon_value;
+
+	// Whether floating point numbers only need to be equal to the value of
+	// the equality check when both are rounded to a number of decimal
+	// places.
+	int round;
+	int round_value;
+
+	// Text to look for as a whole, already encoded in the charset of the
+	// value, or NULL when not searching for text.
+	char *text;
+	size_t text_size;
+
+	// Whether letters of the text match regardless of their case.
+	int ignore_case;
+
 	// Whether to perform a not equals check.
 	int ne;
 	cli_val ne_value;
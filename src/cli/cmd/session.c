@@ -0,0 +1,862 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "cli/cmd/session.h"
+#include "cli/printer.h"
+#include "cli/val.h"
+#include "cli/val/filter.h"
+#include "lib/include/proctal.h"
+#include "cset/cset.h"
+#include "chunk/chunk.h"
+#include "hash/hash.h"
+
+// Largest amount of memory read at once.
+#define BUFFER_SIZE (1024 * 1024)
+
+// Candidates that are closer than this many bytes are read together.
+#define MAX_READ_GAP 4096
+
+// Longest line accepted.
+#define LINE_SIZE 4096
+
+// Most words accepted in a line.
+#define MAX_WORDS 64
+
+/*
+ * Hash of the memory of a page that had candidates when it was last read.
+ */
+struct page_hash {
+	// Where the hashed memory starts and how much of it there is. Usually
+	// the whole page but can be less at the edges of a region and can go
+	// past the end of the page to cover the bytes of a value that crosses
+	// into the next.
+	char *start;
+	size_t size;
+
+	uint64_t hash;
+};
+
+struct page_hashes {
+	// Sorted by start address.
+	struct page_hash *items;
+	size_t count;
+	size_t capacity;
+};
+
+struct session {
+	struct cli_cmd_session_arg *arg;
+
+	proctal p;
+
+	// Addresses and values that are still in the running.
+	struct cset candidates;
+
+	// Whether memory was searched at least once. Until then every address
+	// is a candidate.
+	int searched;
+
+	// Hashes of the pages the candidates are in, taken when their values
+	// were stored. Only kept if the hash_pages option is set.
+	struct page_hashes hashes;
+
+	size_t page_size;
+
+	// Scratch values.
+	cli_val curr;
+	cli_val prev;
+	cli_val addr;
+
+	char *buffer;
+};
+
+struct filter {
+	struct cli_val_filter_compare_arg compare;
+	struct cli_val_filter_compare_prev_arg compare_prev;
+};
+
+static inline void *align_addr(void *addr, size_t align)
+{
+	ptrdiff_t offset = ((unsigned long) addr % align);
+
+	if (offset != 0) {
+		offset = align - offset;
+	}
+
+	return (void *) ((char *) addr + offset);
+}
+
+static void page_hashes_init(struct page_hashes *h)
+{
+	h->items = NULL;
+	h->count = 0;
+	h->capacity = 0;
+}
+
+static void page_hashes_deinit(struct page_hashes *h)
+{
+	free(h->items);
+	page_hashes_init(h);
+}
+
+/*
+ * Appends a hash. Must be called in increasing order of start address.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int page_hashes_add(struct page_hashes *h, char *start, size_t size, uint64_t hash)
+{
+	if (h->count == h->capacity) {
+		size_t capacity = h->capacity ? h->capacity * 2 : 64;
+		struct page_hash *items = realloc(h->items, capacity * sizeof(*items));
+
+		if (items == NULL) {
+			return 0;
+		}
+
+		h->items = items;
+		h->capacity = capacity;
+	}
+
+	struct page_hash *item = &h->items[h->count++];
+	item->start = start;
+	item->size = size;
+	item->hash = hash;
+
+	return 1;
+}
+
+/*
+ * Tells whether the same memory was hashed before with the same result.
+ *
+ * Lookups must be done in increasing order of start address. The cursor keeps
+ * track of where the previous lookup stopped and must start at 0.
+ */
+static int page_hashes_match(struct page_hashes *h, size_t *cursor, char *start, size_t size, uint64_t hash)
+{
+	while (*cursor < h->count && h->items[*cursor].start < start) {
+		*cursor += 1;
+	}
+
+	if (*cursor == h->count) {
+		return 0;
+	}
+
+	struct page_hash *item = &h->items[*cursor];
+
+	return item->start == start && item->size == size && item->hash == hash;
+}
+
+static inline char *page_of(struct session *s, void *addr)
+{
+	return (char *) ((uintptr_t) addr & ~(uintptr_t) (s->page_size - 1));
+}
+
+/*
+ * Works out which memory to hash for a page. That's the part of the page
+ * between lo and hi, stretched to cover the bytes of the last candidate.
+ */
+static inline void page_extent(struct session *s, char *page, char *last_end, char *lo, char *hi, char **start, char **end)
+{
+	*start = page > lo ? page : lo;
+	*end = page + s->page_size < hi ? page + s->page_size : hi;
+
+	if (*end < last_end) {
+		*end = last_end;
+	}
+}
+
+static void filter_init(struct filter *f)
+{
+	cli_val nil = cli_val_nil();
+
+	f->compare.eq = nil;
+	f->compare.ne = nil;
+	f->compare.gt = nil;
+	f->compare.gte = nil;
+	f->compare.lt = nil;
+	f->compare.lte = nil;
+
+	f->compare_prev.changed = 0;
+	f->compare_prev.unchanged = 0;
+	f->compare_prev.increased = 0;
+	f->compare_prev.decreased = 0;
+	f->compare_prev.inc = nil;
+	f->compare_prev.inc_up_to = nil;
+	f->compare_prev.dec = nil;
+	f->compare_prev.dec_up_to = nil;
+}
+
+static void filter_deinit(struct filter *f)
+{
+	cli_val *values[] = {
+		&f->compare.eq,
+		&f->compare.ne,
+		&f->compare.gt,
+		&f->compare.gte,
+		&f->compare.lt,
+		&f->compare.lte,
+		&f->compare_prev.inc,
+		&f->compare_prev.inc_up_to,
+		&f->compare_prev.dec,
+		&f->compare_prev.dec_up_to,
+	};
+
+	for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+		if (*values[i] != cli_val_nil()) {
+			cli_val_destroy(*values[i]);
+			*values[i] = cli_val_nil();
+		}
+	}
+}
+
+/*
+ * Returns where the value of a filter that takes one is stored or NULL if
+ * there's no such filter.
+ */
+static cli_val *filter_value(struct filter *f, const char *name, int *positive)
+{
+	*positive = 0;
+
+	if (strcmp(name, "eq") == 0) {
+		return &f->compare.eq;
+	} else if (strcmp(name, "ne") == 0) {
+		return &f->compare.ne;
+	} else if (strcmp(name, "gt") == 0) {
+		return &f->compare.gt;
+	} else if (strcmp(name, "gte") == 0) {
+		return &f->compare.gte;
+	} else if (strcmp(name, "lt") == 0) {
+		return &f->compare.lt;
+	} else if (strcmp(name, "lte") == 0) {
+		return &f->compare.lte;
+	}
+
+	*positive = 1;
+
+	if (strcmp(name, "inc") == 0) {
+		return &f->compare_prev.inc;
+	} else if (strcmp(name, "inc-up-to") == 0) {
+		return &f->compare_prev.inc_up_to;
+	} else if (strcmp(name, "dec") == 0) {
+		return &f->compare_prev.dec;
+	} else if (strcmp(name, "dec-up-to") == 0) {
+		return &f->compare_prev.dec_up_to;
+	}
+
+	return NULL;
+}
+
+/*
+ * Returns where a filter that takes no value is stored or NULL if there's no
+ * such filter.
+ */
+static int *filter_flag(struct filter *f, const char *name)
+{
+	if (strcmp(name, "changed") == 0) {
+		return &f->compare_prev.changed;
+	} else if (strcmp(name, "unchanged") == 0) {
+		return &f->compare_prev.unchanged;
+	} else if (strcmp(name, "increased") == 0) {
+		return &f->compare_prev.increased;
+	} else if (strcmp(name, "decreased") == 0) {
+		return &f->compare_prev.decreased;
+	}
+
+	return NULL;
+}
+
+/*
+ * Whether the filter turns down every value that stayed the same.
+ */
+static int filter_rejects_unchanged(struct filter *f)
+{
+	cli_val nil = cli_val_nil();
+
+	return f->compare_prev.changed
+		|| f->compare_prev.increased
+		|| f->compare_prev.decreased
+		|| f->compare_prev.inc != nil
+		|| f->compare_prev.inc_up_to != nil
+		|| f->compare_prev.dec != nil
+		|| f->compare_prev.dec_up_to != nil;
+}
+
+static int filter_needs_prev(struct filter *f)
+{
+	return f->compare_prev.unchanged || filter_rejects_unchanged(f);
+}
+
+/*
+ * Fills the filter from the words of a line.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int filter_parse(struct session *s, struct filter *f, char **words, size_t count)
+{
+	for (size_t i = 0; i < count; ++i) {
+		int positive;
+		cli_val *value = filter_value(f, words[i], &positive);
+
+		if (value != NULL) {
+			if (i + 1 == count) {
+				fprintf(stderr, "Missing value for %s.\n", words[i]);
+				return 0;
+			}
+
+			const char *text = words[i + 1];
+
+			if (positive && (strcmp("0", text) == 0 || strncmp("-", text, 1) == 0)) {
+				fprintf(stderr, "Value must be positive for %s.\n", words[i]);
+				return 0;
+			}
+
+			if (*value != cli_val_nil()) {
+				cli_val_destroy(*value);
+			}
+
+			*value = cli_val_create_clone(s->arg->value);
+
+			if (!cli_val_parse(*value, text)) {
+				fprintf(stderr, "Invalid value for %s.\n", words[i]);
+				return 0;
+			}
+
+			i += 1;
+			continue;
+		}
+
+		int *flag = filter_flag(f, words[i]);
+
+		if (flag != NULL) {
+			*flag = 1;
+			continue;
+		}
+
+		fprintf(stderr, "Unknown command %s.\n", words[i]);
+		return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Reports a failed read unless the error is something the rest of the session
+ * can't recover from.
+ *
+ * Returns 1 if the session can go on, 0 otherwise.
+ */
+static int handle_read_error(struct session *s)
+{
+	switch (proctal_error(s->p)) {
+	case PROCTAL_ERROR_READ_FAILURE:
+		// The memory went away or was never readable. Whatever was
+		// there is no longer a candidate.
+		proctal_error_ack(s->p);
+		return 1;
+
+	default:
+		cli_print_proctal_error(s->p);
+		proctal_error_ack(s->p);
+		return 0;
+	}
+}
+
+/*
+ * Searches every address for the first time.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int search_all(struct session *s, struct filter *f, struct cset *out, struct page_hashes *hashes)
+{
+	proctal p = s->p;
+	size_t size = cli_val_sizeof(s->curr);
+	size_t align = cli_val_alignof(s->curr);
+	int out_of_memory = 0;
+
+	proctal_region_set_mask(p, 0);
+
+	proctal_region_new(p);
+
+	void *start, *end;
+	struct chunk chunk;
+
+	while (proctal_region(p, &start, &end)) {
+		char *first = align_addr(start, align);
+
+		if (first + size > (char *) end) {
+			continue;
+		}
+
+		if (!cset_region_begin(out, first, end)) {
+			break;
+		}
+
+		chunk_init(&chunk, first, end, BUFFER_SIZE);
+
+		do {
+			char *offset = chunk_offset(&chunk);
+			size_t curr_size = chunk_size(&chunk);
+
+			size_t read_size = chunk_overlap_size(&chunk, size);
+
+			proctal_read(p, offset, s->buffer, read_size);
+
+			if (proctal_error(p)) {
+				if (!handle_read_error(s)) {
+					cset_region_end(out);
+					proctal_region_new(p);
+					return 0;
+				}
+
+				continue;
+			}
+
+			// Page of the last candidate and where its bytes end.
+			char *page = NULL;
+			char *last_end = NULL;
+
+			for (size_t i = 0; i < curr_size && i + size <= read_size; i += align) {
+				memcpy(cli_val_raw(s->curr), s->buffer + i, size);
+
+				if (!cli_val_filter_compare(&f->compare, s->curr)) {
+					continue;
+				}
+
+				char *a = offset + i;
+
+				if (!cset_add(out, a, s->buffer + i)) {
+					break;
+				}
+
+				if (!s->arg->hash_pages) {
+					continue;
+				}
+
+				if (page != NULL && page_of(s, a) != page) {
+					char *hash_start, *hash_end;
+					page_extent(s, page, last_end, offset, offset + read_size, &hash_start, &hash_end);
+
+					if (!page_hashes_add(hashes, hash_start, hash_end - hash_start, hash64(s->buffer + (hash_start - offset), hash_end - hash_start, 0))) {
+						out_of_memory = 1;
+						break;
+					}
+				}
+
+				page = page_of(s, a);
+				last_end = a + size;
+			}
+
+			if (page != NULL && !out_of_memory) {
+				char *hash_start, *hash_end;
+				page_extent(s, page, last_end, offset, offset + read_size, &hash_start, &hash_end);
+
+				if (!page_hashes_add(hashes, hash_start, hash_end - hash_start, hash64(s->buffer + (hash_start - offset), hash_end - hash_start, 0))) {
+					out_of_memory = 1;
+				}
+			}
+		} while (!cset_error(out) && !out_of_memory && chunk_next(&chunk));
+
+		cset_region_end(out);
+
+		if (cset_error(out) || out_of_memory) {
+			break;
+		}
+	}
+
+	proctal_region_new(p);
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_error_ack(p);
+		return 0;
+	}
+
+	if (cset_error(out) || out_of_memory) {
+		fprintf(stderr, "Ran out of memory.\n");
+		return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Goes over the current candidates, keeping the ones that pass the filter
+ * along with their new values.
+ *
+ * Candidates that are close together are read from memory in one go. When
+ * hashing pages, candidates are read a page at a time instead and a page
+ * whose hash did not change since the last search is known to hold the same
+ * values, which saves comparing them against their previous values.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int search_candidates(struct session *s, struct filter *f, struct cset *out, struct page_hashes *hashes)
+{
+	proctal p = s->p;
+	size_t size = s->candidates.value_size;
+	size_t align = s->candidates.align;
+	int hash_pages = s->arg->hash_pages;
+	int rejects_unchanged = filter_rejects_unchanged(f);
+	int out_of_memory = 0;
+
+	struct cset_region *region = NULL;
+	struct cset_iter it;
+	void *addr, *value;
+	size_t cursor = 0;
+
+	cset_iter_init(&it, &s->candidates);
+
+	for (;;) {
+		// Remembers where the batch starts.
+		struct cset_iter batch = it;
+
+		if (!cset_iter_next(&it, &addr, &value)) {
+			break;
+		}
+
+		struct cset_region *r = cset_iter_region(&it);
+		char *region_end = r->start + r->slots * align;
+
+		if (r != region) {
+			region = r;
+
+			if (!cset_region_begin(out, r->start, region_end)) {
+				break;
+			}
+		}
+
+		char *page = page_of(s, addr);
+		char *block_start = addr;
+		char *block_end = block_start + size;
+		size_t count = 1;
+
+		for (;;) {
+			struct cset_iter peek = it;
+			void *next_addr, *next_value;
+
+			if (!cset_iter_next(&peek, &next_addr, &next_value)
+				|| cset_iter_region(&peek) != r) {
+				break;
+			}
+
+			char *next_end = (char *) next_addr + size;
+
+			if (hash_pages) {
+				if (page_of(s, next_addr) != page) {
+					break;
+				}
+			} else if ((char *) next_addr - block_end > MAX_READ_GAP
+				|| next_end - block_start > BUFFER_SIZE) {
+				break;
+			}
+
+			it = peek;
+			block_end = next_end;
+			count += 1;
+		}
+
+		if (hash_pages) {
+			page_extent(s, page, block_end, r->start, region_end, &block_start, &block_end);
+		}
+
+		size_t block_size = block_end - block_start;
+
+		proctal_read(p, block_start, s->buffer, block_size);
+
+		if (proctal_error(p)) {
+			if (!handle_read_error(s)) {
+				cset_region_end(out);
+				return 0;
+			}
+
+			continue;
+		}
+
+		int unchanged = 0;
+		uint64_t hash = 0;
+
+		if (hash_pages) {
+			hash = hash64(s->buffer, block_size, 0);
+			unchanged = page_hashes_match(&s->hashes, &cursor, block_start, block_size, hash);
+
+			if (unchanged && rejects_unchanged) {
+				continue;
+			}
+		}
+
+		char *last_end = NULL;
+
+		for (size_t i = 0; i < count; ++i) {
+			cset_iter_next(&batch, &addr, &value);
+
+			char *curr = s->buffer + ((char *) addr - block_start);
+
+			memcpy(cli_val_raw(s->curr), curr, size);
+
+			if (!cli_val_filter_compare(&f->compare, s->curr)) {
+				continue;
+			}
+
+			if (!unchanged) {
+				memcpy(cli_val_raw(s->prev), value, size);
+
+				if (!cli_val_filter_compare_prev(&f->compare_prev, s->curr, s->prev)) {
+					continue;
+				}
+			}
+
+			if (!cset_add(out, addr, curr)) {
+				break;
+			}
+
+			last_end = (char *) addr + size;
+		}
+
+		if (cset_error(out)) {
+			break;
+		}
+
+		if (hash_pages && last_end != NULL) {
+			char *hash_start, *hash_end;
+			page_extent(s, page, last_end, r->start, region_end, &hash_start, &hash_end);
+
+			// Dropping candidates at the end of the page can
+			// shrink what needs to be hashed.
+			if (hash_start != block_start || hash_end != block_end) {
+				hash = hash64(s->buffer + (hash_start - block_start), hash_end - hash_start, 0);
+			}
+
+			if (!page_hashes_add(hashes, hash_start, hash_end - hash_start, hash)) {
+				out_of_memory = 1;
+				break;
+			}
+		}
+	}
+
+	cset_region_end(out);
+
+	if (cset_error(out) || out_of_memory) {
+		fprintf(stderr, "Ran out of memory.\n");
+		return 0;
+	}
+
+	return 1;
+}
+
+static void print_count(struct session *s)
+{
+	printf("%zu\n", cset_count(&s->candidates));
+}
+
+static void print_candidates(struct session *s, size_t max)
+{
+	size_t size = s->candidates.value_size;
+	struct cset_iter it;
+	void *addr, *value;
+
+	cset_iter_init(&it, &s->candidates);
+
+	for (size_t i = 0; i < max && cset_iter_next(&it, &addr, &value); ++i) {
+		cli_val_parse_bin(s->addr, (char *) &addr, sizeof(addr));
+		memcpy(cli_val_raw(s->curr), value, size);
+
+		cli_val_print(s->addr, stdout);
+		printf(" ");
+		cli_val_print(s->curr, stdout);
+		printf("\n");
+	}
+}
+
+static void print_help(void)
+{
+	printf(
+		"Filters, which can be combined in a single line:\n"
+		"  eq VAL, ne VAL, gt VAL, gte VAL, lt VAL, lte VAL\n"
+		"  inc VAL, inc-up-to VAL, dec VAL, dec-up-to VAL\n"
+		"  changed, unchanged, increased, decreased\n"
+		"Commands:\n"
+		"  list [N]  Prints the first N results, 10 by default\n"
+		"  count     Prints the number of results\n"
+		"  reset     Forgets all results\n"
+		"  help      Prints this help\n"
+		"  quit      Ends the session\n");
+}
+
+static void reset(struct session *s)
+{
+	cset_deinit(&s->candidates);
+	cset_init(&s->candidates, cli_val_alignof(s->arg->value), cli_val_sizeof(s->arg->value));
+	page_hashes_deinit(&s->hashes);
+	s->searched = 0;
+}
+
+static void narrow(struct session *s, char **words, size_t count)
+{
+	struct filter f;
+	filter_init(&f);
+
+	if (!filter_parse(s, &f, words, count)) {
+		filter_deinit(&f);
+		return;
+	}
+
+	if (!s->searched && filter_needs_prev(&f)) {
+		fprintf(stderr, "Comparing against previous values requires a previous search.\n");
+		filter_deinit(&f);
+		return;
+	}
+
+	struct cset out;
+	cset_init(&out, s->candidates.align, s->candidates.value_size);
+
+	struct page_hashes hashes;
+	page_hashes_init(&hashes);
+
+	int ok = s->searched
+		? search_candidates(s, &f, &out, &hashes)
+		: search_all(s, &f, &out, &hashes);
+
+	filter_deinit(&f);
+
+	if (!ok) {
+		page_hashes_deinit(&hashes);
+		cset_deinit(&out);
+		return;
+	}
+
+	cset_deinit(&s->candidates);
+	s->candidates = out;
+	page_hashes_deinit(&s->hashes);
+	s->hashes = hashes;
+	s->searched = 1;
+
+	print_count(s);
+}
+
+/*
+ * Runs the commands in a line.
+ *
+ * Returns 0 when the session should end, 1 otherwise.
+ */
+static int run_line(struct session *s, char *line)
+{
+	char *words[MAX_WORDS];
+	size_t count = 0;
+	char *saveptr;
+
+	for (char *word = strtok_r(line, " \t\r\n", &saveptr);
+		word != NULL;
+		word = strtok_r(NULL, " \t\r\n", &saveptr)) {
+		if (count == MAX_WORDS) {
+			fprintf(stderr, "Too many words.\n");
+			return 1;
+		}
+
+		words[count++] = word;
+	}
+
+	if (count == 0) {
+		return 1;
+	}
+
+	if (strcmp(words[0], "quit") == 0 || strcmp(words[0], "exit") == 0) {
+		return 0;
+	} else if (strcmp(words[0], "help") == 0) {
+		print_help();
+	} else if (strcmp(words[0], "count") == 0) {
+		print_count(s);
+	} else if (strcmp(words[0], "reset") == 0) {
+		reset(s);
+	} else if (strcmp(words[0], "list") == 0) {
+		unsigned long max = 10;
+
+		if (count > 1) {
+			char *end;
+			max = strtoul(words[1], &end, 10);
+
+			if (*end != '\0') {
+				fprintf(stderr, "Invalid number of results.\n");
+				return 1;
+			}
+		}
+
+		print_candidates(s, max);
+	} else {
+		narrow(s, words, count);
+	}
+
+	return 1;
+}
+
+int cli_cmd_session(struct cli_cmd_session_arg *arg)
+{
+	proctal p = proctal_create();
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_destroy(p);
+		return 1;
+	}
+
+	proctal_set_pid(p, arg->pid);
+
+	if (!arg->read && !arg->write && !arg->execute) {
+		// By default will search readable memory.
+		proctal_region_set_read(p, 1);
+		proctal_region_set_write(p, 0);
+		proctal_region_set_execute(p, 0);
+	} else {
+		proctal_region_set_read(p, arg->read);
+		proctal_region_set_write(p, arg->write);
+		proctal_region_set_execute(p, arg->execute);
+	}
+
+	struct session s;
+	s.arg = arg;
+	s.p = p;
+	s.searched = 0;
+	s.page_size = sysconf(_SC_PAGESIZE);
+	s.curr = cli_val_create_clone(arg->value);
+	s.prev = cli_val_create_clone(arg->value);
+	s.addr = cli_val_wrap(CLI_VAL_TYPE_ADDRESS, cli_val_address_create());
+	s.buffer = malloc(BUFFER_SIZE + cli_val_sizeof(arg->value));
+
+	cset_init(&s.candidates, cli_val_alignof(arg->value), cli_val_sizeof(arg->value));
+	page_hashes_init(&s.hashes);
+
+	if (s.buffer == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+	} else {
+		int interactive = isatty(STDIN_FILENO);
+		char line[LINE_SIZE];
+
+		for (;;) {
+			if (interactive) {
+				printf("> ");
+			}
+
+			fflush(stdout);
+
+			if (fgets(line, sizeof(line), stdin) == NULL) {
+				// It's over.
+				break;
+			}
+
+			if (!run_line(&s, line)) {
+				break;
+			}
+		}
+	}
+
+	page_hashes_deinit(&s.hashes);
+	cset_deinit(&s.candidates);
+	free(s.buffer);
+	cli_val_destroy(s.addr);
+	cli_val_destroy(s.prev);
+	cli_val_destroy(s.curr);
+
+	proctal_destroy(p);
+
+	return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef CLI_CMD_SESSION_H
+#define CLI_CMD_SESSION_H
+
+#include "cli/val.h"
+
+struct cli_cmd_session_arg {
+	int pid;
+
+	// How we're going to interpret values.
+	cli_val value;
+
+	// Whether to search readable memory addresses.
+	int read;
+
+	// Whether to search writable memory addresses.
+	int write;
+
+	// Whether to search executable memory addresses.
+	int execute;
+
+	// Whether to remember a hash of every page with results so that pages
+	// that did not change can be told apart without comparing values.
+	int hash_pages;
+};
+
+int cli_cmd_session(struct cli_cmd_session_arg *arg);
+
+#endif /* CLI_CMD_SESSION_H */
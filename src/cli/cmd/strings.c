@@ -0,0 +1,409 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "cli/cmd/strings.h"
+#include "cli/printer.h"
+#include "cli/jobs.h"
+#include "lib/include/proctal.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Amount of memory a thread looks for strings in at a time.
+#define CHUNK_SIZE (1024 * 1024)
+
+// Amount of memory read at once when a string goes past the end of the chunk
+// it starts in.
+#define TAIL_SIZE 4096
+
+/*
+ * A chunk of memory. The job finds the strings that start in it.
+ */
+struct job {
+	char *start;
+	char *end;
+
+	// Where the memory region the chunk belongs to ends. Strings can go
+	// on until then.
+	char *region_start;
+	char *region_end;
+};
+
+/*
+ * State shared by the threads.
+ */
+struct scan {
+	struct cli_cmd_strings_arg *arg;
+
+	// Size of a character.
+	size_t char_size;
+
+	struct job *jobs;
+	size_t job_count;
+
+	struct jobs queue;
+
+	// One for every job.
+	struct cli_job_output *outputs;
+};
+
+static void output_address(struct cli_job_output *o, void *address)
+{
+	char s[sizeof(uintptr_t) * 2 + 2];
+	int size = snprintf(s, sizeof(s), "%" PRIXPTR " ", (uintptr_t) address);
+
+	cli_job_output_append(o, s, size);
+}
+
+/*
+ * Appends the characters of a string. Only printable ASCII characters make
+ * up strings, so a character is its first byte in both charsets.
+ */
+static void output_text(struct cli_job_output *o, const char *data, size_t size, size_t char_size)
+{
+	if (char_size == 1) {
+		cli_job_output_append(o, data, size);
+		return;
+	}
+
+	char s[TAIL_SIZE / 2];
+
+	while (size > 0) {
+		size_t n = 0;
+
+		for (; n < sizeof(s) && n * char_size < size; ++n) {
+			s[n] = data[n * char_size];
+		}
+
+		cli_job_output_append(o, s, n);
+
+		data += n * char_size;
+		size -= n * char_size;
+	}
+}
+
+static inline int is_printable(unsigned char c)
+{
+	return (c >= 0x20 && c <= 0x7E) || c == '\t';
+}
+
+static inline int is_printable_char(const char *data, size_t char_size)
+{
+	if (char_size == 2 && data[1] != 0) {
+		return 0;
+	}
+
+	return is_printable(data[0]);
+}
+
+#ifdef __SSE2__
+/*
+ * Tells which of the next 16 bytes start a printable character, one bit per
+ * byte. In UTF-16LE only even bytes start a character and the byte after it
+ * must be zero.
+ */
+static inline int classify_block(const char *data, size_t char_size)
+{
+	__m128i v = _mm_loadu_si128((const __m128i *) data);
+
+	// Flipping the sign bit makes signed comparisons order bytes the same
+	// way as unsigned comparisons would.
+	__m128i s = _mm_xor_si128(v, _mm_set1_epi8((char) 0x80));
+	__m128i in_range = _mm_and_si128(
+		_mm_cmpgt_epi8(s, _mm_set1_epi8((char) (0x1F ^ 0x80))),
+		_mm_cmplt_epi8(s, _mm_set1_epi8((char) (0x7F ^ 0x80))));
+	__m128i tab = _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'));
+
+	int mask = _mm_movemask_epi8(_mm_or_si128(in_range, tab));
+
+	if (char_size == 2) {
+		int zero = _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128()));
+		mask &= (zero >> 1) & 0x5555;
+	}
+
+	return mask;
+}
+#endif
+
+/*
+ * Finds the next position, starting at i and going in steps of the size of a
+ * character, of a character that is printable or not, as requested.
+ *
+ * With SSE2, runs of 16 bytes that are all one or the other are skipped at
+ * once.
+ *
+ * Returns the first position that does not hold a whole character if there is
+ * none.
+ */
+static size_t find_char(const char *data, size_t i, size_t size, size_t char_size, int printable)
+{
+#ifdef __SSE2__
+	int all = char_size == 2 ? 0x5555 : 0xFFFF;
+
+	for (; i + 16 <= size; i += 16) {
+		int mask = classify_block(data + i, char_size);
+
+		if (!printable) {
+			mask = ~mask & all;
+		}
+
+		if (mask) {
+			return i + __builtin_ctz(mask);
+		}
+	}
+#endif
+
+	// Whole characters left after the last block of 16 bytes, or all of
+	// them without SSE2, are classified one at a time.
+	for (; i + char_size <= size; i += char_size) {
+		if (is_printable_char(data + i, char_size) == printable) {
+			return i;
+		}
+	}
+
+	return i;
+}
+
+/*
+ * Follows a string into memory that has not been read yet, appending its
+ * characters.
+ *
+ * Returns how many characters were appended.
+ */
+static size_t follow_string(proctal p, struct cli_job_output *o, char *buffer, char *start, char *region_end, size_t char_size)
+{
+	size_t length = 0;
+
+	while (start < region_end) {
+		size_t size = region_end - start > TAIL_SIZE ? TAIL_SIZE : region_end - start;
+
+		proctal_read(p, start, buffer, size);
+
+		if (proctal_error(p)) {
+			// The string ends where memory can no longer be read.
+			proctal_error_ack(p);
+			break;
+		}
+
+		size_t end = find_char(buffer, 0, size, char_size, 0);
+
+		output_text(o, buffer, end, char_size);
+		length += end / char_size;
+
+		if (end + char_size <= size) {
+			break;
+		}
+
+		start += end;
+	}
+
+	return length;
+}
+
+/*
+ * Finds the strings that start in the chunk of a job. The character before the
+ * chunk is also read to tell whether the chunk starts in the middle of a
+ * string, which the previous job takes care of.
+ */
+static void run_job(struct scan *s, proctal p, struct job *job, struct cli_job_output *o, char *buffer, char *tail)
+{
+	size_t char_size = s->char_size;
+
+	char *read_start = job->start > job->region_start ? job->start - char_size : job->start;
+	char *read_end = job->region_end - job->end > TAIL_SIZE ? job->end + TAIL_SIZE : job->region_end;
+	size_t size = read_end - read_start;
+
+	proctal_read(p, read_start, buffer, size);
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_error_ack(p);
+		return;
+	}
+
+	size_t i = job->start - read_start;
+	size_t limit = job->end - read_start;
+
+	if (i > 0 && is_printable_char(buffer + i - char_size, char_size)) {
+		i = find_char(buffer, i, size, char_size, 0);
+	}
+
+	for (;;) {
+		i = find_char(buffer, i, size, char_size, 1);
+
+		if (i >= limit) {
+			break;
+		}
+
+		size_t end = find_char(buffer, i, size, char_size, 0);
+		size_t length = (end - i) / char_size;
+		size_t mark = o->size;
+
+		output_address(o, read_start + i);
+		output_text(o, buffer + i, end - i, char_size);
+
+		if (end + char_size > size) {
+			length += follow_string(p, o, tail, read_start + end, job->region_end, char_size);
+		}
+
+		if (length < s->arg->min_length) {
+			// Too short to count as a string.
+			o->size = mark;
+		} else {
+			cli_job_output_append(o, "\n", 1);
+		}
+
+		i = end;
+	}
+}
+
+/*
+ * Takes jobs until there are none left. Each thread has its own instance
+ * because an instance cannot be shared.
+ *
+ * A thread that fails to get ready still takes jobs and finishes them without
+ * output, so that none is waited on forever.
+ */
+static void *worker_run(void *data)
+{
+	struct scan *s = data;
+
+	proctal p = proctal_create();
+	char *buffer = malloc(CHUNK_SIZE + s->char_size + TAIL_SIZE);
+	char *tail = malloc(TAIL_SIZE);
+
+	int ready = 1;
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		ready = 0;
+	} else if (buffer == NULL || tail == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		ready = 0;
+	}
+
+	proctal_set_pid(p, s->arg->pid);
+
+	size_t i;
+
+	while (jobs_take(&s->queue, &i)) {
+		if (ready) {
+			run_job(s, p, &s->jobs[i], &s->outputs[i], buffer, tail);
+		}
+
+		jobs_finish(&s->queue, &s->outputs[i].done);
+	}
+
+	free(buffer);
+	free(tail);
+	proctal_destroy(p);
+
+	return NULL;
+}
+
+/*
+ * Splits the memory regions in chunks.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int plan_jobs(struct scan *s, proctal p)
+{
+	size_t capacity = 0;
+
+	proctal_region_set_mask(p, 0);
+
+	proctal_region_new(p);
+
+	void *start, *end;
+
+	while (proctal_region(p, &start, &end)) {
+		for (char *chunk = start; chunk < (char *) end; chunk += CHUNK_SIZE) {
+			if (s->job_count == capacity) {
+				capacity = capacity ? capacity * 2 : 256;
+				struct job *jobs = realloc(s->jobs, capacity * sizeof(*jobs));
+
+				if (jobs == NULL) {
+					proctal_region_new(p);
+					fprintf(stderr, "Ran out of memory.\n");
+					return 0;
+				}
+
+				s->jobs = jobs;
+			}
+
+			struct job *job = &s->jobs[s->job_count++];
+			job->start = chunk;
+			job->end = (char *) end - chunk > CHUNK_SIZE ? chunk + CHUNK_SIZE : end;
+			job->region_start = start;
+			job->region_end = end;
+		}
+	}
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_error_ack(p);
+		return 0;
+	}
+
+	return 1;
+}
+
+int cli_cmd_strings(struct cli_cmd_strings_arg *arg)
+{
+	proctal p = proctal_create();
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_destroy(p);
+		return 1;
+	}
+
+	proctal_set_pid(p, arg->pid);
+
+	if (!arg->read && !arg->write && !arg->execute) {
+		// By default will look in readable memory.
+		proctal_region_set_read(p, 1);
+		proctal_region_set_write(p, 0);
+		proctal_region_set_execute(p, 0);
+	} else {
+		proctal_region_set_read(p, arg->read);
+		proctal_region_set_write(p, arg->write);
+		proctal_region_set_execute(p, arg->execute);
+	}
+
+	struct scan s;
+	s.arg = arg;
+	s.char_size = arg->charset == CLI_VAL_TEXT_CHARSET_UTF16LE ? 2 : 1;
+	s.jobs = NULL;
+	s.job_count = 0;
+
+	if (!plan_jobs(&s, p)) {
+		free(s.jobs);
+		proctal_destroy(p);
+		return 1;
+	}
+
+	s.outputs = cli_job_outputs_create(s.job_count);
+
+	if (s.outputs == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		free(s.jobs);
+		proctal_destroy(p);
+		return 1;
+	}
+
+	jobs_init(&s.queue, s.job_count);
+
+	cli_jobs_run(&s.queue, s.outputs, arg->threads, worker_run, &s);
+
+	jobs_deinit(&s.queue);
+
+	cli_job_outputs_destroy(s.outputs, s.job_count);
+	free(s.jobs);
+	proctal_destroy(p);
+
+	return 0;
+}
@@ -0,0 +1,33 @@
+#ifndef CLI_CMD_STRINGS_H
+#define CLI_CMD_STRINGS_H
+
+#include <stdlib.h>
+
+#include "cli/val/text.h"
+
+struct cli_cmd_strings_arg {
+	int pid;
+
+	// Smallest number of characters in a string.
+	size_t min_length;
+
+	// How characters are stored.
+	enum cli_val_text_charset charset;
+
+	// Whether to look in readable memory addresses.
+	int read;
+
+	// Whether to look in writable memory addresses.
+	int write;
+
+	// Whether to look in executable memory addresses.
+	int execute;
+
+	// Number of threads used to go over memory. 0 means one per
+	// processor.
+	int threads;
+};
+
+int cli_cmd_strings(struct cli_cmd_strings_arg *arg);
+
+#endif /* CLI_CMD_STRINGS_H */
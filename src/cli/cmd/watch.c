@@ -1,19 +1,62 @@
 #include <stdio.h>
-#include <assert.h>
+#include <stdint.h>
+#include <string.h>
 #include <signal.h>
+#include <unistd.h>
+#include <time.h>
 
 #include "cli/cmd/watch.h"
 #include "cli/printer.h"
+#include "cli/val/filter.h"
 #include "lib/include/proctal.h"
-#include "magic/magic.h"
+#include "tally/tally.h"
+
+/*
+ * Hits are counted by instruction and watchpoint.
+ */
+struct hit_key {
+	void *addr;
+	int point;
+};
+
+/*
+ * When an instruction first and last accessed a watchpoint, in seconds since
+ * watching started.
+ */
+struct hit_times {
+	double first;
+	double last;
+};
+
+/*
+ * A process being watched.
+ */
+struct target {
+	proctal p;
+
+	// Values as they were before the last access to them. None of the
+	// types that can be watched take more than 16 bytes.
+	char previous[CLI_CMD_WATCH_MAX_POINTS][16];
+
+	// Accesses to every watchpoint when they are not counted by perf
+	// events.
+	unsigned long long counts[CLI_CMD_WATCH_MAX_POINTS];
+};
 
 static int request_quit = 0;
 
+static int request_report = 0;
+
 static void quit(int signum)
 {
 	request_quit = 1;
 }
 
+static void report(int signum)
+{
+	request_report = 1;
+}
+
 static int register_signal_handler()
 {
 	struct sigaction sa = {
@@ -21,103 +64,551 @@ static int register_signal_handler()
 		.sa_flags = 0,
 	};
 
+	struct sigaction sa_report = {
+		.sa_handler = report,
+		.sa_flags = 0,
+	};
+
 	sigemptyset(&sa.sa_mask);
+	sigemptyset(&sa_report.sa_mask);
 
 	return sigaction(SIGINT, &sa, NULL) != -1
-		&& sigaction(SIGTERM, &sa, NULL) != -1;
+		&& sigaction(SIGTERM, &sa, NULL) != -1
+		&& sigaction(SIGALRM, &sa_report, NULL) != -1;
 }
 
 static void unregister_signal_handler()
 {
+	alarm(0);
+
 	signal(SIGINT, SIG_DFL);
 	signal(SIGTERM, SIG_DFL);
+	signal(SIGALRM, SIG_DFL);
+}
+
+static double now(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+
+	return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+/*
+ * Counts a hit.
+ *
+ * Returns the number of times the instruction accessed the watchpoint so far
+ * or 0 on failure.
+ */
+static unsigned long long count_hit(struct tally *hits, void *addr, int point, double time)
+{
+	struct hit_key key;
+
+	// Padding must not make a difference.
+	memset(&key, 0, sizeof(key));
+	key.addr = addr;
+	key.point = point;
+
+	size_t i;
+
+	if (!tally_add(hits, &key, sizeof(key), &i)) {
+		return 0;
+	}
+
+	struct hit_times *times = tally_value(hits, i);
+
+	if (hits->entries[i].count == 1) {
+		times->first = time;
+	}
+
+	times->last = time;
+
+	return hits->entries[i].count;
+}
+
+/*
+ * Reads the value at the start of the bytes being watched.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int read_watched(proctal p, struct cli_cmd_watch_point *point, cli_val value, char *bytes)
+{
+	proctal_read(p, point->address, bytes, cli_val_sizeof(value));
+
+	return !proctal_error(p);
+}
+
+/*
+ * Prints every instruction that made an access, the most frequent first.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int print_hits(struct tally *hits, struct cli_cmd_watch_arg *arg)
+{
+	size_t *sorted = tally_sort(hits);
+
+	if (sorted == NULL) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < hits->count; ++i) {
+		struct hit_key key;
+		memcpy(&key, tally_key(hits, sorted[i]), sizeof(key));
+
+		struct hit_times *times = tally_value(hits, sorted[i]);
+
+		cli_print_address(key.addr);
+		printf(" %llu %.6f %.6f", hits->entries[sorted[i]].count, times->first, times->last);
+
+		if (arg->point_count > 1 && key.point != -1) {
+			printf(" ");
+			cli_print_address(arg->points[key.point].address);
+		}
+
+		printf("\n");
+	}
+
+	free(sorted);
+
+	fflush(stdout);
+
+	return 1;
+}
+
+/*
+ * Prints the number of accesses to every watchpoint in all processes. Perf
+ * events count them on their own.
+ */
+static void print_counts(struct target *targets, size_t target_count, struct cli_cmd_watch_arg *arg, int perf)
+{
+	for (size_t i = 0; i < arg->point_count; ++i) {
+		unsigned long long count = 0;
+
+		for (size_t j = 0; j < target_count; ++j) {
+			if (perf) {
+				proctal_watch_select(targets[j].p, i);
+				count += proctal_watch_accesses(targets[j].p);
+			} else {
+				count += targets[j].counts[i];
+			}
+		}
+
+		cli_print_address(arg->points[i].address);
+		printf(" %llu\n", count);
+	}
+
+	fflush(stdout);
+}
+
+static void destroy_targets(struct target *targets, size_t count)
+{
+	for (size_t i = 0; i < count; ++i) {
+		if (targets[i].p) {
+			proctal_destroy(targets[i].p);
+		}
+	}
+
+	free(targets);
+}
+
+/*
+ * Creates an instance for every process with the watchpoints set up.
+ *
+ * Returns NULL on failure.
+ */
+static struct target *create_targets(struct cli_cmd_watch_arg *arg)
+{
+	struct target *targets = calloc(arg->pid_count, sizeof(*targets));
+
+	if (targets == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		return NULL;
+	}
+
+	for (size_t i = 0; i < arg->pid_count; ++i) {
+		proctal p = proctal_create();
+
+		targets[i].p = p;
+
+		if (proctal_error(p)) {
+			cli_print_proctal_error(p);
+			destroy_targets(targets, arg->pid_count);
+			return NULL;
+		}
+
+		proctal_set_pid(p, arg->pids[i]);
+
+		if (arg->pages) {
+			proctal_watch_set_method(p, PROCTAL_WATCH_METHOD_PAGE_PROTECTION);
+		}
+
+		if (arg->perf) {
+			proctal_watch_set_method(p, PROCTAL_WATCH_METHOD_PERF_EVENTS);
+
+			// Nothing needs to be sampled just to count.
+			proctal_watch_set_sample_period(p, arg->count ? 0 : arg->sample_period);
+		}
+
+		proctal_watch_set_count(p, arg->point_count);
+
+		for (size_t j = 0; j < arg->point_count; ++j) {
+			struct cli_cmd_watch_point *point = &arg->points[j];
+
+			proctal_watch_select(p, j);
+			proctal_watch_set_address(p, point->address);
+			proctal_watch_set_size(p, point->size);
+			proctal_watch_set_read(p, point->read);
+			proctal_watch_set_write(p, point->write);
+			proctal_watch_set_execute(p, point->execute);
+		}
+	}
+
+	return targets;
+}
+
+/*
+ * Begins watching every process. Falls back to the debug registers when perf
+ * events are not available.
+ *
+ * Returns 1 on success, 0 on failure, in which case the error was printed.
+ */
+static int begin_targets(struct target *targets, size_t count, int *perf)
+{
+	for (size_t i = 0; i < count; ++i) {
+		proctal p = targets[i].p;
+
+		if (proctal_watch_begin(p)) {
+			continue;
+		}
+
+		if (*perf
+			&& (proctal_error(p) == PROCTAL_ERROR_UNSUPPORTED
+				|| proctal_error(p) == PROCTAL_ERROR_PERMISSION_DENIED)) {
+			fprintf(stderr, "Perf events are not available, falling back to the debug registers.\n");
+
+			proctal_error_ack(p);
+			*perf = 0;
+
+			// Every process is watched the same way.
+			for (size_t j = 0; j < count; ++j) {
+				if (j < i) {
+					proctal_watch_end(targets[j].p);
+				}
+
+				proctal_watch_set_method(targets[j].p, PROCTAL_WATCH_METHOD_DEBUG_REGISTERS);
+			}
+
+			return begin_targets(targets, count, perf);
+		}
+
+		cli_print_proctal_error(p);
+		return 0;
+	}
+
+	return 1;
 }
 
 int cli_cmd_watch(struct cli_cmd_watch_arg *arg)
 {
+	for (size_t i = 0; i < arg->point_count; ++i) {
+		struct cli_cmd_watch_point *point = &arg->points[i];
+
+		if (!point->read && !point->write && !point->execute) {
+			fprintf(stderr, "Did not specify what to watch for.\n");
+			return 1;
+		}
+
+		if (arg->pages && point->execute) {
+			fprintf(stderr, "Cannot watch for instruction execution by protecting pages.\n");
+			return 1;
+		}
+
+		if (!(point->read && point->write && !point->execute)
+			&& !(point->write && !point->read && !point->execute)
+			&& !(!point->write && !point->read && point->execute)) {
+			fprintf(stderr, "The given combination of read, write and execute options is not supported.\n");
+			return 1;
+		}
+	}
+
 	if (!register_signal_handler()) {
 		fprintf(stderr, "Failed to set up signal handler.\n");
 		return 1;
 	}
 
-	proctal p = proctal_create();
+	struct target *targets = create_targets(arg);
 
-	if (proctal_error(p)) {
-		cli_print_proctal_error(p);
-		proctal_destroy(p);
+	if (targets == NULL) {
+		unregister_signal_handler();
 		return 1;
 	}
 
-	if (!arg->read && !arg->write && !arg->execute) {
-		fprintf(stderr, "Did not specify what to watch for.\n");
-		proctal_destroy(p);
+	size_t target_count = arg->pid_count;
+
+	// The instances of the processes that have not exited yet, in the
+	// same order as the first targets.
+	proctal *live = malloc(target_count * sizeof(*live));
+
+	if (live == NULL) {
+		unregister_signal_handler();
+		fprintf(stderr, "Ran out of memory.\n");
+		destroy_targets(targets, target_count);
 		return 1;
 	}
 
-	if (!(arg->read && arg->write && !arg->execute)
-		&& !(arg->write && !arg->read && !arg->execute)
-		&& !(!arg->write && !arg->read && arg->execute)) {
-		fprintf(stderr, "The given combination of read, write and execute options is not supported.\n");
-		proctal_destroy(p);
+	size_t live_count = target_count;
+
+	for (size_t i = 0; i < target_count; ++i) {
+		live[i] = targets[i].p;
+	}
+
+	cli_val nil = cli_val_nil();
+
+	cli_val old_value = nil;
+	cli_val new_value = nil;
+
+	if (arg->value != nil) {
+		for (size_t i = 0; i < target_count; ++i) {
+			for (size_t j = 0; j < arg->point_count; ++j) {
+				if (!read_watched(targets[i].p, &arg->points[j], arg->value, targets[i].previous[j])) {
+					unregister_signal_handler();
+					cli_print_proctal_error(targets[i].p);
+					free(live);
+					destroy_targets(targets, target_count);
+					return 1;
+				}
+			}
+		}
+
+		old_value = cli_val_create_clone(arg->value);
+		new_value = cli_val_create_clone(arg->value);
+	}
+
+	struct tally hits;
+	tally_init(&hits, sizeof(struct hit_times));
+
+	int perf = arg->perf;
+
+	// The processes are attached to and the breakpoints are set up only
+	// once for all accesses.
+	if (!begin_targets(targets, target_count, &perf)) {
+		unregister_signal_handler();
+
+		if (old_value != nil) {
+			cli_val_destroy(old_value);
+			cli_val_destroy(new_value);
+		}
+
+		tally_deinit(&hits);
+		free(live);
+		destroy_targets(targets, target_count);
 		return 1;
 	}
 
-	proctal_set_pid(p, arg->pid);
+	// What the processes are waited on with is kept from one access to the
+	// next. The instance it's created with stays around until the end.
+	proctal poller_owner = targets[0].p;
+	proctal_watch_poller poller = NULL;
 
-	proctal_watch_set_address(p, arg->address);
-	proctal_watch_set_read(p, arg->read);
-	proctal_watch_set_write(p, arg->write);
-	proctal_watch_set_execute(p, arg->execute);
+	if (target_count > 1) {
+		poller = proctal_watch_poller_create(poller_owner);
 
-	// TODO: Should use a data structure that can grow dynamically and has
-	// good lookup performance.
-	void *matches[10000];
-	size_t match_count = 0;
+		if (poller == NULL) {
+			cli_print_proctal_error(poller_owner);
+
+			unregister_signal_handler();
+
+			if (old_value != nil) {
+				cli_val_destroy(old_value);
+				cli_val_destroy(new_value);
+			}
+
+			tally_deinit(&hits);
+			free(live);
+			destroy_targets(targets, target_count);
+			return 1;
+		}
+	}
 
-	proctal_freeze(p);
+	double start = now();
+
+	int out_of_memory = 0;
+
+	// The instance that failed.
+	proctal failed = NULL;
+
+	if (arg->interval) {
+		alarm(arg->interval);
+	}
 
 	while (!request_quit) {
 		void *addr;
 
-		if (!proctal_watch(p, &addr)) {
+		if (request_report) {
+			request_report = 0;
+
+			if (arg->count) {
+				print_counts(targets, target_count, arg, perf);
+			} else if (!print_hits(&hits, arg)) {
+				out_of_memory = 1;
+				break;
+			}
+
+			printf("\n");
+
+			alarm(arg->interval);
+		}
+
+		size_t ready = 0;
+
+		if (live_count > 1 && !proctal_watch_poller_wait(poller, live, live_count, &ready)) {
+			// Interrupted by a signal or woken up for nothing.
+			if (ready == live_count) {
+				continue;
+			}
+
+			failed = live[ready];
 			break;
 		}
 
-		if (arg->unique) {
-			int match = 0;
+		struct target *target = &targets[ready];
+		proctal p = target->p;
 
-			for (size_t i = 0; i < match_count; ++i) {
-				void *prev = matches[i];
+		if (!proctal_watch_next(p, &addr)) {
+			if (!proctal_error(p)) {
+				// Interrupted by a signal or the stop was not an
+				// access.
+				continue;
+			}
 
-				if (addr == prev) {
-					match = 1;
-					break;
-				}
+			if (proctal_error(p) == PROCTAL_ERROR_PROCESS_EXITED && live_count > 1) {
+				// The others are still watched. Its counts are kept
+				// after the ones that are.
+				struct target exited = *target;
+
+				--live_count;
+				*target = targets[live_count];
+				targets[live_count] = exited;
+				live[ready] = live[live_count];
+
+				proctal_error_ack(exited.p);
+				continue;
 			}
 
-			if (match) {
+			failed = p;
+			break;
+		}
+
+		int hit = proctal_watch_hit(p);
+
+		if (arg->count) {
+			if (hit != -1) {
+				++target->counts[hit];
+			}
+
+			continue;
+		}
+
+		// The thread that made the access is still stopped so what
+		// it wrote cannot have changed yet.
+		if (arg->value != nil && hit != -1) {
+			struct cli_cmd_watch_point *point = &arg->points[hit];
+			size_t size = cli_val_sizeof(arg->value);
+			char current[16];
+
+			if (!read_watched(p, point, arg->value, current)) {
+				failed = p;
+				break;
+			}
+
+			cli_val_parse_bin(old_value, target->previous[hit], size);
+			cli_val_parse_bin(new_value, current, size);
+			memcpy(target->previous[hit], current, size);
+
+			if (arg->when
+				&& (!cli_val_filter_compare(&arg->compare, new_value)
+					|| !cli_val_filter_compare_prev(&arg->compare_prev, new_value, old_value))) {
+				continue;
+			}
+		}
+
+		if (arg->aggregate || arg->unique) {
+			unsigned long long count = count_hit(&hits, addr, hit, now() - start);
+
+			if (count == 0) {
+				out_of_memory = 1;
+				break;
+			}
+
+			if (arg->aggregate || count > 1) {
 				continue;
-			} else {
-				assert(match_count < ARRAY_SIZE(matches));
-				matches[match_count++] = addr;
 			}
 		}
 
 		cli_print_address(addr);
+		printf(" %d", proctal_watch_thread(p));
+
+		// Telling watchpoints apart.
+		if (arg->point_count > 1 && hit != -1) {
+			printf(" ");
+			cli_print_address(arg->points[hit].address);
+		}
+
+		if (arg->values && hit != -1) {
+			printf(" ");
+			cli_val_print(old_value, stdout);
+			printf(" ");
+			cli_val_print(new_value, stdout);
+		}
+
 		printf("\n");
 	}
 
+	proctal_watch_poller_destroy(poller_owner, poller);
+
 	unregister_signal_handler();
 
-	if (proctal_error(p)) {
-		cli_print_proctal_error(p);
-		proctal_destroy(p);
+	free(live);
+
+	if (old_value != nil) {
+		cli_val_destroy(old_value);
+		cli_val_destroy(new_value);
+	}
+
+	if (arg->aggregate && !out_of_memory && !print_hits(&hits, arg)) {
+		out_of_memory = 1;
+	}
+
+	if (arg->count) {
+		print_counts(targets, target_count, arg, perf);
+	}
+
+	tally_deinit(&hits);
+
+	if (out_of_memory) {
+		fprintf(stderr, "Ran out of memory.\n");
+		destroy_targets(targets, target_count);
 		return 1;
 	}
 
-	proctal_unfreeze(p);
+	if (failed) {
+		cli_print_proctal_error(failed);
+		destroy_targets(targets, target_count);
+		return 1;
+	}
+
+	for (size_t i = 0; i < live_count; ++i) {
+		proctal_watch_end(targets[i].p);
+
+		if (proctal_error(targets[i].p)) {
+			cli_print_proctal_error(targets[i].p);
+			destroy_targets(targets, target_count);
+			return 1;
+		}
+	}
 
-	proctal_destroy(p);
+	destroy_targets(targets, target_count);
 
 	return 0;
 }
@@ -1,11 +1,20 @@
 #ifndef CLI_CMD_WATCH_H
 #define CLI_CMD_WATCH_H
 
-struct cli_cmd_watch_arg {
-	int pid;
+#include <stdlib.h>
+
+#include "cli/val.h"
+#include "cli/val/filter.h"
+
+// Largest number of watchpoints that can be watched at once.
+#define CLI_CMD_WATCH_MAX_POINTS 4
 
+struct cli_cmd_watch_point {
 	void *address;
 
+	// Number of bytes to watch.
+	size_t size;
+
 	// Whether to watch for reads.
 	int read;
 
@@ -14,9 +23,62 @@ struct cli_cmd_watch_arg {
 
 	// Whether to watch for instruction execution.
 	int execute;
+};
+
+struct cli_cmd_watch_arg {
+	// Processes to watch, all of them at once.
+	int *pids;
+	size_t pid_count;
+
+	struct cli_cmd_watch_point points[CLI_CMD_WATCH_MAX_POINTS];
+	size_t point_count;
+
+	// Whether to watch by protecting pages instead of with the debug
+	// registers.
+	int pages;
+
+	// Whether to watch with perf events, which do not stop the process,
+	// falling back to the debug registers when they are not available.
+	int perf;
+
+	// One out of how many accesses are reported when watching with perf
+	// events.
+	unsigned long sample_period;
+
+	// Whether to only count accesses to every watchpoint and print the
+	// counts at the end instead of the instructions.
+	int count;
 
 	// Whether to print an address only once.
 	int unique;
+
+	// Whether to count accesses by instruction and print them all at the
+	// end instead of as they happen.
+	int aggregate;
+
+	// Number of seconds between printing the accesses counted so far, or
+	// 0 to only print them at the end. Applies to aggregating and
+	// counting.
+	unsigned int interval;
+
+	// Whether to print the value of the watched bytes before and after
+	// every access.
+	int values;
+
+	// Whether accesses are only reported when the value of the watched
+	// bytes passes the comparisons.
+	int when;
+
+	// How the watched bytes are interpreted. Nil when values are neither
+	// printed nor compared.
+	cli_val value;
+
+	// What the value after an access is compared against. Comparisons
+	// that are not performed are nil.
+	struct cli_val_filter_compare_arg compare;
+
+	// How the value after an access compares to the value before it.
+	struct cli_val_filter_compare_prev_arg compare_prev;
 };
 
 int cli_cmd_watch(struct cli_cmd_watch_arg *arg);
@@ -0,0 +1,458 @@
+#include <string.h>
+
+#include "cli/expression.h"
+
+// Largest number of NFA states an expression can compile to.
+#define MAX_NFA_STATES 100000
+
+// Largest number of DFA states an expression can compile to.
+#define MAX_DFA_STATES 10000
+
+// Largest number of nodes that finding captures can try to match before
+// giving up.
+#define MAX_CAPTURE_STEPS 1000000
+
+/*
+ * Part of an NFA with a single way in and a single way out. Nothing leaves the
+ * end state yet.
+ */
+struct fragment {
+	int start;
+	int end;
+};
+
+/*
+ * What is left to match after a node, as a list. A repetition is continued
+ * with the number of times it has already matched and a capture is ended
+ * where the list gets to it.
+ */
+struct continuation {
+	struct cli_expression *e;
+
+	// Number of times a repetition matched so far and where it last
+	// started to match.
+	int count;
+	size_t position;
+
+	// Whether this is where a capture ends.
+	int capture_end;
+
+	struct continuation *next;
+};
+
+/*
+ * State of finding captures.
+ */
+struct matcher {
+	const char *bytes;
+	size_t size;
+	size_t *bounds;
+
+	// Number of attempts left.
+	long steps;
+};
+
+void cli_expression_set_byte(struct cli_expression *e, unsigned char byte);
+
+void cli_expression_set_range(struct cli_expression *e, unsigned char first, unsigned char last);
+
+int cli_expression_has_byte(struct cli_expression *e, unsigned char byte);
+
+/*
+ * Appends the bytes that every match of a node starts with.
+ *
+ * Returns whether the node always matches exactly those bytes, in which case
+ * whatever comes after it can add to the prefix.
+ */
+static int find_prefix(struct cli_expression *e, char *prefix, size_t max, size_t *size)
+{
+	switch (e->type) {
+	case CLI_EXPRESSION_EMPTY:
+		return 1;
+
+	case CLI_EXPRESSION_BYTES: {
+		int count = 0;
+		unsigned char byte = 0;
+
+		for (int b = 0; b < 256; ++b) {
+			if (cli_expression_has_byte(e, b)) {
+				byte = b;
+				count += 1;
+			}
+		}
+
+		if (count != 1 || *size == max) {
+			return 0;
+		}
+
+		prefix[(*size)++] = byte;
+
+		return 1;
+	}
+
+	case CLI_EXPRESSION_CONCAT:
+		return find_prefix(e->left, prefix, max, size)
+			&& find_prefix(e->right, prefix, max, size);
+
+	case CLI_EXPRESSION_ALTERNATE:
+		return 0;
+
+	case CLI_EXPRESSION_REPEAT:
+		for (int i = 0; i < e->min; ++i) {
+			if (!find_prefix(e->left, prefix, max, size)) {
+				return 0;
+			}
+		}
+
+		return e->min == e->max;
+
+	case CLI_EXPRESSION_CAPTURE:
+		return find_prefix(e->left, prefix, max, size);
+	}
+
+	return 0;
+}
+
+static int match_node(struct matcher *m, struct cli_expression *e, size_t position, struct continuation *k);
+
+static int match_repeat(struct matcher *m, struct cli_expression *e, int count, size_t position, struct continuation *k);
+
+/*
+ * Matches what is left after a node.
+ */
+static int match_continuation(struct matcher *m, size_t position, struct continuation *k)
+{
+	if (k == NULL) {
+		return position == m->size;
+	}
+
+	if (k->capture_end) {
+		size_t *end = &m->bounds[k->e->capture * 2 + 1];
+		size_t previous = *end;
+
+		*end = position;
+
+		if (match_continuation(m, position, k->next)) {
+			return 1;
+		}
+
+		*end = previous;
+		return 0;
+	}
+
+	if (k->e->type == CLI_EXPRESSION_REPEAT) {
+		// Matching nothing more than needed would go on forever.
+		if (k->count > k->e->min && position == k->position) {
+			return 0;
+		}
+
+		return match_repeat(m, k->e, k->count, position, k->next);
+	}
+
+	return match_node(m, k->e, position, k->next);
+}
+
+/*
+ * Matches a repetition that already matched count times, trying to match it
+ * once more before going on with what is left.
+ */
+static int match_repeat(struct matcher *m, struct cli_expression *e, int count, size_t position, struct continuation *k)
+{
+	if (e->max == -1 || count < e->max) {
+		struct continuation again = { e, count + 1, position, 0, k };
+
+		if (match_node(m, e->left, position, &again)) {
+			return 1;
+		}
+	}
+
+	return count >= e->min && match_continuation(m, position, k);
+}
+
+static int match_node(struct matcher *m, struct cli_expression *e, size_t position, struct continuation *k)
+{
+	if (m->steps-- <= 0) {
+		return 0;
+	}
+
+	switch (e->type) {
+	case CLI_EXPRESSION_EMPTY:
+		return match_continuation(m, position, k);
+
+	case CLI_EXPRESSION_BYTES:
+		return position < m->size
+			&& cli_expression_has_byte(e, m->bytes[position])
+			&& match_continuation(m, position + 1, k);
+
+	case CLI_EXPRESSION_CONCAT: {
+		struct continuation right = { e->right, 0, 0, 0, k };
+
+		return match_node(m, e->left, position, &right);
+	}
+
+	case CLI_EXPRESSION_ALTERNATE:
+		return match_node(m, e->left, position, k)
+			|| match_node(m, e->right, position, k);
+
+	case CLI_EXPRESSION_REPEAT:
+		return match_repeat(m, e, 0, position, k);
+
+	case CLI_EXPRESSION_CAPTURE: {
+		struct continuation end = { e, 0, 0, 1, k };
+		size_t *start = &m->bounds[e->capture * 2];
+		size_t previous = *start;
+
+		*start = position;
+
+		if (match_node(m, e->left, position, &end)) {
+			return 1;
+		}
+
+		*start = previous;
+		return 0;
+	}
+	}
+
+	return 0;
+}
+
+static int add_state(struct nfa *nfa)
+{
+	if (nfa->count >= MAX_NFA_STATES) {
+		nfa->error = 1;
+		return -1;
+	}
+
+	return nfa_add(nfa);
+}
+
+/*
+ * Compiles a node to a fragment of an NFA. Going backwards the operands of
+ * every concatenation are swapped.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int compile_node(struct nfa *nfa, struct cli_expression *e, int backward, struct fragment *f)
+{
+	struct fragment a, b;
+
+	switch (e->type) {
+	case CLI_EXPRESSION_EMPTY:
+		f->start = f->end = add_state(nfa);
+		return f->start != -1;
+
+	case CLI_EXPRESSION_CAPTURE:
+		return compile_node(nfa, e->left, backward, f);
+
+	case CLI_EXPRESSION_BYTES:
+		f->start = add_state(nfa);
+		f->end = add_state(nfa);
+
+		if (f->end == -1) {
+			return 0;
+		}
+
+		memcpy(nfa->states[f->start].bytes, e->bytes, sizeof(e->bytes));
+		nfa->states[f->start].next = f->end;
+		return 1;
+
+	case CLI_EXPRESSION_CONCAT:
+		if (!compile_node(nfa, backward ? e->right : e->left, backward, &a)
+			|| !compile_node(nfa, backward ? e->left : e->right, backward, &b)) {
+			return 0;
+		}
+
+		nfa->states[a.end].epsilon[0] = b.start;
+		f->start = a.start;
+		f->end = b.end;
+		return 1;
+
+	case CLI_EXPRESSION_ALTERNATE:
+		if (!compile_node(nfa, e->left, backward, &a)
+			|| !compile_node(nfa, e->right, backward, &b)) {
+			return 0;
+		}
+
+		f->start = add_state(nfa);
+		f->end = add_state(nfa);
+
+		if (f->end == -1) {
+			return 0;
+		}
+
+		nfa->states[f->start].epsilon[0] = a.start;
+		nfa->states[f->start].epsilon[1] = b.start;
+		nfa->states[a.end].epsilon[0] = f->end;
+		nfa->states[b.end].epsilon[0] = f->end;
+		return 1;
+
+	case CLI_EXPRESSION_REPEAT:
+		// Every repetition gets its own copy of the operand.
+		f->start = f->end = add_state(nfa);
+
+		if (f->start == -1) {
+			return 0;
+		}
+
+		for (int i = 0; i < e->min; ++i) {
+			if (!compile_node(nfa, e->left, backward, &a)) {
+				return 0;
+			}
+
+			nfa->states[f->end].epsilon[0] = a.start;
+			f->end = a.end;
+		}
+
+		if (e->max == -1) {
+			int loop = add_state(nfa);
+			int end = add_state(nfa);
+
+			if (end == -1 || !compile_node(nfa, e->left, backward, &a)) {
+				return 0;
+			}
+
+			nfa->states[f->end].epsilon[0] = loop;
+			nfa->states[loop].epsilon[0] = a.start;
+			nfa->states[loop].epsilon[1] = end;
+			nfa->states[a.end].epsilon[0] = loop;
+			f->end = end;
+			return 1;
+		}
+
+		for (int i = e->min; i < e->max; ++i) {
+			int end = add_state(nfa);
+
+			if (end == -1 || !compile_node(nfa, e->left, backward, &a)) {
+				return 0;
+			}
+
+			nfa->states[f->end].epsilon[0] = a.start;
+			nfa->states[f->end].epsilon[1] = end;
+			nfa->states[a.end].epsilon[0] = end;
+			f->end = end;
+		}
+
+		return 1;
+	}
+
+	return 0;
+}
+
+struct cli_expression *cli_expression_create(enum cli_expression_type type)
+{
+	struct cli_expression *e = malloc(sizeof(*e));
+
+	if (e == NULL) {
+		return NULL;
+	}
+
+	e->type = type;
+	memset(e->bytes, 0, sizeof(e->bytes));
+	e->left = NULL;
+	e->right = NULL;
+	e->min = 0;
+	e->max = 0;
+	e->capture = 0;
+
+	return e;
+}
+
+struct cli_expression *cli_expression_create_binary(enum cli_expression_type type, struct cli_expression *left, struct cli_expression *right)
+{
+	struct cli_expression *e = cli_expression_create(type);
+
+	if (e == NULL) {
+		cli_expression_destroy(left);
+		cli_expression_destroy(right);
+		return NULL;
+	}
+
+	e->left = left;
+	e->right = right;
+
+	return e;
+}
+
+void cli_expression_destroy(struct cli_expression *e)
+{
+	if (e == NULL) {
+		return;
+	}
+
+	cli_expression_destroy(e->left);
+	cli_expression_destroy(e->right);
+	free(e);
+}
+
+int cli_expression_nullable(struct cli_expression *e)
+{
+	switch (e->type) {
+	case CLI_EXPRESSION_EMPTY:
+		return 1;
+
+	case CLI_EXPRESSION_BYTES:
+		return 0;
+
+	case CLI_EXPRESSION_CONCAT:
+		return cli_expression_nullable(e->left) && cli_expression_nullable(e->right);
+
+	case CLI_EXPRESSION_ALTERNATE:
+		return cli_expression_nullable(e->left) || cli_expression_nullable(e->right);
+
+	case CLI_EXPRESSION_REPEAT:
+		return e->min == 0 || cli_expression_nullable(e->left);
+
+	case CLI_EXPRESSION_CAPTURE:
+		return cli_expression_nullable(e->left);
+	}
+
+	return 0;
+}
+
+size_t cli_expression_prefix(struct cli_expression *e, char *prefix, size_t max)
+{
+	size_t size = 0;
+
+	find_prefix(e, prefix, max, &size);
+
+	return size;
+}
+
+int cli_expression_captures(struct cli_expression *e, const char *bytes, size_t size, size_t *bounds)
+{
+	struct matcher m = { bytes, size, bounds, MAX_CAPTURE_STEPS };
+
+	return match_node(&m, e, 0, NULL);
+}
+
+int cli_expression_compile(struct cli_expression *e, int backward, int unanchored, struct dfa *d)
+{
+	struct nfa nfa;
+	struct fragment f;
+
+	nfa_init(&nfa);
+
+	if (!compile_node(&nfa, e, backward, &f)) {
+		int error = nfa.count >= MAX_NFA_STATES
+			? CLI_EXPRESSION_ERROR_TOO_COMPLEX
+			: CLI_EXPRESSION_ERROR_OUT_OF_MEMORY;
+
+		nfa_deinit(&nfa);
+		return error;
+	}
+
+	int error = dfa_compile(d, &nfa, f.start, f.end, unanchored, MAX_DFA_STATES);
+
+	nfa_deinit(&nfa);
+
+	switch (error) {
+	case 0:
+		return 0;
+
+	case DFA_ERROR_TOO_MANY_STATES:
+		return CLI_EXPRESSION_ERROR_TOO_COMPLEX;
+
+	default:
+		return CLI_EXPRESSION_ERROR_OUT_OF_MEMORY;
+	}
+}
@@ -0,0 +1,133 @@
+#ifndef CLI_EXPRESSION_H
+#define CLI_EXPRESSION_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "dfa/dfa.h"
+
+#define CLI_EXPRESSION_ERROR_OUT_OF_MEMORY 1
+#define CLI_EXPRESSION_ERROR_TOO_COMPLEX 2
+
+/*
+ * Syntax trees of expressions over bytes. Regular expressions and byte
+ * patterns are both parsed to them and they are compiled to DFAs the same way.
+ */
+
+enum cli_expression_type {
+	CLI_EXPRESSION_EMPTY,
+	CLI_EXPRESSION_BYTES,
+	CLI_EXPRESSION_CONCAT,
+	CLI_EXPRESSION_ALTERNATE,
+	CLI_EXPRESSION_REPEAT,
+	CLI_EXPRESSION_CAPTURE,
+};
+
+/*
+ * A node of the syntax tree.
+ */
+struct cli_expression {
+	enum cli_expression_type type;
+
+	// Bytes that a CLI_EXPRESSION_BYTES node matches.
+	uint64_t bytes[4];
+
+	// Operands of CLI_EXPRESSION_CONCAT and CLI_EXPRESSION_ALTERNATE. A
+	// CLI_EXPRESSION_REPEAT or CLI_EXPRESSION_CAPTURE node only has the
+	// left one.
+	struct cli_expression *left;
+	struct cli_expression *right;
+
+	// Bounds of a CLI_EXPRESSION_REPEAT node. An upper bound of -1 means
+	// there is none.
+	int min;
+	int max;
+
+	// Index of a CLI_EXPRESSION_CAPTURE node. It has no effect on what
+	// matches.
+	int capture;
+};
+
+/*
+ * Creates a node with no bytes, no operands and no bounds.
+ *
+ * Returns NULL on failure.
+ */
+struct cli_expression *cli_expression_create(enum cli_expression_type type);
+
+/*
+ * Creates a node with two operands. The operands are destroyed on failure.
+ *
+ * Returns NULL on failure.
+ */
+struct cli_expression *cli_expression_create_binary(enum cli_expression_type type, struct cli_expression *left, struct cli_expression *right);
+
+/*
+ * Destroys a node along with its operands. Does nothing on NULL.
+ */
+void cli_expression_destroy(struct cli_expression *e);
+
+/*
+ * Adds a byte to the bytes that a node matches.
+ */
+inline void cli_expression_set_byte(struct cli_expression *e, unsigned char byte)
+{
+	e->bytes[byte / 64] |= (uint64_t) 1 << (byte % 64);
+}
+
+/*
+ * Adds a range of bytes, both ends included, to the bytes that a node matches.
+ */
+inline void cli_expression_set_range(struct cli_expression *e, unsigned char first, unsigned char last)
+{
+	for (int byte = first; byte <= last; ++byte) {
+		cli_expression_set_byte(e, byte);
+	}
+}
+
+/*
+ * Tells whether a node matches a byte.
+ */
+inline int cli_expression_has_byte(struct cli_expression *e, unsigned char byte)
+{
+	return (e->bytes[byte / 64] >> (byte % 64)) & 1;
+}
+
+/*
+ * Tells whether a node can match without consuming anything.
+ */
+int cli_expression_nullable(struct cli_expression *e);
+
+/*
+ * Finds the bytes that every match starts with, up to a maximum.
+ *
+ * Returns how many there are.
+ */
+size_t cli_expression_prefix(struct cli_expression *e, char *prefix, size_t max);
+
+/*
+ * Finds where the operand of every CLI_EXPRESSION_CAPTURE node is in bytes
+ * that are known to match as a whole. The bounds of capture i go to
+ * bounds[i * 2] and bounds[i * 2 + 1], the end not included, and stay as they
+ * are for captures that are not part of the match. When a capture is repeated
+ * the last repetition is the one found.
+ *
+ * Repetitions take as much as they can and alternatives are tried from left
+ * to right. Gives up after too many attempts.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int cli_expression_captures(struct cli_expression *e, const char *bytes, size_t size, size_t *bounds);
+
+/*
+ * Compiles a syntax tree to a DFA.
+ *
+ * A forward DFA is fed bytes in the order they are stored and a backward DFA
+ * is fed them in reverse. An unanchored DFA finds matches anywhere while an
+ * anchored one only finds them where it starts.
+ *
+ * Returns 0 on success or one of the CLI_EXPRESSION_ERROR_ values on failure.
+ */
+int cli_expression_compile(struct cli_expression *e, int backward, int unanchored, struct dfa *d);
+
+#endif /* CLI_EXPRESSION_H */
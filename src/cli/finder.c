@@ -0,0 +1,530 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include "cli/finder.h"
+#include "cli/printer.h"
+#include "cli/jobs.h"
+#include "lib/include/proctal.h"
+#include "swbuf/swbuf.h"
+#include "chunk/chunk.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Amount of memory read at once.
+#define CHUNK_SIZE (1024 * 1024)
+
+/*
+ * A memory region. Regions are searched independently of each other since
+ * matches cannot go from one to the next.
+ */
+struct job {
+	char *start;
+	char *end;
+};
+
+/*
+ * State shared by the threads.
+ */
+struct scan {
+	struct cli_find_arg *arg;
+
+	struct dfa *forward;
+	struct dfa *backward;
+
+	const char *prefix;
+	size_t prefix_size;
+
+	struct job *jobs;
+	size_t job_count;
+
+	struct jobs queue;
+
+	// One for every job.
+	struct cli_job_output *outputs;
+};
+
+/*
+ * Appends a line for a match that goes from start to end, not included,
+ * relative to the offset of the current chunk. A negative start is in the
+ * previous chunk, which is still in the buffer, or further back, which is
+ * read again. The number of mismatches is appended after the address when
+ * mismatches are allowed.
+ */
+static void output_match(struct scan *s, proctal p, struct cli_job_output *o, struct swbuf *buf, char *offset, ptrdiff_t start, size_t end, size_t prev_size, int mismatches)
+{
+	char *address = offset + start;
+	char line[sizeof(uintptr_t) * 2 + 16];
+	int size = mismatches < 0
+		? snprintf(line, sizeof(line), "%" PRIXPTR, (uintptr_t) address)
+		: snprintf(line, sizeof(line), "%" PRIXPTR " %d", (uintptr_t) address, mismatches);
+
+	cli_job_output_append(o, line, size);
+
+	if (s->arg->describe != NULL && !o->error) {
+		size_t match_size = end - start;
+		char *bytes = malloc(match_size);
+
+		if (bytes == NULL) {
+			o->error = 1;
+			return;
+		}
+
+		const char *data = swbuf_address_offset(buf, 0);
+		ptrdiff_t k = start;
+
+		if (k < -(ptrdiff_t) prev_size) {
+			k = -(ptrdiff_t) prev_size;
+
+			proctal_read(p, address, bytes, k - start);
+
+			if (proctal_error(p)) {
+				cli_print_proctal_error(p);
+				proctal_error_ack(p);
+				free(bytes);
+				o->error = 1;
+				return;
+			}
+		}
+
+		for (; k < (ptrdiff_t) end; ++k) {
+			bytes[k - start] = k >= 0
+				? data[k]
+				: *(const char *) swbuf_address_offset(buf, prev_size + k - swbuf_size(buf));
+		}
+
+		s->arg->describe(s->arg->describe_data, o, address, bytes, match_size);
+
+		free(bytes);
+	}
+
+	cli_job_output_append(o, "\n", 1);
+}
+
+/*
+ * Finds the next position, starting at i, where the prefix is stored.
+ * Positions from end onwards are not checked and the bytes of the prefix at
+ * the last position must be available.
+ *
+ * With SSE2, 16 positions are filtered at once by the first and last bytes of
+ * the prefix and only the ones that pass are compared in full.
+ *
+ * Returns end if there is none.
+ */
+static size_t find_prefix(struct scan *s, const char *data, size_t i, size_t end)
+{
+	const char *prefix = s->prefix;
+	size_t last = s->prefix_size - 1;
+
+#ifdef __SSE2__
+	__m128i first_byte = _mm_set1_epi8(prefix[0]);
+	__m128i last_byte = _mm_set1_epi8(prefix[last]);
+
+	for (; i + 16 <= end; i += 16) {
+		__m128i f = _mm_loadu_si128((const __m128i *) (data + i));
+		__m128i l = _mm_loadu_si128((const __m128i *) (data + i + last));
+
+		int mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(f, first_byte), _mm_cmpeq_epi8(l, last_byte)));
+
+		while (mask) {
+			int bit = __builtin_ctz(mask);
+
+			if (memcmp(data + i + bit, prefix, s->prefix_size) == 0) {
+				return i + bit;
+			}
+
+			mask &= mask - 1;
+		}
+	}
+#endif
+
+	// Positions after the last block of 16, or all of them without SSE2,
+	// are compared one at a time.
+	for (; i < end; ++i) {
+		if (data[i] == prefix[0] && memcmp(data + i, prefix, s->prefix_size) == 0) {
+			return i;
+		}
+	}
+
+	return end;
+}
+
+/*
+ * Goes backwards from the last byte of a match to find where it starts.
+ * Bytes of the previous chunk are still in the buffer and bytes from further
+ * back are read again a piece at a time, since a match can be of any length.
+ * Nothing before earliest is looked at.
+ *
+ * Returns where the match starts relative to the offset of the current chunk.
+ */
+static ptrdiff_t find_start(struct scan *s, proctal p, struct swbuf *buf, char *offset, size_t end, size_t prev_size, char *earliest)
+{
+	struct dfa *d = s->backward;
+	const char *data = swbuf_address_offset(buf, 0);
+	uint32_t state = d->start;
+
+	ptrdiff_t first = earliest - offset;
+	ptrdiff_t start = end;
+
+	// Bytes from before the previous chunk.
+	char piece[4096];
+	ptrdiff_t piece_start = -(ptrdiff_t) prev_size;
+
+	for (ptrdiff_t k = end; k >= first; --k) {
+		unsigned char byte;
+
+		if (k >= 0) {
+			byte = data[k];
+		} else if (k >= -(ptrdiff_t) prev_size) {
+			byte = *(const char *) swbuf_address_offset(buf, prev_size + k - swbuf_size(buf));
+		} else {
+			if (k < piece_start) {
+				piece_start = k - (ptrdiff_t) sizeof(piece) + 1 > first
+					? k - (ptrdiff_t) sizeof(piece) + 1
+					: first;
+
+				proctal_read(p, offset + piece_start, piece, k - piece_start + 1);
+
+				if (proctal_error(p)) {
+					cli_print_proctal_error(p);
+					proctal_error_ack(p);
+					break;
+				}
+			}
+
+			byte = piece[k - piece_start];
+		}
+
+		state = dfa_step(d, state, byte);
+
+		if (dfa_dead(d, state)) {
+			break;
+		}
+
+		// Going on for as long as possible finds the match that
+		// starts first.
+		if (dfa_accepting(d, state)) {
+			start = k;
+		}
+	}
+
+	return start;
+}
+
+/*
+ * Streams a region through the DFA one chunk at a time. The state is carried
+ * from one chunk to the next so matches can go across them. Matches do not
+ * overlap, the DFA starts over after the end of each one.
+ *
+ * While the DFA is in its start state, positions where the prefix is not
+ * stored cannot start a match and are skipped.
+ */
+static void search_region(struct scan *s, proctal p, struct swbuf *buf, struct job *job, struct cli_job_output *o)
+{
+	struct dfa *d = s->forward;
+	uint32_t state = d->start;
+
+	// Where the DFA was last in its start state. A match cannot start
+	// before then, however many chunks ago that was.
+	char *earliest = job->start;
+
+	// Size of the chunk before the current one, or 0 if it could not be
+	// read.
+	size_t prev_size = 0;
+
+	struct chunk chunk;
+
+	chunk_init(&chunk, job->start, job->end, CHUNK_SIZE);
+
+	do {
+		char *offset = chunk_offset(&chunk);
+		size_t size = chunk_size(&chunk);
+		const char *data = swbuf_address_offset(buf, 0);
+
+		proctal_read(p, offset, swbuf_address_offset(buf, 0), size);
+
+		if (proctal_error(p)) {
+			cli_print_proctal_error(p);
+			proctal_error_ack(p);
+
+			// Matches cannot go across memory we cannot read.
+			state = d->start;
+			prev_size = 0;
+			continue;
+		}
+
+		size_t limit = s->prefix_size && size >= s->prefix_size
+			? size - s->prefix_size + 1
+			: 0;
+
+		for (size_t i = 0; i < size; ++i) {
+			if (state == d->start) {
+				if (i < limit) {
+					i = find_prefix(s, data, i, limit);
+
+					if (i == size) {
+						break;
+					}
+				}
+
+				earliest = offset + i;
+			}
+
+			state = dfa_step(d, state, data[i]);
+
+			if (!dfa_accepting(d, state)) {
+				continue;
+			}
+
+			ptrdiff_t start = find_start(s, p, buf, offset, i, prev_size, earliest);
+
+			output_match(s, p, o, buf, offset, start, i + 1, prev_size, -1);
+
+			state = d->start;
+		}
+
+		swbuf_swap(buf);
+		prev_size = size;
+	} while (chunk_next(&chunk));
+}
+
+/*
+ * Streams a region through a bit-parallel matcher that allows bytes to be
+ * different from what the pattern expects at up to a number of positions.
+ *
+ * Bit j of the state for d mismatches tells whether the first j + 1 positions
+ * of the pattern match the bytes that were just seen with at most d of them
+ * being different. All states move on together by a shift and a mask per
+ * byte, so a region takes a single pass. States are carried from one chunk
+ * to the next so matches can go across them, and start over after the end of
+ * each match so that matches do not overlap.
+ */
+static void search_region_approximately(struct scan *s, proctal p, struct swbuf *buf, struct job *job, struct cli_job_output *o)
+{
+	const uint64_t *masks = s->arg->masks;
+	int max_mismatches = s->arg->max_mismatches;
+	uint64_t found = (uint64_t) 1 << (s->arg->length - 1);
+	uint64_t states[CLI_FIND_MAX_LENGTH];
+
+	memset(states, 0, sizeof(states));
+
+	// Size of the chunk before the current one, or 0 if it could not be
+	// read.
+	size_t prev_size = 0;
+
+	struct chunk chunk;
+
+	chunk_init(&chunk, job->start, job->end, CHUNK_SIZE);
+
+	do {
+		char *offset = chunk_offset(&chunk);
+		size_t size = chunk_size(&chunk);
+		const unsigned char *data = swbuf_address_offset(buf, 0);
+
+		proctal_read(p, offset, swbuf_address_offset(buf, 0), size);
+
+		if (proctal_error(p)) {
+			cli_print_proctal_error(p);
+			proctal_error_ack(p);
+
+			// Matches cannot go across memory we cannot read.
+			memset(states, 0, sizeof(states));
+			prev_size = 0;
+			continue;
+		}
+
+		for (size_t i = 0; i < size; ++i) {
+			uint64_t mask = masks[data[i]];
+
+			// The state with one less mismatch before the byte.
+			uint64_t fewer = states[0];
+
+			states[0] = ((states[0] << 1) | 1) & mask;
+
+			for (int d = 1; d <= max_mismatches; ++d) {
+				uint64_t state = states[d];
+
+				// Either the byte is expected or it is taken
+				// as one more mismatch.
+				states[d] = (((state << 1) | 1) & mask) | ((fewer << 1) | 1);
+				fewer = state;
+			}
+
+			if (!(states[max_mismatches] & found)) {
+				continue;
+			}
+
+			int mismatches = 0;
+
+			while (!(states[mismatches] & found)) {
+				++mismatches;
+			}
+
+			ptrdiff_t start = (ptrdiff_t) (i + 1) - (ptrdiff_t) s->arg->length;
+
+			output_match(s, p, o, buf, offset, start, i + 1, prev_size, mismatches);
+
+			memset(states, 0, sizeof(states));
+		}
+
+		swbuf_swap(buf);
+		prev_size = size;
+	} while (chunk_next(&chunk));
+}
+
+/*
+ * Takes regions until there are none left, with an instance of its own. A
+ * region taken after failing to get ready is finished with nothing found.
+ */
+static void *worker_run(void *data)
+{
+	struct scan *s = data;
+
+	proctal p = proctal_create();
+	struct swbuf buf;
+	swbuf_init(&buf, CHUNK_SIZE);
+
+	int ready = 1;
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		ready = 0;
+	} else if (swbuf_error(&buf)) {
+		fprintf(stderr, "Ran out of memory.\n");
+		ready = 0;
+	}
+
+	proctal_set_pid(p, s->arg->pid);
+
+	size_t i;
+
+	while (jobs_take(&s->queue, &i)) {
+		if (ready && s->arg->masks != NULL) {
+			search_region_approximately(s, p, &buf, &s->jobs[i], &s->outputs[i]);
+		} else if (ready) {
+			search_region(s, p, &buf, &s->jobs[i], &s->outputs[i]);
+		}
+
+		jobs_finish(&s->queue, &s->outputs[i].done);
+	}
+
+	if (!swbuf_error(&buf)) {
+		swbuf_deinit(&buf);
+	}
+
+	proctal_destroy(p);
+
+	return NULL;
+}
+
+/*
+ * Makes a job of every memory region.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int plan_jobs(struct scan *s, proctal p)
+{
+	size_t capacity = 0;
+
+	proctal_region_new(p);
+
+	void *start, *end;
+
+	while (proctal_region(p, &start, &end)) {
+		if (s->job_count == capacity) {
+			capacity = capacity ? capacity * 2 : 256;
+			struct job *jobs = realloc(s->jobs, capacity * sizeof(*jobs));
+
+			if (jobs == NULL) {
+				proctal_region_new(p);
+				fprintf(stderr, "Ran out of memory.\n");
+				return 0;
+			}
+
+			s->jobs = jobs;
+		}
+
+		struct job *job = &s->jobs[s->job_count++];
+		job->start = start;
+		job->end = end;
+	}
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_error_ack(p);
+		return 0;
+	}
+
+	return 1;
+}
+
+int cli_find(struct cli_find_arg *arg)
+{
+	proctal p = proctal_create();
+
+	if (proctal_error(p)) {
+		cli_print_proctal_error(p);
+		proctal_destroy(p);
+		return 0;
+	}
+
+	proctal_set_pid(p, arg->pid);
+
+	if (!arg->read && !arg->write && !arg->execute) {
+		// By default will search readable memory.
+		proctal_region_set_read(p, 1);
+		proctal_region_set_write(p, 0);
+		proctal_region_set_execute(p, 0);
+	} else {
+		proctal_region_set_read(p, arg->read);
+		proctal_region_set_write(p, arg->write);
+		proctal_region_set_execute(p, arg->execute);
+	}
+
+	long mask = 0;
+
+	if (arg->program_code) {
+		mask |= PROCTAL_REGION_PROGRAM_CODE;
+	}
+
+	proctal_region_set_mask(p, mask);
+
+	struct scan s;
+	s.arg = arg;
+	s.forward = arg->forward;
+	s.backward = arg->backward;
+	s.prefix = arg->prefix;
+	s.prefix_size = arg->prefix_size;
+	s.jobs = NULL;
+	s.job_count = 0;
+
+	if (!plan_jobs(&s, p)) {
+		free(s.jobs);
+		proctal_destroy(p);
+		return 0;
+	}
+
+	s.outputs = cli_job_outputs_create(s.job_count);
+
+	if (s.outputs == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		free(s.jobs);
+		proctal_destroy(p);
+		return 0;
+	}
+
+	jobs_init(&s.queue, s.job_count);
+
+	cli_jobs_run(&s.queue, s.outputs, arg->threads, worker_run, &s);
+
+	jobs_deinit(&s.queue);
+
+	cli_job_outputs_destroy(s.outputs, s.job_count);
+	free(s.jobs);
+	proctal_destroy(p);
+
+	return 1;
+}
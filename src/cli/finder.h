@@ -0,0 +1,74 @@
+#ifndef CLI_FINDER_H
+#define CLI_FINDER_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "dfa/dfa.h"
+#include "cli/jobs.h"
+
+// Longest pattern that can be matched with mismatches.
+#define CLI_FIND_MAX_LENGTH 64
+
+/*
+ * What to look for in the memory of a process and where.
+ */
+struct cli_find_arg {
+	int pid;
+
+	// Whether to search readable memory addresses.
+	int read;
+
+	// Whether to search writable memory addresses.
+	int write;
+
+	// Whether to search executable memory addresses.
+	int execute;
+
+	// Whether to search program code.
+	int program_code;
+
+	// Number of threads used to go over memory. 0 means one per
+	// processor.
+	int threads;
+
+	// Unanchored DFA that accepts right after the last byte of a match.
+	struct dfa *forward;
+
+	// Anchored DFA that, fed bytes backwards from the last byte of a
+	// match, accepts right after the first byte of a match.
+	struct dfa *backward;
+
+	// Bytes that every match starts with. The size can be 0.
+	const char *prefix;
+	size_t prefix_size;
+
+	// When not NULL, matches are looked for with a bit-parallel matcher
+	// instead of the DFAs. Bit j of the mask of a byte tells whether the
+	// byte is expected at position j of a pattern of the given length,
+	// which is at most CLI_FIND_MAX_LENGTH. Up to max_mismatches positions
+	// can have a byte that is not expected and the number of them is
+	// printed after the address of every match.
+	const uint64_t *masks;
+	size_t length;
+	int max_mismatches;
+
+	// When not NULL, called with the bytes of every match after its
+	// address is printed and before the line ends, to append more about
+	// it with cli_job_output_append. It is called from multiple threads at
+	// once.
+	void (*describe)(void *data, struct cli_job_output *o, char *address, const char *bytes, size_t size);
+	void *describe_data;
+};
+
+/*
+ * Prints the starting address of every match in memory, in order. Matches do
+ * not overlap and each one ends as soon as it can.
+ *
+ * Memory regions are searched by multiple threads at once.
+ *
+ * Returns 1 on success, 0 on failure. Errors are printed.
+ */
+int cli_find(struct cli_find_arg *arg);
+
+#endif /* CLI_FINDER_H */
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "cli/jobs.h"
+
+struct cli_job_output *cli_job_outputs_create(size_t count)
+{
+	struct cli_job_output *outputs = malloc((count ? count : 1) * sizeof(*outputs));
+
+	if (outputs == NULL) {
+		return NULL;
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		outputs[i] = (struct cli_job_output) { NULL, 0, 0, 0, 0 };
+	}
+
+	return outputs;
+}
+
+void cli_job_outputs_destroy(struct cli_job_output *outputs, size_t count)
+{
+	for (size_t i = 0; i < count; ++i) {
+		free(outputs[i].data);
+	}
+
+	free(outputs);
+}
+
+int cli_job_output_append(struct cli_job_output *o, const char *data, size_t size)
+{
+	if (o->error) {
+		return 0;
+	}
+
+	if (o->size + size > o->capacity) {
+		size_t capacity = o->capacity ? o->capacity * 2 : 4096;
+
+		while (capacity < o->size + size) {
+			capacity *= 2;
+		}
+
+		char *grown = realloc(o->data, capacity);
+
+		if (grown == NULL) {
+			o->error = 1;
+			return 0;
+		}
+
+		o->data = grown;
+		o->capacity = capacity;
+	}
+
+	memcpy(o->data + o->size, data, size);
+	o->size += size;
+
+	return 1;
+}
+
+/*
+ * Prints the output of the jobs in order, waiting for each one to be done.
+ * Outputs are freed as soon as they are printed.
+ */
+static void print_outputs(struct jobs *j, struct cli_job_output *outputs)
+{
+	int reported = 0;
+
+	for (size_t i = 0; i < j->count; ++i) {
+		struct cli_job_output *o = &outputs[i];
+
+		jobs_wait(j, &o->done);
+
+		fwrite(o->data, 1, o->size, stdout);
+
+		if (o->error && !reported) {
+			fprintf(stderr, "Ran out of memory.\n");
+			reported = 1;
+		}
+
+		free(o->data);
+		o->data = NULL;
+	}
+}
+
+void cli_jobs_run(struct jobs *j, struct cli_job_output *outputs, int threads, void *(*f)(void *), void *data)
+{
+	int count = jobs_threads(threads);
+
+	pthread_t *handles = malloc(count * sizeof(*handles));
+
+	if (handles == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		return;
+	}
+
+	int started = jobs_start(handles, count, f, data, 0);
+
+	if (started == 0) {
+		// Not being able to start threads is no reason to give up.
+		f(data);
+	}
+
+	print_outputs(j, outputs);
+
+	jobs_join(handles, started);
+
+	free(handles);
+}
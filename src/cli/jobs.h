@@ -0,0 +1,58 @@
+#ifndef CLI_JOBS_H
+#define CLI_JOBS_H
+
+#include <stdlib.h>
+
+#include "jobs/jobs.h"
+
+/*
+ * What a job prints. Jobs run at the same time and finish in any order but
+ * what they print comes out in the order they were planned.
+ */
+struct cli_job_output {
+	char *data;
+	size_t size;
+	size_t capacity;
+
+	// Whether memory ran out while appending.
+	int error;
+
+	// Whether the job is done. Set through jobs_finish.
+	int done;
+};
+
+/*
+ * Creates the outputs of a number of jobs, all empty.
+ *
+ * Returns NULL on failure.
+ */
+struct cli_job_output *cli_job_outputs_create(size_t count);
+
+/*
+ * Destroys the outputs of a number of jobs.
+ */
+void cli_job_outputs_destroy(struct cli_job_output *outputs, size_t count);
+
+/*
+ * Appends to what a job prints.
+ *
+ * Returns 1 on success, 0 when memory ran out, after which nothing more is
+ * appended.
+ */
+int cli_job_output_append(struct cli_job_output *o, const char *data, size_t size);
+
+/*
+ * Runs f with the given data in the given number of threads, 0 meaning one
+ * per processor, and prints the output of every job in order as soon as it
+ * is done while the threads keep going. Each thread is expected to take jobs
+ * until there are none left and to finish each of them with the done flag of
+ * its output.
+ *
+ * If no thread can be started, f runs in the calling thread before anything
+ * is printed.
+ *
+ * Errors are printed.
+ */
+void cli_jobs_run(struct jobs *j, struct cli_job_output *outputs, int threads, void *(*f)(void *), void *data);
+
+#endif /* CLI_JOBS_H */
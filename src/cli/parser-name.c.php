@@ -52,6 +52,7 @@ $parsers = [
 		"type" => "enum cli_val_text_charset",
 		"values" => [
 			"ascii" => "CLI_VAL_TEXT_CHARSET_ASCII",
+			"utf-16le" => "CLI_VAL_TEXT_CHARSET_UTF16LE",
 		],
 	],
 	[
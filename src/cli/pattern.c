@@ -1,33 +1,32 @@
-#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
 
 #include "cli/pattern.h"
 #include "cli/parser.h"
+#include "cli/expression.h"
 
-enum pattern_type {
-	PATTERN_TYPE_BYTE_VALUE,
-	PATTERN_TYPE_ANY_BYTE,
-};
+// Largest number of times an element can be repeated and largest gap.
+#define MAX_REPEAT 1000
 
-struct pattern {
-	int type;
-};
+// Largest number of bytes of the prefix that is kept.
+#define MAX_PREFIX 64
 
-struct pattern_byte_value {
-	struct pattern p;
+struct parser {
+	struct cli_pattern *cp;
 
-	char value;
+	const char *orig;
+	const char *s;
 };
 
-struct pattern_any_byte;
+struct capture {
+	char name[CLI_PATTERN_MAX_CAPTURE_NAME + 1];
 
-struct pattern_list_node {
-	struct pattern *pattern;
-	struct pattern_list_node *next;
-};
+	enum cli_pattern_capture_type type;
 
-struct pattern_list {
-	struct pattern_list_node *first;
-	struct pattern_list_node *last;
+	// Where the capture is in matches of patterns that can be broken down
+	// to positions.
+	size_t start;
+	size_t end;
 };
 
 struct cli_pattern {
@@ -35,11 +34,36 @@ struct cli_pattern {
 
 	size_t error_compile_offset;
 
-	struct pattern_list patterns;
+	int compiled;
+
+	// Finds matches anywhere.
+	struct dfa forward;
+
+	// Finds where matches start.
+	struct dfa backward;
+
+	// Tells whether the input matches from its first byte.
+	struct dfa anchored;
+
+	char prefix[MAX_PREFIX];
+	size_t prefix_size;
+
+	// Bytes expected at every position, if the pattern can be broken down
+	// to positions.
+	uint64_t positions[CLI_PATTERN_MAX_POSITIONS][4];
+	size_t position_count;
+
+	struct capture captures[CLI_PATTERN_MAX_CAPTURES];
+	size_t capture_count;
+
+	// Syntax tree, kept for finding captures.
+	struct cli_expression *tree;
 
-	struct pattern_list_node *last_pattern;
+	// State of the anchored DFA after the input so far.
+	uint32_t state;
 
 	int finished;
+	int matched;
 };
 
 static void cli_pattern_set_error(cli_pattern cp, int error)
@@ -47,190 +71,671 @@ static void cli_pattern_set_error(cli_pattern cp, int error)
 	cp->error = error;
 }
 
-static void destroy_pattern(struct pattern *p)
+static void parser_error(struct parser *p, int error)
+{
+	cli_pattern_set_error(p->cp, error);
+	p->cp->error_compile_offset = p->s - p->orig;
+}
+
+static struct cli_expression *create_node(struct parser *p, enum cli_expression_type type)
+{
+	struct cli_expression *n = cli_expression_create(type);
+
+	if (n == NULL) {
+		parser_error(p, CLI_PATTERN_ERROR_OUT_OF_MEMORY);
+	}
+
+	return n;
+}
+
+static struct cli_expression *create_binary_node(struct parser *p, enum cli_expression_type type, struct cli_expression *left, struct cli_expression *right)
 {
-	if (p->type == PATTERN_TYPE_ANY_BYTE) {
-		return;
+	struct cli_expression *n = cli_expression_create_binary(type, left, right);
+
+	if (n == NULL) {
+		parser_error(p, CLI_PATTERN_ERROR_OUT_OF_MEMORY);
 	}
 
-	free(p);
+	return n;
 }
 
-static void pattern_list_append_node(struct pattern_list *l, struct pattern_list_node *n)
+static int hex_value(char c)
 {
-	if (l->first == NULL) {
-		l->first = n;
-		l->last = n;
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	} else if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
 	} else {
-		l->last->next = n;
-		l->last = n;
+		return c - 'A' + 10;
 	}
 }
 
-static struct pattern_list_node *create_pattern_list_node(void)
+static void skip_whitespace(struct parser *p)
 {
-	struct pattern_list_node *n = malloc(sizeof(*n));
+	p->s += cli_parse_skip_chars(p->s, " \n\t");
+}
 
-	n->pattern = NULL;
-	n->next = NULL;
+static int is_whitespace(char c)
+{
+	return c == ' ' || c == '\n' || c == '\t';
+}
 
-	return n;
+/*
+ * Tells whether an element could start at the character.
+ */
+static int starts_element(char c)
+{
+	return cli_parse_is_hex_digit(c) || c == '?' || c == '[' || c == '(' || c == '{' || c == '<';
 }
 
-static void destroy_pattern_list_node(struct pattern_list_node *n)
+/*
+ * Tells whether a group, an alternative, a capture or the pattern ends at the
+ * character.
+ */
+static int ends_sequence(char c)
 {
-	free(n);
+	return c == '\0' || c == '|' || c == ')' || c == '>';
 }
 
-static void clear_pattern_list(struct pattern_list *l)
+static int is_name_char(char c, int first)
 {
-	if (l->first == NULL) {
-		return;
-	}
+	return (c >= 'a' && c <= 'z')
+		|| (c >= 'A' && c <= 'Z')
+		|| c == '_'
+		|| (!first && c >= '0' && c <= '9');
+}
 
-	struct pattern_list_node *c = l->first;
-	struct pattern_list_node *n;
+/*
+ * Number of bytes that every match of a node has, or -1 if it varies.
+ */
+static int fixed_size(struct cli_expression *n)
+{
+	int left, right;
 
-	do {
-		n = c->next;
+	switch (n->type) {
+	case CLI_EXPRESSION_EMPTY:
+		return 0;
+
+	case CLI_EXPRESSION_BYTES:
+		return 1;
+
+	case CLI_EXPRESSION_CONCAT:
+		left = fixed_size(n->left);
+		right = fixed_size(n->right);
+		return left == -1 || right == -1 ? -1 : left + right;
 
-		destroy_pattern(c->pattern);
-		destroy_pattern_list_node(c);
-	} while ((c = n));
+	case CLI_EXPRESSION_ALTERNATE:
+		left = fixed_size(n->left);
+		right = fixed_size(n->right);
+		return left == right ? left : -1;
 
-	l->first = NULL;
-	l->last = NULL;
+	case CLI_EXPRESSION_REPEAT:
+		left = fixed_size(n->left);
+		return left == -1 || n->min != n->max ? -1 : left * n->min;
+
+	case CLI_EXPRESSION_CAPTURE:
+		return fixed_size(n->left);
+	}
+
+	return -1;
 }
 
-static struct pattern_byte_value *create_pattern_byte_value()
+/*
+ * Parses a byte value, a nibble wildcard or the any byte wildcard, adding the
+ * bytes it stands for to the node.
+ *
+ * Returns 1 on success, 0 if there is none.
+ */
+static int parse_byte(struct parser *p, struct cli_expression *n)
 {
-	struct pattern_byte_value *p = malloc(sizeof(*p));
+	char high = p->s[0];
+	char low = high == '\0' ? '\0' : p->s[1];
+
+	if (cli_parse_is_hex_digit(high) && cli_parse_is_hex_digit(low)) {
+		cli_expression_set_byte(n, hex_value(high) << 4 | hex_value(low));
+	} else if (cli_parse_is_hex_digit(high) && low == '?') {
+		cli_expression_set_range(n, hex_value(high) << 4, hex_value(high) << 4 | 0xF);
+	} else if (high == '?' && cli_parse_is_hex_digit(low)) {
+		for (int h = 0; h < 16; ++h) {
+			cli_expression_set_byte(n, h << 4 | hex_value(low));
+		}
+	} else if (high == '?' && low == '?') {
+		cli_expression_set_range(n, 0x00, 0xFF);
+	} else {
+		return 0;
+	}
 
-	p->p.type = PATTERN_TYPE_BYTE_VALUE;
+	p->s += 2;
 
-	return p;
+	return 1;
 }
 
-static struct pattern_any_byte *create_pattern_any_byte()
+/*
+ * Parses a set of bytes between brackets.
+ */
+static struct cli_expression *parse_set(struct parser *p)
 {
-	static struct pattern *p = NULL;
+	struct cli_expression *n = create_node(p, CLI_EXPRESSION_BYTES);
 
-	if (p == NULL) {
-		p = malloc(sizeof(*p));
-		p->type = PATTERN_TYPE_ANY_BYTE;
+	if (n == NULL) {
+		return NULL;
 	}
 
-	return (struct pattern_any_byte *) p;
+	// Skipping the opening bracket.
+	p->s += 1;
+
+	skip_whitespace(p);
+
+	do {
+		const char *first = p->s;
+
+		if (!parse_byte(p, n)) {
+			parser_error(p, CLI_PATTERN_ERROR_INVALID_PATTERN);
+			cli_expression_destroy(n);
+			return NULL;
+		}
+
+		if (*p->s == '-') {
+			// A range goes from one byte value to another.
+			const char *last = p->s + 1;
+
+			if (!cli_parse_is_hex_digit(first[0]) || !cli_parse_is_hex_digit(first[1])
+				|| !cli_parse_is_hex_digit(last[0]) || !cli_parse_is_hex_digit(last[1])) {
+				p->s = cli_parse_is_hex_digit(first[0]) && cli_parse_is_hex_digit(first[1]) ? last : first;
+				parser_error(p, CLI_PATTERN_ERROR_INVALID_PATTERN);
+				cli_expression_destroy(n);
+				return NULL;
+			}
+
+			int low = hex_value(first[0]) << 4 | hex_value(first[1]);
+			int high = hex_value(last[0]) << 4 | hex_value(last[1]);
+
+			if (high < low) {
+				p->s = first;
+				parser_error(p, CLI_PATTERN_ERROR_INVALID_PATTERN);
+				cli_expression_destroy(n);
+				return NULL;
+			}
+
+			cli_expression_set_range(n, low, high);
+			p->s = last + 2;
+		}
+
+		if (*p->s == ']') {
+			break;
+		}
+
+		if (!is_whitespace(*p->s)) {
+			parser_error(p, starts_element(*p->s)
+				? CLI_PATTERN_ERROR_MISSING_WHITESPACE
+				: CLI_PATTERN_ERROR_INVALID_PATTERN);
+			cli_expression_destroy(n);
+			return NULL;
+		}
+
+		skip_whitespace(p);
+	} while (*p->s != ']');
+
+	// Skipping the closing bracket.
+	p->s += 1;
+
+	return n;
 }
 
-static int parse_pattern_opt_whitespace(struct cli_pattern *cp, struct pattern_list *l, const char **s)
+static int parse_count(struct parser *p, int *count)
 {
-	size_t consumed = cli_parse_skip_chars(*s, " \n\t");
+	if (*p->s < '0' || *p->s > '9') {
+		return 0;
+	}
 
-	*s += consumed;
+	*count = 0;
+
+	while (*p->s >= '0' && *p->s <= '9') {
+		*count = *count * 10 + (*p->s - '0');
+
+		if (*count > MAX_REPEAT) {
+			return 0;
+		}
+
+		p->s += 1;
+	}
 
 	return 1;
 }
 
-static int parse_pattern_whitespace(struct cli_pattern *cp, struct pattern_list *l, const char **s)
+/*
+ * Parses bounds between braces. There is always an upper bound. Errors are
+ * reported at the opening brace.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int parse_bounds(struct parser *p, int *min, int *max)
 {
-	const char *orig = *s;
+	const char *brace = p->s;
 
-	if (!parse_pattern_opt_whitespace(cp, l, s)) {
-		return 0;
+	// Skipping the opening brace.
+	p->s += 1;
+
+	int valid = parse_count(p, min);
+
+	*max = *min;
+
+	if (valid && *p->s == ',') {
+		p->s += 1;
+
+		valid = parse_count(p, max) && *max >= *min;
 	}
 
-	if (orig == *s) {
+	if (!valid || *p->s != '}') {
+		p->s = brace;
+		parser_error(p, CLI_PATTERN_ERROR_INVALID_PATTERN);
 		return 0;
 	}
 
+	p->s += 1;
+
 	return 1;
 }
 
-static int parse_pattern_byte_value(struct cli_pattern *cp, struct pattern_list *l, const char **s)
+/*
+ * Wraps a node in a repetition, destroying it on failure.
+ */
+static struct cli_expression *create_repeat_node(struct parser *p, struct cli_expression *n, int min, int max)
 {
-	char b;
+	struct cli_expression *r = create_binary_node(p, CLI_EXPRESSION_REPEAT, n, NULL);
 
-	if (!cli_parse_is_hex_digit((*s)[0]) || !cli_parse_is_hex_digit((*s)[1])) {
-		return 0;
+	if (r == NULL) {
+		return NULL;
 	}
 
-	if (sscanf(*s, "%hhx", &b) != 1) {
-		return 0;
+	r->min = min;
+	r->max = max;
+
+	return r;
+}
+
+static struct cli_expression *parse_alternate(struct parser *p);
+
+/*
+ * Parses a capture between angle brackets.
+ */
+static struct cli_expression *parse_capture(struct parser *p)
+{
+	struct cli_pattern *cp = p->cp;
+
+	// Skipping the opening angle bracket.
+	p->s += 1;
+
+	const char *name = p->s;
+
+	while (is_name_char(*p->s, p->s == name)) {
+		p->s += 1;
+	}
+
+	size_t name_size = p->s - name;
+	int duplicate = 0;
+
+	for (size_t i = 0; i < cp->capture_count; ++i) {
+		if (strlen(cp->captures[i].name) == name_size
+			&& strncmp(cp->captures[i].name, name, name_size) == 0) {
+			duplicate = 1;
+		}
+	}
+
+	if (name_size == 0
+		|| name_size > CLI_PATTERN_MAX_CAPTURE_NAME
+		|| duplicate
+		|| cp->capture_count == CLI_PATTERN_MAX_CAPTURES) {
+		p->s = name;
+		parser_error(p, CLI_PATTERN_ERROR_INVALID_PATTERN);
+		return NULL;
 	}
 
-	struct pattern_list_node *n = create_pattern_list_node();
+	enum cli_pattern_capture_type type = CLI_PATTERN_CAPTURE_BYTES;
+	const char *type_name = p->s;
+	int size = 0;
+
+	if (*p->s == ':') {
+		p->s += 1;
+
+		if (strncmp(p->s, "rel8", 4) == 0 && is_whitespace(p->s[4])) {
+			type = CLI_PATTERN_CAPTURE_REL8;
+			size = 1;
+			p->s += 4;
+		} else if (strncmp(p->s, "rel32", 5) == 0 && is_whitespace(p->s[5])) {
+			type = CLI_PATTERN_CAPTURE_REL32;
+			size = 4;
+			p->s += 5;
+		} else {
+			parser_error(p, CLI_PATTERN_ERROR_INVALID_PATTERN);
+			return NULL;
+		}
+	}
+
+	if (!is_whitespace(*p->s)) {
+		parser_error(p, CLI_PATTERN_ERROR_MISSING_WHITESPACE);
+		return NULL;
+	}
 
-	struct pattern_byte_value *p = create_pattern_byte_value();
-	p->value = b;
+	struct capture *c = &cp->captures[cp->capture_count];
+	int index = cp->capture_count++;
 
-	n->pattern = (struct pattern *) p;
+	memcpy(c->name, name, name_size);
+	c->name[name_size] = '\0';
+	c->type = type;
 
-	pattern_list_append_node(l, n);
+	struct cli_expression *n = parse_alternate(p);
 
-	*s += 2;
+	if (n == NULL) {
+		return NULL;
+	}
 
-	return 1;
+	if (*p->s != '>') {
+		parser_error(p, CLI_PATTERN_ERROR_INVALID_PATTERN);
+		cli_expression_destroy(n);
+		return NULL;
+	}
+
+	p->s += 1;
+
+	// Displacements have a size of their own.
+	if (size != 0 && fixed_size(n) != size) {
+		p->s = type_name;
+		parser_error(p, CLI_PATTERN_ERROR_INVALID_PATTERN);
+		cli_expression_destroy(n);
+		return NULL;
+	}
+
+	struct cli_expression *e = create_binary_node(p, CLI_EXPRESSION_CAPTURE, n, NULL);
+
+	if (e == NULL) {
+		return NULL;
+	}
+
+	e->capture = index;
+
+	return e;
 }
 
-static int parse_pattern_any_byte(struct cli_pattern *cp, struct pattern_list *l, const char **s)
+static struct cli_expression *parse_element(struct parser *p)
 {
-	if ((*s)[0] != '?' || (*s)[1] != '?') {
-		return 0;
+	struct cli_expression *n;
+	int min, max;
+
+	switch (*p->s) {
+	case '{':
+		if (!parse_bounds(p, &min, &max)) {
+			return NULL;
+		}
+
+		n = create_node(p, CLI_EXPRESSION_BYTES);
+
+		if (n == NULL) {
+			return NULL;
+		}
+
+		cli_expression_set_range(n, 0x00, 0xFF);
+
+		// A gap is no different from any byte being repeated.
+		return create_repeat_node(p, n, min, max);
+
+	case '(':
+		p->s += 1;
+
+		n = parse_alternate(p);
+
+		if (n == NULL) {
+			return NULL;
+		}
+
+		if (*p->s != ')') {
+			parser_error(p, CLI_PATTERN_ERROR_INVALID_PATTERN);
+			cli_expression_destroy(n);
+			return NULL;
+		}
+
+		p->s += 1;
+		break;
+
+	case '[':
+		n = parse_set(p);
+
+		if (n == NULL) {
+			return NULL;
+		}
+		break;
+
+	case '<':
+		n = parse_capture(p);
+
+		if (n == NULL) {
+			return NULL;
+		}
+		break;
+
+	default:
+		n = create_node(p, CLI_EXPRESSION_BYTES);
+
+		if (n == NULL) {
+			return NULL;
+		}
+
+		if (!parse_byte(p, n)) {
+			parser_error(p, CLI_PATTERN_ERROR_INVALID_PATTERN);
+			cli_expression_destroy(n);
+			return NULL;
+		}
+		break;
 	}
 
-	struct pattern_list_node *n = create_pattern_list_node();
+	if (*p->s != '{') {
+		return n;
+	}
 
-	struct pattern_any_byte *p = create_pattern_any_byte();
+	if (!parse_bounds(p, &min, &max)) {
+		cli_expression_destroy(n);
+		return NULL;
+	}
 
-	n->pattern = (struct pattern *) p;
+	return create_repeat_node(p, n, min, max);
+}
 
-	pattern_list_append_node(l, n);
+/*
+ * Parses elements separated by whitespace until the end of the pattern, of a
+ * group or of an alternative.
+ */
+static struct cli_expression *parse_sequence(struct parser *p)
+{
+	struct cli_expression *n = NULL;
 
-	*s += 2;
+	skip_whitespace(p);
 
-	return 1;
+	while (!ends_sequence(*p->s)) {
+		struct cli_expression *e = parse_element(p);
+
+		if (e == NULL) {
+			cli_expression_destroy(n);
+			return NULL;
+		}
+
+		n = n == NULL ? e : create_binary_node(p, CLI_EXPRESSION_CONCAT, n, e);
+
+		if (n == NULL) {
+			return NULL;
+		}
+
+		if (!ends_sequence(*p->s) && !is_whitespace(*p->s)) {
+			parser_error(p, starts_element(*p->s)
+				? CLI_PATTERN_ERROR_MISSING_WHITESPACE
+				: CLI_PATTERN_ERROR_INVALID_PATTERN);
+			cli_expression_destroy(n);
+			return NULL;
+		}
+
+		skip_whitespace(p);
+	}
+
+	if (n == NULL) {
+		parser_error(p, CLI_PATTERN_ERROR_INVALID_PATTERN);
+	}
+
+	return n;
 }
 
-static int parse_pattern(struct cli_pattern *cp, struct pattern_list *l, const char *s)
+static struct cli_expression *parse_alternate(struct parser *p)
 {
-	const char *orig = s;
-	cp->error_compile_offset = 0;
+	struct cli_expression *n = parse_sequence(p);
 
-	if (!parse_pattern_opt_whitespace(cp, l, &s)) {
-		return 0;
+	while (n != NULL && *p->s == '|') {
+		p->s += 1;
+
+		struct cli_expression *e = parse_sequence(p);
+
+		if (e == NULL) {
+			cli_expression_destroy(n);
+			return NULL;
+		}
+
+		n = create_binary_node(p, CLI_EXPRESSION_ALTERNATE, n, e);
 	}
 
-	if (*s == '\0') {
-		cli_pattern_set_error(cp, CLI_PATTERN_ERROR_EMPTY_PATTERN);
-		return 0;
+	return n;
+}
+
+static struct cli_expression *parse_pattern(struct cli_pattern *cp, const char *s)
+{
+	struct parser p = { cp, s, s };
+
+	skip_whitespace(&p);
+
+	if (*p.s == '\0') {
+		p.s = s;
+		parser_error(&p, CLI_PATTERN_ERROR_EMPTY_PATTERN);
+		return NULL;
 	}
 
-	while (*s != '\0') {
-		if (parse_pattern_byte_value(cp, l, &s)) {
-			if (*s != '\0' && !parse_pattern_whitespace(cp, l, &s)) {
-				cli_pattern_set_error(cp, CLI_PATTERN_ERROR_MISSING_WHITESPACE);
-				cp->error_compile_offset = s - orig;
-				return 0;
-			}
-			continue;
+	struct cli_expression *n = parse_alternate(&p);
+
+	if (n != NULL && *p.s != '\0') {
+		// Only an unmatched closing parenthesis or angle bracket stops
+		// the parser early.
+		parser_error(&p, CLI_PATTERN_ERROR_INVALID_PATTERN);
+		cli_expression_destroy(n);
+		return NULL;
+	}
+
+	return n;
+}
+
+/*
+ * Appends the positions of a node.
+ *
+ * Returns 1 on success, 0 if the node cannot be broken down to positions.
+ */
+static int find_positions(struct cli_pattern *cp, struct cli_expression *n)
+{
+	size_t count = cp->position_count;
+
+	switch (n->type) {
+	case CLI_EXPRESSION_EMPTY:
+		return 1;
+
+	case CLI_EXPRESSION_BYTES:
+		if (count == CLI_PATTERN_MAX_POSITIONS) {
+			return 0;
+		}
+
+		memcpy(cp->positions[count], n->bytes, sizeof(n->bytes));
+		cp->position_count += 1;
+		return 1;
+
+	case CLI_EXPRESSION_CONCAT:
+		return find_positions(cp, n->left) && find_positions(cp, n->right);
+
+	case CLI_EXPRESSION_ALTERNATE: {
+		// Alternatives of a single byte each are the same as a set of
+		// bytes.
+		if (!find_positions(cp, n->left) || cp->position_count != count + 1) {
+			return 0;
+		}
+
+		uint64_t left[4];
+		memcpy(left, cp->positions[count], sizeof(left));
+		cp->position_count = count;
+
+		if (!find_positions(cp, n->right) || cp->position_count != count + 1) {
+			return 0;
 		}
 
-		if (parse_pattern_any_byte(cp, l, &s)) {
-			if (*s != '\0' && !parse_pattern_whitespace(cp, l, &s)) {
-				cli_pattern_set_error(cp, CLI_PATTERN_ERROR_MISSING_WHITESPACE);
-				cp->error_compile_offset = s - orig;
+		for (int i = 0; i < 4; ++i) {
+			cp->positions[count][i] |= left[i];
+		}
+
+		return 1;
+	}
+
+	case CLI_EXPRESSION_REPEAT:
+		if (n->min != n->max) {
+			return 0;
+		}
+
+		for (int i = 0; i < n->min; ++i) {
+			if (!find_positions(cp, n->left)) {
 				return 0;
 			}
-			continue;
 		}
 
-		cli_pattern_set_error(cp, CLI_PATTERN_ERROR_INVALID_PATTERN);
-		cp->error_compile_offset = s - orig;
+		return 1;
+
+	case CLI_EXPRESSION_CAPTURE:
+		if (!find_positions(cp, n->left)) {
+			return 0;
+		}
+
+		cp->captures[n->capture].start = count;
+		cp->captures[n->capture].end = cp->position_count;
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Compiles the syntax tree to a DFA.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int compile_dfa(struct cli_pattern *cp, struct cli_expression *n, int backward, int unanchored, struct dfa *d)
+{
+	switch (cli_expression_compile(n, backward, unanchored, d)) {
+	case 0:
+		return 1;
+
+	case CLI_EXPRESSION_ERROR_TOO_COMPLEX:
+		cli_pattern_set_error(cp, CLI_PATTERN_ERROR_TOO_COMPLEX);
+		return 0;
+
+	default:
+		cli_pattern_set_error(cp, CLI_PATTERN_ERROR_OUT_OF_MEMORY);
 		return 0;
 	}
+}
 
-	return 1;
+static void clear(struct cli_pattern *cp)
+{
+	if (cp->compiled) {
+		dfa_deinit(&cp->forward);
+		dfa_deinit(&cp->backward);
+		dfa_deinit(&cp->anchored);
+	}
+
+	cli_expression_destroy(cp->tree);
+
+	cp->compiled = 0;
+	cp->prefix_size = 0;
+	cp->position_count = 0;
+	cp->capture_count = 0;
+	cp->tree = NULL;
 }
 
 cli_pattern cli_pattern_create(void)
@@ -242,40 +747,89 @@ cli_pattern cli_pattern_create(void)
 	}
 
 	cp->error = 0;
-	cp->patterns.first = NULL;
-	cp->patterns.last = NULL;
-	cp->last_pattern = NULL;
+	cp->error_compile_offset = 0;
+	cp->compiled = 0;
+	cp->prefix_size = 0;
+	cp->position_count = 0;
+	cp->capture_count = 0;
+	cp->tree = NULL;
+	cp->state = 0;
 	cp->finished = 0;
+	cp->matched = 0;
 
 	return cp;
 }
 
 void cli_pattern_destroy(cli_pattern cp)
 {
-	clear_pattern_list(&cp->patterns);
+	clear(cp);
 	free(cp);
 }
 
 int cli_pattern_compile(cli_pattern cp, const char *s)
 {
-	clear_pattern_list(&cp->patterns);
+	clear(cp);
 
-	if (!parse_pattern(cp, &cp->patterns, s)) {
-		clear_pattern_list(&cp->patterns);
+	cp->error = 0;
+	cp->error_compile_offset = 0;
+
+	struct cli_expression *n = parse_pattern(cp, s);
+
+	if (n == NULL) {
+		return 0;
 	}
 
+	if (cli_expression_nullable(n)) {
+		cli_pattern_set_error(cp, CLI_PATTERN_ERROR_EMPTY_MATCH);
+		cli_expression_destroy(n);
+		return 0;
+	}
+
+	// Matches are looked for anywhere going forwards but going backwards
+	// they are known to end where we start.
+	if (!compile_dfa(cp, n, 0, 1, &cp->forward)) {
+		cli_expression_destroy(n);
+		return 0;
+	}
+
+	if (!compile_dfa(cp, n, 1, 0, &cp->backward)) {
+		dfa_deinit(&cp->forward);
+		cli_expression_destroy(n);
+		return 0;
+	}
+
+	if (!compile_dfa(cp, n, 0, 0, &cp->anchored)) {
+		dfa_deinit(&cp->forward);
+		dfa_deinit(&cp->backward);
+		cli_expression_destroy(n);
+		return 0;
+	}
+
+	cp->prefix_size = cli_expression_prefix(n, cp->prefix, MAX_PREFIX);
+
+	if (!find_positions(cp, n)) {
+		cp->position_count = 0;
+	}
+
+	cp->tree = n;
+
+	cp->compiled = 1;
+
+	cli_pattern_new(cp);
+
 	return 1;
 }
 
 int cli_pattern_ready(cli_pattern cp)
 {
-	return cp->patterns.first != NULL;
+	return cp->compiled;
 }
 
 void cli_pattern_new(cli_pattern cp)
 {
-	cp->last_pattern = NULL;
+	cp->state = cp->compiled ? cp->anchored.start : 0;
 	cp->finished = 0;
+	cp->matched = 0;
 }
 
 int cli_pattern_input(cli_pattern cp, const char* data, size_t size)
@@ -290,43 +844,23 @@ int cli_pattern_input(cli_pattern cp, const char* data, size_t size)
 		return 0;
 	}
 
-	struct pattern_list_node *n;
-
-	if (cp->last_pattern) {
-		n = cp->last_pattern->next;
-	} else {
-		n = cp->patterns.first;
-	}
-
 	size_t read = 0;
 
 	for (size_t i = 0; i < size; ++i) {
-		switch (n->pattern->type)  {
-		case PATTERN_TYPE_BYTE_VALUE: {
-			struct pattern_byte_value *p = (struct pattern_byte_value *) n->pattern;
-
-			if (p->value != data[i]) {
-				cp->finished = 1;
-				return read;
-			}
-			break;
-		}
+		cp->state = dfa_step(&cp->anchored, cp->state, data[i]);
 
-		case PATTERN_TYPE_ANY_BYTE:
-			// Always passes.
-			break;
+		if (dfa_dead(&cp->anchored, cp->state)) {
+			cp->finished = 1;
+			return read;
 		}
 
 		++read;
 
-		cp->last_pattern = n;
-
-		if (cp->last_pattern == cp->patterns.last) {
+		if (dfa_accepting(&cp->anchored, cp->state)) {
 			cp->finished = 1;
+			cp->matched = 1;
 			break;
 		}
-
-		n = n->next;
 	}
 
 	return read;
@@ -339,7 +873,87 @@ int cli_pattern_finished(cli_pattern cp)
 
 int cli_pattern_matched(cli_pattern cp)
 {
-	return cp->finished && cp->patterns.last == cp->last_pattern;
+	return cp->matched;
+}
+
+struct dfa *cli_pattern_forward(cli_pattern cp)
+{
+	if (!cp->compiled) {
+		cli_pattern_set_error(cp, CLI_PATTERN_ERROR_COMPILE_PATTERN);
+		return NULL;
+	}
+
+	return &cp->forward;
+}
+
+struct dfa *cli_pattern_backward(cli_pattern cp)
+{
+	if (!cp->compiled) {
+		cli_pattern_set_error(cp, CLI_PATTERN_ERROR_COMPILE_PATTERN);
+		return NULL;
+	}
+
+	return &cp->backward;
+}
+
+const char *cli_pattern_prefix(cli_pattern cp, size_t *size)
+{
+	*size = cp->prefix_size;
+
+	return cp->prefix;
+}
+
+size_t cli_pattern_positions(cli_pattern cp)
+{
+	return cp->position_count;
+}
+
+int cli_pattern_position_has_byte(cli_pattern cp, size_t position, unsigned char byte)
+{
+	return (cp->positions[position][byte / 64] >> (byte % 64)) & 1;
+}
+
+size_t cli_pattern_capture_count(cli_pattern cp)
+{
+	return cp->capture_count;
+}
+
+const char *cli_pattern_capture_name(cli_pattern cp, size_t capture)
+{
+	return cp->captures[capture].name;
+}
+
+enum cli_pattern_capture_type cli_pattern_capture_type(cli_pattern cp, size_t capture)
+{
+	return cp->captures[capture].type;
+}
+
+int cli_pattern_captures(cli_pattern cp, const char *bytes, size_t size, size_t *bounds)
+{
+	if (!cp->compiled) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < cp->capture_count * 2; ++i) {
+		bounds[i] = SIZE_MAX;
+	}
+
+	if (cli_expression_captures(cp->tree, bytes, size, bounds)) {
+		return 1;
+	}
+
+	// Bytes with mismatches can still be dealt with when captures are
+	// always in the same place.
+	if (cp->position_count != size) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < cp->capture_count; ++i) {
+		bounds[i * 2] = cp->captures[i].start;
+		bounds[i * 2 + 1] = cp->captures[i].end;
+	}
+
+	return 1;
 }
 
 int cli_pattern_error(cli_pattern cp)
@@ -3,11 +3,57 @@
 
 #include <stdlib.h>
 
+#include "dfa/dfa.h"
+
 #define CLI_PATTERN_ERROR_INVALID_PATTERN 1
 #define CLI_PATTERN_ERROR_OUT_OF_MEMORY 2
 #define CLI_PATTERN_ERROR_EMPTY_PATTERN 3
 #define CLI_PATTERN_ERROR_MISSING_WHITESPACE 4
 #define CLI_PATTERN_ERROR_COMPILE_PATTERN 5
+#define CLI_PATTERN_ERROR_EMPTY_MATCH 6
+#define CLI_PATTERN_ERROR_TOO_COMPLEX 7
+
+// Largest number of positions that a pattern can be broken down to.
+#define CLI_PATTERN_MAX_POSITIONS 64
+
+// Largest number of captures in a pattern and longest name of a capture.
+#define CLI_PATTERN_MAX_CAPTURES 16
+#define CLI_PATTERN_MAX_CAPTURE_NAME 32
+
+/*
+ * How the bytes of a capture are meant to be read.
+ */
+enum cli_pattern_capture_type {
+	// As they are.
+	CLI_PATTERN_CAPTURE_BYTES,
+
+	// As a signed 8-bit or 32-bit little endian displacement from the
+	// address right after the capture.
+	CLI_PATTERN_CAPTURE_REL8,
+	CLI_PATTERN_CAPTURE_REL32,
+};
+
+/*
+ * Byte patterns.
+ *
+ * A pattern is made of the following elements, separated by whitespace:
+ *
+ *  HH         The byte with the hexadecimal value HH
+ *  H? ?H      Any byte whose high or low nibble is H
+ *  ??         Any byte
+ *  [...]      Any byte of the set, which is made of the elements above and
+ *             of ranges such as 80-8F, separated by whitespace
+ *  (A|B)      Either the elements of A or the elements of B
+ *  {N} {N,M}  A gap of exactly N or between N and M bytes
+ *  <NAME ...> A capture of what the elements inside match, which can be
+ *             read as a displacement with <NAME:rel8 ...> or <NAME:rel32 ...>
+ *
+ * An element directly followed by {N} or {N,M} is repeated exactly N times or
+ * between N and M times.
+ *
+ * A pattern is compiled to DFAs so that memory is searched in a single pass
+ * no matter how many alternatives and gaps it has.
+ */
 
 typedef struct cli_pattern *cli_pattern;
 
@@ -27,6 +73,60 @@ int cli_pattern_finished(cli_pattern cp);
 
 int cli_pattern_matched(cli_pattern cp);
 
+/*
+ * DFA that reaches an accepting state right after the last byte of a match,
+ * wherever the match starts.
+ */
+struct dfa *cli_pattern_forward(cli_pattern cp);
+
+/*
+ * DFA that, fed the bytes of memory backwards from the last byte of a match,
+ * reaches an accepting state right after the first byte of a match.
+ */
+struct dfa *cli_pattern_backward(cli_pattern cp);
+
+/*
+ * Bytes that every match starts with. The size is 0 if there are none.
+ */
+const char *cli_pattern_prefix(cli_pattern cp, size_t *size);
+
+/*
+ * Number of positions of a pattern whose matches always have the same number
+ * of bytes and where each byte can only be one of a set of bytes, which is
+ * what approximate matching works with. Alternatives longer than a single byte
+ * and gaps whose size varies cannot be broken down like that, and neither can
+ * patterns with more than CLI_PATTERN_MAX_POSITIONS positions.
+ *
+ * Returns 0 if the pattern cannot be broken down to positions.
+ */
+size_t cli_pattern_positions(cli_pattern cp);
+
+/*
+ * Tells whether the byte is expected at a position.
+ */
+int cli_pattern_position_has_byte(cli_pattern cp, size_t position, unsigned char byte);
+
+size_t cli_pattern_capture_count(cli_pattern cp);
+
+const char *cli_pattern_capture_name(cli_pattern cp, size_t capture);
+
+enum cli_pattern_capture_type cli_pattern_capture_type(cli_pattern cp, size_t capture);
+
+/*
+ * Finds where captures are in the bytes of a match. The bounds of capture i go
+ * to bounds[i * 2] and bounds[i * 2 + 1], the end not included, or are both
+ * SIZE_MAX for captures that are not part of the match.
+ *
+ * Matches that have mismatches can only be dealt with when the pattern can be
+ * broken down to positions.
+ *
+ * This does not change the pattern so it can be called from multiple threads
+ * at once.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int cli_pattern_captures(cli_pattern cp, const char *bytes, size_t size, size_t *bounds);
+
 int cli_pattern_error(cli_pattern cp);
 
 int cli_pattern_error_compile_offset(cli_pattern cp);
@@ -29,6 +29,10 @@ static const char *proctal_error_messages[] = {
 	[PROCTAL_ERROR_PROCESS_EXITED] = "Process has exited.",
 	[PROCTAL_ERROR_PROCESS_STOPPED] = "Process has stopped.",
 	[PROCTAL_ERROR_PROCESS_UNTAMEABLE] = "Process is in a state that cannot be dealt with.",
+	[PROCTAL_ERROR_PROCESS_TRAPPED] = "Process got trapped.",
+	[PROCTAL_ERROR_UNSUPPORTED_WATCH_SIZE] =
+		"Watching is only supported for 1, 2, 4 or 8 bytes at an address aligned to it"
+		" and for 1 byte when watching for instruction execution.",
 };
 
 static const char *cli_pattern_error_messages[] = {
@@ -38,6 +42,17 @@ static const char *cli_pattern_error_messages[] = {
 	[CLI_PATTERN_ERROR_EMPTY_PATTERN] = "Pattern cannot match anything because it's empty.",
 	[CLI_PATTERN_ERROR_MISSING_WHITESPACE] = "Missing whitespace at offset %d.",
 	[CLI_PATTERN_ERROR_COMPILE_PATTERN] = "You must compile a pattern beforehand.",
+	[CLI_PATTERN_ERROR_EMPTY_MATCH] = "Pattern cannot match bytes that are empty.",
+	[CLI_PATTERN_ERROR_TOO_COMPLEX] = "Pattern is too complex.",
+};
+
+static const char *cli_regex_error_messages[] = {
+	[0] = "Unknown error with regular expression.",
+	[CLI_REGEX_ERROR_INVALID_REGEX] = "Invalid regular expression found at offset %d.",
+	[CLI_REGEX_ERROR_OUT_OF_MEMORY] = "Ran out of memory.",
+	[CLI_REGEX_ERROR_EMPTY_MATCH] = "Regular expression cannot match text that is empty.",
+	[CLI_REGEX_ERROR_TOO_COMPLEX] = "Regular expression is too complex.",
+	[CLI_REGEX_ERROR_COMPILE_REGEX] = "You must compile a regular expression beforehand.",
 };
 
 void cli_print_proctal_error(proctal p)
@@ -80,6 +95,30 @@ void cli_print_pattern_error(cli_pattern cp)
 	}
 }
 
+void cli_print_regex_error(cli_regex cr)
+{
+	int error = cli_regex_error(cr);
+
+	if (error == 0) {
+		return;
+	}
+
+	if (!((unsigned) error < ARRAY_SIZE(cli_regex_error_messages))) {
+		error = 0;
+	}
+
+	switch (error) {
+	case CLI_REGEX_ERROR_INVALID_REGEX:
+		fprintf(stderr, cli_regex_error_messages[error], cli_regex_error_compile_offset(cr));
+		fprintf(stderr, "\n");
+		break;
+
+	default:
+		fprintf(stderr, "%s\n", cli_regex_error_messages[error]);
+		break;
+	}
+}
+
 void cli_print_address(void *address)
 {
 	uintptr_t a = (uintptr_t) address;
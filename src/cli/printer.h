@@ -3,11 +3,14 @@
 
 #include "lib/include/proctal.h"
 #include "cli/pattern.h"
+#include "cli/regex.h"
 
 void cli_print_proctal_error(proctal p);
 
 void cli_print_pattern_error(cli_pattern cp);
 
+void cli_print_regex_error(cli_regex cr);
+
 void cli_print_address(void *address);
 
 void cli_print_byte(unsigned char byte);
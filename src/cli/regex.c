@@ -0,0 +1,662 @@
+#include <string.h>
+#include <stdint.h>
+
+#include "cli/regex.h"
+#include "cli/parser.h"
+#include "cli/expression.h"
+
+// Largest number of times a repetition can be given.
+#define MAX_REPEAT 1000
+
+// Largest number of bytes of the prefix that is kept.
+#define MAX_PREFIX 64
+
+struct parser {
+	struct cli_regex *cr;
+
+	const char *orig;
+	const char *s;
+};
+
+struct cli_regex {
+	int error;
+
+	size_t error_compile_offset;
+
+	int compiled;
+
+	struct dfa forward;
+	struct dfa backward;
+
+	char prefix[MAX_PREFIX];
+	size_t prefix_size;
+};
+
+static void cli_regex_set_error(cli_regex cr, int error)
+{
+	cr->error = error;
+}
+
+static void parser_error(struct parser *p, int error)
+{
+	cli_regex_set_error(p->cr, error);
+	p->cr->error_compile_offset = p->s - p->orig;
+}
+
+static void set_byte(uint64_t *bytes, unsigned char byte)
+{
+	bytes[byte / 64] |= (uint64_t) 1 << (byte % 64);
+}
+
+static void set_range(uint64_t *bytes, unsigned char first, unsigned char last)
+{
+	for (int byte = first; byte <= last; ++byte) {
+		set_byte(bytes, byte);
+	}
+}
+
+static void invert(uint64_t *bytes)
+{
+	for (int i = 0; i < 4; ++i) {
+		bytes[i] = ~bytes[i];
+	}
+}
+
+static struct cli_expression *create_node(struct parser *p, enum cli_expression_type type)
+{
+	struct cli_expression *n = cli_expression_create(type);
+
+	if (n == NULL) {
+		parser_error(p, CLI_REGEX_ERROR_OUT_OF_MEMORY);
+	}
+
+	return n;
+}
+
+static struct cli_expression *create_binary_node(struct parser *p, enum cli_expression_type type, struct cli_expression *left, struct cli_expression *right)
+{
+	struct cli_expression *n = cli_expression_create_binary(type, left, right);
+
+	if (n == NULL) {
+		parser_error(p, CLI_REGEX_ERROR_OUT_OF_MEMORY);
+	}
+
+	return n;
+}
+
+static struct cli_expression *parse_alternate(struct parser *p);
+
+/*
+ * Parses what comes after a backslash. Escapes either stand for a single byte
+ * or for a set of bytes.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int parse_escape(struct parser *p, uint64_t *bytes, int *single, unsigned char *byte)
+{
+	char c = *p->s;
+
+	*single = 1;
+
+	switch (c) {
+	case 'x':
+		if (!cli_parse_is_hex_digit(p->s[1]) || !cli_parse_is_hex_digit(p->s[2])) {
+			parser_error(p, CLI_REGEX_ERROR_INVALID_REGEX);
+			return 0;
+		}
+
+		char hex[3] = { p->s[1], p->s[2], '\0' };
+		*byte = strtoul(hex, NULL, 16);
+		p->s += 3;
+		break;
+
+	case 'n':
+		*byte = '\n';
+		p->s += 1;
+		break;
+
+	case 'r':
+		*byte = '\r';
+		p->s += 1;
+		break;
+
+	case 't':
+		*byte = '\t';
+		p->s += 1;
+		break;
+
+	case '0':
+		*byte = '\0';
+		p->s += 1;
+		break;
+
+	case 'd':
+	case 'D':
+	case 'w':
+	case 'W':
+	case 's':
+	case 'S':
+		*single = 0;
+		memset(bytes, 0, 4 * sizeof(*bytes));
+
+		if (c == 'd' || c == 'D') {
+			set_range(bytes, '0', '9');
+		} else if (c == 'w' || c == 'W') {
+			set_range(bytes, '0', '9');
+			set_range(bytes, 'a', 'z');
+			set_range(bytes, 'A', 'Z');
+			set_byte(bytes, '_');
+		} else {
+			set_range(bytes, '\t', '\r');
+			set_byte(bytes, ' ');
+		}
+
+		if (c == 'D' || c == 'W' || c == 'S') {
+			invert(bytes);
+		}
+
+		p->s += 1;
+		return 1;
+
+	default:
+		if (c == '\0' || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+			// Letters and digits are reserved for escapes
+			// that have a meaning.
+			parser_error(p, CLI_REGEX_ERROR_INVALID_REGEX);
+			return 0;
+		}
+
+		*byte = c;
+		p->s += 1;
+		break;
+	}
+
+	memset(bytes, 0, 4 * sizeof(*bytes));
+	set_byte(bytes, *byte);
+
+	return 1;
+}
+
+/*
+ * Parses a set of bytes between brackets.
+ */
+static struct cli_expression *parse_set(struct parser *p)
+{
+	struct cli_expression *n = create_node(p, CLI_EXPRESSION_BYTES);
+
+	if (n == NULL) {
+		return NULL;
+	}
+
+	// Skipping the opening bracket.
+	p->s += 1;
+
+	int negated = 0;
+
+	if (*p->s == '^') {
+		negated = 1;
+		p->s += 1;
+	}
+
+	int first = 1;
+
+	while (*p->s != ']' || first) {
+		uint64_t bytes[4];
+		int single = 1;
+		unsigned char low;
+
+		first = 0;
+
+		if (*p->s == '\0') {
+			parser_error(p, CLI_REGEX_ERROR_INVALID_REGEX);
+			cli_expression_destroy(n);
+			return NULL;
+		}
+
+		if (*p->s == '\\') {
+			p->s += 1;
+
+			if (!parse_escape(p, bytes, &single, &low)) {
+				cli_expression_destroy(n);
+				return NULL;
+			}
+		} else {
+			low = *p->s;
+			p->s += 1;
+		}
+
+		if (!single) {
+			for (int i = 0; i < 4; ++i) {
+				n->bytes[i] |= bytes[i];
+			}
+
+			continue;
+		}
+
+		if (p->s[0] != '-' || p->s[1] == ']') {
+			set_byte(n->bytes, low);
+			continue;
+		}
+
+		// Skipping the dash.
+		p->s += 1;
+
+		unsigned char high;
+
+		if (*p->s == '\\') {
+			p->s += 1;
+
+			if (!parse_escape(p, bytes, &single, &high)) {
+				cli_expression_destroy(n);
+				return NULL;
+			}
+		} else if (*p->s != '\0') {
+			high = *p->s;
+			p->s += 1;
+		} else {
+			single = 0;
+		}
+
+		if (!single || high < low) {
+			parser_error(p, CLI_REGEX_ERROR_INVALID_REGEX);
+			cli_expression_destroy(n);
+			return NULL;
+		}
+
+		set_range(n->bytes, low, high);
+	}
+
+	// Skipping the closing bracket.
+	p->s += 1;
+
+	if (negated) {
+		invert(n->bytes);
+	}
+
+	return n;
+}
+
+static struct cli_expression *parse_atom(struct parser *p)
+{
+	struct cli_expression *n;
+
+	switch (*p->s) {
+	case '(':
+		p->s += 1;
+
+		n = parse_alternate(p);
+
+		if (n == NULL) {
+			return NULL;
+		}
+
+		if (*p->s != ')') {
+			parser_error(p, CLI_REGEX_ERROR_INVALID_REGEX);
+			cli_expression_destroy(n);
+			return NULL;
+		}
+
+		p->s += 1;
+
+		return n;
+
+	case '[':
+		return parse_set(p);
+
+	case '.':
+		n = create_node(p, CLI_EXPRESSION_BYTES);
+
+		if (n == NULL) {
+			return NULL;
+		}
+
+		invert(n->bytes);
+		p->s += 1;
+
+		return n;
+
+	case '\\': {
+		n = create_node(p, CLI_EXPRESSION_BYTES);
+
+		if (n == NULL) {
+			return NULL;
+		}
+
+		int single;
+		unsigned char byte;
+
+		p->s += 1;
+
+		if (!parse_escape(p, n->bytes, &single, &byte)) {
+			cli_expression_destroy(n);
+			return NULL;
+		}
+
+		return n;
+	}
+
+	case '*':
+	case '+':
+	case '?':
+	case '{':
+		// Nothing to repeat.
+	case '^':
+	case '$':
+		// Anchors have no meaning in memory.
+		parser_error(p, CLI_REGEX_ERROR_INVALID_REGEX);
+		return NULL;
+
+	default:
+		n = create_node(p, CLI_EXPRESSION_BYTES);
+
+		if (n == NULL) {
+			return NULL;
+		}
+
+		set_byte(n->bytes, *p->s);
+		p->s += 1;
+
+		return n;
+	}
+}
+
+static int parse_count(struct parser *p, int *count)
+{
+	if (*p->s < '0' || *p->s > '9') {
+		return 0;
+	}
+
+	*count = 0;
+
+	while (*p->s >= '0' && *p->s <= '9') {
+		*count = *count * 10 + (*p->s - '0');
+
+		if (*count > MAX_REPEAT) {
+			return 0;
+		}
+
+		p->s += 1;
+	}
+
+	return 1;
+}
+
+/*
+ * Parses the bounds of a repetition between braces.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int parse_bounds(struct parser *p, int *min, int *max)
+{
+	// Skipping the opening brace.
+	p->s += 1;
+
+	if (!parse_count(p, min)) {
+		return 0;
+	}
+
+	if (*p->s == '}') {
+		*max = *min;
+	} else if (*p->s == ',') {
+		p->s += 1;
+
+		if (*p->s == '}') {
+			*max = -1;
+		} else if (!parse_count(p, max) || *max < *min) {
+			return 0;
+		}
+	}
+
+	if (*p->s != '}') {
+		return 0;
+	}
+
+	p->s += 1;
+
+	return 1;
+}
+
+static struct cli_expression *parse_repeat(struct parser *p)
+{
+	struct cli_expression *n = parse_atom(p);
+
+	while (n != NULL) {
+		int min, max;
+
+		switch (*p->s) {
+		case '*':
+			min = 0;
+			max = -1;
+			p->s += 1;
+			break;
+
+		case '+':
+			min = 1;
+			max = -1;
+			p->s += 1;
+			break;
+
+		case '?':
+			min = 0;
+			max = 1;
+			p->s += 1;
+			break;
+
+		case '{':
+			if (!parse_bounds(p, &min, &max)) {
+				parser_error(p, CLI_REGEX_ERROR_INVALID_REGEX);
+				cli_expression_destroy(n);
+				return NULL;
+			}
+			break;
+
+		default:
+			return n;
+		}
+
+		struct cli_expression *r = create_binary_node(p, CLI_EXPRESSION_REPEAT, n, NULL);
+
+		if (r == NULL) {
+			return NULL;
+		}
+
+		r->min = min;
+		r->max = max;
+		n = r;
+	}
+
+	return NULL;
+}
+
+static struct cli_expression *parse_concat(struct parser *p)
+{
+	struct cli_expression *n = NULL;
+
+	while (*p->s != '\0' && *p->s != '|' && *p->s != ')') {
+		struct cli_expression *r = parse_repeat(p);
+
+		if (r == NULL) {
+			cli_expression_destroy(n);
+			return NULL;
+		}
+
+		n = n == NULL ? r : create_binary_node(p, CLI_EXPRESSION_CONCAT, n, r);
+
+		if (n == NULL) {
+			return NULL;
+		}
+	}
+
+	return n == NULL ? create_node(p, CLI_EXPRESSION_EMPTY) : n;
+}
+
+static struct cli_expression *parse_alternate(struct parser *p)
+{
+	struct cli_expression *n = parse_concat(p);
+
+	while (n != NULL && *p->s == '|') {
+		p->s += 1;
+
+		struct cli_expression *r = parse_concat(p);
+
+		if (r == NULL) {
+			cli_expression_destroy(n);
+			return NULL;
+		}
+
+		n = create_binary_node(p, CLI_EXPRESSION_ALTERNATE, n, r);
+	}
+
+	return n;
+}
+
+static struct cli_expression *parse_regex(struct cli_regex *cr, const char *s)
+{
+	struct parser p = { cr, s, s };
+
+	struct cli_expression *n = parse_alternate(&p);
+
+	if (n != NULL && *p.s != '\0') {
+		// Only an unmatched closing parenthesis stops the parser early.
+		parser_error(&p, CLI_REGEX_ERROR_INVALID_REGEX);
+		cli_expression_destroy(n);
+		return NULL;
+	}
+
+	return n;
+}
+
+/*
+ * Compiles the syntax tree to a DFA.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int compile_dfa(struct cli_regex *cr, struct cli_expression *n, int backward, struct dfa *d)
+{
+	// Matches are looked for anywhere going forwards but going backwards
+	// they are known to end where we start.
+	switch (cli_expression_compile(n, backward, !backward, d)) {
+	case 0:
+		return 1;
+
+	case CLI_EXPRESSION_ERROR_TOO_COMPLEX:
+		cli_regex_set_error(cr, CLI_REGEX_ERROR_TOO_COMPLEX);
+		return 0;
+
+	default:
+		cli_regex_set_error(cr, CLI_REGEX_ERROR_OUT_OF_MEMORY);
+		return 0;
+	}
+}
+
+static void clear(struct cli_regex *cr)
+{
+	if (cr->compiled) {
+		dfa_deinit(&cr->forward);
+		dfa_deinit(&cr->backward);
+	}
+
+	cr->compiled = 0;
+	cr->prefix_size = 0;
+}
+
+cli_regex cli_regex_create(void)
+{
+	struct cli_regex *cr = malloc(sizeof(*cr));
+
+	if (cr == NULL) {
+		return NULL;
+	}
+
+	cr->error = 0;
+	cr->error_compile_offset = 0;
+	cr->compiled = 0;
+	cr->prefix_size = 0;
+
+	return cr;
+}
+
+void cli_regex_destroy(cli_regex cr)
+{
+	clear(cr);
+	free(cr);
+}
+
+int cli_regex_compile(cli_regex cr, const char *s)
+{
+	clear(cr);
+
+	cr->error = 0;
+	cr->error_compile_offset = 0;
+
+	struct cli_expression *n = parse_regex(cr, s);
+
+	if (n == NULL) {
+		return 0;
+	}
+
+	if (cli_expression_nullable(n)) {
+		cli_regex_set_error(cr, CLI_REGEX_ERROR_EMPTY_MATCH);
+		cli_expression_destroy(n);
+		return 0;
+	}
+
+	if (!compile_dfa(cr, n, 0, &cr->forward)) {
+		cli_expression_destroy(n);
+		return 0;
+	}
+
+	if (!compile_dfa(cr, n, 1, &cr->backward)) {
+		dfa_deinit(&cr->forward);
+		cli_expression_destroy(n);
+		return 0;
+	}
+
+	cr->prefix_size = cli_expression_prefix(n, cr->prefix, MAX_PREFIX);
+	cli_expression_destroy(n);
+
+	cr->compiled = 1;
+
+	return 1;
+}
+
+struct dfa *cli_regex_forward(cli_regex cr)
+{
+	if (!cr->compiled) {
+		cli_regex_set_error(cr, CLI_REGEX_ERROR_COMPILE_REGEX);
+		return NULL;
+	}
+
+	return &cr->forward;
+}
+
+struct dfa *cli_regex_backward(cli_regex cr)
+{
+	if (!cr->compiled) {
+		cli_regex_set_error(cr, CLI_REGEX_ERROR_COMPILE_REGEX);
+		return NULL;
+	}
+
+	return &cr->backward;
+}
+
+const char *cli_regex_prefix(cli_regex cr, size_t *size)
+{
+	*size = cr->prefix_size;
+
+	return cr->prefix;
+}
+
+int cli_regex_error(cli_regex cr)
+{
+	if (cr == NULL) {
+		return CLI_REGEX_ERROR_OUT_OF_MEMORY;
+	}
+
+	return cr->error;
+}
+
+int cli_regex_error_compile_offset(cli_regex cr)
+{
+	return cr->error_compile_offset;
+}
@@ -0,0 +1,67 @@
+#ifndef CLI_REGEX_H
+#define CLI_REGEX_H
+
+#include <stdlib.h>
+
+#include "dfa/dfa.h"
+
+#define CLI_REGEX_ERROR_INVALID_REGEX 1
+#define CLI_REGEX_ERROR_OUT_OF_MEMORY 2
+#define CLI_REGEX_ERROR_EMPTY_MATCH 3
+#define CLI_REGEX_ERROR_TOO_COMPLEX 4
+#define CLI_REGEX_ERROR_COMPILE_REGEX 5
+
+/*
+ * Regular expressions over bytes.
+ *
+ * The following syntax is understood:
+ *
+ *  .          Any byte
+ *  [...]      Any byte of the set, which can have ranges such as a-z
+ *  [^...]     Any byte not in the set
+ *  \d \w \s   Digits, word characters and whitespace, and their uppercase
+ *             counterparts for anything else
+ *  \xHH       The byte with the hexadecimal value HH
+ *  \n \r \t   Newline, carriage return and tab
+ *  \0         The zero byte
+ *  \C         The character C itself, for any other punctuation character
+ *  (...)      Grouping
+ *  A|B        Either A or B
+ *  * + ?      Repeating 0 or more times, 1 or more times or at most once
+ *  {N} {N,}   Repeating exactly N times or at least N times
+ *  {N,M}      Repeating between N and M times
+ *
+ * An expression is compiled to a DFA that finds where matches end and to a
+ * DFA that goes backwards from there to find where they start.
+ */
+
+typedef struct cli_regex *cli_regex;
+
+cli_regex cli_regex_create(void);
+
+void cli_regex_destroy(cli_regex cr);
+
+int cli_regex_compile(cli_regex cr, const char *s);
+
+/*
+ * DFA that reaches an accepting state right after the last byte of a match,
+ * wherever the match starts.
+ */
+struct dfa *cli_regex_forward(cli_regex cr);
+
+/*
+ * DFA that, fed the bytes of memory backwards from the last byte of a match,
+ * reaches an accepting state right after the first byte of a match.
+ */
+struct dfa *cli_regex_backward(cli_regex cr);
+
+/*
+ * Bytes that every match starts with. The size is 0 if there are none.
+ */
+const char *cli_regex_prefix(cli_regex cr, size_t *size);
+
+int cli_regex_error(cli_regex cr);
+
+int cli_regex_error_compile_offset(cli_regex cr);
+
+#endif /* CLI_REGEX_H */
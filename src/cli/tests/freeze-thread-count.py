@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+import select
+import re
+
+def responds(process):
+    poll = select.poll()
+    poll.register(process.stdout, select.POLLIN)
+
+    return bool(poll.poll(33))
+
+def fail(message):
+    sys.stderr.write(message)
+    freezer.kill()
+    guinea.kill()
+    exit(1)
+
+
+test_program = "./tests/cli/program/poke-mt"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+guinea.stdout.readline()
+
+# Along with the main one.
+guinea.stdin.write("s 3\n")
+guinea.stdin.flush()
+guinea.stdout.readline()
+
+freezer = subprocess.Popen(
+    ["./proctal", "freeze", "--pid=" + str(guinea.pid), "--latency", "-i"],
+    stdin=subprocess.PIPE,
+    stderr=subprocess.PIPE,
+    universal_newlines=True)
+
+froze = freezer.stderr.readline()
+
+if not re.match(r"Froze 4 threads in [0-9]+ microseconds\.$", froze):
+    fail("Was expecting 4 threads to be frozen, got:\n" + froze)
+
+guinea.stdin.write("w 0 1\n")
+guinea.stdin.flush()
+
+if responds(guinea):
+    fail("Was not supposed to be able to communicate with guinea pig.\n")
+
+freezer.stdin.close()
+
+unfroze = freezer.stderr.readline()
+
+if not re.match(r"Unfroze 4 threads in [0-9]+ microseconds\.$", unfroze):
+    fail("Was expecting 4 threads to be unfrozen, got:\n" + unfroze)
+
+freezer.wait()
+
+# The write that was held back goes through now.
+guinea.stdout.readline()
+
+guinea.kill()
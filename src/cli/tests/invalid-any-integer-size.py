@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+proctal = "./proctal"
+
+any_size_command = [proctal, "search", "--pid=1", "--integer-size=any"]
+
+tests = [
+    {
+        "command": any_size_command,
+        "expected_output": "Only integers can be of any size.",
+    },
+    {
+        "command": any_size_command + ["--type=ieee754"],
+        "expected_output": "Only integers can be of any size.",
+    },
+    {
+        "command": any_size_command + ["--type=integer", "--input"],
+        "expected_output": "Integers of any size cannot be searched with --input or --in-file.",
+    },
+    {
+        "command": any_size_command + ["--type=integer", "--in-file=results"],
+        "expected_output": "Integers of any size cannot be searched with --input or --in-file.",
+    },
+    {
+        "command": [proctal, "read", "--pid=1", "--address=1", "--type=integer", "--integer-size=any"],
+        "expected_output": "Invalid integer size.",
+    },
+]
+
+for test in tests:
+    try:
+        output = subprocess.check_output(test["command"], stdin=subprocess.DEVNULL, stderr=subprocess.STDOUT)
+    except subprocess.CalledProcessError as e:
+        output = e.output
+
+    output = output.decode("utf-8")
+
+    if not test["expected_output"] in output:
+        sys.stderr.write("Command '" + ' '.join(test["command"]) + "' output was:\n")
+        sys.stderr.write(output)
+        sys.stderr.write("\n")
+        sys.stderr.write("But was expecting:\n")
+        sys.stderr.write(test["expected_output"])
+        sys.stderr.write("\n")
+        exit(1)
@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+proctal = "./proctal"
+
+float_command = [proctal, "search", "--pid=1", "--type=ieee754", "--ieee754-precision=single", "--eq=1.5"]
+
+tests = [
+    {
+        "command": float_command + ["--epsilon=small"],
+        "expected_output": "Invalid epsilon.",
+    },
+    {
+        "command": float_command + ["--epsilon=-0.1"],
+        "expected_output": "Invalid epsilon.",
+    },
+    {
+        "command": float_command + ["--round=-1"],
+        "expected_output": "Invalid number of decimal places.",
+    },
+    {
+        "command": float_command + ["--round=18"],
+        "expected_output": "Invalid number of decimal places.",
+    },
+    {
+        "command": float_command + ["--epsilon=0.1", "--round=2"],
+        "expected_output": "Cannot use --epsilon and --round together.",
+    },
+    {
+        "command": [proctal, "search", "--pid=1", "--type=integer", "--eq=1", "--epsilon=1"],
+        "expected_output": "Only single and double precision floating point numbers can be approximately equal.",
+    },
+    {
+        "command": [proctal, "search", "--pid=1", "--type=ieee754", "--ieee754-precision=extended", "--eq=1", "--round=2"],
+        "expected_output": "Only single and double precision floating point numbers can be approximately equal.",
+    },
+    {
+        "command": [proctal, "search", "--pid=1", "--type=ieee754", "--gt=1", "--epsilon=0.1"],
+        "expected_output": "--epsilon and --round need a value to compare against in --eq.",
+    },
+    {
+        "command": float_command + ["--round=2", "--in-file=results"],
+        "expected_output": "--epsilon and --round cannot be used with --in-file.",
+    },
+]
+
+for test in tests:
+    try:
+        output = subprocess.check_output(test["command"], stderr=subprocess.STDOUT)
+    except subprocess.CalledProcessError as e:
+        output = e.output
+
+    output = output.decode("utf-8")
+
+    if not test["expected_output"] in output:
+        sys.stderr.write("Command '" + ' '.join(test["command"]) + "' output was:\n")
+        sys.stderr.write(output)
+        sys.stderr.write("\n")
+        sys.stderr.write("But was expecting:\n")
+        sys.stderr.write(test["expected_output"])
+        sys.stderr.write("\n")
+        exit(1)
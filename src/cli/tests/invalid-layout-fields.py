@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+proctal = "./proctal"
+
+layout_command = [proctal, "layout", "--pid=1"]
+
+tests = [
+    {
+        "command": layout_command,
+        "expected_output": "You must provide at least 1 field.",
+    },
+    {
+        "command": layout_command + ["0"],
+        "expected_output": "Field 0 must at least have an offset and a type.",
+    },
+    {
+        "command": layout_command + ["xyz:i32"],
+        "expected_output": "Invalid offset in field xyz:i32.",
+    },
+    {
+        "command": layout_command + ["0:i24"],
+        "expected_output": "Invalid type in field 0:i24.",
+    },
+    {
+        "command": layout_command + ["0:i32:approx=1"],
+        "expected_output": "Invalid comparison in field 0:i32:approx=1.",
+    },
+    {
+        "command": layout_command + ["0:i32:eq"],
+        "expected_output": "Invalid comparison in field 0:i32:eq.",
+    },
+    {
+        "command": layout_command + ["0:u8:eq=abc"],
+        "expected_output": "Invalid value in field 0:u8:eq=abc.",
+    },
+    {
+        "command": layout_command + ["0:i32:eq=1", "8:f64:gt=pi"],
+        "expected_output": "Invalid value in field 8:f64:gt=pi.",
+    },
+]
+
+for test in tests:
+    try:
+        output = subprocess.check_output(test["command"], stderr=subprocess.STDOUT)
+    except subprocess.CalledProcessError as e:
+        output = e.output
+
+    output = output.decode("utf-8")
+
+    if not test["expected_output"] in output:
+        sys.stderr.write("Command '" + ' '.join(test["command"]) + "' output was:\n")
+        sys.stderr.write(output)
+        sys.stderr.write("\n")
+        sys.stderr.write("But was expecting:\n")
+        sys.stderr.write(test["expected_output"])
+        sys.stderr.write("\n")
+        exit(1)
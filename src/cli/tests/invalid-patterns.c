@@ -41,7 +41,97 @@ int main(void)
 			.pattern = "9",
 			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
 			.expected_error_compile_offset = 0,
-		}
+		},
+		{
+			.pattern = "0F [80-8F",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 9,
+		},
+		{
+			.pattern = "[8F-80]",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 1,
+		},
+		{
+			.pattern = "[8?-9F]",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 1,
+		},
+		{
+			.pattern = "(E8|E9",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 6,
+		},
+		{
+			.pattern = "(E8|) 00",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 4,
+		},
+		{
+			.pattern = "E8)",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 2,
+		},
+		{
+			.pattern = "(E8|E9)00",
+			.expected_error = CLI_PATTERN_ERROR_MISSING_WHITESPACE,
+			.expected_error_compile_offset = 7,
+		},
+		{
+			.pattern = "55 {4,2} C3",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 3,
+		},
+		{
+			.pattern = "90{4,} C3",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 2,
+		},
+		{
+			.pattern = "{0,16}",
+			.expected_error = CLI_PATTERN_ERROR_EMPTY_MATCH,
+			.expected_error_compile_offset = 0,
+		},
+		{
+			.pattern = "(90|{0,1})",
+			.expected_error = CLI_PATTERN_ERROR_EMPTY_MATCH,
+			.expected_error_compile_offset = 0,
+		},
+		{
+			.pattern = "E8 <1x ?\?>",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 4,
+		},
+		{
+			.pattern = "<a 90> <a 91>",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 8,
+		},
+		{
+			.pattern = "E8 <a:rel32 ??{3}>",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 5,
+		},
+		{
+			.pattern = "E8 <a:rel16 ??{2}>",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 6,
+		},
+		{
+			.pattern = "E8 <a?\?>",
+			.expected_error = CLI_PATTERN_ERROR_MISSING_WHITESPACE,
+			.expected_error_compile_offset = 5,
+		},
+		{
+			.pattern = "E8 <a ??",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 8,
+		},
+		{
+			.pattern = "E8 ?? >",
+			.expected_error = CLI_PATTERN_ERROR_INVALID_PATTERN,
+			.expected_error_compile_offset = 6,
+		},
 	};
 
 	cli_pattern cp = cli_pattern_create();
@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+proctal = "./proctal"
+
+pointerscan_command = [proctal, "pointerscan", "--pid=1", "--address=1"]
+
+tests = [
+    {
+        "command": [proctal, "pointerscan", "--pid=1"],
+        "expected_output": "OPTION -a, --address is required.",
+    },
+    {
+        "command": [proctal, "pointerscan", "--pid=1", "--address=xyz"],
+        "expected_output": "Invalid address.",
+    },
+    {
+        "command": pointerscan_command + ["--depth=0"],
+        "expected_output": "Invalid depth.",
+    },
+    {
+        "command": pointerscan_command + ["--max-offset=far"],
+        "expected_output": "Invalid max offset.",
+    },
+    {
+        "command": pointerscan_command + ["--threads=0"],
+        "expected_output": "Invalid number of threads.",
+    },
+    {
+        "command": pointerscan_command + ["1"],
+        "expected_output": "This command only accepts options.",
+    },
+]
+
+for test in tests:
+    try:
+        output = subprocess.check_output(test["command"], stderr=subprocess.STDOUT)
+    except subprocess.CalledProcessError as e:
+        output = e.output
+
+    output = output.decode("utf-8")
+
+    if not test["expected_output"] in output:
+        sys.stderr.write("Command '" + ' '.join(test["command"]) + "' output was:\n")
+        sys.stderr.write(output)
+        sys.stderr.write("\n")
+        sys.stderr.write("But was expecting:\n")
+        sys.stderr.write(test["expected_output"])
+        sys.stderr.write("\n")
+        exit(1)
@@ -0,0 +1,81 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "cli/regex.h"
+
+int main(void)
+{
+	struct test {
+		const char *regex;
+		int expected_error;
+	};
+
+	struct test tests[] = {
+		{
+			.regex = "",
+			.expected_error = CLI_REGEX_ERROR_EMPTY_MATCH,
+		},
+		{
+			.regex = "a*",
+			.expected_error = CLI_REGEX_ERROR_EMPTY_MATCH,
+		},
+		{
+			.regex = "(a|)",
+			.expected_error = CLI_REGEX_ERROR_EMPTY_MATCH,
+		},
+		{
+			.regex = "(ab",
+			.expected_error = CLI_REGEX_ERROR_INVALID_REGEX,
+		},
+		{
+			.regex = "ab)",
+			.expected_error = CLI_REGEX_ERROR_INVALID_REGEX,
+		},
+		{
+			.regex = "[a-",
+			.expected_error = CLI_REGEX_ERROR_INVALID_REGEX,
+		},
+		{
+			.regex = "*a",
+			.expected_error = CLI_REGEX_ERROR_INVALID_REGEX,
+		},
+		{
+			.regex = "a{3,1}",
+			.expected_error = CLI_REGEX_ERROR_INVALID_REGEX,
+		},
+		{
+			.regex = "\\xg0",
+			.expected_error = CLI_REGEX_ERROR_INVALID_REGEX,
+		},
+		{
+			.regex = "^a",
+			.expected_error = CLI_REGEX_ERROR_INVALID_REGEX,
+		},
+	};
+
+	cli_regex cr = cli_regex_create();
+
+	for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+		struct test *test = &tests[i];
+
+		cli_regex_compile(cr, test->regex);
+
+		int error = cli_regex_error(cr);
+
+		if (error != test->expected_error) {
+			fprintf(
+				stderr,
+				"Regex \"%s\" was expected to fail with error code %d but got %d.\n",
+				test->regex,
+				test->expected_error,
+				error);
+
+			cli_regex_destroy(cr);
+			return 1;
+		}
+	}
+
+	cli_regex_destroy(cr);
+
+	return 0;
+}
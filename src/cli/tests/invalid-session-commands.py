@@ -0,0 +1,73 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+proctal = "./proctal"
+
+session_command = [proctal, "session", "--pid=1", "--type=integer", "--integer-size=32"]
+
+tests = [
+    {
+        "command": [proctal, "session", "--pid=1", "--type=instruction"],
+        "input": "",
+        "expected_output": "Searching for assembly code is not supported.",
+    },
+    {
+        "command": session_command,
+        "input": "frobnicate\n",
+        "expected_output": "Unknown command frobnicate.",
+    },
+    {
+        "command": session_command,
+        "input": "eq\n",
+        "expected_output": "Missing value for eq.",
+    },
+    {
+        "command": session_command,
+        "input": "eq abc\n",
+        "expected_output": "Invalid value for eq.",
+    },
+    {
+        "command": session_command,
+        "input": "inc 0\n",
+        "expected_output": "Value must be positive for inc.",
+    },
+    {
+        "command": session_command,
+        "input": "dec-up-to -1\n",
+        "expected_output": "Value must be positive for dec-up-to.",
+    },
+    {
+        "command": session_command,
+        "input": "increased\n",
+        "expected_output": "Comparing against previous values requires a previous search.",
+    },
+    {
+        "command": session_command,
+        "input": "list ten\n",
+        "expected_output": "Invalid number of results.",
+    },
+    {
+        "command": session_command,
+        "input": "eq 1 " * 33 + "\n",
+        "expected_output": "Too many words.",
+    },
+]
+
+for test in tests:
+    try:
+        output = subprocess.check_output(test["command"], input=test["input"].encode(), stderr=subprocess.STDOUT)
+    except subprocess.CalledProcessError as e:
+        output = e.output
+
+    output = output.decode("utf-8")
+
+    if not test["expected_output"] in output:
+        sys.stderr.write("Command '" + ' '.join(test["command"]) + "' with input '" + test["input"].strip() + "' output was:\n")
+        sys.stderr.write(output)
+        sys.stderr.write("\n")
+        sys.stderr.write("But was expecting:\n")
+        sys.stderr.write(test["expected_output"])
+        sys.stderr.write("\n")
+        exit(1)
@@ -0,0 +1,48 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+proctal = "./proctal"
+
+strings_command = [proctal, "strings", "--pid=1"]
+
+tests = [
+    {
+        "command": strings_command + ["--min-length=0"],
+        "expected_output": "Invalid minimum length.",
+    },
+    {
+        "command": strings_command + ["--min-length=long"],
+        "expected_output": "Invalid minimum length.",
+    },
+    {
+        "command": strings_command + ["--text-charset=utf8"],
+        "expected_output": "Invalid character set.",
+    },
+    {
+        "command": strings_command + ["--threads=0"],
+        "expected_output": "Invalid number of threads.",
+    },
+    {
+        "command": strings_command + ["hello"],
+        "expected_output": "This command only accepts options.",
+    },
+]
+
+for test in tests:
+    try:
+        output = subprocess.check_output(test["command"], stderr=subprocess.STDOUT)
+    except subprocess.CalledProcessError as e:
+        output = e.output
+
+    output = output.decode("utf-8")
+
+    if not test["expected_output"] in output:
+        sys.stderr.write("Command '" + ' '.join(test["command"]) + "' output was:\n")
+        sys.stderr.write(output)
+        sys.stderr.write("\n")
+        sys.stderr.write("But was expecting:\n")
+        sys.stderr.write(test["expected_output"])
+        sys.stderr.write("\n")
+        exit(1)
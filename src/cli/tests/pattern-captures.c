@@ -0,0 +1,117 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "cli/pattern.h"
+
+int main(void)
+{
+	struct test {
+		const char *pattern;
+		const char *bytes;
+		size_t size;
+		size_t capture;
+		size_t expected_start;
+		size_t expected_end;
+	};
+
+	struct test tests[] = {
+		{
+			.pattern = "E8 <target:rel32 ??{4}>",
+			.bytes = "\xe8\x10\x20\x30\x40",
+			.size = 5,
+			.capture = 0,
+			.expected_start = 1,
+			.expected_end = 5,
+		},
+		{
+			.pattern = "48 8B <reg ?\?> {0,4} <imm ??{2}> C3",
+			.bytes = "\x48\x8b\x05\x90\x90\x11\x22\xc3",
+			.size = 8,
+			.capture = 1,
+			.expected_start = 5,
+			.expected_end = 7,
+		},
+		{
+			.pattern = "(<short 74 ?\?>|<near 0F 84 ??{4}>) C3",
+			.bytes = "\x0f\x84\x01\x02\x03\x04\xc3",
+			.size = 7,
+			.capture = 0,
+			.expected_start = SIZE_MAX,
+			.expected_end = SIZE_MAX,
+		},
+		{
+			.pattern = "(<short 74 ?\?>|<near 0F 84 ??{4}>) C3",
+			.bytes = "\x0f\x84\x01\x02\x03\x04\xc3",
+			.size = 7,
+			.capture = 1,
+			.expected_start = 0,
+			.expected_end = 6,
+		},
+		{
+			// Mismatches in a pattern that can be broken down to
+			// positions leave captures where they are.
+			.pattern = "EB <offset:rel8 ?\?> 90",
+			.bytes = "\xeb\x05\xcc",
+			.size = 3,
+			.capture = 0,
+			.expected_start = 1,
+			.expected_end = 2,
+		},
+	};
+
+	cli_pattern cp = cli_pattern_create();
+
+	for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+		struct test *test = &tests[i];
+
+		if (!cli_pattern_compile(cp, test->pattern)) {
+			fprintf(stderr, "Pattern \"%s\" failed to compile.\n", test->pattern);
+			cli_pattern_destroy(cp);
+			return 1;
+		}
+
+		size_t bounds[CLI_PATTERN_MAX_CAPTURES * 2];
+
+		if (!cli_pattern_captures(cp, test->bytes, test->size, bounds)) {
+			fprintf(stderr, "Failed to find captures of pattern \"%s\".\n", test->pattern);
+			cli_pattern_destroy(cp);
+			return 1;
+		}
+
+		size_t start = bounds[test->capture * 2];
+		size_t end = bounds[test->capture * 2 + 1];
+
+		if (start != test->expected_start || end != test->expected_end) {
+			fprintf(
+				stderr,
+				"Capture %zu of pattern \"%s\" is at %zu-%zu but was expected at %zu-%zu.\n",
+				test->capture,
+				test->pattern,
+				start,
+				end,
+				test->expected_start,
+				test->expected_end);
+
+			cli_pattern_destroy(cp);
+			return 1;
+		}
+	}
+
+	cli_pattern_compile(cp, "E8 <target:rel32 ??{4}> <next ?\?>");
+
+	if (cli_pattern_capture_count(cp) != 2
+		|| strcmp(cli_pattern_capture_name(cp, 0), "target") != 0
+		|| cli_pattern_capture_type(cp, 0) != CLI_PATTERN_CAPTURE_REL32
+		|| strcmp(cli_pattern_capture_name(cp, 1), "next") != 0
+		|| cli_pattern_capture_type(cp, 1) != CLI_PATTERN_CAPTURE_BYTES) {
+		fprintf(stderr, "Wrong captures for pattern \"E8 <target:rel32 ??{4}> <next ?\?>\".\n");
+		cli_pattern_destroy(cp);
+		return 1;
+	}
+
+	cli_pattern_destroy(cp);
+
+	return 0;
+}
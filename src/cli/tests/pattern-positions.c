@@ -0,0 +1,87 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "cli/pattern.h"
+
+int main(void)
+{
+	struct test {
+		const char *pattern;
+		size_t expected_positions;
+	};
+
+	struct test tests[] = {
+		{
+			.pattern = "48 8B 05",
+			.expected_positions = 3,
+		},
+		{
+			.pattern = "(E8|E9) ??{4} 4? [80-8F]",
+			.expected_positions = 7,
+		},
+		{
+			.pattern = "55 {3} C3",
+			.expected_positions = 5,
+		},
+		{
+			.pattern = "(E8 00|E9)",
+			.expected_positions = 0,
+		},
+		{
+			.pattern = "55 {0,3} C3",
+			.expected_positions = 0,
+		},
+		{
+			.pattern = "??{65}",
+			.expected_positions = 0,
+		},
+	};
+
+	cli_pattern cp = cli_pattern_create();
+
+	for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+		struct test *test = &tests[i];
+
+		if (!cli_pattern_compile(cp, test->pattern)) {
+			fprintf(stderr, "Pattern \"%s\" failed to compile.\n", test->pattern);
+			cli_pattern_destroy(cp);
+			return 1;
+		}
+
+		size_t positions = cli_pattern_positions(cp);
+
+		if (positions != test->expected_positions) {
+			fprintf(
+				stderr,
+				"Pattern \"%s\" has %zu positions but was expected to have %zu.\n",
+				test->pattern,
+				positions,
+				test->expected_positions);
+
+			cli_pattern_destroy(cp);
+			return 1;
+		}
+	}
+
+	cli_pattern_compile(cp, "(E8|E9) ?5 [80-8F]");
+
+	for (int byte = 0; byte < 256; ++byte) {
+		int expected[] = {
+			byte == 0xE8 || byte == 0xE9,
+			(byte & 0xF) == 5,
+			byte >= 0x80 && byte <= 0x8F,
+		};
+
+		for (size_t position = 0; position < 3; ++position) {
+			if (cli_pattern_position_has_byte(cp, position, byte) != expected[position]) {
+				fprintf(stderr, "Wrong answer for byte %02X at position %zu.\n", byte, position);
+				cli_pattern_destroy(cp);
+				return 1;
+			}
+		}
+	}
+
+	cli_pattern_destroy(cp);
+
+	return 0;
+}
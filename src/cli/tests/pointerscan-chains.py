@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+
+import os
+import subprocess
+import sys
+
+def command(line):
+    guinea.stdin.write(line + "\n")
+    guinea.stdin.flush()
+
+    return guinea.stdout.readline().strip()
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+def module_start(path):
+    # Where the program is first mapped, which is what offsets of a module
+    # are relative to.
+    with open("/proc/" + str(guinea.pid) + "/maps") as maps:
+        for line in maps:
+            fields = line.split()
+
+            if len(fields) == 6 and fields[5] == path:
+                return int(fields[0].split("-")[0], 16)
+
+    fail("Could not find where " + path + " is mapped.\n")
+
+def pointerscan(args):
+    output = subprocess.check_output(
+        ["./proctal", "pointerscan", "--pid=" + str(guinea.pid)] + args,
+        stderr=subprocess.DEVNULL,
+        universal_newlines=True)
+
+    return output.splitlines()
+
+test_program = "./tests/cli/program/store"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+base = int(guinea.stdout.readline(), 16)
+
+# The program keeps the address of the block in a variable of its own, which
+# is where every chain starts.
+variable = int(command("p"), 16)
+start = "store+" + format(variable - module_start(os.path.realpath(test_program)), "X")
+
+# A pointer in the block that leads further in.
+if command("b 100 " + (base + 0x2000).to_bytes(8, "little").hex()) != "ok":
+    fail("Test program did not store the pointer.\n")
+
+tests = [
+    {
+        "args": ["--address=" + format(base + 0x10, "X"), "--depth=1"],
+        "expected_chains": [start + " 10"],
+        "unexpected_chains": [],
+    },
+    {
+        "args": ["--address=" + format(base + 0x2010, "X"), "--depth=2"],
+        "expected_chains": [start + " 100 10"],
+        "unexpected_chains": [],
+    },
+    {
+        # Too far from where the block starts to be reached in one step.
+        "args": ["--address=" + format(base + 0x2010, "X"), "--depth=1"],
+        "expected_chains": [],
+        "unexpected_chains": [start + " 2010"],
+    },
+    {
+        "args": ["--address=" + format(base + 0x2010, "X"), "--depth=1", "--max-offset=16384"],
+        "expected_chains": [start + " 2010"],
+        "unexpected_chains": [],
+    },
+]
+
+for test in tests:
+    chains = pointerscan(test["args"])
+
+    for chain in test["expected_chains"]:
+        if chain not in chains:
+            fail("Pointerscan with " + str(test["args"]) + " was expecting " + chain + ", got:\n" + "\n".join(chains) + "\n")
+
+    for chain in test["unexpected_chains"]:
+        if chain in chains:
+            fail("Pointerscan with " + str(test["args"]) + " was not expecting " + chain + ".\n")
+
+guinea.kill()
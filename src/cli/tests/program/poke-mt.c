@@ -0,0 +1,99 @@
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/*
+ * Asked for at the same address in every process so that many of them can be
+ * watched at once.
+ */
+#define VALUES_HINT ((void *) 0x100000000000)
+
+struct poke {
+	int index;
+	int value;
+};
+
+static volatile int *values;
+
+static void *poke_fun(void *arg)
+{
+	struct poke *poke = arg;
+
+	values[poke->index] = poke->value;
+
+	printf("%ld\n", (long) syscall(SYS_gettid));
+	fflush(stdout);
+
+	return NULL;
+}
+
+static void *sleep_fun(void *arg)
+{
+	for (;;) {
+		pause();
+	}
+
+	return NULL;
+}
+
+/*
+ * Prints the address of an array of integers and then reads commands from
+ * standard input, one per line:
+ *
+ *   w INDEX VALUE  A new thread writes VALUE to the integer at INDEX and
+ *                  prints its thread ID.
+ *   s COUNT        Starts COUNT threads that do nothing and prints ok.
+ *
+ * Quits when no more input is available.
+ */
+int main(void)
+{
+	values = mmap(VALUES_HINT, sysconf(_SC_PAGESIZE), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (values == MAP_FAILED) {
+		return 1;
+	}
+
+	printf("%" PRIXPTR "\n", (uintptr_t) values);
+	fflush(stdout);
+
+	char command;
+
+	while (scanf(" %c", &command) == 1) {
+		if (command == 'w') {
+			struct poke poke;
+			pthread_t t;
+
+			if (scanf("%d %d", &poke.index, &poke.value) != 2) {
+				return 1;
+			}
+
+			pthread_create(&t, NULL, poke_fun, &poke);
+			pthread_join(t, NULL);
+		} else if (command == 's') {
+			int count;
+
+			if (scanf("%d", &count) != 1) {
+				return 1;
+			}
+
+			for (int i = 0; i < count; ++i) {
+				pthread_t t;
+				pthread_create(&t, NULL, sleep_fun, NULL);
+			}
+
+			printf("ok\n");
+			fflush(stdout);
+		} else {
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,112 @@
+#define _GNU_SOURCE
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/*
+ * Asked for at an address that nothing else is likely to be next to, so that
+ * the memory stays a region of its own.
+ */
+#define STORE_HINT ((void *) 0x200000000000)
+
+// Spans several of the chunks that commands read memory in.
+#define STORE_SIZE (4 * 1024 * 1024)
+
+static unsigned char *store;
+
+static int hex_digit(char c)
+{
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	} else if (c >= 'a' && c <= 'f') {
+		return c - 'a' + 10;
+	} else if (c >= 'A' && c <= 'F') {
+		return c - 'A' + 10;
+	}
+
+	return -1;
+}
+
+/*
+ * Prints the address of a zeroed block of memory and then reads commands from
+ * standard input, one per line, printing ok after each one unless told
+ * otherwise:
+ *
+ *   b OFFSET HEX          Writes the bytes given in hexadecimal at OFFSET.
+ *   f OFFSET COUNT BYTE   Writes BYTE, given in hexadecimal, COUNT times
+ *                         starting at OFFSET.
+ *   p                     Prints the address of the variable of the program
+ *                         that points to the block instead.
+ *
+ * Offsets and counts are in hexadecimal. Bytes are written straight into the
+ * block, so they are not found anywhere else in memory. Quits when no more
+ * input is available.
+ */
+int main(void)
+{
+	store = mmap(STORE_HINT, STORE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+	if (store == MAP_FAILED) {
+		return 1;
+	}
+
+	printf("%" PRIXPTR "\n", (uintptr_t) store);
+	fflush(stdout);
+
+	char command;
+
+	while (scanf(" %c", &command) == 1) {
+		if (command == 'p') {
+			printf("%" PRIXPTR "\n", (uintptr_t) &store);
+			fflush(stdout);
+			continue;
+		}
+
+		size_t offset;
+
+		if (scanf("%zx", &offset) != 1) {
+			return 1;
+		}
+
+		if (command == 'b') {
+			char c;
+
+			if (scanf(" %c", &c) != 1) {
+				return 1;
+			}
+
+			while (hex_digit(c) != -1) {
+				int high = hex_digit(c);
+				int low = hex_digit(getchar());
+
+				if (low == -1 || offset >= STORE_SIZE) {
+					return 1;
+				}
+
+				store[offset++] = high * 16 + low;
+				c = getchar();
+			}
+		} else if (command == 'f') {
+			size_t count;
+			unsigned int byte;
+
+			if (scanf("%zx %x", &count, &byte) != 2 || offset + count > STORE_SIZE) {
+				return 1;
+			}
+
+			for (size_t i = 0; i < count; ++i) {
+				store[offset + i] = byte;
+			}
+		} else {
+			return 1;
+		}
+
+		printf("ok\n");
+		fflush(stdout);
+	}
+
+	return 0;
+}
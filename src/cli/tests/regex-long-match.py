@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+def store(command):
+    guinea.stdin.write(command + "\n")
+    guinea.stdin.flush()
+
+    if guinea.stdout.readline().strip() != "ok":
+        fail("Test program did not take '" + command + "'.\n")
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+def regex(pattern):
+    output = subprocess.check_output(["./proctal", "regex", "--pid=" + str(guinea.pid), pattern], universal_newlines=True)
+
+    # Only matches in the block are of interest.
+    return [int(line, 16) - base for line in output.splitlines() if base <= int(line, 16) < base + 4 * 1024 * 1024]
+
+test_program = "./tests/cli/program/store"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+base = int(guinea.stdout.readline(), 16)
+
+# Memory is read 1 MiB at a time. The first match starts more than 2 MiB
+# before the chunk it ends in and the second one starts in the chunk right
+# before.
+store("b 100 3c")
+store("f 101 280000 78")
+store("b 280101 3e")
+store("b 2ffff0 3c787878")
+store("f 2ffff4 20 78")
+store("b 300014 3e")
+
+tests = [
+    {
+        "pattern": "<x*>",
+        "expected_offsets": [0x100, 0x2ffff0],
+    },
+    {
+        "pattern": "<x+>",
+        "expected_offsets": [0x100, 0x2ffff0],
+    },
+]
+
+for test in tests:
+    offsets = regex(test["pattern"])
+
+    if offsets != test["expected_offsets"]:
+        fail("Regex " + test["pattern"] + " was expecting matches at offsets " + str([hex(o) for o in test["expected_offsets"]]) + ", got " + str([hex(o) for o in offsets]) + ".\n")
+
+guinea.kill()
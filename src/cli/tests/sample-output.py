@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+import re
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+
+test_program = "./tests/cli/program/poke-mt"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+guinea.stdout.readline()
+
+# Along with the main one.
+guinea.stdin.write("s 2\n")
+guinea.stdin.flush()
+guinea.stdout.readline()
+
+tests = [
+    {
+        "args": [],
+        "line": r"[0-9A-F]+ ([0-9]+)$",
+    },
+    {
+        "args": ["--folded"],
+        "line": r"[0-9A-F]+(;[0-9A-F]+)* ([0-9]+)$",
+    },
+]
+
+for test in tests:
+    command = ["./proctal", "sample", "--pid=" + str(guinea.pid), "--hz=20", "--duration=0.5"] + test["args"]
+
+    sampler = subprocess.Popen(command, stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+    output, error = sampler.communicate()
+
+    samples = re.match(r"Took ([0-9]+) samples", error)
+
+    if sampler.returncode != 0 or not samples:
+        fail("Command '" + " ".join(command) + "' failed with:\n" + error)
+
+    counts = []
+
+    for line in output.splitlines():
+        match = re.match(test["line"], line)
+
+        if not match:
+            fail("Command '" + " ".join(command) + "' printed an unexpected line:\n" + line + "\n")
+
+        counts.append(int(match.groups()[-1]))
+
+    if counts != sorted(counts, reverse=True):
+        fail("Command '" + " ".join(command) + "' did not print the most frequent first:\n" + output)
+
+    # Every thread is found in every sample.
+    if sum(counts) != 3 * int(samples.group(1)):
+        fail("Command '" + " ".join(command) + "' was expecting every sample to find 3 threads, got:\n" + output + error)
+
+guinea.kill()
@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+def store(command):
+    guinea.stdin.write(command + "\n")
+    guinea.stdin.flush()
+
+    if guinea.stdout.readline().strip() != "ok":
+        fail("Test program did not take '" + command + "'.\n")
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+def search(args):
+    output = subprocess.check_output(
+        ["./proctal", "search", "--pid=" + str(guinea.pid), "--type=integer", "--integer-size=any"] + args,
+        stderr=subprocess.DEVNULL,
+        universal_newlines=True)
+
+    matches = []
+
+    for line in output.splitlines():
+        address, value, name = line.split()
+        address = int(address, 16)
+
+        # Only matches in the block are of interest.
+        if base <= address < base + 4 * 1024 * 1024:
+            matches.append((address - base, int(value), name))
+
+    return sorted(matches)
+
+test_program = "./tests/cli/program/store"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+base = int(guinea.stdout.readline(), 16)
+
+# The rest of the block is zeroed, so a small value is also found in every
+# larger integer that starts at the same address. Memory is read 1 MiB at a
+# time and the block is 4 MiB.
+store("b 10 5a")
+store("b 21 5a")
+store("b fff8 5a")
+store("b ffff8 5a")
+store("b 3ffff8 5a")
+store("b 3fffff 5a")
+store("b 40 feff")
+store("b 80 e903")
+store("b 100002 ea03")
+store("b 3ffffc f203")
+
+every_size = lambda offset, value: [(offset, value, "i8"), (offset, value, "i16"), (offset, value, "i32"), (offset, value, "i64")]
+
+tests = [
+    {
+        "args": ["--eq=90"],
+        "expected_matches":
+            every_size(0x10, 90)
+            + [(0x21, 90, "i8")]
+            + every_size(0xfff8, 90)
+            + every_size(0xffff8, 90)
+            # The last byte of the block is not zero.
+            + every_size(0x3ffff8, 90)[:3]
+            + [(0x3fffff, 90, "i8")],
+    },
+    {
+        "args": ["--eq=-2"],
+        "expected_matches": [(0x40, -2, "i8"), (0x40, -2, "i16")],
+    },
+    {
+        # Too large for 8 bits.
+        "args": ["--gt=1000", "--lt=1011"],
+        "expected_matches": [
+            (0x80, 1001, "i16"),
+            (0x80, 1001, "i32"),
+            (0x80, 1001, "i64"),
+            (0x100002, 1002, "i16"),
+            (0x3ffffc, 1010, "i16"),
+        ],
+    },
+    {
+        # The same bytes, which are not sign extended this time.
+        "args": ["--eq=65534", "--integer-sign=unsigned"],
+        "expected_matches": [(0x40, 65534, "u16"), (0x40, 65534, "u32"), (0x40, 65534, "u64")],
+    },
+]
+
+for test in tests:
+    matches = search(test["args"])
+
+    if matches != sorted(test["expected_matches"]):
+        fail("Searching with " + str(test["args"]) + " was expecting\n" + str(test["expected_matches"]) + "\ngot\n" + str(matches) + "\n")
+
+guinea.kill()
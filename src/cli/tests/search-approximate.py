@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+
+import struct
+import subprocess
+import sys
+
+def store(offset, data):
+    guinea.stdin.write("b " + format(offset, "x") + " " + data.hex() + "\n")
+    guinea.stdin.flush()
+
+    if guinea.stdout.readline().strip() != "ok":
+        fail("Test program did not store " + data.hex() + ".\n")
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+def search(args):
+    output = subprocess.check_output(
+        ["./proctal", "search", "--pid=" + str(guinea.pid), "--type=ieee754"] + args,
+        stderr=subprocess.DEVNULL,
+        universal_newlines=True)
+
+    offsets = []
+
+    for line in output.splitlines():
+        address = int(line.split()[0], 16)
+
+        # Only matches in the block are of interest.
+        if base <= address < base + 4 * 1024 * 1024:
+            offsets.append(address - base)
+
+    return offsets
+
+test_program = "./tests/cli/program/store"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+base = int(guinea.stdout.readline(), 16)
+
+# Memory is read 1 MiB at a time and the block is 4 MiB. Several numbers are
+# compared at once, so some are put where fewer are left at the end of a
+# chunk.
+singles = {
+    0x10: 1.5,
+    0x14: 1.503,
+    0x18: 1.52,
+    0x1c: -1.5,
+    0x20: float("nan"),
+    0x24: 1.499,
+    0xffffc: 1.5,
+    0x100000: 1.497,
+    0x3ffff4: 1.51,
+    0x3ffffc: 1.506,
+}
+
+doubles = {
+    0x1ffff8: 2.25,
+    0x200000: 2.2504,
+    0x200008: 2.26,
+    0x200010: 2.2,
+    0x2ffff0: 2.246,
+    0x2ffff8: 2.25,
+}
+
+for offset, value in singles.items():
+    store(offset, struct.pack("<f", value))
+
+for offset, value in doubles.items():
+    store(offset, struct.pack("<d", value))
+
+tests = [
+    {
+        "args": ["--ieee754-precision=single", "--eq=1.5", "--epsilon=0.01"],
+        "expected_offsets": [0x10, 0x14, 0x24, 0xffffc, 0x100000, 0x3ffff4, 0x3ffffc],
+    },
+    {
+        "args": ["--ieee754-precision=single", "--eq=1.5", "--epsilon=0.001"],
+        "expected_offsets": [0x10, 0x24, 0xffffc],
+    },
+    {
+        "args": ["--ieee754-precision=single", "--eq=1.5", "--round=2"],
+        "expected_offsets": [0x10, 0x14, 0x24, 0xffffc, 0x100000],
+    },
+    {
+        "args": ["--ieee754-precision=single", "--eq=-1.5", "--round=0"],
+        "expected_offsets": [0x1c],
+    },
+    {
+        "args": ["--ieee754-precision=double", "--eq=2.25", "--epsilon=0.001"],
+        "expected_offsets": [0x1ffff8, 0x200000, 0x2ffff8],
+    },
+    {
+        "args": ["--ieee754-precision=double", "--eq=2.25", "--round=2"],
+        "expected_offsets": [0x1ffff8, 0x200000, 0x2ffff0, 0x2ffff8],
+    },
+]
+
+for test in tests:
+    offsets = search(test["args"])
+
+    if offsets != test["expected_offsets"]:
+        fail("Searching with " + str(test["args"]) + " was expecting matches at offsets " + str([hex(o) for o in test["expected_offsets"]]) + ", got " + str([hex(o) for o in offsets]) + ".\n")
+
+guinea.kill()
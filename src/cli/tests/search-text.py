@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+def store(offset, data):
+    guinea.stdin.write("b " + format(offset, "x") + " " + data.hex() + "\n")
+    guinea.stdin.flush()
+
+    if guinea.stdout.readline().strip() != "ok":
+        fail("Test program did not store " + data.hex() + ".\n")
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+def search(args):
+    output = subprocess.check_output(
+        ["./proctal", "search", "--pid=" + str(guinea.pid), "--type=text"] + args,
+        stderr=subprocess.DEVNULL,
+        universal_newlines=True)
+
+    matches = []
+
+    for line in output.splitlines():
+        address, text = line.split(" ", 1)
+        address = int(address, 16)
+
+        # Only matches in the block are of interest.
+        if base <= address < base + 4 * 1024 * 1024:
+            matches.append((address - base, text))
+
+    return matches
+
+test_program = "./tests/cli/program/store"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+base = int(guinea.stdout.readline(), 16)
+
+# Memory is read 1 MiB at a time and the block is 4 MiB. Positions are
+# filtered 16 at a time, so some of the text is put where fewer are left at
+# the end of a chunk and some goes across chunks.
+ascii = {
+    0x10: "Needle",
+    0x30: "needle",
+    0x50: "nEEdlE",
+    0x70: "needl",
+    0x90: "ne@dle",
+    0xffff5: "NEEDLE",
+    0x1ffffd: "needle",
+    0x3ffffa: "needle",
+}
+
+utf16 = {
+    0x200010: "Needle",
+    0x200031: "needle",
+    0x2ffffa: "NEEDLE",
+    0x3fffe0: "needle",
+}
+
+for offset, text in ascii.items():
+    store(offset, text.encode("ascii"))
+
+for offset, text in utf16.items():
+    store(offset, text.encode("utf-16-le"))
+
+tests = [
+    {
+        "args": ["--eq=needle"],
+        "expected_matches": [(0x30, "needle"), (0x1ffffd, "needle"), (0x3ffffa, "needle")],
+    },
+    {
+        "args": ["--eq=needle", "--ignore-case"],
+        "expected_matches": [
+            (0x10, "Needle"),
+            (0x30, "needle"),
+            (0x50, "nEEdlE"),
+            (0xffff5, "NEEDLE"),
+            (0x1ffffd, "needle"),
+            (0x3ffffa, "needle"),
+        ],
+    },
+    {
+        # Only letters have their case ignored.
+        "args": ["--eq=ne@dle", "--ignore-case"],
+        "expected_matches": [(0x90, "ne@dle")],
+    },
+    {
+        "args": ["--eq=needle", "--text-charset=utf-16le"],
+        "expected_matches": [(0x3fffe0, "needle")],
+    },
+    {
+        # Characters only start at even addresses.
+        "args": ["--eq=needle", "--text-charset=utf-16le", "--ignore-case"],
+        "expected_matches": [(0x200010, "Needle"), (0x2ffffa, "NEEDLE"), (0x3fffe0, "needle")],
+    },
+]
+
+for test in tests:
+    matches = search(test["args"])
+
+    if matches != test["expected_matches"]:
+        fail("Searching with " + str(test["args"]) + " was expecting\n" + str(test["expected_matches"]) + "\ngot\n" + str(matches) + "\n")
+
+guinea.kill()
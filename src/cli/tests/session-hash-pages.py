@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+def command(process, line):
+    process.stdin.write(line + "\n")
+    process.stdin.flush()
+
+    return process.stdout.readline().strip()
+
+def fail(message):
+    sys.stderr.write(message)
+    exit(1)
+
+def store(offset, value):
+    if command(guinea, "b " + format(offset, "x") + " " + value.to_bytes(4, "little", signed=True).hex()) != "ok":
+        fail("Test program did not store " + str(value) + ".\n")
+
+def narrow(session, filters):
+    if not command(session, filters).isdigit():
+        fail("Command " + filters + " did not print the number of results.\n")
+
+    # The count that follows the list tells where it ends.
+    session.stdin.write("list 100000000\ncount\n")
+    session.stdin.flush()
+
+    results = []
+
+    for line in iter(session.stdout.readline, ""):
+        words = line.split()
+
+        if len(words) == 1:
+            break
+
+        address = int(words[0], 16)
+
+        # Only results in the block are of interest.
+        if base <= address < base + 4 * 1024 * 1024:
+            results.append((address - base, int(words[1])))
+
+    return results
+
+def run(args):
+    # Starts over from the same memory every time.
+    if command(guinea, "f 0 400000 0") != "ok" or command(guinea, "f " + format(start, "x") + " " + format(end - start, "x") + " 7") != "ok":
+        fail("Test program did not fill the block.\n")
+
+    session = subprocess.Popen(
+        [
+            "./proctal",
+            "session",
+            "--pid=" + str(guinea.pid),
+            "--type=integer",
+            "--integer-size=32",
+        ] + args,
+        stdin=subprocess.PIPE,
+        stdout=subprocess.PIPE,
+        universal_newlines=True)
+
+    outputs = []
+
+    for step in steps:
+        for offset, value in step["values"].items():
+            store(offset, value)
+
+        outputs.append(narrow(session, step["command"]))
+
+    session.stdin.close()
+    session.wait()
+
+    return outputs
+
+test_program = "./tests/cli/program/store"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+base = int(guinea.stdout.readline(), 16)
+
+# Every integer from start to end holds 0x07070707 to begin with, across
+# pages and across the 1 MiB boundary at 0x200000.
+start = 0x180000
+end = 0x280000
+filled = 0x07070707
+
+steps = [
+    {
+        "values": {},
+        "command": "eq " + str(filled),
+        "expected_offsets": list(range(start, end, 4)),
+    },
+    {
+        # First and last integers of pages and one right outside of the
+        # filled memory.
+        "values": {start: 5, 0x1ffffc: 5, end - 4: 5, 0x100000: 9},
+        "command": "unchanged",
+        "expected_offsets": [o for o in range(start, end, 4) if o not in [start, 0x1ffffc, end - 4]],
+    },
+    {
+        "values": {0x200000: 8, 0x234560: 8, 0x234564: 1},
+        "command": "changed",
+        "expected_offsets": [0x200000, 0x234560, 0x234564],
+    },
+    {
+        # Values are compared against the last search, not the first.
+        "values": {0x234564: filled},
+        "command": "unchanged",
+        "expected_offsets": [0x200000, 0x234560],
+    },
+    {
+        "values": {0x200000: filled},
+        "command": "changed",
+        "expected_offsets": [0x200000],
+    },
+]
+
+full = run([])
+hashed = run(["--hash-pages"])
+
+guinea.kill()
+
+for i, step in enumerate(steps):
+    offsets = [offset for offset, value in full[i]]
+
+    if offsets != step["expected_offsets"]:
+        fail("Command " + step["command"] + " left " + str(len(offsets)) + " results in the block instead of " + str(len(step["expected_offsets"])) + ".\n")
+
+    if hashed[i] != full[i]:
+        fail("Command " + step["command"] + " left different results with --hash-pages.\n")
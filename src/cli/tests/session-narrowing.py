@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+def store(offset, value):
+    guinea.stdin.write("b " + format(offset, "x") + " " + value.to_bytes(4, "little", signed=True).hex() + "\n")
+    guinea.stdin.flush()
+
+    if guinea.stdout.readline().strip() != "ok":
+        fail("Test program did not store " + str(value) + ".\n")
+
+def fail(message):
+    sys.stderr.write(message)
+    session.kill()
+    guinea.kill()
+    exit(1)
+
+def narrow(command):
+    session.stdin.write(command + "\n")
+    session.stdin.flush()
+
+    if not session.stdout.readline().strip().isdigit():
+        fail("Command " + command + " did not print the number of results.\n")
+
+    # The count that follows the list tells where it ends.
+    session.stdin.write("list 100000000\ncount\n")
+    session.stdin.flush()
+
+    offsets = []
+
+    for line in iter(session.stdout.readline, ""):
+        words = line.split()
+
+        if len(words) == 1:
+            break
+
+        address = int(words[0], 16)
+
+        # Only results in the block are of interest.
+        if base <= address < base + 4 * 1024 * 1024:
+            offsets.append(address - base)
+
+    return offsets
+
+test_program = "./tests/cli/program/store"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+base = int(guinea.stdout.readline(), 16)
+
+session = subprocess.Popen(
+    [
+        "./proctal",
+        "session",
+        "--pid=" + str(guinea.pid),
+        "--type=integer",
+        "--integer-size=32",
+    ],
+    stdin=subprocess.PIPE,
+    stdout=subprocess.PIPE,
+    universal_newlines=True)
+
+a = 0x10
+b = 0x100010
+c = 0x200020
+d = 0x3ffffc
+
+# Every step changes the values and then narrows down the results.
+steps = [
+    {
+        "values": {a: 201527, b: 201527, c: 201527, d: 201527},
+        "command": "eq 201527",
+        "expected_offsets": [a, b, c, d],
+    },
+    {
+        "values": {a: 201530, b: 201520, d: 201529},
+        "command": "increased",
+        "expected_offsets": [a, d],
+    },
+    {
+        "values": {a: 201531, d: 201539},
+        "command": "inc-up-to 5",
+        "expected_offsets": [a],
+    },
+    {
+        "values": {},
+        "command": "reset",
+        "expected_offsets": [],
+    },
+    {
+        "values": {},
+        "command": "eq 201520",
+        "expected_offsets": [b],
+    },
+    {
+        "values": {b: 201515, c: 201520},
+        "command": "dec-up-to 5",
+        "expected_offsets": [b],
+    },
+    {
+        "values": {},
+        "command": "reset",
+        "expected_offsets": [],
+    },
+    {
+        "values": {},
+        "command": "gte 201515 lte 201520",
+        "expected_offsets": [b, c],
+    },
+    {
+        "values": {b: 201505, c: 201519},
+        "command": "dec-up-to 5",
+        "expected_offsets": [c],
+    },
+    {
+        "values": {},
+        "command": "unchanged",
+        "expected_offsets": [c],
+    },
+]
+
+for step in steps:
+    for offset, value in step["values"].items():
+        store(offset, value)
+
+    if step["command"] == "reset":
+        session.stdin.write("reset\n")
+        session.stdin.flush()
+        continue
+
+    offsets = narrow(step["command"])
+
+    if offsets != step["expected_offsets"]:
+        fail("Command " + step["command"] + " was expecting results at offsets " + str([hex(o) for o in step["expected_offsets"]]) + ", got " + str([hex(o) for o in offsets]) + ".\n")
+
+session.stdin.close()
+session.wait()
+guinea.kill()
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+
+def command(line):
+    guinea.stdin.write(line + "\n")
+    guinea.stdin.flush()
+
+    return guinea.stdout.readline().strip()
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+def store(offset, data):
+    if command("b " + format(offset, "X") + " " + data.hex()) != "ok":
+        fail("Test program did not store " + data.hex() + " at offset " + format(offset, "X") + ".\n")
+
+def strings(args):
+    output = subprocess.check_output(
+        ["./proctal", "strings", "--pid=" + str(guinea.pid)] + args,
+        stderr=subprocess.DEVNULL,
+        universal_newlines=True)
+
+    found = []
+
+    # Only what is in the block is known.
+    for line in output.splitlines():
+        address, text = line.split(" ", 1)
+        offset = int(address, 16) - base
+
+        if offset >= 0 and offset < 4 * 1024 * 1024:
+            found.append((offset, text))
+
+    # Threads go through memory at once, so strings come out in any order.
+    return [format(offset, "X") + " " + text for offset, text in sorted(found)]
+
+guinea = subprocess.Popen(["./tests/cli/program/store"], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+base = int(guinea.stdout.readline(), 16)
+
+store(0x100, b"proctal strings")
+store(0x200, b"abc")
+store(0x300, "proctal utf-16".encode("utf-16-le"))
+# Across the boundary of the chunks that memory is read in.
+store(0xFFFF8, b"over the boundary")
+store(0x2FFFF8, "over the boundary".encode("utf-16-le"))
+
+tests = [
+    {
+        "args": [],
+        "expected_strings": [
+            "100 proctal strings",
+            "FFFF8 over the boundary",
+        ],
+    },
+    {
+        "args": ["--min-length=3"],
+        "expected_strings": [
+            "100 proctal strings",
+            "200 abc",
+            "FFFF8 over the boundary",
+        ],
+    },
+    {
+        "args": ["--text-charset=utf-16le"],
+        "expected_strings": [
+            "300 proctal utf-16",
+            "2FFFF8 over the boundary",
+        ],
+    },
+]
+
+for test in tests:
+    found = strings(test["args"])
+
+    if found != test["expected_strings"]:
+        fail("Strings with " + str(test["args"]) + " found:\n" + "\n".join(found) + "\nBut was expecting:\n" + "\n".join(test["expected_strings"]) + "\n")
+
+guinea.kill()
@@ -32,6 +32,46 @@ int main(void)
 			.pattern = "    ??      88        ",
 			.expected_match = "\xaa\x88",
 		},
+		{
+			.pattern = "4? 8B",
+			.expected_match = "\x48\x8b",
+		},
+		{
+			.pattern = "?F 05",
+			.expected_match = "\x0f\x05",
+		},
+		{
+			.pattern = "0F [80-8F]",
+			.expected_match = "\x0f\x84",
+		},
+		{
+			.pattern = "[00 C? 90-9F]",
+			.expected_match = "\xc3",
+		},
+		{
+			.pattern = "(E8|E9) ?? ?? ?? ??",
+			.expected_match = "\xe9\x01\x02\x03\x04",
+		},
+		{
+			.pattern = "( E8 | 0F 8? ) 01",
+			.expected_match = "\x0f\x85\x01",
+		},
+		{
+			.pattern = "55 {0,4} C3",
+			.expected_match = "\x55\x90\x90\xc3",
+		},
+		{
+			.pattern = "55 {2} C3",
+			.expected_match = "\x55\x01\x02\xc3",
+		},
+		{
+			.pattern = "90{3} C3",
+			.expected_match = "\x90\x90\x90\xc3",
+		},
+		{
+			.pattern = "(48 89|4C 8B){1,2} E5",
+			.expected_match = "\x48\x89\x4c\x8b\xe5",
+		},
 	};
 
 	cli_pattern cp = cli_pattern_create();
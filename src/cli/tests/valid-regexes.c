@@ -0,0 +1,156 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cli/regex.h"
+
+/*
+ * Runs the forward DFA until the first match ends and then the backward DFA
+ * to find where it starts.
+ */
+static int first_match(cli_regex cr, const char *input, size_t *start, size_t *end)
+{
+	struct dfa *forward = cli_regex_forward(cr);
+	struct dfa *backward = cli_regex_backward(cr);
+	size_t size = strlen(input);
+	uint32_t state = forward->start;
+
+	for (size_t i = 0; i < size; ++i) {
+		state = dfa_step(forward, state, input[i]);
+
+		if (!dfa_accepting(forward, state)) {
+			continue;
+		}
+
+		*end = i + 1;
+
+		state = backward->start;
+
+		for (size_t j = i + 1; j-- > 0;) {
+			state = dfa_step(backward, state, input[j]);
+
+			if (dfa_accepting(backward, state)) {
+				*start = j;
+			}
+
+			if (dfa_dead(backward, state)) {
+				break;
+			}
+		}
+
+		return 1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	struct test {
+		const char *regex;
+		const char *input;
+		size_t expected_start;
+		size_t expected_end;
+	};
+
+	struct test tests[] = {
+		{
+			.regex = "abc",
+			.input = "xxabcxx",
+			.expected_start = 2,
+			.expected_end = 5,
+		},
+		{
+			.regex = "a+",
+			.input = "xaaa",
+			.expected_start = 1,
+			.expected_end = 2,
+		},
+		{
+			.regex = "x*yz",
+			.input = "axxxyz",
+			.expected_start = 1,
+			.expected_end = 6,
+		},
+		{
+			.regex = "(cat|dog)s?",
+			.input = "hotdogs",
+			.expected_start = 3,
+			.expected_end = 6,
+		},
+		{
+			.regex = "[0-9a-f]{4}",
+			.input = "id=0x12ab",
+			.expected_start = 5,
+			.expected_end = 9,
+		},
+		{
+			.regex = "\\x00\\xff",
+			.input = "a\xff",
+			.expected_start = 0,
+			.expected_end = 0,
+		},
+		{
+			.regex = "\\d{2,3}\\.",
+			.input = "v1.2345.",
+			.expected_start = 4,
+			.expected_end = 8,
+		},
+		{
+			.regex = "[^a-z]b",
+			.input = "abZb",
+			.expected_start = 2,
+			.expected_end = 4,
+		},
+	};
+
+	cli_regex cr = cli_regex_create();
+
+	for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+		struct test *test = &tests[i];
+
+		if (!cli_regex_compile(cr, test->regex)) {
+			fprintf(
+				stderr,
+				"Regex \"%s\" fails with error code %d.\n",
+				test->regex,
+				cli_regex_error(cr));
+
+			cli_regex_destroy(cr);
+			return 1;
+		}
+
+		size_t start = 0;
+		size_t end = 0;
+
+		first_match(cr, test->input, &start, &end);
+
+		if (start != test->expected_start || end != test->expected_end) {
+			fprintf(
+				stderr,
+				"Regex \"%s\" matched from %zu to %zu instead of from %zu to %zu.\n",
+				test->regex,
+				start,
+				end,
+				test->expected_start,
+				test->expected_end);
+
+			cli_regex_destroy(cr);
+			return 1;
+		}
+	}
+
+	size_t prefix_size;
+	cli_regex_compile(cr, "session=[0-9]+");
+	const char *prefix = cli_regex_prefix(cr, &prefix_size);
+
+	if (prefix_size != 8 || memcmp(prefix, "session=", 8) != 0) {
+		fprintf(stderr, "Expected a prefix of \"session=\".\n");
+		cli_regex_destroy(cr);
+		return 1;
+	}
+
+	cli_regex_destroy(cr);
+
+	return 0;
+}
@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+import signal
+import time
+import re
+
+def poke(process, index, value):
+    process.stdin.write("w " + str(index) + " " + str(value) + "\n")
+    process.stdin.flush()
+
+    return int(process.stdout.readline())
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+def watch(args, writes):
+    watcher = subprocess.Popen(
+        ["./proctal", "watch", "--pid=" + str(guinea.pid), "--address=" + address, "--size=4", "-w"] + args,
+        stdout=subprocess.PIPE,
+        universal_newlines=True)
+
+    # Waiting for the watch command to attach. We should probably figure
+    # out a reliable way for it to tell us when it's watching instead of
+    # guessing when.
+    time.sleep(0.1)
+
+    for value in range(writes):
+        poke(guinea, 0, value)
+
+    watcher.send_signal(signal.SIGINT)
+
+    return watcher.communicate()[0]
+
+
+test_program = "./tests/cli/program/poke-mt"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+address = guinea.stdout.readline().strip()
+
+# The same instruction makes every write.
+output = watch(["--aggregate"], 3)
+match = re.match(r"([0-9A-F]+) 3 ([0-9.]+) ([0-9.]+)\n$", output)
+
+if not match:
+    fail("Was expecting one instruction with 3 accesses, got:\n" + output)
+
+if float(match.group(2)) > float(match.group(3)):
+    fail("The first access came after the last one:\n" + output)
+
+output = watch(["--unique"], 3)
+
+if not re.match(r"[0-9A-F]+ [0-9]+\n$", output):
+    fail("Was expecting one instruction to be printed once, got:\n" + output)
+
+guinea.kill()
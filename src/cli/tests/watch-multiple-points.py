@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+import signal
+import time
+
+def poke(process, index, value):
+    process.stdin.write("w " + str(index) + " " + str(value) + "\n")
+    process.stdin.flush()
+
+    return int(process.stdout.readline())
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+
+test_program = "./tests/cli/program/poke-mt"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+address = int(guinea.stdout.readline(), 16)
+
+def watchpoint(index, size):
+    return format(address + index * 4, "X") + ":" + str(size)
+
+# One of every size, each aligned to it.
+watchpoints = [
+    watchpoint(0, 4),
+    watchpoint(1, 4),
+    watchpoint(2, 8),
+    watchpoint(4, 2),
+]
+
+watcher = subprocess.Popen(
+    ["./proctal", "watch", "--pid=" + str(guinea.pid), "-w"] + watchpoints,
+    stdout=subprocess.PIPE,
+    universal_newlines=True)
+
+# Waiting for the watch command to attach. We should probably figure out a
+# reliable way for it to tell us when it's watching instead of guessing when.
+time.sleep(0.1)
+
+indexes = [4, 1, 2, 0]
+
+for index in indexes:
+    poke(guinea, index, 1)
+
+watcher.send_signal(signal.SIGINT)
+output = watcher.communicate()[0]
+
+lines = output.splitlines()
+
+if len(lines) != len(indexes):
+    fail("Was expecting " + str(len(indexes)) + " accesses, got:\n" + output)
+
+# The watchpoint that was hit comes after the ID of the thread.
+for index, line in zip(indexes, lines):
+    expected = format(address + index * 4, "X")
+
+    if line.split()[2] != expected:
+        fail("Was expecting an access to " + expected + ", got:\n" + output)
+
+guinea.kill()
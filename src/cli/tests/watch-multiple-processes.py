@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+import signal
+import time
+
+def poke(process, index, value):
+    process.stdin.write("w " + str(index) + " " + str(value) + "\n")
+    process.stdin.flush()
+
+    return int(process.stdout.readline())
+
+def kill_guineas():
+    for guinea in guineas:
+        guinea.kill()
+
+def fail(message):
+    sys.stderr.write(message)
+    kill_guineas()
+    exit(1)
+
+
+test_program = "./tests/cli/program/poke-mt"
+
+guineas = [
+    subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+    for i in range(2)
+]
+
+addresses = [guinea.stdout.readline().strip() for guinea in guineas]
+
+if addresses[0] != addresses[1]:
+    sys.stderr.write("Guinea pigs could not get the same address.\n")
+    kill_guineas()
+
+    # Skipped.
+    exit(77)
+
+watcher = subprocess.Popen(
+    [
+        "./proctal",
+        "watch",
+        "--pid=" + ",".join(str(guinea.pid) for guinea in guineas),
+        "--address=" + addresses[0],
+        "--size=4",
+        "-w",
+    ],
+    stdout=subprocess.PIPE,
+    universal_newlines=True)
+
+# Waiting for the watch command to attach. We should probably figure out a
+# reliable way for it to tell us when it's watching instead of guessing when.
+time.sleep(0.1)
+
+tids = []
+
+for value in range(1, 3):
+    for guinea in guineas:
+        tids.append(poke(guinea, 0, value))
+
+# The others are still watched after one of them exits.
+guineas[0].stdin.close()
+guineas[0].wait()
+
+tids.append(poke(guineas[1], 0, 3))
+
+watcher.send_signal(signal.SIGINT)
+output = watcher.communicate()[0]
+
+if watcher.returncode != 0:
+    fail("Watch command exited with " + str(watcher.returncode) + ".\n")
+
+reported = [int(line.split()[1]) for line in output.splitlines()]
+
+if reported != tids:
+    fail("Was expecting accesses by threads " + str(tids) + ", got:\n" + output)
+
+kill_guineas()
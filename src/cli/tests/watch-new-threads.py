@@ -0,0 +1,46 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+import signal
+import time
+
+def poke(process, index, value):
+    process.stdin.write("w " + str(index) + " " + str(value) + "\n")
+    process.stdin.flush()
+
+    return int(process.stdout.readline())
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+
+test_program = "./tests/cli/program/poke-mt"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+address = guinea.stdout.readline().strip()
+
+watcher = subprocess.Popen(
+    ["./proctal", "watch", "--pid=" + str(guinea.pid), "--address=" + address, "--size=4", "-w"],
+    stdout=subprocess.PIPE,
+    universal_newlines=True)
+
+# Waiting for the watch command to attach. We should probably figure out a
+# reliable way for it to tell us when it's watching instead of guessing when.
+time.sleep(0.1)
+
+# Every write is made by a thread that did not exist when watching started.
+tids = [poke(guinea, 0, value) for value in range(1, 4)]
+
+watcher.send_signal(signal.SIGINT)
+output = watcher.communicate()[0]
+
+reported = [int(line.split()[1]) for line in output.splitlines()]
+
+if reported != tids:
+    fail("Was expecting accesses by threads " + str(tids) + ", got:\n" + output)
+
+guinea.kill()
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+import signal
+import time
+
+def poke(process, index, value):
+    process.stdin.write("w " + str(index) + " " + str(value) + "\n")
+    process.stdin.flush()
+
+    return int(process.stdout.readline())
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+
+test_program = "./tests/cli/program/poke-mt"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+address = guinea.stdout.readline().strip()
+
+# Wider than any debug register can watch.
+watcher = subprocess.Popen(
+    ["./proctal", "watch", "--pid=" + str(guinea.pid), "-w", "--pages", address + ":64"],
+    stdout=subprocess.PIPE,
+    universal_newlines=True)
+
+# Waiting for the watch command to attach. We should probably figure out a
+# reliable way for it to tell us when it's watching instead of guessing when.
+time.sleep(0.1)
+
+tids = [poke(guinea, index, 1) for index in [0, 10, 15]]
+
+# Same page, outside of the watchpoint.
+poke(guinea, 16, 1)
+
+watcher.send_signal(signal.SIGINT)
+output = watcher.communicate()[0]
+
+reported = [int(line.split()[1]) for line in output.splitlines()]
+
+if reported != tids:
+    fail("Was expecting accesses by threads " + str(tids) + ", got:\n" + output)
+
+# The pages must have their protection back.
+poke(guinea, 0, 2)
+
+if guinea.poll() is not None:
+    fail("Guinea pig did not survive the end of the session.\n")
+
+guinea.kill()
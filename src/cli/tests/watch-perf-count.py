@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+import signal
+import time
+
+def poke(process, index, value):
+    process.stdin.write("w " + str(index) + " " + str(value) + "\n")
+    process.stdin.flush()
+
+    return int(process.stdout.readline())
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+
+test_program = "./tests/cli/program/poke-mt"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+address = guinea.stdout.readline().strip()
+
+watcher = subprocess.Popen(
+    ["./proctal", "watch", "--pid=" + str(guinea.pid), "--address=" + address, "--size=4", "-w", "--perf", "--count"],
+    stdout=subprocess.PIPE,
+    stderr=subprocess.PIPE,
+    universal_newlines=True)
+
+# Waiting for the watch command to open the events. We should probably figure
+# out a reliable way for it to tell us when it's watching instead of guessing
+# when.
+time.sleep(0.1)
+
+# Threads created after the events were opened inherit them.
+for value in range(1, 4):
+    poke(guinea, 0, value)
+
+watcher.send_signal(signal.SIGINT)
+output, error = watcher.communicate()
+
+if "Perf events are not available" in error:
+    sys.stderr.write(error)
+    guinea.kill()
+
+    # Skipped.
+    exit(77)
+
+if output != address + " 3\n":
+    fail("Was expecting 3 accesses to be counted, got:\n" + output + error)
+
+guinea.kill()
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+import signal
+import time
+
+def poke(process, index, value):
+    process.stdin.write("w " + str(index) + " " + str(value) + "\n")
+    process.stdin.flush()
+
+    return int(process.stdout.readline())
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+
+test_program = "./tests/cli/program/poke-mt"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+address = guinea.stdout.readline().strip()
+
+watcher = subprocess.Popen(
+    ["./proctal", "watch", "--pid=" + str(guinea.pid), "--address=" + address, "--size=4", "-w"],
+    stdout=subprocess.PIPE,
+    universal_newlines=True)
+
+# Waiting for the watch command to attach. We should probably figure out a
+# reliable way for it to tell us when it's watching instead of guessing when.
+time.sleep(0.1)
+
+# The process stays attached to between hits.
+for value in range(1, 4):
+    poke(guinea, 0, value)
+
+watcher.send_signal(signal.SIGINT)
+output = watcher.communicate()[0]
+
+if watcher.returncode != 0:
+    fail("Watch command exited with " + str(watcher.returncode) + ".\n")
+
+lines = output.splitlines()
+
+if len(lines) != 3:
+    fail("Was expecting 3 accesses, got:\n" + output)
+
+# The process must go on as it was after the session ends.
+poke(guinea, 0, 4)
+
+if guinea.poll() is not None:
+    fail("Guinea pig did not survive the end of the session.\n")
+
+guinea.kill()
@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+
+import subprocess
+import sys
+import signal
+import time
+
+def poke(process, index, value):
+    process.stdin.write("w " + str(index) + " " + str(value) + "\n")
+    process.stdin.flush()
+
+    return int(process.stdout.readline())
+
+def fail(message):
+    sys.stderr.write(message)
+    guinea.kill()
+    exit(1)
+
+def watch(args, values):
+    watcher = subprocess.Popen(
+        [
+            "./proctal",
+            "watch",
+            "--pid=" + str(guinea.pid),
+            "--address=" + address,
+            "--size=4",
+            "-w",
+            "--type=integer",
+            "--integer-size=32",
+            "--values",
+        ] + args,
+        stdout=subprocess.PIPE,
+        universal_newlines=True)
+
+    # Waiting for the watch command to attach. We should probably figure
+    # out a reliable way for it to tell us when it's watching instead of
+    # guessing when.
+    time.sleep(0.1)
+
+    for value in values:
+        poke(guinea, 0, value)
+
+    watcher.send_signal(signal.SIGINT)
+
+    return watcher.communicate()[0]
+
+
+test_program = "./tests/cli/program/poke-mt"
+
+guinea = subprocess.Popen([test_program], stdin=subprocess.PIPE, stdout=subprocess.PIPE, universal_newlines=True)
+
+address = guinea.stdout.readline().strip()
+
+# The value before every write is the one from the write before it.
+tests = [
+    {
+        "args": [],
+        "expected_values": [["0", "5"], ["5", "7"], ["7", "3"]],
+    },
+    {
+        "args": ["--when=gt=6"],
+        "expected_values": [["5", "7"]],
+    },
+    {
+        "args": ["--when=decreased"],
+        "expected_values": [["7", "3"]],
+    },
+    {
+        "args": ["--when=gte=5:lte=5"],
+        "expected_values": [["3", "5"]],
+    },
+]
+
+for test in tests:
+    output = watch(test["args"], [5, 7, 3])
+    values = [line.split()[2:] for line in output.splitlines()]
+
+    if values != test["expected_values"]:
+        fail("Watching with " + str(test["args"]) + " was expecting values " + str(test["expected_values"]) + ", got:\n" + output)
+
+guinea.kill()
@@ -0,0 +1,48 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cli/val/text.h"
+
+int main(void)
+{
+	struct test {
+		const char *string;
+		const unsigned char bytes[2];
+	};
+
+	struct test tests[] = {
+		{ "A", { 0x41, 0x00 } },
+		{ "~", { 0x7E, 0x00 } },
+		{ "\xC3\xA9", { 0xE9, 0x00 } },
+		{ "\xD0\x96", { 0x16, 0x04 } },
+		{ "\xE2\x82\xAC", { 0xAC, 0x20 } },
+		{ "\xEF\xBF\xBD", { 0xFD, 0xFF } },
+	};
+
+	struct cli_val_text_attr a;
+	cli_val_text_attr_init(&a);
+	cli_val_text_attr_set_charset(&a, CLI_VAL_TEXT_CHARSET_UTF16LE);
+	struct cli_val_text *v = cli_val_text_create(&a);
+	cli_val_text_attr_deinit(&a);
+
+	for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+		struct test *test = &tests[i];
+
+		if (cli_val_text_parse(v, test->string) != 1) {
+			fprintf(stderr, "cli_val_text_parse failed on string #%lu\n", i + 1);
+			cli_val_text_destroy(v);
+			return 1;
+		}
+
+		if (memcmp(cli_val_text_raw(v), test->bytes, 2) != 0) {
+			fprintf(stderr, "Wrong code unit for string #%lu\n", i + 1);
+			cli_val_text_destroy(v);
+			return 1;
+		}
+	}
+
+	cli_val_text_destroy(v);
+
+	return 0;
+}
@@ -0,0 +1,174 @@
+#include <assert.h>
+#include <stdint.h>
+
+#include "cli/val/text.h"
+
+/*
+ * A character is a single UTF-16 code unit stored in little endian byte order,
+ * which covers the Basic Multilingual Plane. Surrogates only make sense in
+ * pairs so they are printed as the replacement character.
+ */
+
+#define REPLACEMENT_CHARACTER 0xFFFD
+
+static inline int is_surrogate(uint16_t unit)
+{
+	return unit >= 0xD800 && unit <= 0xDFFF;
+}
+
+static inline uint16_t get_unit(struct cli_val_text *v)
+{
+	unsigned char *bytes = (unsigned char *) v->data;
+
+	return bytes[0] | (bytes[1] << 8);
+}
+
+static inline void set_unit(struct cli_val_text *v, uint16_t unit)
+{
+	unsigned char *bytes = (unsigned char *) v->data;
+
+	bytes[0] = unit & 0xFF;
+	bytes[1] = unit >> 8;
+}
+
+/*
+ * Decodes a UTF-8 character that fits in a single code unit. Bytes are
+ * fetched one at a time by calling next, which returns EOF at the end.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int decode_utf8(int (*next)(void *), void *data, uint16_t *unit)
+{
+	int ch = next(data);
+
+	if (ch == EOF || ch == '\0') {
+		return 0;
+	}
+
+	uint32_t cp;
+	int continuation;
+
+	if (ch < 0x80) {
+		cp = ch;
+		continuation = 0;
+	} else if ((ch & 0xE0) == 0xC0) {
+		cp = ch & 0x1F;
+		continuation = 1;
+	} else if ((ch & 0xF0) == 0xE0) {
+		cp = ch & 0x0F;
+		continuation = 2;
+	} else {
+		// Either not a leading byte or a character that needs more
+		// than one code unit.
+		return 0;
+	}
+
+	for (int i = 0; i < continuation; ++i) {
+		ch = next(data);
+
+		if (ch == EOF || (ch & 0xC0) != 0x80) {
+			return 0;
+		}
+
+		cp = (cp << 6) | (ch & 0x3F);
+	}
+
+	// Overlong encodings and surrogates are not valid UTF-8.
+	if ((continuation == 1 && cp < 0x80)
+		|| (continuation == 2 && cp < 0x800)
+		|| is_surrogate(cp)) {
+		return 0;
+	}
+
+	*unit = cp;
+
+	return 1;
+}
+
+static int next_from_string(void *data)
+{
+	const char **s = data;
+
+	if (**s == '\0') {
+		return EOF;
+	}
+
+	return (unsigned char) *(*s)++;
+}
+
+static int next_from_file(void *data)
+{
+	return fgetc((FILE *) data);
+}
+
+size_t cli_val_text_utf16le_sizeof(struct cli_val_text *v)
+{
+	return 2;
+}
+
+int cli_val_text_utf16le_cmp(
+	struct cli_val_text *v,
+	struct cli_val_text *other_v)
+{
+	return COMPARE(get_unit(v), get_unit(other_v));
+}
+
+int cli_val_text_utf16le_print(struct cli_val_text *v, FILE *f)
+{
+	uint16_t unit = get_unit(v);
+
+	if (is_surrogate(unit)) {
+		unit = REPLACEMENT_CHARACTER;
+	}
+
+	if (unit < 0x80) {
+		return fprintf(f, "%c", unit);
+	} else if (unit < 0x800) {
+		return fprintf(f, "%c%c",
+			0xC0 | (unit >> 6),
+			0x80 | (unit & 0x3F));
+	} else {
+		return fprintf(f, "%c%c%c",
+			0xE0 | (unit >> 12),
+			0x80 | ((unit >> 6) & 0x3F),
+			0x80 | (unit & 0x3F));
+	}
+}
+
+int cli_val_text_utf16le_scan(struct cli_val_text *v, FILE *f)
+{
+	uint16_t unit;
+
+	if (!decode_utf8(next_from_file, f, &unit)) {
+		return 0;
+	}
+
+	set_unit(v, unit);
+
+	return 1;
+}
+
+int cli_val_text_utf16le_parse(struct cli_val_text *v, const char *s)
+{
+	uint16_t unit;
+
+	if (!decode_utf8(next_from_string, &s, &unit)) {
+		return 0;
+	}
+
+	set_unit(v, unit);
+
+	return 1;
+}
+
+int cli_val_text_utf16le_parse_bin(struct cli_val_text *v, const char *s, size_t length)
+{
+	if (length < 2) {
+		return 0;
+	}
+
+	v->data[0] = s[0];
+	v->data[1] = s[1];
+
+	return 2;
+}
@@ -9,6 +9,15 @@ int cli_val_text_ascii_scan(struct cli_val_text *v, FILE *f);
 int cli_val_text_ascii_parse(struct cli_val_text *v, const char *s);
 int cli_val_text_ascii_parse_bin(struct cli_val_text *v, const char *s, size_t length);
 
+size_t cli_val_text_utf16le_sizeof(struct cli_val_text *v);
+int cli_val_text_utf16le_cmp(
+	struct cli_val_text *v,
+	struct cli_val_text *other_v);
+int cli_val_text_utf16le_print(struct cli_val_text *v, FILE *f);
+int cli_val_text_utf16le_scan(struct cli_val_text *v, FILE *f);
+int cli_val_text_utf16le_parse(struct cli_val_text *v, const char *s);
+int cli_val_text_utf16le_parse_bin(struct cli_val_text *v, const char *s, size_t length);
+
 struct cli_val_text_charset_impl {
 	int (*size)(struct cli_val_text *);
 	int (*cmp)(struct cli_val_text *, struct cli_val_text *);
@@ -27,6 +36,14 @@ static struct cli_val_text_charset_impl impls[] = {
 		.parse = (void *) cli_val_text_ascii_parse,
 		.parse_bin = (void *) cli_val_text_ascii_parse_bin,
 	},
+	[CLI_VAL_TEXT_CHARSET_UTF16LE] = {
+		.size = (void *) cli_val_text_utf16le_sizeof,
+		.cmp = (void *) cli_val_text_utf16le_cmp,
+		.print = (void *) cli_val_text_utf16le_print,
+		.scan = (void *) cli_val_text_utf16le_scan,
+		.parse = (void *) cli_val_text_utf16le_parse,
+		.parse_bin = (void *) cli_val_text_utf16le_parse_bin,
+	},
 };
 
 static struct cli_val_text_charset_impl *get_charset_impl_by_charset(enum cli_val_text_charset charset)
@@ -14,6 +14,7 @@
  */
 enum cli_val_text_charset {
 	CLI_VAL_TEXT_CHARSET_ASCII,
+	CLI_VAL_TEXT_CHARSET_UTF16LE,
 };
 
 /*
@@ -74,6 +75,11 @@ inline struct cli_val_text *cli_val_text_create(struct cli_val_text_attr *a)
 		size = 1;
 		break;
 
+	case CLI_VAL_TEXT_CHARSET_UTF16LE:
+		// A single code unit.
+		size = 2;
+		break;
+
 	default:
 		// Not expecting to ever reach here.
 		assert(0);
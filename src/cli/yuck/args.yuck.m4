@@ -36,6 +36,7 @@ define(`TYPE_ARGUMENTS', `
                         By default CHARSET is ascii.
                         CHARSET can be:
                         ascii
+                        utf-16le
   --ieee754-precision=PRECISION
                         If type is ieee754, this determines the precision of
                         the floating point number. By default PRECISION is
@@ -152,6 +153,18 @@ You can additionally filter against the results of a previous search by passing
 the --input option which expects the output of the previous command to be
 streamed to the standard input stream.
 
+Text in --eq is searched for as a whole instead of one character at a time.
+Each match is followed by the text found there. This changed what a search for
+text prints: it used to only look for the first character of --eq and print
+every address where that character was stored. Passing a single character still
+finds the same addresses. Filtering the output of a previous search with
+--input still compares one character at a time.
+
+Passing any as the integer size searches for integers of 8, 16, 32 and 64 bits
+while only going through memory once. Each match is followed by its size and
+sign, such as i32 or u16. Sizes that cannot hold a value that passes the
+filters are skipped.
+
 Examples:
   Searching for all bytes that equal 12
         proctal search --pid=12345 --eq 12
@@ -169,10 +182,25 @@ Examples:
   Searching in executable memory only
         proctal search --pid=12345 -x --eq 12
 
+  Searching for a counter between 100 and 200 of unknown size
+        proctal search --pid=12345 --type=integer --integer-size=any --gt 100 --lt 200
+
+  Searching for a floating point number that is displayed as 3.14
+        proctal search --pid=12345 --type=ieee754 --eq 3.14 --round 2
+
+  Searching for a string stored in UTF-16 regardless of its case
+        proctal search --pid=12345 --type=text --text-charset=utf-16le --eq Hello --ignore-case
+
+  Searching for any of the 32-bit integers listed in a file
+        proctal search --pid=12345 --type=integer --integer-size=32 --in-file=ids
+
 
   PID_ARGUMENT
   -i, --input           Reads the output of a previous scan of the same type
                         from standard input.
+  --in-file=FILE        Only matches values listed in FILE, separated by
+                        whitespace. Values match if they are stored with the
+                        same bytes. Suitable for a large number of values.
   TYPE_ARGUMENTS
   -r, --read            Readable memory.
   -w, --write           Writable memory.
@@ -183,6 +211,13 @@ Examples:
   --gte=VAL             Greater than or equal to VAL
   --lt=VAL              Less than VAL
   --lte=VAL             Less than or equal to VAL
+  --epsilon=VAL         With --eq, matches floating point numbers that are at
+                        most VAL away from the value instead of exactly equal.
+  --round=DIGITS        With --eq, matches floating point numbers that are equal
+                        to the value when both are rounded to DIGITS decimal
+                        places. NaN never matches, with either option.
+  --ignore-case         With text in --eq, ASCII letters match regardless of
+                        their case.
   --inc=VAL             Incremented by VAL
   --inc-up-to=VAL       Incremented up to and including VAL
   --dec=VAL             Decremented by VAL
@@ -194,12 +229,147 @@ Examples:
 
 
 
+Usage: proctal session
+Starts an interactive search session.
+
+Reads commands from standard input, one per line. The first search goes through
+all of memory and every search after that only looks at the results of the
+previous one, which are kept in memory for as long as the session lasts.
+
+After every search the number of results left is printed.
+
+The following commands are available:
+
+ eq VAL, ne VAL, gt VAL, gte VAL, lt VAL, lte VAL
+
+   Compares values in memory against VAL.
+
+ inc VAL, inc-up-to VAL, dec VAL, dec-up-to VAL
+
+   Compares values in memory against the values of the previous search.
+
+ changed, unchanged, increased, decreased
+
+   Compares values in memory against the values of the previous search.
+
+ list [N]
+
+   Prints the address and value of the first N results. Defaults to 10.
+
+ count
+
+   Prints the number of results.
+
+ reset
+
+   Forgets all results. The next search goes through all of memory again.
+
+ quit
+
+   Ends the session. Reaching the end of the input also ends it.
+
+Multiple filters can be given in the same line.
+
+With --hash-pages, a hash is kept of every page of memory that has results.
+Pages that hash the same on the next search are known not to have changed and
+their values don't need to be compared against the previous ones one by one.
+
+Examples:
+  Narrowing down a value that increased and is now between 10 and 20
+        proctal session --pid=12345 --type=integer --integer-size=32
+        > gt 10 lte 20
+        > increased
+        > list 5
+
+
+  PID_ARGUMENT
+  TYPE_ARGUMENTS
+  -r, --read            Readable memory.
+  -w, --write           Writable memory.
+  -x, --execute         Executable memory.
+  --hash-pages          Skips comparing values in pages that did not change.
+
+
+
+Usage: proctal pointerscan
+Finds chains of pointers that lead to an address.
+
+Addresses of values allocated at run time change every time a program runs.
+Reaching them through a chain of pointers that starts in memory that belongs to
+the program or to one of its libraries is usually more reliable.
+
+Every pointer sized value in writable memory that points somewhere in the
+address space is collected first. Starting from the address, pointers that
+point at most --max-offset bytes before it are followed backwards until they
+are found in memory that belongs to a module, up to --depth pointers away.
+
+Each chain is printed in a line. The first column is the module and the offset
+from where it starts in memory of the first pointer. The remaining columns are
+the offsets that are added to each pointer in turn, all in hexadecimal. The
+last one leads to the address.
+
+Examples:
+  Finding chains of up to 3 pointers leading to 1c09346
+        proctal pointerscan --pid=12345 --address=1c09346 --depth=3
+
+
+  PID_ARGUMENT
+  -a, --address=ADDR    Address the chains lead to.
+  --depth=N             Largest number of pointers in a chain. By default N is
+                        3.
+  --max-offset=SIZE     Largest number of bytes between where a pointer points
+                        to and the next step of the chain. By default SIZE is
+                        4096.
+  --threads=N           Number of threads that go over memory. By default N is
+                        the number of processors.
+
+
+
+Usage: proctal layout FIELDS...
+Searches for structures in memory.
+
+Outputs the start address of every structure whose fields all match.
+
+A field is described by its offset from the start of the structure in
+hexadecimal, its type and any number of comparisons, all separated by colons:
+
+  OFFSET:TYPE:COMPARISON=VALUE:COMPARISON=VALUE...
+
+TYPE can be:
+  i8, i16, i32, i64  Signed integers of 8, 16, 32 and 64 bits
+  u8, u16, u32, u64  Unsigned integers of 8, 16, 32 and 64 bits
+  f32, f64           Single and double precision floating point numbers
+  byte
+  address
+
+COMPARISON can be:
+  eq, ne, gt, gte, lt, lte
+
+Memory is only gone through once. The field that is expected to match the
+least is checked first and the remaining fields are only checked where it
+matches. Structures start at addresses aligned to the largest alignment of
+their fields.
+
+Examples:
+  Searching for a structure with 100 at offset 10 and a number between 0 and 5
+  at offset 24
+        proctal layout --pid=12345 10:i32:eq=100 24:f32:gt=0:lt=5
+
+
+  PID_ARGUMENT
+  -r, --read            Readable memory.
+  -w, --write           Writable memory.
+  -x, --execute         Executable memory.
+
+
+
 Usage: proctal pattern PATTERN
 Searches for patterns in memory.
 
 Outputs the starting address of each match.
 
-The following patterns are available:
+A pattern is made of elements separated by whitespace. The following elements
+are available:
 
  00 to FF - Exact byte value
 
@@ -210,6 +380,52 @@ The following patterns are available:
 
    Matches any byte value.
 
+ 4? and ?8 - Nibble wildcards
+
+   Matches any byte value whose high or low 4 bits are the given hexadecimal
+   digit.
+
+ [80-8F C? 90] - Set of byte values
+
+   Matches any of the byte values in brackets. The set is made of byte
+   values, wildcards and ranges of byte values separated by whitespace.
+
+ (E8|E9) - Alternatives
+
+   Matches either of the sequences of elements separated by the vertical bar.
+
+ {N} and {N,M} - Gaps
+
+   Skips exactly N or between N and M byte values.
+
+ <NAME ...> - Capture
+
+   Matches the elements inside and prints the bytes they matched after the
+   address as NAME=BYTES. With <NAME:rel8 ...> or <NAME:rel32 ...> the bytes,
+   which must always be 1 or 4, are read as a signed little endian
+   displacement and the address they point to, counting from the address
+   right after the capture, is printed instead. This is how call, jump and
+   RIP-relative targets are resolved.
+
+An element directly followed by {N} or {N,M} is repeated exactly N times or
+between N and M times, as in ??{4} for 4 bytes of any value.
+
+Matches do not overlap and each one ends as soon as it can. A pattern that can
+match nothing at all is rejected.
+
+The pattern is compiled once to a deterministic automaton that takes a single
+step per byte, so memory is searched in a single pass no matter how many
+alternatives and gaps the pattern has. Memory regions are searched in
+parallel.
+
+With --max-mismatches, up to that many bytes of a match can be different from
+what the pattern expects, which helps find code that changed slightly. The
+number of bytes that were different is printed after the address of every
+match. This works with patterns of up to 64 bytes that always match the same
+number of bytes, so alternatives can only be of single bytes and gaps must
+have an exact size. Memory is still searched in a single pass, with a
+bit-parallel matcher that keeps track of every number of mismatches at once.
+
 Examples:
   Searching for exact sequence of bytes
         proctal pattern --pid=12345 -x "48 83 C0 01"
@@ -217,42 +433,250 @@ Examples:
   Searching for sequence with any value between E8 and 48 followed by 83 C0 01
         proctal pattern --pid=12345 -x "E8 ?? ?? ?? ??  48 83 C0 01"
 
+  Searching for a relative call or jump followed by a REX.W mov
+        proctal pattern --pid=12345 -x "(E8|E9) ??{4} {0,16} 4? 8B"
+
+  Searching for a conditional near jump
+        proctal pattern --pid=12345 -x "0F [80-8F]"
+
   Searching for patterns in program code
         proctal pattern --pid=12345 --program-code "48 83 C0 01"
 
+  Resolving the targets of relative calls
+        proctal pattern --pid=12345 -x "E8 <target:rel32 ??{4}>"
+
+  Resolving the address loaded by a RIP-relative mov
+        proctal pattern --pid=12345 -x "48 8B 05 <global:rel32 ??{4}>"
+
+  Searching for a sequence where up to 2 bytes may have changed
+        proctal pattern --pid=12345 -x --max-mismatches=2 "55 48 89 E5 48 83 EC 20 89 7D EC"
+
+
+  PID_ARGUMENT
+  -r, --read            Readable memory.
+  -w, --write           Writable memory.
+  -x, --execute         Executable memory.
+  --program-code        Program code in memory.
+  --max-mismatches=N    Allows up to N bytes of a match to be different.
+  --threads=N           Number of threads that go over memory. By default N is
+                        the number of processors.
+
+
+
+Usage: proctal regex REGEX
+Searches for regular expressions in memory.
+
+Outputs the starting address of each match.
+
+Expressions work on bytes. The following syntax is available:
+
+  .          Any byte
+  [...]      Any byte of the set, which can have ranges such as a-z
+  [^...]     Any byte not in the set
+  \d \w \s   Digits, word characters and whitespace
+  \D \W \S   Anything else
+  \xHH       The byte with the hexadecimal value HH
+  \n \r \t   Newline, carriage return and tab
+  \0         The zero byte
+  \C         The punctuation character C itself
+  (...)      Grouping
+  A|B        Either A or B
+  * + ?      Repeating 0 or more times, 1 or more times or at most once
+  {N} {N,}   Repeating exactly N times or at least N times
+  {N,M}      Repeating between N and M times
+
+Matches do not overlap and each one ends as soon as it can, so a+ finds every
+a on its own. An expression that can match nothing at all is rejected.
+
+The expression is compiled once to a deterministic automaton that takes a
+single step per byte. Memory regions are searched in parallel. When every match
+starts with the same bytes, memory is skimmed for them first.
+
+Examples:
+  Searching for session tokens
+        proctal regex --pid=12345 "session=[0-9a-f]{32}"
+
+  Searching for any of 2 words
+        proctal regex --pid=12345 -w "(user|admin)name"
+
 
   PID_ARGUMENT
   -r, --read            Readable memory.
   -w, --write           Writable memory.
   -x, --execute         Executable memory.
   --program-code        Program code in memory.
+  --threads=N           Number of threads that go over memory. By default N is
+                        the number of processors.
+
+
+
+Usage: proctal strings
+Finds printable strings in memory.
+
+Outputs the address of each string followed by the string itself, in a line.
+
+A string is a sequence of at least --min-length printable ASCII characters,
+including tabs. In UTF-16LE each character takes up 2 bytes and strings start
+at even addresses.
+
+Memory is split in chunks that several threads go through at once, so it does
+not have to be copied anywhere else first.
+
+Examples:
+  Finding strings of at least 8 characters in writable memory
+        proctal strings --pid=12345 -w --min-length=8
+
+  Finding strings stored in UTF-16LE
+        proctal strings --pid=12345 --text-charset=utf-16le
+
+
+  PID_ARGUMENT
+  -r, --read            Readable memory.
+  -w, --write           Writable memory.
+  -x, --execute         Executable memory.
+  --min-length=N        Smallest number of characters in a string. By default
+                        N is 4.
+  --text-charset=CHARSET
+                        How characters are stored. By default CHARSET is
+                        ascii. CHARSET can be:
+                        ascii
+                        utf-16le
+  --threads=N           Number of threads that go over memory. By default N is
+                        the number of processors.
 
 
 
 Usage: proctal freeze
-Freezes main thread of execution.
+Freezes all threads of execution.
 
 The program will be frozen as long as the command is executing. It will stop
 executing when it receives the SIGINT signal.
 
+Threads that are created while freezing are frozen as well.
+
 Examples:
   Freezing a process
         proctal freeze --pid=12345
 
+  Finding out how long it takes to freeze and unfreeze a process
+        proctal freeze --pid=12345 --latency
+
 
   PID_ARGUMENT
   -i, --input           Additionally to quitting when receiving SIGINT, will
                         read from standard input and quit when no more input is
                         available, whichever happens first.
+  --latency             Prints to standard error how many threads were frozen
+                        and how long it took to freeze and unfreeze them.
+
+
 
+Usage: proctal sample
+Finds out where a program spends its time.
 
+Samples are taken at a steady rate until the duration is over or the SIGINT
+signal is received. Every sample briefly freezes all threads of execution and
+reads the address of the instruction each one is at. Threads that are waiting
+are counted as well, so it shows where time goes rather than where the
+processor is busy.
+
+Outputs every address that was found followed by the number of times it was
+found, the most frequent first. When it finishes, prints to standard error how
+long the process was stopped for every sample, on average and at most.
+
+With --folded the stack of every thread is walked by following frame pointers
+and whole stacks are counted instead. Every line has the addresses of a stack
+from the outermost function inwards, separated by semicolons, followed by the
+count, which is the format flame graph tools take. Functions that do not keep
+a frame pointer make their callers go missing or be made up.
+
+Examples:
+  Sampling a process for 10 seconds
+        proctal sample --pid=12345 --duration=10
 
-Usage: proctal watch
-Watches for memory accesses in main thread of execution.
+  Sampling stacks 1000 times a second until interrupted
+        proctal sample --pid=12345 --hz=1000 --folded
+
+
+  PID_ARGUMENT
+  --hz=F                Number of samples per second. By default F is 99.
+  --duration=SECONDS    Stop after SECONDS seconds instead of when
+                        interrupted.
+  --folded              Count whole stacks and print them folded.
+  --depth=N             Largest number of addresses in a stack, 64 by default.
+                        Requires --folded.
+
+
+
+Usage: proctal watch [WATCHPOINTS...]
+Watches for memory accesses in all threads of execution.
+
+Outputs the address of the instruction that made the access followed by the ID
+of the thread that ran it. Threads that are created while watching are watched
+as well.
 
 It's important to note that this may not report the actual instruction that
 accessed the address.
 
+Up to 4 addresses can be watched at once, one given with --address and the
+others as watchpoints that look like this:
+
+  ADDRESS:SIZE:MODE
+
+SIZE is the number of bytes to watch, which can be 1, 2, 4 or 8, and ADDRESS
+must be aligned to it. MODE is made of the letters r, w and x. Both can be
+left out, in which case --size and the -r, -w and -x options are used. When
+more than one address is watched, the address that was accessed is printed
+after the ID of the thread.
+
+All watchpoints are set up in the debug registers once and the process is
+only stopped when one of them is hit.
+
+With --pages the pages that watchpoints are in are protected instead, which
+lifts the limits on SIZE, so whole buffers and structures can be watched. Any
+access to those pages stops the process, even outside of watchpoints, which
+makes it a lot slower. Execution and reads alone cannot be watched this way,
+and accesses made by other threads while one is being let through can be
+missed. The kernel does not stop the process when it accesses those pages
+itself, so system calls such as read(2) or recv(2) into a watched buffer fail
+with EFAULT.
+
+With --perf the kernel sets up the debug registers through perf events and
+the process is never stopped, apart from a moment at the start. Accesses are
+reported after the fact, and with --sample-period only one out of every so
+many of them is. Every watched address takes a file descriptor for every
+thread, and for every processor as well unless only counting. When perf
+events are not available or the limit on open files is reached it falls back
+to the debug registers.
+
+With --count only the number of accesses to every watchpoint is printed, when
+watching stops, after the address of the watchpoint. With --perf the kernel
+counts them without stopping the process at all.
+
+With --aggregate nothing is printed while watching. Instead, accesses are
+counted by instruction and when watching stops every instruction is printed
+once, the most frequent first, followed by the number of accesses it made and
+the times of the first and last one, in seconds since watching started.
+
+With --values the watched bytes are read every time they are accessed, while
+the thread that accessed them is still stopped, and the value they had before
+and the value they have after are printed at the end of the line. The value
+is taken from the start of the watched bytes. With --when
+only the accesses after which the value passes a condition are reported and
+the others are let go right away. A condition is made of comparisons
+separated by colons:
+
+  COMPARISON=VALUE:COMPARISON=VALUE...
+
+COMPARISON can be eq, ne, gt, gte, lt and lte, or changed, unchanged,
+increased and decreased, which take no value and compare against the value
+from before the access. Values are interpreted according to the type options.
+
+Many processes can be watched at once by giving --pid a list of PIDs separated
+by commas, which is meant for processes that run the same program. Accesses
+in all of them are reported as they happen and counted together, and a
+process that exits stops being watched while the others go on.
+
 Examples:
   Watching for any instruction reading or writing to 1c09346
         proctal watch --pid=12345 --address=1c09346 -rw
@@ -260,14 +684,50 @@ Examples:
   Watching for 1c09346 being executed as an instruction
         proctal watch --pid=12345 --address=1c09346 -x
 
+  Watching for writes to 4 fields of a structure
+        proctal watch --pid=12345 -w 1c09340:4 1c09344:4 1c09348:8 1c09350:2
 
-  PID_ARGUMENT
+  Counting the instructions that write to 1c09346, every 5 seconds
+        proctal watch --pid=12345 --address=1c09346 -w --aggregate --interval=5
+
+  Watching for writes to a 4096 byte buffer at 1c0a000
+        proctal watch --pid=12345 -w 1c0a000:4096 --pages
+
+  Counting writes to 1c09346 without stopping the process
+        proctal watch --pid=12345 --address=1c09346 -w --perf --count
+
+  Watching for writes that set a 32-bit integer at 1c09348 above 100
+        proctal watch --pid=12345 -w 1c09348:4 --type=integer --integer-size=32 --values --when=gt=100
+
+  Counting the instructions that write to 1c09346 in 3 worker processes
+        proctal watch --pid=12345,12346,12347 --address=1c09346 -w --aggregate
+
+
+  -p, --pid=PID         Process ID (PID) of a program, or a list of them
+                        separated by commas.
   -a, --address=ADDR    Address to watch.
+  --size=SIZE           Number of bytes to watch. By default SIZE is 1.
+  --pages               Watch by protecting pages instead of with the debug
+                        registers. read(2) and recv(2) into those pages fail
+                        with EFAULT.
   -r, --read            Read access.
   -w, --write           Write access.
   -x, --execute         Execute instruction.
   --unique              Print an address only once.
-
+  --aggregate           Count accesses by instruction and print them when
+                        watching stops.
+  --interval=SECONDS    Also print the accesses counted so far every SECONDS
+                        seconds. Requires --aggregate or --count.
+  --count               Only count accesses to every watchpoint and print
+                        the counts when watching stops.
+  --perf                Watch with perf events, which do not stop the
+                        process.
+  --sample-period=N     Report one out of every N accesses. Requires --perf.
+                        By default N is 1.
+  --values              Print the value before and after every access.
+  --when=CONDITION      Only report accesses after which the value passes
+                        CONDITION.
+  TYPE_ARGUMENTS
 
 
 Usage: proctal execute
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "cli/yuck/main.h"
 #include "cli/cmd/alloc.h"
@@ -7,10 +8,16 @@
 #include "cli/cmd/dump.h"
 #include "cli/cmd/execute.h"
 #include "cli/cmd/freeze.h"
+#include "cli/cmd/layout.h"
 #include "cli/cmd/measure.h"
 #include "cli/cmd/pattern.h"
+#include "cli/cmd/pointerscan.h"
 #include "cli/cmd/read.h"
+#include "cli/cmd/regex.h"
 #include "cli/cmd/search.h"
+#include "cli/cmd/session.h"
+#include "cli/cmd/strings.h"
+#include "cli/cmd/sample.h"
 #include "cli/cmd/watch.h"
 #include "cli/cmd/write.h"
 #include "cli/parser.h"
@@ -246,7 +253,9 @@ static inline int cli_type_arguments_##NAME(struct type_arguments *type, YUCK_TY
 CLI_PARSE_TYPE_ARGUMENTS(read, struct yuck_cmd_read_s)
 CLI_PARSE_TYPE_ARGUMENTS(write, struct yuck_cmd_write_s)
 CLI_PARSE_TYPE_ARGUMENTS(search, struct yuck_cmd_search_s)
+CLI_PARSE_TYPE_ARGUMENTS(session, struct yuck_cmd_session_s)
 CLI_PARSE_TYPE_ARGUMENTS(measure, struct yuck_cmd_measure_s)
+CLI_PARSE_TYPE_ARGUMENTS(watch, struct yuck_cmd_watch_s)
 
 #undef CLI_TYPE_ARGUMENTS
 
@@ -440,6 +449,68 @@ static struct cli_cmd_write_arg *create_cli_cmd_write_arg(yuck_t *yuck_arg)
 	return arg;
 }
 
+/*
+ * Encodes a string, one character at a time, in the charset of a text value.
+ * Characters are taken from the string as they appear in UTF-8.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int encode_text(cli_val v, const char *s, char **bytes, size_t *size)
+{
+	size_t char_size = cli_val_sizeof(v);
+	size_t length = strlen(s);
+
+	// No charset takes up more bytes than UTF-8 does per character.
+	*bytes = malloc(length * char_size);
+	*size = 0;
+
+	if (*bytes == NULL) {
+		return 0;
+	}
+
+	while (*s != '\0') {
+		unsigned char lead = *s;
+		size_t n = lead < 0x80 ? 1
+			: (lead & 0xE0) == 0xC0 ? 2
+			: (lead & 0xF0) == 0xE0 ? 3
+			: (lead & 0xF8) == 0xF0 ? 4
+			: 0;
+
+		if (n == 0) {
+			free(*bytes);
+			return 0;
+		}
+
+		char character[5] = { '\0' };
+
+		for (size_t i = 0; i < n; ++i) {
+			if (s[i] == '\0') {
+				// Cut short.
+				free(*bytes);
+				return 0;
+			}
+
+			character[i] = s[i];
+		}
+
+		if (!cli_val_parse(v, character)) {
+			free(*bytes);
+			return 0;
+		}
+
+		memcpy(*bytes + *size, cli_val_raw(v), char_size);
+		*size += char_size;
+		s += n;
+	}
+
+	if (*size == 0) {
+		free(*bytes);
+		return 0;
+	}
+
+	return 1;
+}
+
 static void destroy_cli_cmd_search_arg(struct cli_cmd_search_arg *arg)
 {
 	if (arg->value != cli_val_nil()) {
@@ -464,6 +535,7 @@ static void destroy_cli_cmd_search_arg(struct cli_cmd_search_arg *arg)
 
 #undef DESTROY_COMPARE_ARG
 
+	free(arg->text);
 	free(arg);
 }
 
@@ -482,6 +554,12 @@ static struct cli_cmd_search_arg *create_cli_cmd_search_arg(yuck_t *yuck_arg)
 	arg->dec = 0;
 	arg->dec_up_to = 0;
 	arg->input = 0;
+	arg->in_file = yuck_arg->search.in_file_arg;
+	arg->any_integer_size = 0;
+	arg->epsilon = 0;
+	arg->round = 0;
+	arg->text = NULL;
+	arg->ignore_case = yuck_arg->search.ignore_case_flag == 1;
 
 	arg->read = yuck_arg->search.read_flag == 1;
 	arg->write = yuck_arg->search.write_flag == 1;
@@ -511,12 +589,35 @@ static struct cli_cmd_search_arg *create_cli_cmd_search_arg(yuck_t *yuck_arg)
 		return NULL;
 	}
 
+	// Integers of every size are searched for as 64-bit integers.
+	if (yuck_arg->search.integer_size_arg != NULL
+		&& strcmp(yuck_arg->search.integer_size_arg, "any") == 0) {
+		arg->any_integer_size = 1;
+		yuck_arg->search.integer_size_arg = "64";
+	}
+
 	struct type_arguments type_args;
 	if (!cli_type_arguments_search(&type_args, &yuck_arg->search)) {
 		destroy_cli_cmd_search_arg(arg);
 		return NULL;
 	}
 
+	if (arg->any_integer_size) {
+		if (type_args.type != CLI_VAL_TYPE_INTEGER) {
+			fputs("Only integers can be of any size.\n", stderr);
+			destroy_cli_cmd_search_arg(arg);
+			return NULL;
+		}
+
+		if (yuck_arg->search.input_flag || arg->in_file != NULL) {
+			fputs("Integers of any size cannot be searched with --input or --in-file.\n", stderr);
+			destroy_cli_cmd_search_arg(arg);
+			return NULL;
+		}
+
+		arg->integer_sign = type_args.integer_sign;
+	}
+
 	if (type_args.type == CLI_VAL_TYPE_INSTRUCTION) {
 		fprintf(stderr, "Searching for assembly code is not supported.\n");
 		destroy_cli_cmd_search_arg(arg);
@@ -535,6 +636,83 @@ static struct cli_cmd_search_arg *create_cli_cmd_search_arg(yuck_t *yuck_arg)
 		arg->input = 1;
 	}
 
+	if (yuck_arg->search.epsilon_arg != NULL) {
+		arg->epsilon = 1;
+
+		if (!cli_parse_double(yuck_arg->search.epsilon_arg, &arg->epsilon_value)
+			|| !(arg->epsilon_value >= 0)) {
+			fputs("Invalid epsilon.\n", stderr);
+			destroy_cli_cmd_search_arg(arg);
+			return NULL;
+		}
+	}
+
+	if (yuck_arg->search.round_arg != NULL) {
+		arg->round = 1;
+
+		if (!cli_parse_int(yuck_arg->search.round_arg, &arg->round_value)
+			|| arg->round_value < 0
+			|| arg->round_value > 17) {
+			fputs("Invalid number of decimal places.\n", stderr);
+			destroy_cli_cmd_search_arg(arg);
+			return NULL;
+		}
+	}
+
+	if (arg->epsilon || arg->round) {
+		if (arg->epsilon && arg->round) {
+			fputs("Cannot use --epsilon and --round together.\n", stderr);
+			destroy_cli_cmd_search_arg(arg);
+			return NULL;
+		}
+
+		if (type_args.type != CLI_VAL_TYPE_IEEE754
+			|| type_args.ieee754_precision == CLI_VAL_IEEE754_PRECISION_EXTENDED) {
+			fputs("Only single and double precision floating point numbers can be approximately equal.\n", stderr);
+			destroy_cli_cmd_search_arg(arg);
+			return NULL;
+		}
+
+		if (yuck_arg->search.eq_arg == NULL) {
+			fputs("--epsilon and --round need a value to compare against in --eq.\n", stderr);
+			destroy_cli_cmd_search_arg(arg);
+			return NULL;
+		}
+
+		if (arg->in_file != NULL) {
+			fputs("--epsilon and --round cannot be used with --in-file.\n", stderr);
+			destroy_cli_cmd_search_arg(arg);
+			return NULL;
+		}
+	}
+
+	if (type_args.type == CLI_VAL_TYPE_TEXT
+		&& yuck_arg->search.eq_arg != NULL
+		&& !arg->input) {
+		if (arg->in_file != NULL
+			|| yuck_arg->search.ne_arg != NULL
+			|| yuck_arg->search.gt_arg != NULL
+			|| yuck_arg->search.gte_arg != NULL
+			|| yuck_arg->search.lt_arg != NULL
+			|| yuck_arg->search.lte_arg != NULL) {
+			fputs("Text in --eq cannot be combined with other filters.\n", stderr);
+			destroy_cli_cmd_search_arg(arg);
+			return NULL;
+		}
+
+		if (!encode_text(arg->value, yuck_arg->search.eq_arg, &arg->text, &arg->text_size)) {
+			fputs("Invalid value for --eq.\n", stderr);
+			destroy_cli_cmd_search_arg(arg);
+			return NULL;
+		}
+	}
+
+	if (arg->ignore_case && arg->text == NULL) {
+		fputs("--ignore-case needs text to look for in --eq.\n", stderr);
+		destroy_cli_cmd_search_arg(arg);
+		return NULL;
+	}
+
 #define FORCE_POSITIVE(NAME) \
 	if (yuck_arg->search.NAME##_arg != NULL \
 		&& (strcmp("0", yuck_arg->search.NAME##_arg) == 0 \
@@ -592,136 +770,1147 @@ static struct cli_cmd_search_arg *create_cli_cmd_search_arg(yuck_t *yuck_arg)
 	return arg;
 }
 
-static void destroy_cli_cmd_pattern_arg(struct cli_cmd_pattern_arg *arg)
+static void destroy_cli_cmd_session_arg(struct cli_cmd_session_arg *arg)
 {
+	if (arg->value != cli_val_nil()) {
+		cli_val_destroy(arg->value);
+	}
+
 	free(arg);
 }
 
-static struct cli_cmd_pattern_arg *create_cli_cmd_pattern_arg(yuck_t *yuck_arg)
+static struct cli_cmd_session_arg *create_cli_cmd_session_arg(yuck_t *yuck_arg)
 {
-	struct cli_cmd_pattern_arg *arg = malloc(sizeof(*arg));
+	struct cli_cmd_session_arg *arg = malloc(sizeof(*arg));
+	arg->value = cli_val_nil();
 
-	if (yuck_arg->cmd != PROCTAL_CMD_PATTERN) {
+	arg->read = yuck_arg->session.read_flag == 1;
+	arg->write = yuck_arg->session.write_flag == 1;
+	arg->execute = yuck_arg->session.execute_flag == 1;
+	arg->hash_pages = yuck_arg->session.hash_pages_flag == 1;
+
+	if (yuck_arg->cmd != PROCTAL_CMD_SESSION) {
 		fputs("Wrong command.\n", stderr);
-		destroy_cli_cmd_pattern_arg(arg);
+		destroy_cli_cmd_session_arg(arg);
 		return NULL;
 	}
 
-	if (yuck_arg->nargs != 1) {
-		fputs("Incorrect number of arguments.\n", stderr);
-		destroy_cli_cmd_pattern_arg(arg);
+	if (yuck_arg->nargs != 0) {
+		fputs("This command only accepts options.\n", stderr);
+		destroy_cli_cmd_session_arg(arg);
 		return NULL;
 	}
 
-	if (yuck_arg->pattern.pid_arg == NULL) {
+	if (yuck_arg->session.pid_arg == NULL) {
 		fputs("OPTION -p, --pid is required.\n", stderr);
-		destroy_cli_cmd_pattern_arg(arg);
+		destroy_cli_cmd_session_arg(arg);
 		return NULL;
 	}
 
-	if (!cli_parse_int(yuck_arg->pattern.pid_arg, &arg->pid)) {
+	if (!cli_parse_int(yuck_arg->session.pid_arg, &arg->pid)) {
 		fputs("Invalid pid.\n", stderr);
-		destroy_cli_cmd_pattern_arg(arg);
+		destroy_cli_cmd_session_arg(arg);
 		return NULL;
 	}
 
-	arg->pattern = yuck_arg->args[0];
+	struct type_arguments type_args;
+	if (!cli_type_arguments_session(&type_args, &yuck_arg->session)) {
+		destroy_cli_cmd_session_arg(arg);
+		return NULL;
+	}
 
-	arg->read = yuck_arg->pattern.read_flag == 1;
-	arg->write = yuck_arg->pattern.write_flag == 1;
-	arg->execute = yuck_arg->pattern.execute_flag == 1;
-	arg->program_code = yuck_arg->pattern.program_code_flag == 1;
+	if (type_args.type == CLI_VAL_TYPE_INSTRUCTION) {
+		fprintf(stderr, "Searching for assembly code is not supported.\n");
+		destroy_cli_cmd_session_arg(arg);
+		return NULL;
+	}
+
+	arg->value = create_cli_val_from_type_arguments(&type_args);
+
+	if (arg->value == cli_val_nil()) {
+		fputs("Invalid type arguments.\n", stderr);
+		destroy_cli_cmd_session_arg(arg);
+		return NULL;
+	}
 
 	return arg;
 }
 
-static void destroy_cli_cmd_freeze_arg(struct cli_cmd_freeze_arg *arg)
+static void destroy_cli_cmd_pointerscan_arg(struct cli_cmd_pointerscan_arg *arg)
 {
 	free(arg);
 }
 
-static struct cli_cmd_freeze_arg *create_cli_cmd_freeze_arg(yuck_t *yuck_arg)
+static struct cli_cmd_pointerscan_arg *create_cli_cmd_pointerscan_arg(yuck_t *yuck_arg)
 {
-	struct cli_cmd_freeze_arg *arg = malloc(sizeof(*arg));
+	struct cli_cmd_pointerscan_arg *arg = malloc(sizeof(*arg));
+	arg->depth = 3;
+	arg->max_offset = 4096;
+	arg->threads = 0;
 
-	if (yuck_arg->cmd != PROCTAL_CMD_FREEZE) {
+	if (yuck_arg->cmd != PROCTAL_CMD_POINTERSCAN) {
 		fputs("Wrong command.\n", stderr);
-		destroy_cli_cmd_freeze_arg(arg);
+		destroy_cli_cmd_pointerscan_arg(arg);
 		return NULL;
 	}
 
 	if (yuck_arg->nargs != 0) {
-		fputs("Too many arguments.\n", stderr);
-		destroy_cli_cmd_freeze_arg(arg);
+		fputs("This command only accepts options.\n", stderr);
+		destroy_cli_cmd_pointerscan_arg(arg);
 		return NULL;
 	}
 
-	if (yuck_arg->freeze.pid_arg == NULL) {
+	if (yuck_arg->pointerscan.pid_arg == NULL) {
 		fputs("OPTION -p, --pid is required.\n", stderr);
-		destroy_cli_cmd_freeze_arg(arg);
+		destroy_cli_cmd_pointerscan_arg(arg);
 		return NULL;
 	}
 
-	if (!cli_parse_int(yuck_arg->freeze.pid_arg, &arg->pid)) {
+	if (!cli_parse_int(yuck_arg->pointerscan.pid_arg, &arg->pid)) {
 		fputs("Invalid pid.\n", stderr);
-		destroy_cli_cmd_freeze_arg(arg);
+		destroy_cli_cmd_pointerscan_arg(arg);
 		return NULL;
 	}
 
-	arg->input = yuck_arg->freeze.input_flag == 1;
+	if (yuck_arg->pointerscan.address_arg == NULL) {
+		fputs("OPTION -a, --address is required.\n", stderr);
+		destroy_cli_cmd_pointerscan_arg(arg);
+		return NULL;
+	}
+
+	if (!cli_parse_address(yuck_arg->pointerscan.address_arg, &arg->address)) {
+		fputs("Invalid address.\n", stderr);
+		destroy_cli_cmd_pointerscan_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->pointerscan.depth_arg != NULL
+		&& (!cli_parse_int(yuck_arg->pointerscan.depth_arg, &arg->depth) || arg->depth < 1)) {
+		fputs("Invalid depth.\n", stderr);
+		destroy_cli_cmd_pointerscan_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->pointerscan.max_offset_arg != NULL) {
+		unsigned long max_offset;
+
+		if (!cli_parse_ulong(yuck_arg->pointerscan.max_offset_arg, &max_offset)) {
+			fputs("Invalid max offset.\n", stderr);
+			destroy_cli_cmd_pointerscan_arg(arg);
+			return NULL;
+		}
+
+		arg->max_offset = max_offset;
+	}
+
+	if (yuck_arg->pointerscan.threads_arg != NULL
+		&& (!cli_parse_int(yuck_arg->pointerscan.threads_arg, &arg->threads) || arg->threads < 1)) {
+		fputs("Invalid number of threads.\n", stderr);
+		destroy_cli_cmd_pointerscan_arg(arg);
+		return NULL;
+	}
 
 	return arg;
 }
 
-static void destroy_cli_cmd_watch_arg(struct cli_cmd_watch_arg *arg)
+/*
+ * Parses the type of a structure field. Types are given in a short form since
+ * a field is described in a single argument.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int parse_layout_field_type(const char *s, struct type_arguments *type)
+{
+	static const struct {
+		const char *name;
+		enum cli_val_integer_size size;
+		enum cli_val_integer_sign sign;
+	} integers[] = {
+		{ "i8", CLI_VAL_INTEGER_SIZE_8, CLI_VAL_INTEGER_SIGN_2SCMPL },
+		{ "i16", CLI_VAL_INTEGER_SIZE_16, CLI_VAL_INTEGER_SIGN_2SCMPL },
+		{ "i32", CLI_VAL_INTEGER_SIZE_32, CLI_VAL_INTEGER_SIGN_2SCMPL },
+		{ "i64", CLI_VAL_INTEGER_SIZE_64, CLI_VAL_INTEGER_SIGN_2SCMPL },
+		{ "u8", CLI_VAL_INTEGER_SIZE_8, CLI_VAL_INTEGER_SIGN_UNSIGNED },
+		{ "u16", CLI_VAL_INTEGER_SIZE_16, CLI_VAL_INTEGER_SIGN_UNSIGNED },
+		{ "u32", CLI_VAL_INTEGER_SIZE_32, CLI_VAL_INTEGER_SIGN_UNSIGNED },
+		{ "u64", CLI_VAL_INTEGER_SIZE_64, CLI_VAL_INTEGER_SIGN_UNSIGNED },
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(integers); ++i) {
+		if (strcmp(s, integers[i].name) == 0) {
+			type->type = CLI_VAL_TYPE_INTEGER;
+			type->integer_endianness = DEFAULT_VAL_INTEGER_ENDIANNESS;
+			type->integer_size = integers[i].size;
+			type->integer_sign = integers[i].sign;
+			return 1;
+		}
+	}
+
+	if (strcmp(s, "f32") == 0) {
+		type->type = CLI_VAL_TYPE_IEEE754;
+		type->ieee754_precision = CLI_VAL_IEEE754_PRECISION_SINGLE;
+		return 1;
+	}
+
+	if (strcmp(s, "f64") == 0) {
+		type->type = CLI_VAL_TYPE_IEEE754;
+		type->ieee754_precision = CLI_VAL_IEEE754_PRECISION_DOUBLE;
+		return 1;
+	}
+
+	if (strcmp(s, "byte") == 0) {
+		type->type = CLI_VAL_TYPE_BYTE;
+		return 1;
+	}
+
+	if (strcmp(s, "address") == 0) {
+		type->type = CLI_VAL_TYPE_ADDRESS;
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Parses a structure field, which looks like OFFSET:TYPE followed by any
+ * number of :COMPARISON=VALUE.
+ *
+ * The field must be deinitialized even on failure.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int parse_layout_field(const char *s, struct cli_cmd_layout_field *field)
+{
+	cli_val nil = cli_val_nil();
+
+	field->value = nil;
+	field->compare.eq = nil;
+	field->compare.ne = nil;
+	field->compare.gt = nil;
+	field->compare.gte = nil;
+	field->compare.lt = nil;
+	field->compare.lte = nil;
+
+	char *copy = strdup(s);
+
+	if (copy == NULL) {
+		fputs("Ran out of memory.\n", stderr);
+		return 0;
+	}
+
+	char *save;
+	char *offset = strtok_r(copy, ":", &save);
+	char *type = strtok_r(NULL, ":", &save);
+
+	if (offset == NULL || type == NULL) {
+		fprintf(stderr, "Field %s must at least have an offset and a type.\n", s);
+		free(copy);
+		return 0;
+	}
+
+	// Offsets are in hexadecimal just like addresses.
+	void *offset_value;
+
+	if (!cli_parse_address(offset, &offset_value)) {
+		fprintf(stderr, "Invalid offset in field %s.\n", s);
+		free(copy);
+		return 0;
+	}
+
+	field->offset = (uintptr_t) offset_value;
+
+	struct type_arguments type_args;
+
+	if (!parse_layout_field_type(type, &type_args)) {
+		fprintf(stderr, "Invalid type in field %s.\n", s);
+		free(copy);
+		return 0;
+	}
+
+	field->value = create_cli_val_from_type_arguments(&type_args);
+
+	if (field->value == nil) {
+		fputs("Invalid type arguments.\n", stderr);
+		free(copy);
+		return 0;
+	}
+
+	char *comparison;
+
+	while ((comparison = strtok_r(NULL, ":", &save)) != NULL) {
+		char *value = strchr(comparison, '=');
+		cli_val *compare = NULL;
+
+		if (value != NULL) {
+			*value++ = '\0';
+		}
+
+#define GET_COMPARISON(NAME) \
+		if (strcmp(comparison, #NAME) == 0) { \
+			compare = &field->compare.NAME; \
+		}
+
+		GET_COMPARISON(eq);
+		GET_COMPARISON(ne);
+		GET_COMPARISON(gt);
+		GET_COMPARISON(gte);
+		GET_COMPARISON(lt);
+		GET_COMPARISON(lte);
+
+#undef GET_COMPARISON
+
+		if (compare == NULL || value == NULL) {
+			fprintf(stderr, "Invalid comparison in field %s.\n", s);
+			free(copy);
+			return 0;
+		}
+
+		if (*compare != nil) {
+			cli_val_destroy(*compare);
+		}
+
+		*compare = create_cli_val_from_type_arguments(&type_args);
+
+		if (*compare == nil || !cli_val_parse(*compare, value)) {
+			fprintf(stderr, "Invalid value in field %s.\n", s);
+			free(copy);
+			return 0;
+		}
+	}
+
+	free(copy);
+
+	return 1;
+}
+
+static void deinit_layout_field(struct cli_cmd_layout_field *field)
+{
+	cli_val nil = cli_val_nil();
+	cli_val *vals[] = {
+		&field->value,
+		&field->compare.eq,
+		&field->compare.ne,
+		&field->compare.gt,
+		&field->compare.gte,
+		&field->compare.lt,
+		&field->compare.lte,
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(vals); ++i) {
+		if (*vals[i] != nil) {
+			cli_val_destroy(*vals[i]);
+		}
+	}
+}
+
+static void destroy_cli_cmd_layout_arg(struct cli_cmd_layout_arg *arg)
 {
+	for (size_t i = 0; i < arg->field_count; ++i) {
+		deinit_layout_field(&arg->fields[i]);
+	}
+
+	free(arg->fields);
 	free(arg);
 }
 
-static struct cli_cmd_watch_arg *create_cli_cmd_watch_arg(yuck_t *yuck_arg)
+static struct cli_cmd_layout_arg *create_cli_cmd_layout_arg(yuck_t *yuck_arg)
 {
-	struct cli_cmd_watch_arg *arg = malloc(sizeof(*arg));
+	struct cli_cmd_layout_arg *arg = malloc(sizeof(*arg));
+	arg->fields = NULL;
+	arg->field_count = 0;
 
-	if (yuck_arg->cmd != PROCTAL_CMD_WATCH) {
+	if (yuck_arg->cmd != PROCTAL_CMD_LAYOUT) {
 		fputs("Wrong command.\n", stderr);
-		destroy_cli_cmd_watch_arg(arg);
+		destroy_cli_cmd_layout_arg(arg);
 		return NULL;
 	}
 
-	if (yuck_arg->nargs != 0) {
-		fputs("Too many arguments.\n", stderr);
-		destroy_cli_cmd_watch_arg(arg);
+	if (yuck_arg->nargs == 0) {
+		fputs("You must provide at least 1 field.\n", stderr);
+		destroy_cli_cmd_layout_arg(arg);
 		return NULL;
 	}
 
-	if (yuck_arg->watch.pid_arg == NULL) {
+	if (yuck_arg->layout.pid_arg == NULL) {
 		fputs("OPTION -p, --pid is required.\n", stderr);
-		destroy_cli_cmd_watch_arg(arg);
+		destroy_cli_cmd_layout_arg(arg);
 		return NULL;
 	}
 
-	if (!cli_parse_int(yuck_arg->watch.pid_arg, &arg->pid)) {
+	if (!cli_parse_int(yuck_arg->layout.pid_arg, &arg->pid)) {
 		fputs("Invalid pid.\n", stderr);
-		destroy_cli_cmd_watch_arg(arg);
+		destroy_cli_cmd_layout_arg(arg);
 		return NULL;
 	}
 
-	if (yuck_arg->watch.address_arg == NULL) {
-		fputs("OPTION -a, --address is required.\n", stderr);
-		destroy_cli_cmd_watch_arg(arg);
+	arg->fields = malloc(yuck_arg->nargs * sizeof(*arg->fields));
+
+	if (arg->fields == NULL) {
+		fputs("Ran out of memory.\n", stderr);
+		destroy_cli_cmd_layout_arg(arg);
 		return NULL;
 	}
 
-	if (!cli_parse_address(yuck_arg->watch.address_arg, &arg->address)) {
-		fputs("Invalid address.\n", stderr);
-		destroy_cli_cmd_watch_arg(arg);
+	for (size_t i = 0; i < yuck_arg->nargs; ++i) {
+		int ok = parse_layout_field(yuck_arg->args[i], &arg->fields[i]);
+
+		// Counting it regardless so that whatever it holds gets
+		// destroyed.
+		arg->field_count += 1;
+
+		if (!ok) {
+			destroy_cli_cmd_layout_arg(arg);
+			return NULL;
+		}
+	}
+
+	arg->read = yuck_arg->layout.read_flag == 1;
+	arg->write = yuck_arg->layout.write_flag == 1;
+	arg->execute = yuck_arg->layout.execute_flag == 1;
+
+	return arg;
+}
+
+static void destroy_cli_cmd_regex_arg(struct cli_cmd_regex_arg *arg)
+{
+	free(arg);
+}
+
+static struct cli_cmd_regex_arg *create_cli_cmd_regex_arg(yuck_t *yuck_arg)
+{
+	struct cli_cmd_regex_arg *arg = malloc(sizeof(*arg));
+	arg->threads = 0;
+
+	if (yuck_arg->cmd != PROCTAL_CMD_REGEX) {
+		fputs("Wrong command.\n", stderr);
+		destroy_cli_cmd_regex_arg(arg);
 		return NULL;
 	}
 
-	arg->read = yuck_arg->watch.read_flag == 1;
-	arg->write = yuck_arg->watch.write_flag == 1;
-	arg->execute = yuck_arg->watch.execute_flag == 1;
-	arg->unique = yuck_arg->watch.unique_flag == 1;
+	if (yuck_arg->nargs != 1) {
+		fputs("Incorrect number of arguments.\n", stderr);
+		destroy_cli_cmd_regex_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->regex.pid_arg == NULL) {
+		fputs("OPTION -p, --pid is required.\n", stderr);
+		destroy_cli_cmd_regex_arg(arg);
+		return NULL;
+	}
+
+	if (!cli_parse_int(yuck_arg->regex.pid_arg, &arg->pid)) {
+		fputs("Invalid pid.\n", stderr);
+		destroy_cli_cmd_regex_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->regex.threads_arg != NULL
+		&& (!cli_parse_int(yuck_arg->regex.threads_arg, &arg->threads) || arg->threads < 1)) {
+		fputs("Invalid number of threads.\n", stderr);
+		destroy_cli_cmd_regex_arg(arg);
+		return NULL;
+	}
+
+	arg->regex = yuck_arg->args[0];
+
+	arg->read = yuck_arg->regex.read_flag == 1;
+	arg->write = yuck_arg->regex.write_flag == 1;
+	arg->execute = yuck_arg->regex.execute_flag == 1;
+	arg->program_code = yuck_arg->regex.program_code_flag == 1;
+
+	return arg;
+}
+
+static void destroy_cli_cmd_strings_arg(struct cli_cmd_strings_arg *arg)
+{
+	free(arg);
+}
+
+static struct cli_cmd_strings_arg *create_cli_cmd_strings_arg(yuck_t *yuck_arg)
+{
+	struct cli_cmd_strings_arg *arg = malloc(sizeof(*arg));
+	arg->min_length = 4;
+	arg->charset = DEFAULT_VAL_TEXT_CHARSET;
+	arg->threads = 0;
+
+	if (yuck_arg->cmd != PROCTAL_CMD_STRINGS) {
+		fputs("Wrong command.\n", stderr);
+		destroy_cli_cmd_strings_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->nargs != 0) {
+		fputs("This command only accepts options.\n", stderr);
+		destroy_cli_cmd_strings_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->strings.pid_arg == NULL) {
+		fputs("OPTION -p, --pid is required.\n", stderr);
+		destroy_cli_cmd_strings_arg(arg);
+		return NULL;
+	}
+
+	if (!cli_parse_int(yuck_arg->strings.pid_arg, &arg->pid)) {
+		fputs("Invalid pid.\n", stderr);
+		destroy_cli_cmd_strings_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->strings.min_length_arg != NULL) {
+		unsigned long min_length;
+
+		if (!cli_parse_ulong(yuck_arg->strings.min_length_arg, &min_length) || min_length < 1) {
+			fputs("Invalid minimum length.\n", stderr);
+			destroy_cli_cmd_strings_arg(arg);
+			return NULL;
+		}
+
+		arg->min_length = min_length;
+	}
+
+	if (yuck_arg->strings.text_charset_arg != NULL
+		&& !cli_parse_val_text_charset(yuck_arg->strings.text_charset_arg, &arg->charset)) {
+		fputs("Invalid character set.\n", stderr);
+		destroy_cli_cmd_strings_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->strings.threads_arg != NULL
+		&& (!cli_parse_int(yuck_arg->strings.threads_arg, &arg->threads) || arg->threads < 1)) {
+		fputs("Invalid number of threads.\n", stderr);
+		destroy_cli_cmd_strings_arg(arg);
+		return NULL;
+	}
+
+	arg->read = yuck_arg->strings.read_flag == 1;
+	arg->write = yuck_arg->strings.write_flag == 1;
+	arg->execute = yuck_arg->strings.execute_flag == 1;
+
+	return arg;
+}
+
+static void destroy_cli_cmd_pattern_arg(struct cli_cmd_pattern_arg *arg)
+{
+	free(arg);
+}
+
+static struct cli_cmd_pattern_arg *create_cli_cmd_pattern_arg(yuck_t *yuck_arg)
+{
+	struct cli_cmd_pattern_arg *arg = malloc(sizeof(*arg));
+	arg->threads = 0;
+	arg->approximate = 0;
+	arg->max_mismatches = 0;
+
+	if (yuck_arg->cmd != PROCTAL_CMD_PATTERN) {
+		fputs("Wrong command.\n", stderr);
+		destroy_cli_cmd_pattern_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->nargs != 1) {
+		fputs("Incorrect number of arguments.\n", stderr);
+		destroy_cli_cmd_pattern_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->pattern.pid_arg == NULL) {
+		fputs("OPTION -p, --pid is required.\n", stderr);
+		destroy_cli_cmd_pattern_arg(arg);
+		return NULL;
+	}
+
+	if (!cli_parse_int(yuck_arg->pattern.pid_arg, &arg->pid)) {
+		fputs("Invalid pid.\n", stderr);
+		destroy_cli_cmd_pattern_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->pattern.threads_arg != NULL
+		&& (!cli_parse_int(yuck_arg->pattern.threads_arg, &arg->threads) || arg->threads < 1)) {
+		fputs("Invalid number of threads.\n", stderr);
+		destroy_cli_cmd_pattern_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->pattern.max_mismatches_arg != NULL) {
+		arg->approximate = 1;
+
+		if (!cli_parse_int(yuck_arg->pattern.max_mismatches_arg, &arg->max_mismatches)
+			|| arg->max_mismatches < 0) {
+			fputs("Invalid number of mismatches.\n", stderr);
+			destroy_cli_cmd_pattern_arg(arg);
+			return NULL;
+		}
+	}
+
+	arg->pattern = yuck_arg->args[0];
+
+	arg->read = yuck_arg->pattern.read_flag == 1;
+	arg->write = yuck_arg->pattern.write_flag == 1;
+	arg->execute = yuck_arg->pattern.execute_flag == 1;
+	arg->program_code = yuck_arg->pattern.program_code_flag == 1;
+
+	return arg;
+}
+
+static void destroy_cli_cmd_freeze_arg(struct cli_cmd_freeze_arg *arg)
+{
+	free(arg);
+}
+
+static struct cli_cmd_freeze_arg *create_cli_cmd_freeze_arg(yuck_t *yuck_arg)
+{
+	struct cli_cmd_freeze_arg *arg = malloc(sizeof(*arg));
+
+	if (yuck_arg->cmd != PROCTAL_CMD_FREEZE) {
+		fputs("Wrong command.\n", stderr);
+		destroy_cli_cmd_freeze_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->nargs != 0) {
+		fputs("Too many arguments.\n", stderr);
+		destroy_cli_cmd_freeze_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->freeze.pid_arg == NULL) {
+		fputs("OPTION -p, --pid is required.\n", stderr);
+		destroy_cli_cmd_freeze_arg(arg);
+		return NULL;
+	}
+
+	if (!cli_parse_int(yuck_arg->freeze.pid_arg, &arg->pid)) {
+		fputs("Invalid pid.\n", stderr);
+		destroy_cli_cmd_freeze_arg(arg);
+		return NULL;
+	}
+
+	arg->input = yuck_arg->freeze.input_flag == 1;
+	arg->latency = yuck_arg->freeze.latency_flag == 1;
+
+	return arg;
+}
+
+static void destroy_cli_cmd_sample_arg(struct cli_cmd_sample_arg *arg)
+{
+	free(arg);
+}
+
+static struct cli_cmd_sample_arg *create_cli_cmd_sample_arg(yuck_t *yuck_arg)
+{
+	struct cli_cmd_sample_arg *arg = malloc(sizeof(*arg));
+
+	if (yuck_arg->cmd != PROCTAL_CMD_SAMPLE) {
+		fputs("Wrong command.\n", stderr);
+		destroy_cli_cmd_sample_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->nargs != 0) {
+		fputs("Too many arguments.\n", stderr);
+		destroy_cli_cmd_sample_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->sample.pid_arg == NULL) {
+		fputs("OPTION -p, --pid is required.\n", stderr);
+		destroy_cli_cmd_sample_arg(arg);
+		return NULL;
+	}
+
+	if (!cli_parse_int(yuck_arg->sample.pid_arg, &arg->pid)) {
+		fputs("Invalid pid.\n", stderr);
+		destroy_cli_cmd_sample_arg(arg);
+		return NULL;
+	}
+
+	arg->hz = 99;
+
+	if (yuck_arg->sample.hz_arg != NULL
+		&& (!cli_parse_double(yuck_arg->sample.hz_arg, &arg->hz)
+			|| !(arg->hz > 0 && arg->hz <= 1e9))) {
+		fputs("Invalid rate.\n", stderr);
+		destroy_cli_cmd_sample_arg(arg);
+		return NULL;
+	}
+
+	arg->duration = 0;
+
+	if (yuck_arg->sample.duration_arg != NULL
+		&& (!cli_parse_double(yuck_arg->sample.duration_arg, &arg->duration)
+			|| !(arg->duration > 0))) {
+		fputs("Invalid duration.\n", stderr);
+		destroy_cli_cmd_sample_arg(arg);
+		return NULL;
+	}
+
+	arg->folded = yuck_arg->sample.folded_flag == 1;
+	arg->depth = 64;
+
+	if (yuck_arg->sample.depth_arg != NULL) {
+		unsigned long depth;
+
+		if (!cli_parse_ulong(yuck_arg->sample.depth_arg, &depth) || depth < 1) {
+			fputs("Invalid depth.\n", stderr);
+			destroy_cli_cmd_sample_arg(arg);
+			return NULL;
+		}
+
+		if (!arg->folded) {
+			fputs("OPTION --depth requires --folded.\n", stderr);
+			destroy_cli_cmd_sample_arg(arg);
+			return NULL;
+		}
+
+		arg->depth = depth;
+	}
+
+	return arg;
+}
+
+static void destroy_cli_cmd_watch_arg(struct cli_cmd_watch_arg *arg)
+{
+	cli_val nil = cli_val_nil();
+	cli_val vals[] = {
+		arg->value,
+		arg->compare.eq,
+		arg->compare.ne,
+		arg->compare.gt,
+		arg->compare.gte,
+		arg->compare.lt,
+		arg->compare.lte,
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(vals); ++i) {
+		if (vals[i] != nil) {
+			cli_val_destroy(vals[i]);
+		}
+	}
+
+	free(arg->pids);
+	free(arg);
+}
+
+/*
+ * Parses a list of PIDs separated by commas.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int parse_watch_pids(const char *s, struct cli_cmd_watch_arg *arg)
+{
+	size_t count = 1;
+
+	for (const char *c = s; *c; ++c) {
+		if (*c == ',') {
+			++count;
+		}
+	}
+
+	arg->pids = malloc(count * sizeof(*arg->pids));
+	char *copy = strdup(s);
+
+	if (arg->pids == NULL || copy == NULL) {
+		fputs("Ran out of memory.\n", stderr);
+		free(copy);
+		return 0;
+	}
+
+	char *save;
+	char *pid = strtok_r(copy, ",", &save);
+
+	arg->pid_count = 0;
+
+	while (pid != NULL) {
+		if (!cli_parse_int(pid, &arg->pids[arg->pid_count++])) {
+			fputs("Invalid pid.\n", stderr);
+			free(copy);
+			return 0;
+		}
+
+		pid = strtok_r(NULL, ",", &save);
+	}
+
+	free(copy);
+
+	if (arg->pid_count != count) {
+		fputs("Invalid pid.\n", stderr);
+		return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Parses the condition of --when, which is any number of comparisons
+ * separated by colons, each either COMPARISON=VALUE or one that compares
+ * against the previous value.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int parse_watch_when(const char *s, struct type_arguments *type, struct cli_cmd_watch_arg *arg)
+{
+	cli_val nil = cli_val_nil();
+
+	char *copy = strdup(s);
+
+	if (copy == NULL) {
+		fputs("Ran out of memory.\n", stderr);
+		return 0;
+	}
+
+	char *save;
+	char *comparison = strtok_r(copy, ":", &save);
+
+	if (comparison == NULL) {
+		fputs("Invalid condition.\n", stderr);
+		free(copy);
+		return 0;
+	}
+
+	do {
+		char *value = strchr(comparison, '=');
+		cli_val *compare = NULL;
+		int *compare_prev = NULL;
+
+		if (value != NULL) {
+			*value++ = '\0';
+		}
+
+#define GET_COMPARISON(NAME) \
+		if (strcmp(comparison, #NAME) == 0) { \
+			compare = &arg->compare.NAME; \
+		}
+
+		GET_COMPARISON(eq);
+		GET_COMPARISON(ne);
+		GET_COMPARISON(gt);
+		GET_COMPARISON(gte);
+		GET_COMPARISON(lt);
+		GET_COMPARISON(lte);
+
+#undef GET_COMPARISON
+
+#define GET_COMPARISON_PREV(NAME) \
+		if (strcmp(comparison, #NAME) == 0) { \
+			compare_prev = &arg->compare_prev.NAME; \
+		}
+
+		GET_COMPARISON_PREV(changed);
+		GET_COMPARISON_PREV(unchanged);
+		GET_COMPARISON_PREV(increased);
+		GET_COMPARISON_PREV(decreased);
+
+#undef GET_COMPARISON_PREV
+
+		if (compare_prev != NULL && value == NULL) {
+			*compare_prev = 1;
+			continue;
+		}
+
+		if (compare == NULL || value == NULL) {
+			fprintf(stderr, "Invalid comparison %s in condition.\n", comparison);
+			free(copy);
+			return 0;
+		}
+
+		if (*compare != nil) {
+			cli_val_destroy(*compare);
+		}
+
+		*compare = create_cli_val_from_type_arguments(type);
+
+		if (*compare == nil || !cli_val_parse(*compare, value)) {
+			fprintf(stderr, "Invalid value in condition.\n");
+			free(copy);
+			return 0;
+		}
+	} while ((comparison = strtok_r(NULL, ":", &save)) != NULL);
+
+	free(copy);
+
+	return 1;
+}
+
+/*
+ * Parses the number of bytes to watch. Only protecting pages allows sizes
+ * other than those of the debug registers.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int parse_watch_size(const char *s, int pages, size_t *size)
+{
+	unsigned long v;
+
+	if (!cli_parse_ulong(s, &v) || v == 0) {
+		return 0;
+	}
+
+	if (!pages && v != 1 && v != 2 && v != 4 && v != 8) {
+		return 0;
+	}
+
+	*size = v;
+
+	return 1;
+}
+
+/*
+ * Parses a watchpoint, which looks like ADDRESS:SIZE:MODE where MODE is made
+ * of the letters r, w and x. The size and the mode can be left out, in which
+ * case they're taken from the given watchpoint.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int parse_watch_point(const char *s, int pages, struct cli_cmd_watch_point *point)
+{
+	char *copy = strdup(s);
+
+	if (copy == NULL) {
+		fputs("Ran out of memory.\n", stderr);
+		return 0;
+	}
+
+	char *save;
+	char *address = strtok_r(copy, ":", &save);
+	char *size = strtok_r(NULL, ":", &save);
+	char *mode = strtok_r(NULL, ":", &save);
+
+	if (address == NULL || !cli_parse_address(address, &point->address)) {
+		fprintf(stderr, "Invalid address in watchpoint %s.\n", s);
+		free(copy);
+		return 0;
+	}
+
+	if (size != NULL && !parse_watch_size(size, pages, &point->size)) {
+		fprintf(stderr, "Invalid size in watchpoint %s.\n", s);
+		free(copy);
+		return 0;
+	}
+
+	if (mode != NULL) {
+		point->read = strchr(mode, 'r') != NULL;
+		point->write = strchr(mode, 'w') != NULL;
+		point->execute = strchr(mode, 'x') != NULL;
+
+		if (strspn(mode, "rwx") != strlen(mode)) {
+			fprintf(stderr, "Invalid mode in watchpoint %s.\n", s);
+			free(copy);
+			return 0;
+		}
+	}
+
+	if (strtok_r(NULL, ":", &save) != NULL) {
+		fprintf(stderr, "Too many parts in watchpoint %s.\n", s);
+		free(copy);
+		return 0;
+	}
+
+	free(copy);
+
+	return 1;
+}
+
+static struct cli_cmd_watch_arg *create_cli_cmd_watch_arg(yuck_t *yuck_arg)
+{
+	struct cli_cmd_watch_arg *arg = malloc(sizeof(*arg));
+
+	arg->pids = NULL;
+	arg->pid_count = 0;
+
+	cli_val nil = cli_val_nil();
+	arg->value = nil;
+	arg->compare.eq = nil;
+	arg->compare.ne = nil;
+	arg->compare.gt = nil;
+	arg->compare.gte = nil;
+	arg->compare.lt = nil;
+	arg->compare.lte = nil;
+	arg->compare_prev.changed = 0;
+	arg->compare_prev.unchanged = 0;
+	arg->compare_prev.increased = 0;
+	arg->compare_prev.decreased = 0;
+	arg->compare_prev.inc = nil;
+	arg->compare_prev.inc_up_to = nil;
+	arg->compare_prev.dec = nil;
+	arg->compare_prev.dec_up_to = nil;
+
+	if (yuck_arg->cmd != PROCTAL_CMD_WATCH) {
+		fputs("Wrong command.\n", stderr);
+		destroy_cli_cmd_watch_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->watch.pid_arg == NULL) {
+		fputs("OPTION -p, --pid is required.\n", stderr);
+		destroy_cli_cmd_watch_arg(arg);
+		return NULL;
+	}
+
+	if (!parse_watch_pids(yuck_arg->watch.pid_arg, arg)) {
+		destroy_cli_cmd_watch_arg(arg);
+		return NULL;
+	}
+
+	arg->pages = yuck_arg->watch.pages_flag == 1;
+
+	// Options apply to every watchpoint that does not say otherwise.
+	struct cli_cmd_watch_point defaults;
+	defaults.address = NULL;
+	defaults.size = 1;
+	defaults.read = yuck_arg->watch.read_flag == 1;
+	defaults.write = yuck_arg->watch.write_flag == 1;
+	defaults.execute = yuck_arg->watch.execute_flag == 1;
+
+	if (yuck_arg->watch.size_arg != NULL
+		&& !parse_watch_size(yuck_arg->watch.size_arg, arg->pages, &defaults.size)) {
+		fputs("Invalid size.\n", stderr);
+		destroy_cli_cmd_watch_arg(arg);
+		return NULL;
+	}
+
+	arg->point_count = 0;
+
+	if (yuck_arg->watch.address_arg != NULL) {
+		arg->points[0] = defaults;
+
+		if (!cli_parse_address(yuck_arg->watch.address_arg, &arg->points[0].address)) {
+			fputs("Invalid address.\n", stderr);
+			destroy_cli_cmd_watch_arg(arg);
+			return NULL;
+		}
+
+		arg->point_count = 1;
+	}
+
+	if (arg->point_count + yuck_arg->nargs > CLI_CMD_WATCH_MAX_POINTS) {
+		fprintf(stderr, "Cannot watch more than %d watchpoints at once.\n", CLI_CMD_WATCH_MAX_POINTS);
+		destroy_cli_cmd_watch_arg(arg);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < yuck_arg->nargs; ++i) {
+		struct cli_cmd_watch_point *point = &arg->points[arg->point_count++];
+
+		*point = defaults;
+
+		if (!parse_watch_point(yuck_arg->args[i], arg->pages, point)) {
+			destroy_cli_cmd_watch_arg(arg);
+			return NULL;
+		}
+	}
+
+	if (arg->point_count == 0) {
+		fputs("OPTION -a, --address or a watchpoint is required.\n", stderr);
+		destroy_cli_cmd_watch_arg(arg);
+		return NULL;
+	}
+
+	arg->unique = yuck_arg->watch.unique_flag == 1;
+	arg->aggregate = yuck_arg->watch.aggregate_flag == 1;
+	arg->count = yuck_arg->watch.count_flag == 1;
+	arg->interval = 0;
+
+	if (arg->count && (arg->aggregate || arg->unique)) {
+		fputs("OPTION --count cannot be used with --aggregate or --unique.\n", stderr);
+		destroy_cli_cmd_watch_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->watch.interval_arg != NULL) {
+		if (!cli_parse_uint(yuck_arg->watch.interval_arg, &arg->interval)
+			|| arg->interval == 0) {
+			fputs("Invalid interval.\n", stderr);
+			destroy_cli_cmd_watch_arg(arg);
+			return NULL;
+		}
+
+		if (!arg->aggregate && !arg->count) {
+			fputs("OPTION --interval requires --aggregate or --count.\n", stderr);
+			destroy_cli_cmd_watch_arg(arg);
+			return NULL;
+		}
+	}
+
+	arg->perf = yuck_arg->watch.perf_flag == 1;
+	arg->sample_period = 1;
+
+	if (arg->perf && arg->pages) {
+		fputs("OPTION --perf cannot be used with --pages.\n", stderr);
+		destroy_cli_cmd_watch_arg(arg);
+		return NULL;
+	}
+
+	if (yuck_arg->watch.sample_period_arg != NULL) {
+		if (!cli_parse_ulong(yuck_arg->watch.sample_period_arg, &arg->sample_period)
+			|| arg->sample_period == 0) {
+			fputs("Invalid sample period.\n", stderr);
+			destroy_cli_cmd_watch_arg(arg);
+			return NULL;
+		}
+
+		if (!arg->perf) {
+			fputs("OPTION --sample-period requires --perf.\n", stderr);
+			destroy_cli_cmd_watch_arg(arg);
+			return NULL;
+		}
+	}
+
+	arg->values = yuck_arg->watch.values_flag == 1;
+	arg->when = yuck_arg->watch.when_arg != NULL;
+
+	if ((arg->values || arg->when) && (arg->perf || arg->count)) {
+		// With perf events the process goes on before the values
+		// could be read.
+		fputs("OPTIONS --values and --when cannot be used with --perf or --count.\n", stderr);
+		destroy_cli_cmd_watch_arg(arg);
+		return NULL;
+	}
+
+	if (arg->values || arg->when) {
+		struct type_arguments type_args;
+
+		if (!cli_type_arguments_watch(&type_args, &yuck_arg->watch)) {
+			destroy_cli_cmd_watch_arg(arg);
+			return NULL;
+		}
+
+		switch (type_args.type) {
+		case CLI_VAL_TYPE_BYTE:
+		case CLI_VAL_TYPE_INTEGER:
+		case CLI_VAL_TYPE_IEEE754:
+		case CLI_VAL_TYPE_ADDRESS:
+			break;
+
+		default:
+			fputs("Values of this type cannot be watched.\n", stderr);
+			destroy_cli_cmd_watch_arg(arg);
+			return NULL;
+		}
+
+		arg->value = create_cli_val_from_type_arguments(&type_args);
+
+		if (arg->value == nil) {
+			fputs("Invalid type arguments.\n", stderr);
+			destroy_cli_cmd_watch_arg(arg);
+			return NULL;
+		}
+
+		for (size_t i = 0; i < arg->point_count; ++i) {
+			if (cli_val_sizeof(arg->value) > arg->points[i].size) {
+				fputs("Type is larger than the number of bytes watched.\n", stderr);
+				destroy_cli_cmd_watch_arg(arg);
+				return NULL;
+			}
+		}
+
+		if (arg->when && !parse_watch_when(yuck_arg->watch.when_arg, &type_args, arg)) {
+			destroy_cli_cmd_watch_arg(arg);
+			return NULL;
+		}
+	}
 
 	return arg;
 }
@@ -1007,8 +2196,14 @@ static int cmd_handler_none(yuck_t *argp)
 CMD_HANDLER_COMMON(read)
 CMD_HANDLER_COMMON(write)
 CMD_HANDLER_COMMON(search)
+CMD_HANDLER_COMMON(session)
+CMD_HANDLER_COMMON(pointerscan)
+CMD_HANDLER_COMMON(layout)
 CMD_HANDLER_COMMON(pattern)
+CMD_HANDLER_COMMON(regex)
+CMD_HANDLER_COMMON(strings)
 CMD_HANDLER_COMMON(freeze)
+CMD_HANDLER_COMMON(sample)
 CMD_HANDLER_COMMON(watch)
 CMD_HANDLER_COMMON(execute)
 CMD_HANDLER_COMMON(alloc)
@@ -1023,8 +2218,14 @@ cmd_handler cmd_handlers[] = {
 	[PROCTAL_CMD_READ] = cmd_handler_read,
 	[PROCTAL_CMD_WRITE] = cmd_handler_write,
 	[PROCTAL_CMD_SEARCH] = cmd_handler_search,
+	[PROCTAL_CMD_SESSION] = cmd_handler_session,
+	[PROCTAL_CMD_POINTERSCAN] = cmd_handler_pointerscan,
+	[PROCTAL_CMD_LAYOUT] = cmd_handler_layout,
 	[PROCTAL_CMD_PATTERN] = cmd_handler_pattern,
+	[PROCTAL_CMD_REGEX] = cmd_handler_regex,
+	[PROCTAL_CMD_STRINGS] = cmd_handler_strings,
 	[PROCTAL_CMD_FREEZE] = cmd_handler_freeze,
+	[PROCTAL_CMD_SAMPLE] = cmd_handler_sample,
 	[PROCTAL_CMD_WATCH] = cmd_handler_watch,
 	[PROCTAL_CMD_EXECUTE] = cmd_handler_execute,
 	[PROCTAL_CMD_ALLOC] = cmd_handler_alloc,
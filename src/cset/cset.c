@@ -0,0 +1,349 @@
+#include <string.h>
+
+#include "cset/cset.h"
+
+size_t cset_count(struct cset *s);
+
+size_t cset_region_count(struct cset *s);
+
+struct cset_region *cset_region(struct cset *s, size_t i);
+
+int cset_error(struct cset *s);
+
+struct cset_region *cset_iter_region(struct cset_iter *it);
+
+/*
+ * Number of bytes a bitmap of the region would take. Always a multiple of the
+ * size of a word.
+ */
+static inline size_t bitmap_size(struct cset_region *r)
+{
+	return ((r->slots + 63) / 64) * sizeof(uint64_t);
+}
+
+static inline uint64_t *bitmap(struct cset_region *r)
+{
+	return (uint64_t *) r->index;
+}
+
+/*
+ * Writes a variable length integer. Every byte holds 7 bits of the number
+ * with the highest bit telling whether there's more to come.
+ */
+static inline size_t encode_varint(unsigned char *out, size_t v)
+{
+	size_t i = 0;
+
+	while (v >= 0x80) {
+		out[i++] = (unsigned char) (v | 0x80);
+		v >>= 7;
+	}
+
+	out[i++] = (unsigned char) v;
+
+	return i;
+}
+
+static inline size_t decode_varint(const unsigned char *in, size_t *pos)
+{
+	size_t v = 0;
+	int shift = 0;
+	unsigned char b;
+
+	do {
+		b = in[(*pos)++];
+		v |= (size_t) (b & 0x7F) << shift;
+		shift += 7;
+	} while (b & 0x80);
+
+	return v;
+}
+
+static int grow(struct cset *s, void **buf, size_t *capacity, size_t needed)
+{
+	if (needed <= *capacity) {
+		return 1;
+	}
+
+	size_t capacity_new = *capacity ? *capacity : 64;
+
+	while (capacity_new < needed) {
+		capacity_new *= 2;
+	}
+
+	void *buf_new = realloc(*buf, capacity_new);
+
+	if (buf_new == NULL) {
+		s->error = 1;
+		return 0;
+	}
+
+	*buf = buf_new;
+	*capacity = capacity_new;
+
+	return 1;
+}
+
+/*
+ * Converts the list of gaps of a region to a bitmap.
+ */
+static int convert_to_bitmap(struct cset *s, struct cset_region *r)
+{
+	size_t size = bitmap_size(r);
+	uint64_t *words = calloc(1, size);
+
+	if (words == NULL) {
+		s->error = 1;
+		return 0;
+	}
+
+	size_t pos = 0;
+	size_t slot = 0;
+
+	while (pos < r->index_size) {
+		slot += decode_varint(r->index, &pos);
+		words[slot / 64] |= (uint64_t) 1 << (slot % 64);
+		slot += 1;
+	}
+
+	free(r->index);
+
+	r->repr = CSET_REPR_BITMAP;
+	r->index = (unsigned char *) words;
+	r->index_size = size;
+	s->build.index_capacity = size;
+
+	return 1;
+}
+
+void cset_init(struct cset *s, size_t align, size_t value_size)
+{
+	s->align = align > 0 ? align : 1;
+	s->value_size = value_size;
+	s->count = 0;
+	s->regions = NULL;
+	s->region_count = 0;
+	s->region_capacity = 0;
+	s->build.active = 0;
+	s->error = 0;
+}
+
+void cset_deinit(struct cset *s)
+{
+	size_t n = s->region_count + (s->build.active ? 1 : 0);
+
+	for (size_t i = 0; i < n; ++i) {
+		free(s->regions[i].index);
+		free(s->regions[i].values);
+	}
+
+	free(s->regions);
+
+	s->regions = NULL;
+	s->region_count = 0;
+	s->region_capacity = 0;
+	s->count = 0;
+	s->build.active = 0;
+}
+
+int cset_region_begin(struct cset *s, void *start, void *end)
+{
+	if (s->build.active) {
+		cset_region_end(s);
+	}
+
+	if (s->region_count == s->region_capacity) {
+		size_t capacity = s->region_capacity ? s->region_capacity * 2 : 16;
+		struct cset_region *regions = realloc(s->regions, capacity * sizeof(*regions));
+
+		if (regions == NULL) {
+			s->error = 1;
+			return 0;
+		}
+
+		s->regions = regions;
+		s->region_capacity = capacity;
+	}
+
+	char *aligned = start;
+	size_t misalignment = (uintptr_t) aligned % s->align;
+
+	if (misalignment) {
+		aligned += s->align - misalignment;
+	}
+
+	struct cset_region *r = &s->regions[s->region_count];
+	r->start = aligned;
+	r->slots = aligned < (char *) end
+		? ((char *) end - aligned + s->align - 1) / s->align
+		: 0;
+	r->count = 0;
+	r->repr = CSET_REPR_DELTA;
+	r->index = NULL;
+	r->index_size = 0;
+	r->values = NULL;
+
+	s->build.active = 1;
+	s->build.next_slot = 0;
+	s->build.index_capacity = 0;
+	s->build.values_capacity = 0;
+
+	return 1;
+}
+
+int cset_add(struct cset *s, void *addr, const void *value)
+{
+	struct cset_region *r = &s->regions[s->region_count];
+	size_t slot = ((char *) addr - r->start) / s->align;
+
+	if (r->repr == CSET_REPR_DELTA) {
+		// A gap is at most the size of a size_t encoded in 7 bit
+		// groups.
+		if (!grow(s, (void **) &r->index, &s->build.index_capacity, r->index_size + (sizeof(size_t) * 8 + 6) / 7)) {
+			return 0;
+		}
+
+		r->index_size += encode_varint(r->index + r->index_size, slot - s->build.next_slot);
+
+		if (r->index_size > bitmap_size(r) && !convert_to_bitmap(s, r)) {
+			return 0;
+		}
+	} else {
+		bitmap(r)[slot / 64] |= (uint64_t) 1 << (slot % 64);
+	}
+
+	s->build.next_slot = slot + 1;
+
+	size_t values_size = r->count * s->value_size;
+
+	if (!grow(s, (void **) &r->values, &s->build.values_capacity, values_size + s->value_size)) {
+		return 0;
+	}
+
+	memcpy(r->values + values_size, value, s->value_size);
+
+	r->count += 1;
+	s->count += 1;
+
+	return 1;
+}
+
+int cset_region_end(struct cset *s)
+{
+	if (!s->build.active) {
+		return 1;
+	}
+
+	struct cset_region *r = &s->regions[s->region_count];
+
+	s->build.active = 0;
+
+	if (r->count == 0) {
+		free(r->index);
+		free(r->values);
+		return 1;
+	}
+
+	// Giving back what was reserved for growth. Failing to shrink is not a
+	// problem because the old block stays valid.
+	if (r->index_size < s->build.index_capacity) {
+		void *index = realloc(r->index, r->index_size);
+
+		if (index) {
+			r->index = index;
+		}
+	}
+
+	if (r->count * s->value_size < s->build.values_capacity) {
+		void *values = realloc(r->values, r->count * s->value_size);
+
+		if (values) {
+			r->values = values;
+		}
+	}
+
+	s->region_count += 1;
+
+	return 1;
+}
+
+size_t cset_memory(struct cset *s)
+{
+	size_t size = s->region_capacity * sizeof(*s->regions);
+
+	for (size_t i = 0; i < s->region_count; ++i) {
+		size += s->regions[i].index_size;
+		size += s->regions[i].count * s->value_size;
+	}
+
+	return size;
+}
+
+/*
+ * Prepares the iterator for reading the first candidate of its current
+ * region.
+ */
+static inline void iter_enter_region(struct cset_iter *it)
+{
+	it->i = 0;
+	it->pos = 0;
+	it->next_slot = 0;
+	it->word = 0;
+
+	if (it->region < it->set->region_count) {
+		struct cset_region *r = &it->set->regions[it->region];
+
+		if (r->repr == CSET_REPR_BITMAP) {
+			it->word = bitmap(r)[0];
+		}
+	}
+}
+
+void cset_iter_init(struct cset_iter *it, struct cset *s)
+{
+	it->set = s;
+	it->region = 0;
+
+	iter_enter_region(it);
+}
+
+int cset_iter_next(struct cset_iter *it, void **addr, void **value)
+{
+	struct cset *s = it->set;
+
+	while (it->region < s->region_count) {
+		struct cset_region *r = &s->regions[it->region];
+
+		if (it->i == r->count) {
+			it->region += 1;
+			iter_enter_region(it);
+			continue;
+		}
+
+		size_t slot;
+
+		if (r->repr == CSET_REPR_DELTA) {
+			slot = it->next_slot + decode_varint(r->index, &it->pos);
+			it->next_slot = slot + 1;
+		} else {
+			while (it->word == 0) {
+				it->pos += 1;
+				it->word = bitmap(r)[it->pos];
+			}
+
+			slot = it->pos * 64 + (size_t) __builtin_ctzll(it->word);
+
+			// Clears the lowest bit that is set.
+			it->word &= it->word - 1;
+		}
+
+		*addr = r->start + slot * s->align;
+		*value = r->values + it->i * s->value_size;
+
+		it->i += 1;
+
+		return 1;
+	}
+
+	return 0;
+}
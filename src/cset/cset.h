@@ -0,0 +1,213 @@
+#ifndef CSET_CSET_H
+#define CSET_CSET_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/*
+ * Candidate set. Keeps track of a potentially huge number of addresses along
+ * with a value of fixed size for each one of them.
+ *
+ * Addresses are grouped by the block of memory they belong to and are stored
+ * as slot numbers relative to the start of the block, where a slot is the
+ * distance between two suitably aligned addresses.
+ *
+ * The slot numbers of a block are either kept in a bitmap, which costs 1 bit
+ * per slot, or in a list of gaps between consecutive slot numbers encoded as
+ * variable length integers, which costs at least 1 byte per address but
+ * nothing for slots that aren't taken. The set starts with a list and
+ * switches over to a bitmap as soon as the list grows larger than what the
+ * bitmap would take, so memory usage never goes over the smallest of the two.
+ *
+ * Values are stored in a separate contiguous block of memory in the same order
+ * as their addresses. Going over all candidates only ever walks memory
+ * forward.
+ */
+
+#define CSET_REPR_DELTA 1
+#define CSET_REPR_BITMAP 2
+
+/*
+ * A block of memory and the candidates found in it.
+ */
+struct cset_region {
+	// Address of the first slot.
+	char *start;
+
+	// How many slots the block of memory has.
+	size_t slots;
+
+	// How many candidates were added.
+	size_t count;
+
+	// Tells whether index is a bitmap or a list of gaps.
+	int repr;
+
+	// Encoded slot numbers.
+	unsigned char *index;
+
+	// How many bytes of index are in use.
+	size_t index_size;
+
+	// Values of the candidates, in the same order as their addresses.
+	char *values;
+};
+
+/*
+ * The cset struct. Call cset_init to initialize it.
+ */
+struct cset {
+	// Distance between slots.
+	size_t align;
+
+	// Size of a value.
+	size_t value_size;
+
+	// Number of candidates in all regions.
+	size_t count;
+
+	struct cset_region *regions;
+	size_t region_count;
+	size_t region_capacity;
+
+	/*
+	 * State of the region that is being built.
+	 */
+	struct {
+		// Whether a region has begun.
+		int active;
+
+		// Slot number of the last candidate added to the region plus
+		// 1. Lets us tell gaps apart from the first slot.
+		size_t next_slot;
+
+		// Allocated sizes.
+		size_t index_capacity;
+		size_t values_capacity;
+	} build;
+
+	// Whether we failed to allocate memory.
+	int error;
+};
+
+/*
+ * Iterates over the candidates of a set. Call cset_iter_init to initialize
+ * it.
+ */
+struct cset_iter {
+	struct cset *set;
+
+	// Index of the current region.
+	size_t region;
+
+	// How many candidates of the current region were passed.
+	size_t i;
+
+	// Read position in the index of the current region.
+	size_t pos;
+
+	// Slot number of the next candidate in a list of gaps.
+	size_t next_slot;
+
+	// Bits of the current word of a bitmap that haven't been passed yet.
+	uint64_t word;
+};
+
+/*
+ * Initializes a cset struct.
+ *
+ * Addresses are expected to be multiples of align and each value takes
+ * value_size bytes.
+ */
+void cset_init(struct cset *s, size_t align, size_t value_size);
+
+/*
+ * Deinitializes a cset struct, releasing all memory.
+ */
+void cset_deinit(struct cset *s);
+
+/*
+ * Starts adding candidates of a new block of memory.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int cset_region_begin(struct cset *s, void *start, void *end);
+
+/*
+ * Adds a candidate to the block of memory that was started by
+ * cset_region_begin. Addresses must be given in increasing order.
+ *
+ * The value is copied.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int cset_add(struct cset *s, void *addr, const void *value);
+
+/*
+ * Finishes the block of memory started by cset_region_begin. A block without
+ * candidates is discarded.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int cset_region_end(struct cset *s);
+
+/*
+ * Returns how many bytes of memory the set is taking.
+ */
+size_t cset_memory(struct cset *s);
+
+/*
+ * Puts an iterator at the first candidate of the set.
+ */
+void cset_iter_init(struct cset_iter *it, struct cset *s);
+
+/*
+ * Passes the address and a pointer to the stored value of the next candidate.
+ *
+ * The stored value can be modified in place.
+ *
+ * Returns 1 on success, 0 when there are no more candidates.
+ */
+int cset_iter_next(struct cset_iter *it, void **addr, void **value);
+
+/*
+ * Returns the number of candidates.
+ */
+inline size_t cset_count(struct cset *s)
+{
+	return s->count;
+}
+
+/*
+ * Returns the number of blocks of memory with candidates.
+ */
+inline size_t cset_region_count(struct cset *s)
+{
+	return s->region_count;
+}
+
+/*
+ * Returns a block of memory by its index.
+ */
+inline struct cset_region *cset_region(struct cset *s, size_t i)
+{
+	return &s->regions[i];
+}
+
+/*
+ * Returns 1 if an error ocurred, 0 if everything is ok.
+ */
+inline int cset_error(struct cset *s)
+{
+	return s->error;
+}
+
+/*
+ * Returns the region of the candidate last passed by cset_iter_next.
+ */
+inline struct cset_region *cset_iter_region(struct cset_iter *it)
+{
+	return &it->set->regions[it->region];
+}
+
+#endif /* CSET_CSET_H */
@@ -0,0 +1,86 @@
+#include <stdio.h>
+
+#include "cset/cset.h"
+
+int main(void)
+{
+	// Never dereferenced.
+	char *start = (char *) 0x100000;
+	size_t n = 100000;
+
+	struct cset s;
+	cset_init(&s, 1, 1);
+
+	cset_region_begin(&s, start, start + n);
+
+	for (size_t i = 0; i < n; ++i) {
+		if (i % 3 == 0) {
+			continue;
+		}
+
+		unsigned char v = i;
+		cset_add(&s, start + i, &v);
+	}
+
+	cset_region_end(&s);
+
+	if (cset_error(&s)) {
+		fprintf(stderr, "Failed to build set.\n");
+		cset_deinit(&s);
+		return 1;
+	}
+
+	if (cset_region(&s, 0)->repr != CSET_REPR_BITMAP) {
+		fprintf(stderr, "Was expecting candidates to be stored in a bitmap.\n");
+		cset_deinit(&s);
+		return 1;
+	}
+
+	if (cset_region(&s, 0)->index_size > n / 8 + 8) {
+		fprintf(stderr, "Bitmap is larger than expected.\n");
+		cset_deinit(&s);
+		return 1;
+	}
+
+	struct cset_iter it;
+	cset_iter_init(&it, &s);
+
+	void *addr;
+	void *value;
+	size_t count = 0;
+
+	for (size_t i = 0; i < n; ++i) {
+		if (i % 3 == 0) {
+			continue;
+		}
+
+		if (!cset_iter_next(&it, &addr, &value)) {
+			fprintf(stderr, "Ran out of candidates at %zu.\n", i);
+			cset_deinit(&s);
+			return 1;
+		}
+
+		if (addr != start + i || *(unsigned char *) value != (unsigned char) i) {
+			fprintf(stderr, "Candidate %zu is not what was added.\n", i);
+			cset_deinit(&s);
+			return 1;
+		}
+
+		++count;
+	}
+
+	if (cset_iter_next(&it, &addr, &value)) {
+		fprintf(stderr, "Was not expecting more candidates.\n");
+		cset_deinit(&s);
+		return 1;
+	}
+
+	if (cset_count(&s) != count) {
+		fprintf(stderr, "Was expecting %zu candidates, got %zu.\n", count, cset_count(&s));
+		cset_deinit(&s);
+		return 1;
+	}
+
+	cset_deinit(&s);
+	return 0;
+}
@@ -0,0 +1,30 @@
+#include <stdio.h>
+
+#include "cset/cset.h"
+
+int main(void)
+{
+	struct cset s;
+	cset_init(&s, 1, 1);
+
+	struct cset_iter it;
+	cset_iter_init(&it, &s);
+
+	void *addr;
+	void *value;
+
+	if (cset_iter_next(&it, &addr, &value)) {
+		fprintf(stderr, "An empty set was not supposed to have candidates.\n");
+		cset_deinit(&s);
+		return 1;
+	}
+
+	if (cset_count(&s) != 0) {
+		fprintf(stderr, "An empty set was not supposed to count candidates.\n");
+		cset_deinit(&s);
+		return 1;
+	}
+
+	cset_deinit(&s);
+	return 0;
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+
+#include "cset/cset.h"
+
+int main(void)
+{
+	// Never dereferenced.
+	char *a = (char *) 0x10000;
+	char *b = (char *) 0x20000;
+	char *c = (char *) 0x30000;
+
+	struct cset s;
+	cset_init(&s, 8, sizeof(long));
+
+	long v1 = 1, v2 = 2, v3 = 3;
+
+	cset_region_begin(&s, a, a + 0x1000);
+	cset_add(&s, a + 8, &v1);
+	cset_region_end(&s);
+
+	// Has no candidates so must not be kept.
+	cset_region_begin(&s, b, b + 0x1000);
+	cset_region_end(&s);
+
+	cset_region_begin(&s, c, c + 0x1000);
+	cset_add(&s, c, &v2);
+	cset_add(&s, c + 0xFF8, &v3);
+	cset_region_end(&s);
+
+	if (cset_region_count(&s) != 2) {
+		fprintf(stderr, "Was expecting 2 regions, got %zu.\n", cset_region_count(&s));
+		cset_deinit(&s);
+		return 1;
+	}
+
+	struct cset_iter it;
+	cset_iter_init(&it, &s);
+
+	void *addr;
+	void *value;
+
+	void *expected_addr[] = { a + 8, c, c + 0xFF8 };
+	long expected_value[] = { 1, 2, 3 };
+	struct cset_region *expected_region[] = {
+		cset_region(&s, 0),
+		cset_region(&s, 1),
+		cset_region(&s, 1),
+	};
+
+	for (int i = 0; i < 3; ++i) {
+		if (!cset_iter_next(&it, &addr, &value)) {
+			fprintf(stderr, "Ran out of candidates at %d.\n", i);
+			cset_deinit(&s);
+			return 1;
+		}
+
+		if (addr != expected_addr[i] || *(long *) value != expected_value[i]) {
+			fprintf(stderr, "Candidate %d is not what was added.\n", i);
+			cset_deinit(&s);
+			return 1;
+		}
+
+		if (cset_iter_region(&it) != expected_region[i]) {
+			fprintf(stderr, "Candidate %d is in the wrong region.\n", i);
+			cset_deinit(&s);
+			return 1;
+		}
+	}
+
+	if (cset_iter_next(&it, &addr, &value)) {
+		fprintf(stderr, "Was not expecting more candidates.\n");
+		cset_deinit(&s);
+		return 1;
+	}
+
+	cset_deinit(&s);
+	return 0;
+}
@@ -0,0 +1,62 @@
+#include <stdio.h>
+
+#include "cset/cset.h"
+
+int main(void)
+{
+	// Never dereferenced.
+	char *start = (char *) 0x100000;
+	char *end = start + 0x100000;
+
+	struct cset s;
+	cset_init(&s, 4, sizeof(int));
+
+	cset_region_begin(&s, start, end);
+
+	for (int i = 0; i < 10; ++i) {
+		cset_add(&s, start + i * 0x1000, &i);
+	}
+
+	cset_region_end(&s);
+
+	if (cset_error(&s)) {
+		fprintf(stderr, "Failed to build set.\n");
+		cset_deinit(&s);
+		return 1;
+	}
+
+	if (cset_region(&s, 0)->repr != CSET_REPR_DELTA) {
+		fprintf(stderr, "Was expecting a few candidates to be stored as a list.\n");
+		cset_deinit(&s);
+		return 1;
+	}
+
+	struct cset_iter it;
+	cset_iter_init(&it, &s);
+
+	void *addr;
+	void *value;
+
+	for (int i = 0; i < 10; ++i) {
+		if (!cset_iter_next(&it, &addr, &value)) {
+			fprintf(stderr, "Ran out of candidates at %d.\n", i);
+			cset_deinit(&s);
+			return 1;
+		}
+
+		if (addr != start + i * 0x1000 || *(int *) value != i) {
+			fprintf(stderr, "Candidate %d is not what was added.\n", i);
+			cset_deinit(&s);
+			return 1;
+		}
+	}
+
+	if (cset_iter_next(&it, &addr, &value)) {
+		fprintf(stderr, "Was not expecting more candidates.\n");
+		cset_deinit(&s);
+		return 1;
+	}
+
+	cset_deinit(&s);
+	return 0;
+}
@@ -0,0 +1,459 @@
+#include <string.h>
+
+#include "dfa/dfa.h"
+#include "hash/hash.h"
+
+int nfa_error(struct nfa *n);
+
+void nfa_set_byte(struct nfa *n, int state, unsigned char byte);
+
+int nfa_has_byte(struct nfa *n, int state, unsigned char byte);
+
+uint32_t dfa_step(struct dfa *d, uint32_t state, unsigned char byte);
+
+int dfa_accepting(struct dfa *d, uint32_t state);
+
+int dfa_dead(struct dfa *d, uint32_t state);
+
+/*
+ * State of the subset construction. Every DFA state stands for a set of NFA
+ * states. Only NFA states that consume bytes and the accept state are kept in
+ * the sets since the others make no difference to what comes next, which lets
+ * more sets turn out to be the same.
+ */
+struct builder {
+	struct nfa *nfa;
+	struct dfa *dfa;
+
+	int start;
+	int accept;
+	int unanchored;
+	size_t max_states;
+
+	// First byte of every class.
+	unsigned char representatives[256];
+
+	// NFA states of every DFA state, one set after the other.
+	int *members;
+	size_t member_count;
+	size_t member_capacity;
+
+	// Where the set of every DFA state begins in members and how many NFA
+	// states it has.
+	size_t *offsets;
+	size_t *lengths;
+	size_t state_capacity;
+
+	// Hash table of DFA states by their sets. Slots hold the state plus
+	// 1 so that 0 means the slot is free.
+	uint32_t *table;
+	size_t table_mask;
+
+	// Set being put together.
+	int *set;
+	size_t set_count;
+
+	// NFA states waiting to be visited while following epsilon
+	// transitions.
+	int *stack;
+
+	// Generation in which every NFA state was last added to the set.
+	unsigned *marks;
+	unsigned generation;
+};
+
+static int grow(void **items, size_t *capacity, size_t size, size_t needed)
+{
+	if (needed <= *capacity) {
+		return 1;
+	}
+
+	size_t capacity_new = *capacity ? *capacity * 2 : 64;
+
+	while (capacity_new < needed) {
+		capacity_new *= 2;
+	}
+
+	void *items_new = realloc(*items, capacity_new * size);
+
+	if (items_new == NULL) {
+		return 0;
+	}
+
+	*items = items_new;
+	*capacity = capacity_new;
+
+	return 1;
+}
+
+static int compare_ints(const void *a, const void *b)
+{
+	int x = *(const int *) a;
+	int y = *(const int *) b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ * Adds an NFA state to the set along with every state it reaches without
+ * consuming anything.
+ */
+static void closure(struct builder *b, int state)
+{
+	struct nfa_state *states = b->nfa->states;
+	size_t top = 0;
+
+	b->stack[top++] = state;
+
+	while (top > 0) {
+		int s = b->stack[--top];
+
+		if (b->marks[s] == b->generation) {
+			continue;
+		}
+
+		b->marks[s] = b->generation;
+
+		if (states[s].next != -1 || s == b->accept) {
+			b->set[b->set_count++] = s;
+		}
+
+		for (int i = 0; i < 2; ++i) {
+			if (states[s].epsilon[i] != -1) {
+				b->stack[top++] = states[s].epsilon[i];
+			}
+		}
+	}
+}
+
+static uint64_t hash_set(const int *set, size_t count)
+{
+	return hash64(set, count * sizeof(*set), 0);
+}
+
+static int same_set(struct builder *b, uint32_t state, const int *set, size_t count)
+{
+	return b->lengths[state] == count
+		&& memcmp(b->members + b->offsets[state], set, count * sizeof(*set)) == 0;
+}
+
+/*
+ * Doubles the size of the hash table.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int rehash(struct builder *b)
+{
+	size_t size = (b->table_mask + 1) * 2;
+	uint32_t *table = calloc(size, sizeof(*table));
+
+	if (table == NULL) {
+		return 0;
+	}
+
+	for (uint32_t state = 0; state < b->dfa->state_count; ++state) {
+		size_t slot = hash_set(b->members + b->offsets[state], b->lengths[state]) & (size - 1);
+
+		while (table[slot] != 0) {
+			slot = (slot + 1) & (size - 1);
+		}
+
+		table[slot] = state + 1;
+	}
+
+	free(b->table);
+	b->table = table;
+	b->table_mask = size - 1;
+
+	return 1;
+}
+
+/*
+ * Makes room for more DFA states in every array that has an item per state.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int grow_states(struct builder *b, size_t needed)
+{
+	struct dfa *d = b->dfa;
+
+	if (needed <= b->state_capacity) {
+		return 1;
+	}
+
+	size_t capacity = b->state_capacity ? b->state_capacity * 2 : 64;
+
+#define GROW(ITEMS, SIZE) \
+	do { \
+		void *items = realloc(ITEMS, capacity * (SIZE)); \
+\
+		if (items == NULL) { \
+			return 0; \
+		} \
+\
+		ITEMS = items; \
+	} while (0)
+
+	GROW(b->offsets, sizeof(*b->offsets));
+	GROW(b->lengths, sizeof(*b->lengths));
+	GROW(d->accepting, sizeof(*d->accepting));
+	GROW(d->next, d->class_count * sizeof(*d->next));
+
+#undef GROW
+
+	b->state_capacity = capacity;
+
+	return 1;
+}
+
+/*
+ * Finds the DFA state of the set that was put together, adding it if there is
+ * none yet.
+ *
+ * Returns 0 on success or one of the DFA_ERROR_ values on failure.
+ */
+static int find_or_add(struct builder *b, uint32_t *result)
+{
+	struct dfa *d = b->dfa;
+
+	qsort(b->set, b->set_count, sizeof(*b->set), compare_ints);
+
+	size_t slot = hash_set(b->set, b->set_count) & b->table_mask;
+
+	while (b->table[slot] != 0) {
+		uint32_t state = b->table[slot] - 1;
+
+		if (same_set(b, state, b->set, b->set_count)) {
+			*result = state;
+			return 0;
+		}
+
+		slot = (slot + 1) & b->table_mask;
+	}
+
+	if (d->state_count == b->max_states) {
+		return DFA_ERROR_TOO_MANY_STATES;
+	}
+
+	if (!grow((void **) &b->members, &b->member_capacity, sizeof(*b->members), b->member_count + b->set_count)
+		|| !grow_states(b, d->state_count + 1)) {
+		return DFA_ERROR_OUT_OF_MEMORY;
+	}
+
+	uint32_t state = d->state_count++;
+
+	b->offsets[state] = b->member_count;
+	b->lengths[state] = b->set_count;
+	if (b->set_count > 0) {
+		memcpy(b->members + b->member_count, b->set, b->set_count * sizeof(*b->set));
+		b->member_count += b->set_count;
+	}
+
+	d->accepting[state] = 0;
+
+	for (size_t i = 0; i < b->set_count; ++i) {
+		if (b->set[i] == b->accept) {
+			d->accepting[state] = 1;
+		}
+	}
+
+	b->table[slot] = state + 1;
+
+	// Keeping the table at most half full.
+	if (d->state_count * 2 > b->table_mask + 1 && !rehash(b)) {
+		return DFA_ERROR_OUT_OF_MEMORY;
+	}
+
+	*result = state;
+
+	return 0;
+}
+
+/*
+ * Groups bytes that every NFA state treats the same way. A class is a range
+ * of consecutive bytes, which is enough since sets of bytes in patterns are
+ * mostly made of ranges.
+ */
+static void make_classes(struct builder *b)
+{
+	struct nfa *n = b->nfa;
+	struct dfa *d = b->dfa;
+	unsigned char boundary[256] = { 0 };
+
+	for (size_t s = 0; s < n->count; ++s) {
+		if (n->states[s].next == -1) {
+			continue;
+		}
+
+		for (int byte = 1; byte < 256; ++byte) {
+			if (nfa_has_byte(n, s, byte) != nfa_has_byte(n, s, byte - 1)) {
+				boundary[byte] = 1;
+			}
+		}
+	}
+
+	d->class_count = 0;
+
+	for (int byte = 0; byte < 256; ++byte) {
+		if (byte == 0 || boundary[byte]) {
+			b->representatives[d->class_count++] = byte;
+		}
+
+		d->classes[byte] = d->class_count - 1;
+	}
+}
+
+/*
+ * Finds the state every state and class lead to, adding states as they are
+ * found.
+ *
+ * Returns 0 on success or one of the DFA_ERROR_ values on failure.
+ */
+static int build(struct builder *b)
+{
+	struct nfa *n = b->nfa;
+	struct dfa *d = b->dfa;
+	uint32_t state;
+	int error;
+
+	// The dead state is the empty set.
+	b->set_count = 0;
+
+	if ((error = find_or_add(b, &state))) {
+		return error;
+	}
+
+	b->generation += 1;
+	b->set_count = 0;
+	closure(b, b->start);
+
+	if ((error = find_or_add(b, &d->start))) {
+		return error;
+	}
+
+	for (uint32_t from = 0; from < d->state_count; ++from) {
+		for (size_t c = 0; c < d->class_count; ++c) {
+			unsigned char byte = b->representatives[c];
+
+			b->generation += 1;
+			b->set_count = 0;
+
+			// The dead state stays dead even when unanchored.
+			if (b->unanchored && from != 0) {
+				closure(b, b->start);
+			}
+
+			for (size_t i = 0; i < b->lengths[from]; ++i) {
+				int s = b->members[b->offsets[from] + i];
+
+				if (n->states[s].next != -1 && nfa_has_byte(n, s, byte)) {
+					closure(b, n->states[s].next);
+				}
+			}
+
+			if ((error = find_or_add(b, &state))) {
+				return error;
+			}
+
+			d->next[from * d->class_count + c] = state;
+		}
+	}
+
+	return 0;
+}
+
+void nfa_init(struct nfa *n)
+{
+	n->states = NULL;
+	n->count = 0;
+	n->capacity = 0;
+	n->error = 0;
+}
+
+void nfa_deinit(struct nfa *n)
+{
+	free(n->states);
+}
+
+int nfa_add(struct nfa *n)
+{
+	if (n->error || n->count >= INT32_MAX) {
+		n->error = 1;
+		return -1;
+	}
+
+	if (!grow((void **) &n->states, &n->capacity, sizeof(*n->states), n->count + 1)) {
+		n->error = 1;
+		return -1;
+	}
+
+	struct nfa_state *s = &n->states[n->count];
+
+	memset(s->bytes, 0, sizeof(s->bytes));
+	s->next = -1;
+	s->epsilon[0] = -1;
+	s->epsilon[1] = -1;
+
+	return n->count++;
+}
+
+int dfa_compile(struct dfa *d, struct nfa *n, int start, int accept, int unanchored, size_t max_states)
+{
+	struct builder b;
+
+	b.nfa = n;
+	b.dfa = d;
+	b.start = start;
+	b.accept = accept;
+	b.unanchored = unanchored;
+	b.max_states = max_states;
+	b.members = NULL;
+	b.member_count = 0;
+	b.member_capacity = 0;
+	b.offsets = NULL;
+	b.lengths = NULL;
+	b.state_capacity = 0;
+	b.table_mask = 63;
+	b.table = calloc(b.table_mask + 1, sizeof(*b.table));
+	b.set = malloc(n->count * sizeof(*b.set));
+	b.stack = malloc((n->count * 2 + 1) * sizeof(*b.stack));
+	b.marks = calloc(n->count, sizeof(*b.marks));
+	b.generation = 0;
+
+	d->next = NULL;
+	d->accepting = NULL;
+	d->state_count = 0;
+
+	int error = 0;
+
+	if (b.table == NULL || b.set == NULL || b.stack == NULL || b.marks == NULL) {
+		error = DFA_ERROR_OUT_OF_MEMORY;
+	} else {
+		make_classes(&b);
+		error = build(&b);
+	}
+
+	free(b.members);
+	free(b.offsets);
+	free(b.lengths);
+	free(b.table);
+	free(b.set);
+	free(b.stack);
+	free(b.marks);
+
+	if (error) {
+		dfa_deinit(d);
+	}
+
+	return error;
+}
+
+void dfa_deinit(struct dfa *d)
+{
+	free(d->next);
+	free(d->accepting);
+
+	d->next = NULL;
+	d->accepting = NULL;
+	d->state_count = 0;
+}
@@ -0,0 +1,153 @@
+#ifndef DFA_DFA_H
+#define DFA_DFA_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/*
+ * Finite automata over bytes.
+ *
+ * An NFA is built first, one state at a time, and then turned into a DFA by
+ * subset construction. Running the DFA takes a single table lookup per byte
+ * no matter how complex the NFA was.
+ *
+ * Bytes that every NFA state treats the same way are grouped in classes so
+ * that the transition table has one column per class instead of one per
+ * byte.
+ */
+
+#define DFA_ERROR_OUT_OF_MEMORY 1
+#define DFA_ERROR_TOO_MANY_STATES 2
+
+/*
+ * A state of an NFA. It either consumes a byte of the set and moves on to
+ * next or moves on to the states in epsilon without consuming anything.
+ */
+struct nfa_state {
+	uint64_t bytes[4];
+
+	// State reached by consuming a byte of the set, or -1.
+	int next;
+
+	// States reached without consuming anything, or -1.
+	int epsilon[2];
+};
+
+/*
+ * The nfa struct. Call nfa_init to initialize it.
+ */
+struct nfa {
+	struct nfa_state *states;
+	size_t count;
+	size_t capacity;
+
+	// Whether we failed to allocate memory.
+	int error;
+};
+
+/*
+ * The dfa struct. Call dfa_compile to initialize it.
+ */
+struct dfa {
+	// Class of every byte.
+	unsigned char classes[256];
+	size_t class_count;
+
+	// State reached from every state by a byte of every class, one row per
+	// state.
+	uint32_t *next;
+
+	// Whether a state is accepting.
+	unsigned char *accepting;
+
+	size_t state_count;
+
+	// State to start from. State 0 is dead, it can never lead to an
+	// accepting state.
+	uint32_t start;
+};
+
+/*
+ * Initializes an nfa struct with no states.
+ */
+void nfa_init(struct nfa *n);
+
+/*
+ * Deinitializes an nfa struct, releasing all memory.
+ */
+void nfa_deinit(struct nfa *n);
+
+/*
+ * Adds a state with no transitions.
+ *
+ * Returns the index of the state or -1 on failure.
+ */
+int nfa_add(struct nfa *n);
+
+/*
+ * Returns 1 if an error ocurred, 0 if everything is ok.
+ */
+inline int nfa_error(struct nfa *n)
+{
+	return n->error;
+}
+
+/*
+ * Adds a byte to the set of bytes that lead a state to its next state.
+ */
+inline void nfa_set_byte(struct nfa *n, int state, unsigned char byte)
+{
+	n->states[state].bytes[byte / 64] |= (uint64_t) 1 << (byte % 64);
+}
+
+/*
+ * Tells whether a byte leads a state to its next state.
+ */
+inline int nfa_has_byte(struct nfa *n, int state, unsigned char byte)
+{
+	return (n->states[state].bytes[byte / 64] >> (byte % 64)) & 1;
+}
+
+/*
+ * Turns an NFA into a DFA. The DFA accepts when the NFA can reach the accept
+ * state.
+ *
+ * An unanchored DFA acts as if the NFA started over at every byte, which is
+ * what finding matches anywhere in a stream of bytes requires.
+ *
+ * Gives up once the DFA would have more than max_states states.
+ *
+ * Returns 0 on success or one of the DFA_ERROR_ values on failure.
+ */
+int dfa_compile(struct dfa *d, struct nfa *n, int start, int accept, int unanchored, size_t max_states);
+
+/*
+ * Deinitializes a dfa struct, releasing all memory.
+ */
+void dfa_deinit(struct dfa *d);
+
+/*
+ * Returns the state reached by consuming a byte.
+ */
+inline uint32_t dfa_step(struct dfa *d, uint32_t state, unsigned char byte)
+{
+	return d->next[state * d->class_count + d->classes[byte]];
+}
+
+/*
+ * Tells whether the state is accepting.
+ */
+inline int dfa_accepting(struct dfa *d, uint32_t state)
+{
+	return d->accepting[state];
+}
+
+/*
+ * Tells whether no accepting state can be reached from the state anymore.
+ */
+inline int dfa_dead(struct dfa *d, uint32_t state)
+{
+	return state == 0;
+}
+
+#endif /* DFA_DFA_H */
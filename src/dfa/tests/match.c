@@ -0,0 +1,92 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "dfa/dfa.h"
+
+/*
+ * Builds an NFA for ab*c and checks where the unanchored DFA finds the ends
+ * of matches.
+ */
+int main(void)
+{
+	struct nfa n;
+	nfa_init(&n);
+
+	int start = nfa_add(&n);
+	int b = nfa_add(&n);
+	int c = nfa_add(&n);
+	int accept = nfa_add(&n);
+
+	if (nfa_error(&n)) {
+		fprintf(stderr, "Failed to add states.\n");
+		nfa_deinit(&n);
+		return 1;
+	}
+
+	nfa_set_byte(&n, start, 'a');
+	n.states[start].next = b;
+
+	nfa_set_byte(&n, b, 'b');
+	n.states[b].next = b;
+	n.states[b].epsilon[0] = c;
+
+	nfa_set_byte(&n, c, 'c');
+	n.states[c].next = accept;
+
+	struct dfa d;
+
+	if (dfa_compile(&d, &n, start, accept, 1, 100) != 0) {
+		fprintf(stderr, "Failed to compile.\n");
+		nfa_deinit(&n);
+		return 1;
+	}
+
+	nfa_deinit(&n);
+
+	const char *input = "xacaabbbcxabxbcac";
+	const char *expected = "00100000100000001";
+
+	uint32_t state = d.start;
+
+	for (size_t i = 0; i < strlen(input); ++i) {
+		state = dfa_step(&d, state, input[i]);
+
+		if (dfa_accepting(&d, state) != (expected[i] == '1')) {
+			fprintf(stderr, "Wrong answer at offset %zu.\n", i);
+			dfa_deinit(&d);
+			return 1;
+		}
+	}
+
+	if (dfa_dead(&d, state)) {
+		fprintf(stderr, "Unanchored DFA must never die.\n");
+		dfa_deinit(&d);
+		return 1;
+	}
+
+	dfa_deinit(&d);
+
+	// Anchored, the first byte that does not fit leads to the dead state.
+	nfa_init(&n);
+	start = nfa_add(&n);
+	accept = nfa_add(&n);
+	nfa_set_byte(&n, start, 'a');
+	n.states[start].next = accept;
+
+	if (nfa_error(&n) || dfa_compile(&d, &n, start, accept, 0, 100) != 0) {
+		fprintf(stderr, "Failed to compile anchored DFA.\n");
+		nfa_deinit(&n);
+		return 1;
+	}
+
+	nfa_deinit(&n);
+
+	if (!dfa_dead(&d, dfa_step(&d, d.start, 'x'))) {
+		fprintf(stderr, "Anchored DFA must die on a mismatch.\n");
+		dfa_deinit(&d);
+		return 1;
+	}
+
+	dfa_deinit(&d);
+	return 0;
+}
@@ -0,0 +1,108 @@
+#include <string.h>
+
+#include "hash/hash.h"
+
+#define PRIME1 0x9E3779B185EBCA87ULL
+#define PRIME2 0xC2B2AE3D27D4EB4FULL
+#define PRIME3 0x165667B19E3779F9ULL
+#define PRIME4 0x85EBCA77C2B2AE63ULL
+#define PRIME5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t rotl(uint64_t v, int n)
+{
+	return (v << n) | (v >> (64 - n));
+}
+
+/*
+ * Memory is not guaranteed to be aligned so words are copied out.
+ */
+static inline uint64_t read64(const unsigned char *p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint32_t read32(const unsigned char *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline uint64_t round64(uint64_t acc, uint64_t input)
+{
+	acc += input * PRIME2;
+	acc = rotl(acc, 31);
+	acc *= PRIME1;
+	return acc;
+}
+
+static inline uint64_t merge_round(uint64_t acc, uint64_t v)
+{
+	acc ^= round64(0, v);
+	acc = acc * PRIME1 + PRIME4;
+	return acc;
+}
+
+uint64_t hash64(const void *data, size_t size, uint64_t seed)
+{
+	const unsigned char *p = data;
+	const unsigned char *end = p + size;
+	uint64_t h;
+
+	if (size >= 32) {
+		// Four independent lanes so that the processor can work on
+		// them at the same time.
+		uint64_t v1 = seed + PRIME1 + PRIME2;
+		uint64_t v2 = seed + PRIME2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - PRIME1;
+
+		const unsigned char *limit = end - 32;
+
+		do {
+			v1 = round64(v1, read64(p));
+			v2 = round64(v2, read64(p + 8));
+			v3 = round64(v3, read64(p + 16));
+			v4 = round64(v4, read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+
+		h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+		h = merge_round(h, v1);
+		h = merge_round(h, v2);
+		h = merge_round(h, v3);
+		h = merge_round(h, v4);
+	} else {
+		h = seed + PRIME5;
+	}
+
+	h += (uint64_t) size;
+
+	while (p + 8 <= end) {
+		h ^= round64(0, read64(p));
+		h = rotl(h, 27) * PRIME1 + PRIME4;
+		p += 8;
+	}
+
+	if (p + 4 <= end) {
+		h ^= (uint64_t) read32(p) * PRIME1;
+		h = rotl(h, 23) * PRIME2 + PRIME3;
+		p += 4;
+	}
+
+	while (p < end) {
+		h ^= (*p) * PRIME5;
+		h = rotl(h, 11) * PRIME1;
+		p += 1;
+	}
+
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	h *= PRIME3;
+	h ^= h >> 32;
+
+	return h;
+}
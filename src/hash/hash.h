@@ -0,0 +1,16 @@
+#ifndef HASH_HASH_H
+#define HASH_HASH_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/*
+ * Computes a 64 bit hash of a block of memory.
+ *
+ * This is the xxHash64 algorithm. It's fast enough to go over large blocks of
+ * memory at close to the speed they can be read at, so it's useful for telling
+ * whether memory changed without having to keep a copy around.
+ */
+uint64_t hash64(const void *data, size_t size, uint64_t seed);
+
+#endif /* HASH_HASH_H */
@@ -0,0 +1,48 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "hash/hash.h"
+
+int main(void)
+{
+	char block[4096 + 1];
+
+	for (size_t i = 0; i < sizeof(block); ++i) {
+		block[i] = (char) (i * 31);
+	}
+
+	// Starting one byte in makes sure reads don't rely on alignment.
+	char *data = block + 1;
+	size_t size = sizeof(block) - 1;
+
+	uint64_t original = hash64(data, size, 0);
+
+	for (size_t i = 0; i < size; ++i) {
+		data[i] ^= 1;
+
+		if (hash64(data, size, 0) == original) {
+			fprintf(stderr, "Changing byte %zu did not change the hash.\n", i);
+			return 1;
+		}
+
+		data[i] ^= 1;
+	}
+
+	if (hash64(data, size, 0) != original) {
+		fprintf(stderr, "Hash of the same memory is not the same.\n");
+		return 1;
+	}
+
+	if (hash64(data, size - 1, 0) == original) {
+		fprintf(stderr, "Hash did not take size into account.\n");
+		return 1;
+	}
+
+	if (hash64(data, size, 1) == original) {
+		fprintf(stderr, "Hash did not take seed into account.\n");
+		return 1;
+	}
+
+	return 0;
+}
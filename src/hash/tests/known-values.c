@@ -0,0 +1,35 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include "hash/hash.h"
+
+struct test {
+	const char *input;
+	uint64_t seed;
+	uint64_t expected;
+};
+
+int main(void)
+{
+	struct test tests[] = {
+		{ "", 0, 0xEF46DB3751D8E999ULL },
+		{ "a", 0, 0xD24EC4F1A98C6E5BULL },
+		{ "abc", 0, 0x44BC2CF5AD770999ULL },
+		{ "Nobody inspects the spammish repetition", 0, 0xFBCEA83C8A378BF1ULL },
+	};
+
+	for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+		struct test *test = &tests[i];
+
+		uint64_t result = hash64(test->input, strlen(test->input), test->seed);
+
+		if (result != test->expected) {
+			fprintf(stderr, "Hash of \"%s\" was %016" PRIX64 ", expected %016" PRIX64 ".\n", test->input, result, test->expected);
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+#include <unistd.h>
+
+#include "jobs/jobs.h"
+
+void jobs_init(struct jobs *j, size_t count)
+{
+	j->count = count;
+	j->next = 0;
+
+	pthread_mutex_init(&j->lock, NULL);
+	pthread_cond_init(&j->done, NULL);
+}
+
+void jobs_deinit(struct jobs *j)
+{
+	pthread_cond_destroy(&j->done);
+	pthread_mutex_destroy(&j->lock);
+}
+
+int jobs_take(struct jobs *j, size_t *i)
+{
+	int taken = 0;
+
+	pthread_mutex_lock(&j->lock);
+
+	if (j->next < j->count) {
+		*i = j->next++;
+		taken = 1;
+	}
+
+	pthread_mutex_unlock(&j->lock);
+
+	return taken;
+}
+
+void jobs_finish(struct jobs *j, int *done)
+{
+	pthread_mutex_lock(&j->lock);
+	*done = 1;
+	pthread_cond_broadcast(&j->done);
+	pthread_mutex_unlock(&j->lock);
+}
+
+void jobs_wait(struct jobs *j, int *done)
+{
+	pthread_mutex_lock(&j->lock);
+
+	while (!*done) {
+		pthread_cond_wait(&j->done, &j->lock);
+	}
+
+	pthread_mutex_unlock(&j->lock);
+}
+
+int jobs_threads(int threads)
+{
+	if (threads > 0) {
+		return threads;
+	}
+
+	long processors = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return processors > 0 ? processors : 1;
+}
+
+int jobs_start(pthread_t *threads, int count, void *(*f)(void *), void *data, size_t size)
+{
+	int started = 0;
+
+	for (; started < count; ++started) {
+		if (pthread_create(&threads[started], NULL, f, (char *) data + started * size) != 0) {
+			break;
+		}
+	}
+
+	return started;
+}
+
+void jobs_join(pthread_t *threads, int count)
+{
+	for (int i = 0; i < count; ++i) {
+		pthread_join(threads[i], NULL);
+	}
+}
@@ -0,0 +1,72 @@
+#ifndef JOBS_JOBS_H
+#define JOBS_JOBS_H
+
+#include <stdlib.h>
+#include <pthread.h>
+
+/*
+ * Queue of jobs that threads take one at a time in the order they were
+ * planned. Jobs are known by their position. Call jobs_init to initialize the
+ * struct.
+ */
+struct jobs {
+	size_t count;
+
+	// Position of the next job to take.
+	size_t next;
+
+	pthread_mutex_t lock;
+
+	// Signaled whenever a job is done.
+	pthread_cond_t done;
+};
+
+/*
+ * Initializes a queue of the given number of jobs.
+ */
+void jobs_init(struct jobs *j, size_t count);
+
+/*
+ * Deinitializes a queue.
+ */
+void jobs_deinit(struct jobs *j);
+
+/*
+ * Takes the next job.
+ *
+ * Returns 1 and puts its position in i, or 0 when there are none left.
+ */
+int jobs_take(struct jobs *j, size_t *i);
+
+/*
+ * Sets the flag that tells that a job is done and wakes up whoever waits on
+ * it.
+ */
+void jobs_finish(struct jobs *j, int *done);
+
+/*
+ * Waits until the flag of a job is set by jobs_finish.
+ */
+void jobs_wait(struct jobs *j, int *done);
+
+/*
+ * Returns the given number of threads if it is positive, otherwise one per
+ * processor.
+ */
+int jobs_threads(int threads);
+
+/*
+ * Starts up to count threads that run f, putting their handles in threads.
+ * Thread i is given data plus i times size, so a size of 0 gives all of them
+ * the same data.
+ *
+ * Returns how many started. They are the first ones.
+ */
+int jobs_start(pthread_t *threads, int count, void *(*f)(void *), void *data, size_t size);
+
+/*
+ * Waits for threads started by jobs_start to end.
+ */
+void jobs_join(pthread_t *threads, int count);
+
+#endif /* JOBS_JOBS_H */
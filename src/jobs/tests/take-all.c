@@ -0,0 +1,73 @@
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "jobs/jobs.h"
+
+#define JOB_COUNT 10000
+
+#define THREAD_COUNT 4
+
+struct state {
+	struct jobs queue;
+
+	// How many times each job was taken.
+	int taken[JOB_COUNT];
+
+	// Done flag of each job.
+	int done[JOB_COUNT];
+};
+
+static void *take(void *data)
+{
+	struct state *s = data;
+	size_t i;
+
+	while (jobs_take(&s->queue, &i)) {
+		s->taken[i] += 1;
+		jobs_finish(&s->queue, &s->done[i]);
+	}
+
+	return NULL;
+}
+
+int main(void)
+{
+	static struct state s;
+
+	jobs_init(&s.queue, JOB_COUNT);
+
+	pthread_t threads[THREAD_COUNT];
+	int started = jobs_start(threads, THREAD_COUNT, take, &s, 0);
+
+	if (started == 0) {
+		take(&s);
+	}
+
+	// Waiting in order works no matter the order jobs finish in.
+	for (size_t i = 0; i < JOB_COUNT; ++i) {
+		jobs_wait(&s.queue, &s.done[i]);
+	}
+
+	jobs_join(threads, started);
+
+	jobs_deinit(&s.queue);
+
+	for (size_t i = 0; i < JOB_COUNT; ++i) {
+		if (s.taken[i] != 1) {
+			fprintf(stderr, "Job %zu was taken %d times.\n", i, s.taken[i]);
+			return 1;
+		}
+	}
+
+	if (jobs_threads(3) != 3) {
+		fprintf(stderr, "A positive number of threads is supposed to be kept.\n");
+		return 1;
+	}
+
+	if (jobs_threads(0) < 1) {
+		fprintf(stderr, "There's supposed to be at least one thread per processor.\n");
+		return 1;
+	}
+
+	return 0;
+}
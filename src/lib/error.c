@@ -28,6 +28,9 @@ static const char *a[] = {
 	[PROCTAL_ERROR_PROCESS_STOPPED] = "Process has stopped.",
 	[PROCTAL_ERROR_PROCESS_UNTAMEABLE] = "Process is in a state that cannot be dealt with.",
 	[PROCTAL_ERROR_PROCESS_TRAPPED] = "Process got trapped.",
+	[PROCTAL_ERROR_UNSUPPORTED_WATCH_SIZE] =
+		"Watching is only supported for 1, 2, 4 or 8 bytes at an address aligned to it"
+		" and for 1 byte when watching for instruction execution.",
 };
 
 int proctal_error(proctal p)
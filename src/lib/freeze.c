@@ -9,3 +9,8 @@ int proctal_unfreeze(proctal p)
 {
 	return proctal_impl_unfreeze(p);
 }
+
+size_t proctal_freeze_thread_count(proctal p)
+{
+	return proctal_impl_freeze_thread_count(p);
+}
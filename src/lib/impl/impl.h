@@ -21,6 +21,18 @@ int proctal_impl_freeze(proctal p);
 
 int proctal_impl_unfreeze(proctal p);
 
+size_t proctal_impl_freeze_thread_count(proctal p);
+
+int proctal_impl_sample(proctal p);
+
+size_t proctal_impl_sample_thread_count(proctal p);
+
+int proctal_impl_sample_thread(proctal p, size_t thread);
+
+size_t proctal_impl_sample_frame_count(proctal p, size_t thread);
+
+void *proctal_impl_sample_frame(proctal p, size_t thread, size_t frame);
+
 void proctal_impl_address_new(proctal p);
 
 int proctal_impl_address(proctal p, void **addr);
@@ -29,7 +41,23 @@ void proctal_impl_region_new(proctal p);
 
 int proctal_impl_region(proctal p, void **start, void **end);
 
-int proctal_impl_watch(proctal p, void **addr);
+const char *proctal_impl_region_path(proctal p);
+
+int proctal_impl_watch_begin(proctal p);
+
+int proctal_impl_watch_next(proctal p, void **addr);
+
+int proctal_impl_watch_end(proctal p);
+
+unsigned long long proctal_impl_watch_accesses(proctal p);
+
+int proctal_impl_watch_poll(proctal *instances, size_t count, size_t *ready);
+
+proctal_watch_poller proctal_impl_watch_poller_create(proctal p);
+
+void proctal_impl_watch_poller_destroy(proctal p, proctal_watch_poller poller);
+
+int proctal_impl_watch_poller_wait(proctal_watch_poller poller, proctal *instances, size_t count, size_t *ready);
 
 int proctal_impl_execute(proctal p, const char *byte_code, size_t byte_code_length);
 
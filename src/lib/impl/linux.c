@@ -5,8 +5,11 @@
 #include "lib/linux/address.h"
 #include "lib/linux/region.h"
 #include "lib/linux/watch.h"
+#include "lib/linux/poll.h"
 #include "lib/linux/alloc.h"
 #include "lib/linux/execute.h"
+#include "lib/linux/freeze.h"
+#include "lib/linux/sample.h"
 
 proctal proctal_impl_create(void)
 {
@@ -66,14 +69,56 @@ int proctal_impl_freeze(proctal p)
 {
 	struct proctal_linux *pl = (struct proctal_linux *) p;
 
-	return proctal_linux_ptrace_attach(pl);
+	return proctal_linux_freeze(pl);
 }
 
 int proctal_impl_unfreeze(proctal p)
 {
 	struct proctal_linux *pl = (struct proctal_linux *) p;
 
-	return proctal_linux_ptrace_detach(pl);
+	return proctal_linux_unfreeze(pl);
+}
+
+size_t proctal_impl_freeze_thread_count(proctal p)
+{
+	struct proctal_linux *pl = (struct proctal_linux *) p;
+
+	return pl->freeze.thread_count;
+}
+
+int proctal_impl_sample(proctal p)
+{
+	struct proctal_linux *pl = (struct proctal_linux *) p;
+
+	return proctal_linux_sample(pl);
+}
+
+size_t proctal_impl_sample_thread_count(proctal p)
+{
+	struct proctal_linux *pl = (struct proctal_linux *) p;
+
+	return pl->sample.thread_count;
+}
+
+int proctal_impl_sample_thread(proctal p, size_t thread)
+{
+	struct proctal_linux *pl = (struct proctal_linux *) p;
+
+	return pl->sample.threads[thread].tid;
+}
+
+size_t proctal_impl_sample_frame_count(proctal p, size_t thread)
+{
+	struct proctal_linux *pl = (struct proctal_linux *) p;
+
+	return pl->sample.threads[thread].frame_count;
+}
+
+void *proctal_impl_sample_frame(proctal p, size_t thread, size_t frame)
+{
+	struct proctal_linux *pl = (struct proctal_linux *) p;
+
+	return pl->sample.frames[pl->sample.threads[thread].first + frame];
 }
 
 void proctal_impl_address_new(proctal p)
@@ -104,11 +149,63 @@ int proctal_impl_region(proctal p, void **start, void **end)
 	return proctal_linux_region(pl, start, end);
 }
 
-int proctal_impl_watch(proctal p, void **addr)
+const char *proctal_impl_region_path(proctal p)
+{
+	struct proctal_linux *pl = (struct proctal_linux *) p;
+
+	return proctal_linux_region_path(pl);
+}
+
+int proctal_impl_watch_begin(proctal p)
+{
+	struct proctal_linux *pl = (struct proctal_linux *) p;
+
+	return proctal_linux_watch_begin(pl);
+}
+
+int proctal_impl_watch_next(proctal p, void **addr)
+{
+	struct proctal_linux *pl = (struct proctal_linux *) p;
+
+	return proctal_linux_watch_next(pl, addr);
+}
+
+int proctal_impl_watch_end(proctal p)
+{
+	struct proctal_linux *pl = (struct proctal_linux *) p;
+
+	return proctal_linux_watch_end(pl);
+}
+
+unsigned long long proctal_impl_watch_accesses(proctal p)
 {
 	struct proctal_linux *pl = (struct proctal_linux *) p;
 
-	return proctal_linux_watch(pl, addr);
+	return proctal_linux_watch_accesses(pl);
+}
+
+int proctal_impl_watch_poll(proctal *instances, size_t count, size_t *ready)
+{
+	return proctal_linux_watch_poll(instances, count, ready);
+}
+
+proctal_watch_poller proctal_impl_watch_poller_create(proctal p)
+{
+	struct proctal_linux *pl = (struct proctal_linux *) p;
+
+	return proctal_linux_watch_poller_create(pl);
+}
+
+void proctal_impl_watch_poller_destroy(proctal p, proctal_watch_poller poller)
+{
+	struct proctal_linux *pl = (struct proctal_linux *) p;
+
+	proctal_linux_watch_poller_destroy(pl, poller);
+}
+
+int proctal_impl_watch_poller_wait(proctal_watch_poller poller, proctal *instances, size_t count, size_t *ready)
+{
+	return proctal_linux_watch_poller_wait(poller, instances, count, ready);
 }
 
 int proctal_impl_execute(proctal p, const char *byte_code, size_t byte_code_length)
@@ -31,6 +31,7 @@
 #define PROCTAL_ERROR_PROCESS_STOPPED 17
 #define PROCTAL_ERROR_PROCESS_UNTAMEABLE 18
 #define PROCTAL_ERROR_PROCESS_TRAPPED 19
+#define PROCTAL_ERROR_UNSUPPORTED_WATCH_SIZE 20
 
 /*
  * Macro definitions of known memory regions.
@@ -46,12 +47,34 @@
 #define PROCTAL_ALLOC_PERM_WRITE 2
 #define PROCTAL_ALLOC_PERM_READ 4
 
+/*
+ * Largest number of watchpoints that can be watched at once.
+ */
+#define PROCTAL_WATCH_MAX 4
+
+/*
+ * Macro definitions of the ways memory accesses can be watched for.
+ */
+#define PROCTAL_WATCH_METHOD_DEBUG_REGISTERS 1
+#define PROCTAL_WATCH_METHOD_PAGE_PROTECTION 2
+#define PROCTAL_WATCH_METHOD_PERF_EVENTS 3
+
 /*
  * Provides a type name for an instance. The actual definition is an
  * implementation detail that you shouldn't worry about.
  */
 typedef struct proctal *proctal;
 
+/*
+ * Provides a type name for a pointer index.
+ */
+typedef struct proctal_pointer_index *proctal_pointer_index;
+
+/*
+ * Provides a type name for a watch poller.
+ */
+typedef struct proctal_watch_poller *proctal_watch_poller;
+
 /*
  * Creates an instance.
  *
@@ -365,6 +388,18 @@ void proctal_region_new(proctal p);
  */
 int proctal_region(proctal p, void **start, void **end);
 
+/*
+ * Returns the path of the file mapped to the memory region that was last
+ * passed by proctal_region.
+ *
+ * Memory regions that do not map a file have an empty path or a name enclosed
+ * in square brackets given by the operating system, such as [heap] or
+ * [stack].
+ *
+ * The string is only valid until the next call to proctal_region.
+ */
+const char *proctal_region_path(proctal p);
+
 /*
  * Returns which memory regions are being iterated over.
  *
@@ -442,7 +477,11 @@ int proctal_region_execute(proctal p);
 void proctal_region_set_execute(proctal p, int execute);
 
 /*
- * Freezes main thread of execution.
+ * Freezes every thread of execution, including the ones that are created
+ * while it happens. Threads are interrupted rather than sent a signal so that
+ * they stop as soon as possible.
+ *
+ * Freezing multiple times only has an effect the first time.
  *
  * You should unfreeze before exiting your program otherwise something may
  * crash.
@@ -460,19 +499,275 @@ int proctal_freeze(proctal p);
 int proctal_unfreeze(proctal p);
 
 /*
- * Watches for memory accesses by the main thread of execution.
+ * Returns how many threads are frozen.
+ */
+size_t proctal_freeze_thread_count(proctal p);
+
+/*
+ * Takes a sample of where every thread of execution is. The process is
+ * frozen, the address of the instruction that every thread is at is read
+ * along with the return addresses found by following frame pointers, and the
+ * process is unfrozen right away.
+ *
+ * Functions that do not keep a frame pointer make their callers go missing
+ * or be made up, and one that is about to set it up leaves out its caller.
+ *
+ * Cannot be used while watching.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int proctal_sample(proctal p);
+
+/*
+ * Returns how many threads were in the last sample.
+ */
+size_t proctal_sample_thread_count(proctal p);
+
+/*
+ * Returns the ID of a thread in the last sample.
+ */
+int proctal_sample_thread(proctal p, size_t thread);
+
+/*
+ * Returns how many addresses were found for a thread in the last sample.
+ */
+size_t proctal_sample_frame_count(proctal p, size_t thread);
+
+/*
+ * Returns an address found for a thread in the last sample. The first one is
+ * the address of the instruction the thread was at and the others are return
+ * addresses, from the innermost function outwards.
+ */
+void *proctal_sample_frame(proctal p, size_t thread, size_t frame);
+
+/*
+ * Largest number of addresses that are found for a thread, counting the
+ * address of the instruction it is at. By default it's 1, which leaves out
+ * the stack.
+ */
+size_t proctal_sample_depth(proctal p);
+
+/*
+ * Sets the largest number of addresses that are found for a thread. Anything
+ * below 1 is taken as 1.
+ */
+void proctal_sample_set_depth(proctal p, size_t depth);
+
+/*
+ * Watches for memory accesses by any thread of execution.
  *
  * You can define the address you want to watch by calling
- * proctal_watch_set_addr.
+ * proctal_watch_set_addr and how many bytes by calling proctal_watch_set_size.
  *
  * You can set whether you want to watch for reads or writes by calling
  * proctal_watch_set_read and proctal_watch_set_write. By default it's set to
  * watch only for reads.
  *
+ * Up to PROCTAL_WATCH_MAX watchpoints can be watched at once. Options are set
+ * on the watchpoint chosen with proctal_watch_select.
+ *
  * This function will block until an access is detected.
+ *
+ * Every call attaches to the process and sets up the breakpoint all over
+ * again. To catch more than one access, use proctal_watch_begin,
+ * proctal_watch_next and proctal_watch_end instead.
  */
 int proctal_watch(proctal p, void **addr);
 
+/*
+ * Begins a watch session. Attaches to every thread of the process and sets up
+ * the breakpoints once for every access that will be watched for with
+ * proctal_watch_next. Threads that are created later on get the breakpoints
+ * as well.
+ *
+ * Only the threads of the process are waited for. Changes in the state of
+ * other child processes of the calling thread are left for whoever started
+ * them, although while one of them goes unclaimed the threads are looked at
+ * less often. Use proctal_watch_poll to watch more than one process at once.
+ *
+ * Cannot be begun while the process is frozen by the same instance, unless
+ * watching with perf events.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int proctal_watch_begin(proctal p);
+
+/*
+ * Lets the process run until the next access is detected. The address of the
+ * instruction is put in addr, proctal_watch_hit tells which watchpoint
+ * detected it and proctal_watch_thread which thread made it.
+ *
+ * The thread that made the access is kept stopped until the next call while
+ * the others keep running.
+ *
+ * Can only be called between proctal_watch_begin and proctal_watch_end.
+ *
+ * Blocks once at most, so that the caller gets to look at signals that come
+ * in while stops that are not accesses are dealt with. Right after
+ * proctal_watch_poll or a poller chose the instance it does not block at all
+ * and only deals with what the instance was chosen for.
+ *
+ * Returns 1 when an access was detected. Returns 0 on failure or when the
+ * wait was interrupted by a signal or there was nothing to report, in which
+ * case no error is set.
+ */
+int proctal_watch_next(proctal p, void **addr);
+
+/*
+ * Ends a watch session. Removes the breakpoint and detaches from the process.
+ *
+ * Destroying the instance automatically ends the session.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int proctal_watch_end(proctal p);
+
+/*
+ * Returns the number of accesses to the selected watchpoint that were counted
+ * since the session began, including those that were not reported. Only
+ * works when watching with perf events.
+ *
+ * On failure returns 0. Call proctal_error to find out what happened.
+ */
+unsigned long long proctal_watch_accesses(proctal p);
+
+/*
+ * Waits on the watch sessions of many instances at once, so that one thread
+ * can watch many processes. Blocks until one of them has something to deal
+ * with and puts it in ready. Call proctal_watch_next on that one next, which
+ * will not block. Instances that keep having something to deal with do not
+ * keep the others waiting.
+ *
+ * Every instance must have begun a session and count must be above 0. Their
+ * sessions must not be waited on with proctal_watch_next alone in the mean
+ * time because the other sessions would be kept waiting. Changes in the state
+ * of child processes that are not watched are left for whoever started them.
+ *
+ * SIGCHLD is blocked and consumed while waiting.
+ *
+ * Everything it needs is set up on every call. Use a poller created with
+ * proctal_watch_poller_create when waiting over and over.
+ *
+ * Returns 1 on success. Returns 0 on failure, in which case the error is set
+ * on the instance put in ready, or when the wait was interrupted by a signal
+ * or woke up for a child process that is not watched, in which case ready is
+ * set to count and no error is set.
+ */
+int proctal_watch_poll(proctal *instances, size_t count, size_t *ready);
+
+/*
+ * Creates a poller, which waits on watch sessions the same way as
+ * proctal_watch_poll but keeps what it needs from one wait to the next, such
+ * as which session every thread belongs to.
+ *
+ * SIGCHLD is blocked in the calling thread for as long as the poller exists,
+ * so it must be waited on and destroyed by the same thread.
+ *
+ * The poller uses the memory allocator of the instance and must be destroyed
+ * with the same instance, which must outlive it.
+ *
+ * On failure returns NULL. Call proctal_error to find out what happened.
+ */
+proctal_watch_poller proctal_watch_poller_create(proctal p);
+
+/*
+ * Destroys a poller and unblocks SIGCHLD again.
+ */
+void proctal_watch_poller_destroy(proctal p, proctal_watch_poller poller);
+
+/*
+ * Waits on the watch sessions of many instances at once. The instances may
+ * differ from one call to the next.
+ *
+ * Returns the same as proctal_watch_poll.
+ */
+int proctal_watch_poller_wait(proctal_watch_poller poller, proctal *instances, size_t count, size_t *ready);
+
+/*
+ * Returns the number of watchpoints that will be watched at once.
+ */
+size_t proctal_watch_count(proctal p);
+
+/*
+ * Sets the number of watchpoints that will be watched at once, from 1 to
+ * PROCTAL_WATCH_MAX. Watchpoints are numbered from 0. By default only the
+ * first one is watched.
+ */
+void proctal_watch_set_count(proctal p, size_t count);
+
+/*
+ * Returns how accesses will be detected.
+ */
+int proctal_watch_method(proctal p);
+
+/*
+ * Sets how accesses will be detected, which is one of the macros whose name
+ * start with PROCTAL_WATCH_METHOD.
+ *
+ * With PROCTAL_WATCH_METHOD_DEBUG_REGISTERS, the default, the processor
+ * detects accesses on its own, which costs nothing until one happens, but
+ * watchpoints are limited in size.
+ *
+ * With PROCTAL_WATCH_METHOD_PAGE_PROTECTION the pages that watchpoints are in
+ * are protected from the accesses being watched for, which lets watchpoints be
+ * of any size. Every access to those pages stops the thread that made it,
+ * even when it's outside of the watchpoints, so that it can be carried out
+ * with the protection lifted for a single instruction. Accesses made by other
+ * threads during that time go unnoticed. Execution cannot be watched for and
+ * neither can reads on their own. The process must not change the protection
+ * of those pages while watching. The kernel does not stop a thread when it
+ * accesses the pages on behalf of the process, so system calls such as read(2)
+ * or recv(2) that fill a buffer in those pages fail with EFAULT instead.
+ *
+ * With PROCTAL_WATCH_METHOD_PERF_EVENTS the kernel sets up the debug registers
+ * and counts accesses without ever stopping the process, apart from a moment
+ * when the session begins. Only a sample of the accesses is reported, as set
+ * with proctal_watch_set_sample_period, and they are reported after the fact
+ * so the process keeps running. Watchpoints are limited in the same way as
+ * with the debug registers. Every watchpoint takes a file descriptor for every
+ * thread, times the number of processors when sampling, so a process with many
+ * threads can use up the limit on open files. The kernel may not allow it, or
+ * the limit may be reached, in which case beginning a session fails with
+ * PROCTAL_ERROR_UNSUPPORTED or PROCTAL_ERROR_PERMISSION_DENIED.
+ */
+void proctal_watch_set_method(proctal p, int method);
+
+/*
+ * Returns one out of how many accesses are reported when watching with perf
+ * events.
+ */
+unsigned long long proctal_watch_sample_period(proctal p);
+
+/*
+ * Sets one out of how many accesses are reported when watching with perf
+ * events. The others are only counted. With 0 none are reported and
+ * proctal_watch_next only returns when interrupted or when the process
+ * exits. The default is 1.
+ */
+void proctal_watch_set_sample_period(proctal p, unsigned long long period);
+
+/*
+ * Returns the watchpoint that options are set on.
+ */
+size_t proctal_watch_selected(proctal p);
+
+/*
+ * Chooses the watchpoint that the following functions set options on. By
+ * default it's the first one.
+ */
+void proctal_watch_select(proctal p, size_t index);
+
+/*
+ * Returns the watchpoint that detected the last access, or -1 if it's not
+ * known.
+ */
+int proctal_watch_hit(proctal p);
+
+/*
+ * Returns the ID of the thread that made the last access.
+ */
+int proctal_watch_thread(proctal p);
+
 /*
  * Returns the address that will be watched for accesses.
  */
@@ -483,6 +778,19 @@ void *proctal_watch_address(proctal p);
  */
 void proctal_watch_set_address(proctal p, void *addr);
 
+/*
+ * Returns the number of bytes that will be watched for accesses.
+ */
+size_t proctal_watch_size(proctal p);
+
+/*
+ * Sets the number of bytes to watch. Can be 1, 2, 4 or 8 and the address must
+ * be aligned to it, unless watching with page protection where it can be any
+ * number above 0. Instruction execution can only be watched with 1. The
+ * default is 1.
+ */
+void proctal_watch_set_size(proctal p, size_t size);
+
 /*
  * Checks whether it's going to watch for reads.
  *
@@ -565,6 +873,82 @@ void *proctal_alloc(proctal p, size_t size, int perm);
  */
 void proctal_dealloc(proctal p, void *addr);
 
+/*
+ * Creates an index of the pointers stored in the writable memory of the
+ * program. It starts out empty, call proctal_pointer_index_build to fill it.
+ *
+ * A value is taken as a pointer if it is aligned and points inside a memory
+ * region. The index is kept sorted by the address that the pointers point to.
+ *
+ * The index uses the memory allocator of the instance and must be destroyed
+ * with the same instance.
+ *
+ * On failure returns NULL. Call proctal_error to find out what happened.
+ */
+proctal_pointer_index proctal_pointer_index_create(proctal p);
+
+/*
+ * Destroys an index.
+ */
+void proctal_pointer_index_destroy(proctal p, proctal_pointer_index index);
+
+/*
+ * Returns the number of threads used to go over memory and sort pointers. 0
+ * means one per processor, which is the default.
+ */
+int proctal_pointer_index_threads(proctal_pointer_index index);
+
+/*
+ * Sets the number of threads used to go over memory and sort pointers.
+ */
+void proctal_pointer_index_set_threads(proctal_pointer_index index, int threads);
+
+/*
+ * Goes over all writable memory and replaces the contents of the index with
+ * the pointers it finds.
+ *
+ * The memory region iterator is left in a clean state with the same options
+ * it had before the call.
+ *
+ * On failure returns 0 and the index is left untouched. Call proctal_error to
+ * find out what happened.
+ */
+int proctal_pointer_index_build(proctal p, proctal_pointer_index index);
+
+/*
+ * Brings the index up to date by only going over the pointers of pages whose
+ * contents changed since the index was last built or refreshed. If memory
+ * regions were mapped or unmapped in the meantime, it does the same as
+ * proctal_pointer_index_build.
+ *
+ * The memory region iterator is left in a clean state with the same options
+ * it had before the call.
+ *
+ * On failure returns 0 and the index is left untouched. Call proctal_error to
+ * find out what happened.
+ */
+int proctal_pointer_index_refresh(proctal p, proctal_pointer_index index);
+
+/*
+ * Returns the number of pointers in the index.
+ */
+size_t proctal_pointer_index_size(proctal_pointer_index index);
+
+/*
+ * Finds the pointers that point to an address in the range that begins at
+ * start and ends right before end.
+ *
+ * Returns how many there are. Their positions in the index are consecutive
+ * and begin at the one written to first.
+ */
+size_t proctal_pointer_index_find(proctal_pointer_index index, void *start, void *end, size_t *first);
+
+/*
+ * Retrieves the pointer at the given position of the index: the address it
+ * points to and the address where it is stored.
+ */
+void proctal_pointer_index_get(proctal_pointer_index index, size_t i, void **pointee, void **location);
+
 /*
  * Sets the memory allocator/deallocator used for internal data structures.
  *
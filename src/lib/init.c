@@ -18,10 +18,22 @@ void proctal_init(struct proctal *p)
 	p->region.write = 0;
 	p->region.execute = 0;
 
-	p->watch.addr = NULL;
-	p->watch.read = 0;
-	p->watch.write = 0;
-	p->watch.execute = 0;
+	for (size_t i = 0; i < PROCTAL_WATCH_MAX; ++i) {
+		p->watch.points[i].addr = NULL;
+		p->watch.points[i].size = 1;
+		p->watch.points[i].read = 0;
+		p->watch.points[i].write = 0;
+		p->watch.points[i].execute = 0;
+	}
+
+	p->watch.method = PROCTAL_WATCH_METHOD_DEBUG_REGISTERS;
+	p->watch.sample_period = 1;
+	p->watch.count = 1;
+	p->watch.selected = 0;
+	p->watch.hit = -1;
+	p->watch.thread = 0;
+
+	p->sample.depth = 1;
 }
 
 void proctal_deinit(struct proctal *p)
@@ -1,3 +1,8 @@
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include "lib/linux/execute.h"
 #include "lib/linux/proc.h"
 #include "lib/linux/alloc.h"
@@ -30,20 +35,8 @@ struct execute_save_state {
 	// TODO: Save remaining registers.
 };
 
-struct syscall_save_state {
-	void *addr; // Instruction pointer.
-	unsigned long long eflags; // Flags.
-	unsigned long long rdi; // First argument.
-	unsigned long long rsi; // Second argument.
-	unsigned long long rdx; // Third argument.
-	unsigned long long r10; // Fourth argument.
-	unsigned long long r8; // Fifth argument.
-	unsigned long long r9; // Sixth argument.
-	unsigned long long rax; // Return value.
-
-	unsigned long long rcx; // May be modifed.
-	unsigned long long r11; // May be modifed.
-};
+// The syscall instruction.
+static const char syscall_code[] = { 0x0F, 0x05 };
 
 static inline int execute_save_state(struct proctal_linux *pl, struct execute_save_state *s)
 {
@@ -97,42 +90,6 @@ static inline int execute_load_state(struct proctal_linux *pl, struct execute_sa
 	return 1;
 }
 
-static inline int syscall_save_state(struct proctal_linux *pl, struct syscall_save_state *s)
-{
-	if (!proctal_linux_ptrace_get_instruction_address(pl, &s->addr)
-		|| !proctal_linux_ptrace_get_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RDI, &s->rdi)
-		|| !proctal_linux_ptrace_get_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RSI, &s->rsi)
-		|| !proctal_linux_ptrace_get_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RDX, &s->rdx)
-		|| !proctal_linux_ptrace_get_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_R10, &s->r10)
-		|| !proctal_linux_ptrace_get_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_R8, &s->r8)
-		|| !proctal_linux_ptrace_get_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_R9, &s->r9)
-		|| !proctal_linux_ptrace_get_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RAX, &s->rax)
-		|| !proctal_linux_ptrace_get_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RCX, &s->rcx)
-		|| !proctal_linux_ptrace_get_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_R11, &s->r11)) {
-		return 0;
-	}
-
-	return 1;
-}
-
-static inline int syscall_load_state(struct proctal_linux *pl, struct syscall_save_state *s)
-{
-	if (!proctal_linux_ptrace_set_instruction_address(pl, s->addr)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RDI, s->rdi)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RSI, s->rsi)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RDX, s->rdx)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_R10, s->r10)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_R8, s->r8)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_R9, s->r9)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RAX, s->rax)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RCX, s->rcx)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_R11, s->r11)) {
-		return 0;
-	}
-
-	return 1;
-}
-
 static inline void *find_inject_addr(struct proctal_linux *pl, size_t size)
 {
 	FILE *maps = fopen(proctal_linux_proc_path(pl->pid, "maps"), "r");
@@ -162,9 +119,82 @@ static inline void *find_inject_addr(struct proctal_linux *pl, size_t size)
 	return addr;
 }
 
-static inline int set_syscall6(
+void *proctal_linux_execute_syscall_addr(struct proctal_linux *pl)
+{
+	void *addr = find_inject_addr(pl, ARRAY_SIZE(syscall_code));
+
+	if (addr == NULL) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_INJECT_ADDR_NOT_FOUND);
+	}
+
+	return addr;
+}
+
+/*
+ * Steps over the system call instruction. A signal that was on its way to the
+ * thread may stop it before the instruction runs, in which case it's put in
+ * signal and the step is tried again.
+ */
+static inline int step_syscall(struct proctal_linux *pl, pid_t tid, int *signal)
+{
+	for (;;) {
+		int stopped;
+
+		if (proctal_linux_ptrace_thread_step(pl, tid, &stopped)) {
+			return 1;
+		}
+
+		// The instruction itself faulting is not retried.
+		if (stopped == 0 || stopped == SIGSEGV) {
+			return 0;
+		}
+
+		proctal_error_ack(&pl->p);
+		*signal = stopped;
+	}
+}
+
+/*
+ * Runs the system call instruction at addr with the given registers. A thread
+ * that was stopped in the middle of a system call, such as when it reports
+ * creating a thread, finishes it first and stops again before getting to the
+ * instruction. What it returned is then put in orig so that the thread gets
+ * it back.
+ */
+static inline int do_syscall(struct proctal_linux *pl, pid_t tid, void *addr, struct user_regs_struct *regs, struct user_regs_struct *orig, unsigned long long *ret, int *signal)
+{
+	struct user_regs_struct after;
+
+	do {
+		if (!proctal_linux_ptrace_thread_set_x86_regs(pl, tid, regs)
+			|| !step_syscall(pl, tid, signal)
+			|| !proctal_linux_ptrace_thread_get_x86_regs(pl, tid, &after)) {
+			return 0;
+		}
+
+		if (after.rip == (unsigned long long) addr) {
+			orig->rax = after.rax;
+		}
+	} while (after.rip == (unsigned long long) addr);
+
+	*ret = after.rax;
+
+	return 1;
+}
+
+/*
+ * Puts the system call instruction at addr, or puts back what was there
+ * before.
+ */
+static inline int swap_syscall(struct proctal_linux *pl, void *addr, char *code)
+{
+	return proctal_linux_mem_swap(pl, addr, code, code, ARRAY_SIZE(syscall_code));
+}
+
+int proctal_linux_execute_syscall(
 	struct proctal_linux *pl,
 	int num,
+	unsigned long long *ret,
 	unsigned long long one,
 	unsigned long long two,
 	unsigned long long three,
@@ -172,55 +202,45 @@ static inline int set_syscall6(
 	unsigned long long five,
 	unsigned long long six)
 {
-	if (!proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RAX, num)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RDI, one)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RSI, two)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RDX, three)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_R10, four)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_R8, five)
-		|| !proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_R9, six)) {
+	if (!proctal_linux_ptrace_attach(pl)) {
 		return 0;
 	}
 
-	return 1;
-}
-
-static inline int do_syscall(struct proctal_linux *pl, unsigned long long *ret)
-{
-	char code[] = { 0x0F, 0x05 };
-
-	void *inject_addr = find_inject_addr(pl, ARRAY_SIZE(code));
+	void *addr = proctal_linux_execute_syscall_addr(pl);
+	char code[ARRAY_SIZE(syscall_code)];
+	int signal = 0;
 
-	if (inject_addr == NULL) {
-		proctal_set_error(&pl->p, PROCTAL_ERROR_INJECT_ADDR_NOT_FOUND);
-		return 0;
-	}
+	memcpy(code, syscall_code, ARRAY_SIZE(code));
 
-	if (!proctal_linux_mem_swap(pl, inject_addr, code, code, ARRAY_SIZE(code))) {
+	if (addr == NULL || !swap_syscall(pl, addr, code)) {
+		proctal_linux_ptrace_detach(pl);
 		return 0;
 	}
 
-	if (!proctal_linux_ptrace_set_instruction_address(pl, inject_addr)) {
-		return 0;
-	}
+	int ok = proctal_linux_execute_thread_syscall(pl, pl->pid, addr, &signal, num, ret, one, two, three, four, five, six);
 
-	if (!proctal_linux_ptrace_step(pl)) {
+	if (!swap_syscall(pl, addr, code) || !ok) {
+		proctal_linux_ptrace_detach(pl);
 		return 0;
 	}
 
-	if (!proctal_linux_ptrace_get_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_RAX, ret)) {
+	if (!proctal_linux_ptrace_detach(pl)) {
 		return 0;
 	}
 
-	if (!proctal_linux_mem_swap(pl, inject_addr, code, code, ARRAY_SIZE(code))) {
-		return 0;
+	if (signal != 0) {
+		// Sent again so that it's not lost.
+		kill(pl->pid, signal);
 	}
 
 	return 1;
 }
 
-int proctal_linux_execute_syscall(
+int proctal_linux_execute_thread_syscall(
 	struct proctal_linux *pl,
+	pid_t tid,
+	void *addr,
+	int *signal,
 	int num,
 	unsigned long long *ret,
 	unsigned long long one,
@@ -230,34 +250,72 @@ int proctal_linux_execute_syscall(
 	unsigned long long five,
 	unsigned long long six)
 {
-	struct syscall_save_state orig;
+	struct user_regs_struct orig, regs;
 
-	if (!proctal_linux_ptrace_attach(pl)) {
+	// The system call that the thread was stopped in is kept in orig_rax
+	// and restored along with everything else, so that the kernel
+	// restarts it when the thread resumes.
+	if (!proctal_linux_ptrace_thread_get_x86_regs(pl, tid, &orig)) {
 		return 0;
 	}
 
-	if (!syscall_save_state(pl, &orig)) {
-		proctal_linux_ptrace_detach(pl);
+	regs = orig;
+	regs.rip = (unsigned long long) addr;
+	regs.rax = num;
+	regs.rdi = one;
+	regs.rsi = two;
+	regs.rdx = three;
+	regs.r10 = four;
+	regs.r8 = five;
+	regs.r9 = six;
+
+	if (!do_syscall(pl, tid, addr, &regs, &orig, ret, signal)) {
+		proctal_linux_ptrace_thread_set_x86_regs(pl, tid, &orig);
 		return 0;
 	}
 
-	if (!set_syscall6(pl, num, one, two, three, four, five, six)
-		|| !do_syscall(pl, ret)) {
-		syscall_load_state(pl, &orig);
-		proctal_linux_ptrace_detach(pl);
+	if (!proctal_linux_ptrace_thread_set_x86_regs(pl, tid, &orig)) {
 		return 0;
 	}
 
-	if (!syscall_load_state(pl, &orig)) {
-		proctal_linux_ptrace_detach(pl);
-		return 0;
+	return 1;
+}
+
+void *proctal_linux_execute_syscall_page(struct proctal_linux *pl, pid_t tid, int *signal)
+{
+	void *addr = proctal_linux_execute_syscall_addr(pl);
+	char code[ARRAY_SIZE(syscall_code)];
+
+	memcpy(code, syscall_code, ARRAY_SIZE(code));
+
+	if (addr == NULL || !swap_syscall(pl, addr, code)) {
+		return NULL;
 	}
 
-	if (!proctal_linux_ptrace_detach(pl)) {
-		return 0;
+	int prot = PROT_READ | PROT_EXEC;
+	int flags = 0x22; // MAP_PRIVATE | MAP_ANONYMOUS
+	unsigned long long page;
+
+	// mmap x86-64 system call.
+	int ok = proctal_linux_execute_thread_syscall(pl, tid, addr, signal, 9, &page, 0, sysconf(_SC_PAGESIZE), prot, flags, -1, 0);
+
+	if (!swap_syscall(pl, addr, code) || !ok) {
+		return NULL;
 	}
 
-	return 1;
+	// Errors are returned as negative numbers.
+	if (page > (unsigned long long) -4096) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+		return NULL;
+	}
+
+	// Written the same way a debugger puts in breakpoints, since the
+	// page is not writable.
+	if (!proctal_linux_mem_write(pl, (void *) page, syscall_code, ARRAY_SIZE(syscall_code))) {
+		return NULL;
+	}
+
+	return (void *) page;
 }
 
 int proctal_linux_execute(struct proctal_linux *pl, const char *byte_code, size_t byte_code_length)
@@ -16,4 +16,48 @@ int proctal_linux_execute_syscall(
 	unsigned long long five,
 	unsigned long long six);
 
+/*
+ * Finds where the instruction that performs a system call can be put for a
+ * moment. It stays usable as long as the memory map of the process doesn't
+ * change there.
+ *
+ * Returns NULL on failure.
+ */
+void *proctal_linux_execute_syscall_addr(struct proctal_linux *pl);
+
+/*
+ * Makes a thread that is already attached to and stopped map a page of its
+ * own that holds the instruction that performs a system call, so that system
+ * calls can be made over and over without putting the instruction over code.
+ * The instruction is put at the address given by
+ * proctal_linux_execute_syscall_addr for a moment to do so, which is why the
+ * other threads must not be running. The page is left for the caller to unmap.
+ * A signal that comes in the mean time is put in signal for the caller to
+ * deliver when the thread is resumed.
+ *
+ * Returns NULL on failure.
+ */
+void *proctal_linux_execute_syscall_page(struct proctal_linux *pl, pid_t tid, int *signal);
+
+/*
+ * Makes a thread that is already attached to and stopped perform a system
+ * call by running the instruction that is already at addr, such as in the
+ * page given by proctal_linux_execute_syscall_page. A signal that comes in
+ * the mean time is put in signal for the caller to deliver when the thread is
+ * resumed.
+ */
+int proctal_linux_execute_thread_syscall(
+	struct proctal_linux *pl,
+	pid_t tid,
+	void *addr,
+	int *signal,
+	int num,
+	unsigned long long *ret,
+	unsigned long long one,
+	unsigned long long two,
+	unsigned long long three,
+	unsigned long long four,
+	unsigned long long five,
+	unsigned long long six);
+
 #endif /* LIB_LINUX_EXECUTE_H */
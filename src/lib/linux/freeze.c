@@ -0,0 +1,251 @@
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+
+#include "lib/linux/proctal.h"
+#include "lib/linux/freeze.h"
+#include "lib/linux/proc.h"
+
+static int has_thread(struct proctal_linux *pl, pid_t tid)
+{
+	for (size_t i = 0; i < pl->freeze.thread_count; ++i) {
+		if (pl->freeze.threads[i].tid == tid) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Starts keeping track of a thread.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int add_thread(struct proctal_linux *pl, pid_t tid)
+{
+	struct proctal_linux_freeze *f = &pl->freeze;
+
+	if (f->thread_count == f->thread_capacity) {
+		size_t capacity = f->thread_capacity ? f->thread_capacity * 2 : 16;
+		struct proctal_linux_freeze_thread *threads = proctal_malloc(&pl->p, capacity * sizeof(*threads));
+
+		if (threads == NULL) {
+			return 0;
+		}
+
+		if (f->threads) {
+			memcpy(threads, f->threads, f->thread_count * sizeof(*threads));
+			proctal_free(&pl->p, f->threads);
+		}
+
+		f->threads = threads;
+		f->thread_capacity = capacity;
+	}
+
+	f->threads[f->thread_count].tid = tid;
+	f->threads[f->thread_count].signal = 0;
+	++f->thread_count;
+
+	return 1;
+}
+
+static void remove_thread(struct proctal_linux *pl, size_t i)
+{
+	pl->freeze.threads[i] = pl->freeze.threads[--pl->freeze.thread_count];
+}
+
+/*
+ * Seizes every thread of the process that is not seized yet and interrupts
+ * it. Interrupting does not wait for a signal to be delivered so threads stop
+ * about as soon as they get to run.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int seize_threads(struct proctal_linux *pl)
+{
+	int found;
+
+	do {
+		DIR *dir = proctal_linux_proc_tasks(pl->pid);
+
+		if (dir == NULL) {
+			proctal_set_error(&pl->p, PROCTAL_ERROR_PROCESS_NOT_FOUND);
+			return 0;
+		}
+
+		found = 0;
+
+		pid_t tid;
+
+		while ((tid = proctal_linux_proc_next_task(dir)) != 0) {
+			if (has_thread(pl, tid)) {
+				continue;
+			}
+
+			if (!proctal_linux_ptrace_thread_seize(pl, tid, PTRACE_O_TRACECLONE)) {
+				// Threads other than the main one may have
+				// exited or been seized on creation in the
+				// mean time.
+				if (tid == pl->pid) {
+					closedir(dir);
+					return 0;
+				}
+
+				proctal_error_ack(&pl->p);
+				continue;
+			}
+
+			if (!add_thread(pl, tid)) {
+				proctal_linux_ptrace_thread_detach(pl, tid, 0);
+				closedir(dir);
+				return 0;
+			}
+
+			if (!proctal_linux_ptrace_thread_interrupt(pl, tid)) {
+				// Exited already, which is found out when
+				// waiting for it.
+				proctal_error_ack(&pl->p);
+			}
+
+			found = 1;
+		}
+
+		closedir(dir);
+	} while (found);
+
+	return 1;
+}
+
+/*
+ * Waits for every thread to stop. Threads that were created while they were
+ * being seized report it before stopping and are added to the list, where
+ * they will be waited on as well because they start stopped.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int wait_threads(struct proctal_linux *pl)
+{
+	for (size_t i = 0; i < pl->freeze.thread_count;) {
+		pid_t tid = pl->freeze.threads[i].tid;
+		int wstatus;
+
+		if (waitpid(tid, &wstatus, __WALL) != tid
+			|| WIFEXITED(wstatus)
+			|| WIFSIGNALED(wstatus)) {
+			if (tid == pl->pid) {
+				proctal_set_error(&pl->p, PROCTAL_ERROR_PROCESS_EXITED);
+				return 0;
+			}
+
+			remove_thread(pl, i);
+			continue;
+		}
+
+		int event = wstatus >> 16;
+		int signal = WSTOPSIG(wstatus);
+
+		if (event == PTRACE_EVENT_CLONE) {
+			unsigned long child;
+
+			if (proctal_linux_ptrace_thread_event_message(pl, tid, &child)
+				&& !has_thread(pl, child)
+				&& !add_thread(pl, child)) {
+				return 0;
+			}
+
+			// The thread is not in the stop that was asked for
+			// yet.
+			if (!proctal_linux_ptrace_thread_cont(pl, tid, 0)) {
+				return 0;
+			}
+
+			continue;
+		} else if (event == 0) {
+			// A signal that was on its way to the process. It
+			// stays pending until the thread is let go.
+			pl->freeze.threads[i].signal = signal;
+
+			if (!proctal_linux_ptrace_thread_interrupt(pl, tid)
+				|| !proctal_linux_ptrace_thread_cont(pl, tid, 0)) {
+				return 0;
+			}
+
+			continue;
+		}
+
+		++i;
+	}
+
+	return 1;
+}
+
+/*
+ * Lets every thread go.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int detach_threads(struct proctal_linux *pl)
+{
+	int ok = 1;
+
+	for (size_t i = 0; i < pl->freeze.thread_count; ++i) {
+		struct proctal_linux_freeze_thread *thread = &pl->freeze.threads[i];
+
+		if (!proctal_linux_ptrace_thread_detach(pl, thread->tid, thread->signal)) {
+			// Threads may have exited while frozen.
+			if (thread->tid == pl->pid) {
+				ok = 0;
+			} else {
+				proctal_error_ack(&pl->p);
+			}
+		}
+	}
+
+	pl->freeze.thread_count = 0;
+
+	return ok;
+}
+
+int proctal_linux_freeze(struct proctal_linux *pl)
+{
+	if (pl->freeze.count) {
+		++pl->freeze.count;
+		return 1;
+	}
+
+	// Threads cannot be seized while they are attached to some other way.
+	if (pl->ptrace || pl->watch.started) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED);
+		return 0;
+	}
+
+	if (!seize_threads(pl) || !wait_threads(pl)) {
+		detach_threads(pl);
+		return 0;
+	}
+
+	// The main thread now counts as attached to so that code injection
+	// and the like can work with it.
+	pl->ptrace = 1;
+	pl->freeze.count = 1;
+
+	return 1;
+}
+
+int proctal_linux_unfreeze(struct proctal_linux *pl)
+{
+	if (pl->freeze.count == 0) {
+		return 1;
+	}
+
+	if (--pl->freeze.count) {
+		return 1;
+	}
+
+	pl->ptrace = 0;
+
+	return detach_threads(pl);
+}
@@ -0,0 +1,11 @@
+#ifndef LIB_LINUX_FREEZE_H
+#define LIB_LINUX_FREEZE_H
+
+#include "lib/linux/proctal.h"
+#include "lib/linux/ptrace.h"
+
+int proctal_linux_freeze(struct proctal_linux *pl);
+
+int proctal_linux_unfreeze(struct proctal_linux *pl);
+
+#endif /* LIB_LINUX_FREEZE_H */
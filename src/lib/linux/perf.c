@@ -0,0 +1,637 @@
+// There is no wrapper for perf_event_open, only syscall.
+#define _DEFAULT_SOURCE
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <linux/hw_breakpoint.h>
+
+#include "lib/linux/perf.h"
+#include "lib/linux/freeze.h"
+
+// Number of pages that samples are written to on every processor, not
+// counting the page in front that tells where they are. Must be a power of 2.
+#define BUFFER_PAGES 16
+
+/*
+ * What a sample is made of, in the order the kernel writes it.
+ */
+struct sample {
+	uint64_t id;
+	uint64_t ip;
+	uint32_t pid;
+	uint32_t tid;
+};
+
+static void set_error(struct proctal_linux *pl, int error)
+{
+	switch (error) {
+	case EACCES:
+	case EPERM:
+		proctal_set_error(&pl->p, PROCTAL_ERROR_PERMISSION_DENIED);
+		break;
+
+	case ESRCH:
+		proctal_set_error(&pl->p, PROCTAL_ERROR_PROCESS_NOT_FOUND);
+		break;
+
+	case ENOMEM:
+		proctal_set_error(&pl->p, PROCTAL_ERROR_OUT_OF_MEMORY);
+		break;
+
+	case ENOENT:
+	case ENODEV:
+	case ENOSPC:
+	case ENOSYS:
+	case EINVAL:
+	case EOPNOTSUPP:
+		// Either the kernel was built without them or the processor
+		// cannot watch like that.
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED);
+		break;
+
+	case EMFILE:
+	case ENFILE:
+		// Every event takes a file descriptor so a process with
+		// many threads can run out of them, which the other
+		// methods don't need.
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED);
+		break;
+
+	default:
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+		break;
+	}
+}
+
+static void init_attr(struct proctal_linux *pl, struct proctal_watch_point *point, struct perf_event_attr *attr)
+{
+	memset(attr, 0, sizeof(*attr));
+
+	attr->type = PERF_TYPE_BREAKPOINT;
+	attr->size = sizeof(*attr);
+	attr->bp_addr = (uintptr_t) point->addr;
+
+	if (point->execute) {
+		attr->bp_type = HW_BREAKPOINT_X;
+
+		// The kernel does not accept any other length for execution.
+		attr->bp_len = sizeof(long);
+	} else {
+		attr->bp_type = point->read ? HW_BREAKPOINT_RW : HW_BREAKPOINT_W;
+		attr->bp_len = point->size;
+	}
+
+	// Threads created later on get copies of the events.
+	attr->inherit = 1;
+	attr->exclude_kernel = 1;
+	attr->exclude_hv = 1;
+
+	if (pl->p.watch.sample_period) {
+		attr->sample_period = pl->p.watch.sample_period;
+		attr->sample_type = PERF_SAMPLE_IDENTIFIER | PERF_SAMPLE_IP | PERF_SAMPLE_TID;
+		attr->wakeup_events = 1;
+	}
+}
+
+/*
+ * Starts keeping track of an event.
+ *
+ * Returns NULL on failure.
+ */
+static struct proctal_linux_watch_event *add_event(struct proctal_linux *pl, int fd, size_t point)
+{
+	struct proctal_linux_watch *w = &pl->watch;
+
+	if (w->event_count == w->event_capacity) {
+		size_t capacity = w->event_capacity ? w->event_capacity * 2 : 16;
+		struct proctal_linux_watch_event *events = proctal_malloc(&pl->p, capacity * sizeof(*events));
+
+		if (events == NULL) {
+			return NULL;
+		}
+
+		if (w->events) {
+			memcpy(events, w->events, w->event_count * sizeof(*events));
+			proctal_free(&pl->p, w->events);
+		}
+
+		w->events = events;
+		w->event_capacity = capacity;
+	}
+
+	struct proctal_linux_watch_event *event = &w->events[w->event_count++];
+	event->fd = fd;
+	event->id = 0;
+	event->point = point;
+	event->hup = 0;
+
+	return event;
+}
+
+/*
+ * Maps the buffer that the samples of an event are written to.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int add_buffer(struct proctal_linux *pl, int fd)
+{
+	struct proctal_linux_watch *w = &pl->watch;
+
+	if (w->buffer_count == w->buffer_capacity) {
+		size_t capacity = w->buffer_capacity ? w->buffer_capacity * 2 : 16;
+		struct proctal_linux_watch_buffer *buffers = proctal_malloc(&pl->p, capacity * sizeof(*buffers));
+
+		if (buffers == NULL) {
+			return 0;
+		}
+
+		if (w->buffers) {
+			memcpy(buffers, w->buffers, w->buffer_count * sizeof(*buffers));
+			proctal_free(&pl->p, w->buffers);
+		}
+
+		w->buffers = buffers;
+		w->buffer_capacity = capacity;
+	}
+
+	size_t page_size = sysconf(_SC_PAGESIZE);
+	void *buffer = mmap(NULL, (BUFFER_PAGES + 1) * page_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	if (buffer == MAP_FAILED) {
+		set_error(pl, errno);
+		return 0;
+	}
+
+	w->buffers[w->buffer_count].page = buffer;
+	w->buffers[w->buffer_count].fd = fd;
+	++w->buffer_count;
+
+	return 1;
+}
+
+static void close_events(struct proctal_linux *pl)
+{
+	size_t page_size = sysconf(_SC_PAGESIZE);
+
+	if (pl->watch.epoll != -1) {
+		close(pl->watch.epoll);
+		pl->watch.epoll = -1;
+	}
+
+	if (pl->watch.pidfd != -1) {
+		close(pl->watch.pidfd);
+		pl->watch.pidfd = -1;
+	}
+
+	for (size_t i = 0; i < pl->watch.buffer_count; ++i) {
+		munmap(pl->watch.buffers[i].page, (BUFFER_PAGES + 1) * page_size);
+	}
+
+	for (size_t i = 0; i < pl->watch.event_count; ++i) {
+		close(pl->watch.events[i].fd);
+	}
+
+	pl->watch.buffer_count = 0;
+	pl->watch.event_count = 0;
+}
+
+/*
+ * Opens an event for every watchpoint on every thread that only counts on the
+ * given processor, or on all of them when cpu is -1. When sampling they all
+ * write their samples to the same buffer, which needs a processor to be
+ * given.
+ *
+ * Returns 1 on success, 0 on failure and -1 when the processor is offline.
+ */
+static int open_events(struct proctal_linux *pl, int cpu)
+{
+	int output = -1;
+
+	for (size_t i = 0; i < pl->freeze.thread_count; ++i) {
+		pid_t tid = pl->freeze.threads[i].tid;
+
+		for (size_t j = 0; j < pl->p.watch.count; ++j) {
+			struct perf_event_attr attr;
+			init_attr(pl, &pl->p.watch.points[j], &attr);
+
+			int fd = syscall(SYS_perf_event_open, &attr, tid, cpu, -1, PERF_FLAG_FD_CLOEXEC);
+
+			if (fd == -1) {
+				if (errno == ENODEV && cpu != -1 && output == -1) {
+					return -1;
+				}
+
+				// Frozen threads can still be killed.
+				if (errno == ESRCH && tid != pl->pid) {
+					break;
+				}
+
+				set_error(pl, errno);
+				return 0;
+			}
+
+			struct proctal_linux_watch_event *event = add_event(pl, fd, j);
+
+			if (event == NULL) {
+				close(fd);
+				return 0;
+			}
+
+			if (!pl->p.watch.sample_period) {
+				continue;
+			}
+
+			// Samples tell which event they came from by this ID.
+			if (ioctl(fd, PERF_EVENT_IOC_ID, &event->id) == -1) {
+				set_error(pl, errno);
+				return 0;
+			}
+
+			if (output == -1) {
+				if (!add_buffer(pl, fd)) {
+					return 0;
+				}
+
+				output = fd;
+			} else if (ioctl(fd, PERF_EVENT_IOC_SET_OUTPUT, output) == -1) {
+				set_error(pl, errno);
+				return 0;
+			}
+		}
+	}
+
+	return 1;
+}
+
+static void copy_from_buffer(struct perf_event_mmap_page *buffer, uint64_t offset, void *dest, size_t size)
+{
+	size_t page_size = sysconf(_SC_PAGESIZE);
+	size_t data_size = BUFFER_PAGES * page_size;
+	const char *data = (const char *) buffer + page_size;
+
+	// Records wrap around at the end.
+	for (size_t i = 0; i < size; ++i) {
+		((char *) dest)[i] = data[(offset + i) & (data_size - 1)];
+	}
+}
+
+/*
+ * Takes the next sample out of a buffer, skipping over any other kind of
+ * record.
+ *
+ * Returns 1 when there was one, 0 when the buffer is empty.
+ */
+static int read_sample(struct perf_event_mmap_page *buffer, struct sample *sample)
+{
+	uint64_t head = __atomic_load_n(&buffer->data_head, __ATOMIC_ACQUIRE);
+	uint64_t tail = buffer->data_tail;
+	int found = 0;
+
+	while (!found && tail != head) {
+		struct perf_event_header header;
+		copy_from_buffer(buffer, tail, &header, sizeof(header));
+
+		if (header.type == PERF_RECORD_SAMPLE) {
+			copy_from_buffer(buffer, tail + sizeof(header), sample, sizeof(*sample));
+			found = 1;
+		}
+
+		tail += header.size;
+	}
+
+	// Gives the space back to the kernel.
+	__atomic_store_n(&buffer->data_tail, tail, __ATOMIC_RELEASE);
+
+	return found;
+}
+
+static int point_of_event(struct proctal_linux *pl, uint64_t id)
+{
+	for (size_t i = 0; i < pl->watch.event_count; ++i) {
+		if (pl->watch.events[i].id == id) {
+			return pl->watch.events[i].point;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * Opens the process file descriptor that tells when the process exited.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int open_pidfd(struct proctal_linux *pl)
+{
+	if (pl->watch.pidfd != -1) {
+		return 1;
+	}
+
+	// Same number on every architecture.
+	pl->watch.pidfd = syscall(434 /* pidfd_open */, pl->pid, 0);
+
+	if (pl->watch.pidfd == -1) {
+		set_error(pl, errno);
+		return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Waits for the process to exit when only counting, since there are no
+ * samples to wait for.
+ *
+ * Returns 0 when it exited, on failure or when the wait was interrupted by a
+ * signal, in which case no error is set.
+ */
+static int wait_exit(struct proctal_linux *pl)
+{
+	struct pollfd pidfd = { pl->watch.pidfd, POLLIN, 0 };
+
+	if (poll(&pidfd, 1, -1) == -1) {
+		if (errno != EINTR) {
+			proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+		}
+
+		return 0;
+	}
+
+	proctal_set_error(&pl->p, PROCTAL_ERROR_PROCESS_EXITED);
+	return 0;
+}
+
+/*
+ * Waits for samples to be written. Events whose threads are gone along with
+ * every thread that inherited them are left out from then on.
+ *
+ * Returns 1 when there may be samples to read. Returns 0 on failure or when
+ * the wait was interrupted by a signal, in which case no error is set.
+ */
+static int wait_events(struct proctal_linux *pl)
+{
+	if (!pl->p.watch.sample_period) {
+		return wait_exit(pl);
+	}
+
+	struct pollfd *polls = proctal_malloc(&pl->p, pl->watch.event_count * sizeof(*polls));
+
+	if (polls == NULL) {
+		return 0;
+	}
+
+	size_t count = 0;
+
+	for (size_t i = 0; i < pl->watch.event_count; ++i) {
+		if (!pl->watch.events[i].hup) {
+			polls[count].fd = pl->watch.events[i].fd;
+			polls[count].events = POLLIN;
+			polls[count].revents = 0;
+			++count;
+		}
+	}
+
+	if (count == 0) {
+		proctal_free(&pl->p, polls);
+		proctal_set_error(&pl->p, PROCTAL_ERROR_PROCESS_EXITED);
+		return 0;
+	}
+
+	if (poll(polls, count, -1) == -1) {
+		if (errno != EINTR) {
+			proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+		}
+
+		proctal_free(&pl->p, polls);
+		return 0;
+	}
+
+	for (size_t i = 0, j = 0; i < pl->watch.event_count; ++i) {
+		if (!pl->watch.events[i].hup) {
+			pl->watch.events[i].hup = (polls[j++].revents & POLLHUP) != 0;
+		}
+	}
+
+	proctal_free(&pl->p, polls);
+
+	return 1;
+}
+
+/*
+ * Tells whether the process exited, going by its process file descriptor.
+ */
+static int has_exited(struct proctal_linux *pl)
+{
+	if (pl->watch.pidfd == -1) {
+		return 0;
+	}
+
+	struct pollfd pidfd = { pl->watch.pidfd, POLLIN, 0 };
+
+	return poll(&pidfd, 1, 0) == 1;
+}
+
+int proctal_linux_perf_watch_begin(struct proctal_linux *pl)
+{
+	// Threads must not come and go while the events are being opened or
+	// some would be left out. Those created afterwards inherit them.
+	if (!proctal_linux_freeze(pl)) {
+		return 0;
+	}
+
+	pl->p.watch.hit = -1;
+	pl->p.watch.thread = 0;
+	pl->watch.started = 1;
+
+	int ok = 1;
+
+	if (pl->p.watch.sample_period) {
+		// Inherited events can only have buffers when they are
+		// specific to a processor.
+		long processors = sysconf(_SC_NPROCESSORS_CONF);
+
+		for (long cpu = 0; ok && cpu < processors; ++cpu) {
+			ok = open_events(pl, cpu) != 0;
+		}
+	} else {
+		// Counts need no buffer, so one event for every watchpoint
+		// and thread is enough and what gets waited for is the
+		// process exiting.
+		ok = open_pidfd(pl) && open_events(pl, -1) != 0;
+	}
+
+	if (!ok) {
+		close_events(pl);
+		pl->watch.started = 0;
+
+		int error = proctal_error(&pl->p);
+		proctal_linux_unfreeze(pl);
+		proctal_set_error(&pl->p, error);
+
+		return 0;
+	}
+
+	if (!proctal_linux_unfreeze(pl)) {
+		close_events(pl);
+		pl->watch.started = 0;
+		return 0;
+	}
+
+	return 1;
+}
+
+int proctal_linux_perf_watch_next(struct proctal_linux *pl, void **addr)
+{
+	if (!pl->watch.started) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+		return 0;
+	}
+
+	int nonblocking = pl->watch.dispatched;
+	pl->watch.dispatched = 0;
+
+	for (;;) {
+		struct sample sample;
+
+		for (size_t i = 0; i < pl->watch.buffer_count; ++i) {
+			if (read_sample(pl->watch.buffers[i].page, &sample)) {
+				pl->p.watch.hit = point_of_event(pl, sample.id);
+				pl->p.watch.thread = sample.tid;
+				*addr = (void *) (uintptr_t) sample.ip;
+				return 1;
+			}
+		}
+
+		if (nonblocking) {
+			if (has_exited(pl)) {
+				proctal_set_error(&pl->p, PROCTAL_ERROR_PROCESS_EXITED);
+			}
+
+			return 0;
+		}
+
+		if (!wait_events(pl)) {
+			return 0;
+		}
+	}
+}
+
+int proctal_linux_perf_watch_end(struct proctal_linux *pl)
+{
+	if (!pl->watch.started) {
+		return 1;
+	}
+
+	close_events(pl);
+	pl->watch.started = 0;
+
+	return 1;
+}
+
+unsigned long long proctal_linux_perf_watch_accesses(struct proctal_linux *pl)
+{
+	unsigned long long accesses = 0;
+
+	for (size_t i = 0; i < pl->watch.event_count; ++i) {
+		struct proctal_linux_watch_event *event = &pl->watch.events[i];
+
+		if (event->point != pl->p.watch.selected) {
+			continue;
+		}
+
+		// Counts of the threads that inherited the event are included.
+		uint64_t count;
+
+		if (read(event->fd, &count, sizeof(count)) != sizeof(count)) {
+			proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+			return 0;
+		}
+
+		accesses += count;
+	}
+
+	return accesses;
+}
+
+int proctal_linux_perf_watch_fd(struct proctal_linux *pl)
+{
+	if (pl->watch.epoll != -1) {
+		return pl->watch.epoll;
+	}
+
+	if (!open_pidfd(pl)) {
+		return -1;
+	}
+
+	pl->watch.epoll = epoll_create1(EPOLL_CLOEXEC);
+
+	if (pl->watch.epoll == -1) {
+		set_error(pl, errno);
+		return -1;
+	}
+
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.fd = pl->watch.pidfd;
+
+	int ok = epoll_ctl(pl->watch.epoll, EPOLL_CTL_ADD, pl->watch.pidfd, &event) == 0;
+
+	// Events that share a buffer are woken up together so the ones that
+	// the buffers belong to are enough.
+	for (size_t i = 0; ok && i < pl->watch.buffer_count; ++i) {
+		event.data.fd = pl->watch.buffers[i].fd;
+		ok = epoll_ctl(pl->watch.epoll, EPOLL_CTL_ADD, event.data.fd, &event) == 0;
+	}
+
+	if (!ok) {
+		set_error(pl, errno);
+		close(pl->watch.epoll);
+		pl->watch.epoll = -1;
+		return -1;
+	}
+
+	return pl->watch.epoll;
+}
+
+int proctal_linux_perf_watch_ready(struct proctal_linux *pl)
+{
+	if (!pl->watch.started) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+		return -1;
+	}
+
+	if (pl->watch.epoll != -1) {
+		struct epoll_event events[64];
+		int count = epoll_wait(pl->watch.epoll, events, 64, 0);
+
+		for (int i = 0; i < count; ++i) {
+			if (events[i].data.fd == pl->watch.pidfd) {
+				return 1;
+			}
+
+			// Its thread is gone along with the threads that
+			// inherited the event, so it would keep waking up.
+			if (events[i].events & EPOLLHUP) {
+				epoll_ctl(pl->watch.epoll, EPOLL_CTL_DEL, events[i].data.fd, NULL);
+			}
+		}
+	}
+
+	for (size_t i = 0; i < pl->watch.buffer_count; ++i) {
+		struct perf_event_mmap_page *page = pl->watch.buffers[i].page;
+
+		if (__atomic_load_n(&page->data_head, __ATOMIC_ACQUIRE) != page->data_tail) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,35 @@
+#ifndef LIB_LINUX_PERF_H
+#define LIB_LINUX_PERF_H
+
+#include "lib/linux/proctal.h"
+
+/*
+ * Watching with perf events. The kernel sets up the breakpoints on every
+ * thread and counts accesses on its own, so the process is not stopped.
+ */
+
+int proctal_linux_perf_watch_begin(struct proctal_linux *pl);
+
+int proctal_linux_perf_watch_next(struct proctal_linux *pl, void **addr);
+
+int proctal_linux_perf_watch_end(struct proctal_linux *pl);
+
+unsigned long long proctal_linux_perf_watch_accesses(struct proctal_linux *pl);
+
+/*
+ * Returns an epoll instance that becomes readable when there may be samples
+ * to read or when the process exits.
+ *
+ * Returns -1 on failure.
+ */
+int proctal_linux_perf_watch_fd(struct proctal_linux *pl);
+
+/*
+ * Checks without blocking whether there are samples to read or whether the
+ * process exited.
+ *
+ * Returns 1 if so, 0 if not and -1 on failure.
+ */
+int proctal_linux_perf_watch_ready(struct proctal_linux *pl);
+
+#endif /* LIB_LINUX_PERF_H */
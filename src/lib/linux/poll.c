@@ -0,0 +1,463 @@
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+
+#include "lib/linux/poll.h"
+#include "lib/linux/watch.h"
+
+struct proctal_watch_poller {
+	// Instance whose memory allocator is used.
+	struct proctal_linux *pl;
+
+	// SIGCHLD is read from here while it's blocked.
+	int sigfd;
+
+	// Signal mask to go back to.
+	sigset_t old;
+
+	// Room for SIGCHLD and a file descriptor of every session.
+	struct pollfd *polls;
+	size_t poll_capacity;
+
+	// Which session every thread that changed state belongs to, sorted
+	// by thread ID.
+	struct route {
+		pid_t tid;
+		struct proctal_linux *pl;
+	} *routes;
+
+	size_t route_count;
+	size_t route_capacity;
+};
+
+/*
+ * Finds where the route of a thread is or would be.
+ */
+static size_t find_route(struct proctal_watch_poller *poller, pid_t tid)
+{
+	size_t low = 0;
+	size_t high = poller->route_count;
+
+	while (low < high) {
+		size_t middle = low + (high - low) / 2;
+
+		if (poller->routes[middle].tid < tid) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	return low;
+}
+
+/*
+ * Remembers which session a thread belongs to.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int add_route(struct proctal_watch_poller *poller, size_t i, pid_t tid, struct proctal_linux *pl)
+{
+	if (poller->route_count == poller->route_capacity) {
+		size_t capacity = poller->route_capacity ? poller->route_capacity * 2 : 64;
+		struct route *routes = proctal_malloc(&poller->pl->p, capacity * sizeof(*routes));
+
+		if (routes == NULL) {
+			return 0;
+		}
+
+		if (poller->routes) {
+			memcpy(routes, poller->routes, poller->route_count * sizeof(*routes));
+			proctal_free(&poller->pl->p, poller->routes);
+		}
+
+		poller->routes = routes;
+		poller->route_capacity = capacity;
+	}
+
+	memmove(&poller->routes[i + 1], &poller->routes[i], (poller->route_count - i) * sizeof(*poller->routes));
+
+	poller->routes[i].tid = tid;
+	poller->routes[i].pl = pl;
+	++poller->route_count;
+
+	return 1;
+}
+
+static void remove_route(struct proctal_watch_poller *poller, size_t i)
+{
+	--poller->route_count;
+
+	memmove(&poller->routes[i], &poller->routes[i + 1], (poller->route_count - i) * sizeof(*poller->routes));
+}
+
+/*
+ * Finds an instance among the given ones. Instances are only compared so that
+ * one that is gone is never looked at.
+ *
+ * Returns count when it's not one of them.
+ */
+static size_t find_instance(proctal *instances, size_t count, struct proctal_linux *pl)
+{
+	size_t i = 0;
+
+	while (i < count && (struct proctal_linux *) instances[i] != pl) {
+		++i;
+	}
+
+	return i;
+}
+
+/*
+ * Finds the session that a thread belongs to. Threads that were seen before
+ * are remembered and the others are looked up in every session.
+ *
+ * Returns the index of the session, or count when it does not belong to any
+ * of them.
+ */
+static size_t route(struct proctal_watch_poller *poller, proctal *instances, size_t count, pid_t tid)
+{
+	size_t i = find_route(poller, tid);
+
+	if (i < poller->route_count && poller->routes[i].tid == tid) {
+		struct proctal_linux *pl = poller->routes[i].pl;
+		size_t j = find_instance(instances, count, pl);
+
+		if (j < count && pl->watch.started) {
+			return j;
+		}
+
+		// The session is over and the ID may have been taken by
+		// another thread since.
+		remove_route(poller, i);
+	}
+
+	for (size_t j = 0; j < count; ++j) {
+		struct proctal_linux *pl = (struct proctal_linux *) instances[j];
+
+		if (pl->watch.method == PROCTAL_WATCH_METHOD_PERF_EVENTS
+			|| !pl->watch.started
+			|| !proctal_linux_watch_has_thread(pl, tid)) {
+			continue;
+		}
+
+		// Not remembering it only makes the next look up slower.
+		if (!add_route(poller, i, tid, pl)) {
+			proctal_error_ack(&poller->pl->p);
+		}
+
+		return j;
+	}
+
+	return count;
+}
+
+/*
+ * Hands a change in the state of a thread over to the session it belongs to.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int hand_over(struct proctal_watch_poller *poller, struct proctal_linux *pl, pid_t tid, int wstatus)
+{
+	if (!proctal_linux_watch_queue(pl, tid, wstatus)) {
+		return 0;
+	}
+
+	if (WIFEXITED(wstatus) || WIFSIGNALED(wstatus)) {
+		size_t i = find_route(poller, tid);
+
+		if (i < poller->route_count && poller->routes[i].tid == tid) {
+			remove_route(poller, i);
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Waits for the threads of every session one by one, for when a child process
+ * that is not watched changed state and nobody waited for it yet, since it
+ * is reported before any of them for as long as it stays that way.
+ *
+ * Returns the same as drain.
+ */
+static int drain_threads(struct proctal_watch_poller *poller, proctal *instances, size_t count, size_t *ready)
+{
+	for (size_t i = 0; i < count; ++i) {
+		struct proctal_linux *pl = (struct proctal_linux *) instances[i];
+
+		if (pl->watch.method == PROCTAL_WATCH_METHOD_PERF_EVENTS || !pl->watch.started) {
+			continue;
+		}
+
+		for (size_t j = 0; j < pl->watch.thread_count; ++j) {
+			pid_t tid = pl->watch.threads[j].tid;
+			int wstatus;
+
+			if (pl->watch.threads[j].stopped || waitpid(tid, &wstatus, WNOHANG | __WALL) != tid) {
+				continue;
+			}
+
+			if (!hand_over(poller, pl, tid, wstatus)) {
+				*ready = i;
+				return 0;
+			}
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Waits for every thread that changed state and hands each change over to the
+ * session the thread belongs to. Changes of child processes that are not
+ * watched are left for whoever started them.
+ *
+ * Returns 1 on success, 0 on failure, in which case the session that failed
+ * is put in ready.
+ */
+static int drain(struct proctal_watch_poller *poller, proctal *instances, size_t count, size_t *ready)
+{
+	for (;;) {
+		pid_t tid = proctal_linux_watch_peek(0);
+
+		// Either none changed state or there are no children at all.
+		if (tid <= 0) {
+			return 1;
+		}
+
+		size_t i = route(poller, instances, count, tid);
+
+		if (i == count) {
+			return drain_threads(poller, instances, count, ready);
+		}
+
+		int wstatus;
+
+		if (waitpid(tid, &wstatus, WNOHANG | __WALL) != tid) {
+			continue;
+		}
+
+		if (!hand_over(poller, (struct proctal_linux *) instances[i], tid, wstatus)) {
+			*ready = i;
+			return 0;
+		}
+	}
+}
+
+/*
+ * Finds the session that is ready and was chosen the longest time ago, so
+ * that a busy process cannot keep the others waiting.
+ *
+ * Returns 1 when one was found, 0 when none is ready and -1 on failure, in
+ * which case the session that failed is put in ready.
+ */
+static int find_ready(proctal *instances, size_t count, size_t *ready)
+{
+	unsigned long long last_turn = 0;
+	struct proctal_linux *chosen = NULL;
+
+	for (size_t i = 0; i < count; ++i) {
+		struct proctal_linux *pl = (struct proctal_linux *) instances[i];
+		int is_ready = proctal_linux_watch_ready(pl);
+
+		if (is_ready == -1) {
+			*ready = i;
+			return -1;
+		}
+
+		if (pl->watch.turn > last_turn) {
+			last_turn = pl->watch.turn;
+		}
+
+		if (is_ready && (chosen == NULL || pl->watch.turn < chosen->watch.turn)) {
+			chosen = pl;
+			*ready = i;
+		}
+	}
+
+	if (chosen == NULL) {
+		return 0;
+	}
+
+	chosen->watch.turn = last_turn + 1;
+	chosen->watch.dispatched = 1;
+
+	return 1;
+}
+
+/*
+ * Makes room for SIGCHLD and a file descriptor of every session.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int reserve_polls(struct proctal_watch_poller *poller, size_t count)
+{
+	if (poller->poll_capacity >= count + 1) {
+		return 1;
+	}
+
+	struct pollfd *polls = proctal_malloc(&poller->pl->p, (count + 1) * sizeof(*polls));
+
+	if (polls == NULL) {
+		return 0;
+	}
+
+	if (poller->polls) {
+		proctal_free(&poller->pl->p, poller->polls);
+	}
+
+	poller->polls = polls;
+	poller->poll_capacity = count + 1;
+
+	return 1;
+}
+
+struct proctal_watch_poller *proctal_linux_watch_poller_create(struct proctal_linux *pl)
+{
+	struct proctal_watch_poller *poller = proctal_malloc(&pl->p, sizeof(*poller));
+
+	if (poller == NULL) {
+		return NULL;
+	}
+
+	poller->pl = pl;
+	poller->polls = NULL;
+	poller->poll_capacity = 0;
+	poller->routes = NULL;
+	poller->route_count = 0;
+	poller->route_capacity = 0;
+
+	sigset_t chld;
+	sigemptyset(&chld);
+	sigaddset(&chld, SIGCHLD);
+
+	// SIGCHLD has to be blocked to be read from a file descriptor. It
+	// stays pending until it's read so none is missed between looking for
+	// stops and waiting.
+	if (pthread_sigmask(SIG_BLOCK, &chld, &poller->old) != 0) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+		proctal_free(&pl->p, poller);
+		return NULL;
+	}
+
+	poller->sigfd = signalfd(-1, &chld, SFD_NONBLOCK | SFD_CLOEXEC);
+
+	if (poller->sigfd == -1) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+		pthread_sigmask(SIG_SETMASK, &poller->old, NULL);
+		proctal_free(&pl->p, poller);
+		return NULL;
+	}
+
+	return poller;
+}
+
+void proctal_linux_watch_poller_destroy(struct proctal_linux *pl, struct proctal_watch_poller *poller)
+{
+	if (poller == NULL) {
+		return;
+	}
+
+	close(poller->sigfd);
+	pthread_sigmask(SIG_SETMASK, &poller->old, NULL);
+
+	if (poller->polls) {
+		proctal_free(&pl->p, poller->polls);
+	}
+
+	if (poller->routes) {
+		proctal_free(&pl->p, poller->routes);
+	}
+
+	proctal_free(&pl->p, poller);
+}
+
+int proctal_linux_watch_poller_wait(struct proctal_watch_poller *poller, proctal *instances, size_t count, size_t *ready)
+{
+	*ready = 0;
+
+	if (!reserve_polls(poller, count)) {
+		proctal_set_error(instances[0], PROCTAL_ERROR_OUT_OF_MEMORY);
+		return 0;
+	}
+
+	struct pollfd *polls = poller->polls;
+
+	for (int woken = 0; ; woken = 1) {
+		struct signalfd_siginfo info;
+
+		// It only tells that the state of some thread changed and
+		// several of them may be merged into one.
+		while (read(poller->sigfd, &info, sizeof(info)) == sizeof(info)) {
+		}
+
+		if (!drain(poller, instances, count, ready)) {
+			return 0;
+		}
+
+		int found = find_ready(instances, count, ready);
+
+		if (found != 0) {
+			return found == 1;
+		}
+
+		// A signal handler may have run instead of poll being
+		// interrupted, so the caller gets to look at what it did.
+		if (woken) {
+			*ready = count;
+			return 0;
+		}
+
+		polls[0].fd = poller->sigfd;
+		polls[0].events = POLLIN;
+		polls[0].revents = 0;
+
+		for (size_t i = 0; i < count; ++i) {
+			int fd = proctal_linux_watch_fd((struct proctal_linux *) instances[i]);
+
+			if (fd == -1 && proctal_error(instances[i])) {
+				*ready = i;
+				return 0;
+			}
+
+			// Negative ones are left out.
+			polls[i + 1].fd = fd;
+			polls[i + 1].events = POLLIN;
+			polls[i + 1].revents = 0;
+		}
+
+		if (poll(polls, count + 1, -1) == -1) {
+			if (errno == EINTR) {
+				*ready = count;
+			} else {
+				*ready = 0;
+				proctal_set_error(instances[0], PROCTAL_ERROR_UNKNOWN);
+			}
+
+			return 0;
+		}
+	}
+}
+
+int proctal_linux_watch_poll(proctal *instances, size_t count, size_t *ready)
+{
+	*ready = 0;
+
+	struct proctal_watch_poller *poller = proctal_linux_watch_poller_create((struct proctal_linux *) instances[0]);
+
+	if (poller == NULL) {
+		return 0;
+	}
+
+	int ret = proctal_linux_watch_poller_wait(poller, instances, count, ready);
+
+	proctal_linux_watch_poller_destroy((struct proctal_linux *) instances[0], poller);
+
+	return ret;
+}
@@ -0,0 +1,14 @@
+#ifndef LIB_LINUX_POLL_H
+#define LIB_LINUX_POLL_H
+
+#include "lib/linux/proctal.h"
+
+struct proctal_watch_poller *proctal_linux_watch_poller_create(struct proctal_linux *pl);
+
+void proctal_linux_watch_poller_destroy(struct proctal_linux *pl, struct proctal_watch_poller *poller);
+
+int proctal_linux_watch_poller_wait(struct proctal_watch_poller *poller, proctal *instances, size_t count, size_t *ready);
+
+int proctal_linux_watch_poll(proctal *instances, size_t count, size_t *ready);
+
+#endif /* LIB_LINUX_POLL_H */
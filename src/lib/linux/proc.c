@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 #include <sys/types.h>
 
@@ -133,6 +134,8 @@ int proctal_linux_read_mem_region(struct proctal_linux_mem_region *region, FILE
 		mem_region_skip_space(maps);
 		int read = read_until_nl(maps, region->path, sizeof(region->path) - 1);
 		region->path[read] = '\0';
+	} else {
+		region->path[0] = '\0';
 	}
 
 	mem_region_skip_until_nl(maps);
@@ -152,3 +155,24 @@ const char *proctal_linux_program_path(pid_t pid)
 
 	return path;
 }
+
+DIR *proctal_linux_proc_tasks(pid_t pid)
+{
+	return opendir(proctal_linux_proc_path(pid, "task"));
+}
+
+pid_t proctal_linux_proc_next_task(DIR *tasks)
+{
+	struct dirent *entry;
+
+	while ((entry = readdir(tasks)) != NULL) {
+		pid_t tid = atoi(entry->d_name);
+
+		// Skipping . and ..
+		if (tid > 0) {
+			return tid;
+		}
+	}
+
+	return 0;
+}
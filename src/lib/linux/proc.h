@@ -2,6 +2,7 @@
 #define LIB_LINUX_PROC_H
 
 #include <stdio.h>
+#include <dirent.h>
 #include <sys/types.h>
 
 struct proctal_linux_mem_region {
@@ -22,4 +23,18 @@ int proctal_linux_read_mem_region(struct proctal_linux_mem_region *region, FILE
 
 const char *proctal_linux_program_path(pid_t pid);
 
+/*
+ * Opens the list of threads of a process. Close it with closedir.
+ *
+ * Returns NULL on failure.
+ */
+DIR *proctal_linux_proc_tasks(pid_t pid);
+
+/*
+ * Reads the ID of the next thread from the list.
+ *
+ * Returns 0 when there are no more.
+ */
+pid_t proctal_linux_proc_next_task(DIR *tasks);
+
 #endif /* LIB_LINUX_PROC_H */
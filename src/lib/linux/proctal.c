@@ -1,5 +1,7 @@
 #include "lib/linux/proctal.h"
 #include "lib/linux/ptrace.h"
+#include "lib/linux/watch.h"
+#include "lib/linux/freeze.h"
 
 void proctal_linux_init(struct proctal_linux *pl)
 {
@@ -14,6 +16,43 @@ void proctal_linux_init(struct proctal_linux *pl)
 
 	pl->region.finished = 0;
 	pl->region.maps = NULL;
+	pl->region.curr.path[0] = '\0';
+
+	pl->freeze.count = 0;
+	pl->freeze.threads = NULL;
+	pl->freeze.thread_count = 0;
+	pl->freeze.thread_capacity = 0;
+
+	pl->sample.threads = NULL;
+	pl->sample.thread_count = 0;
+	pl->sample.thread_capacity = 0;
+	pl->sample.frames = NULL;
+	pl->sample.frame_count = 0;
+	pl->sample.frame_capacity = 0;
+
+	pl->watch.started = 0;
+	pl->watch.threads = NULL;
+	pl->watch.thread_count = 0;
+	pl->watch.thread_capacity = 0;
+	pl->watch.pages = NULL;
+	pl->watch.page_count = 0;
+	pl->watch.page_capacity = 0;
+	pl->watch.protected = 0;
+	pl->watch.method = 0;
+	pl->watch.events = NULL;
+	pl->watch.event_count = 0;
+	pl->watch.event_capacity = 0;
+	pl->watch.buffers = NULL;
+	pl->watch.buffer_count = 0;
+	pl->watch.buffer_capacity = 0;
+	pl->watch.pidfd = -1;
+	pl->watch.epoll = -1;
+	pl->watch.queue = NULL;
+	pl->watch.queue_start = 0;
+	pl->watch.queue_count = 0;
+	pl->watch.queue_capacity = 0;
+	pl->watch.dispatched = 0;
+	pl->watch.turn = 0;
 }
 
 void proctal_linux_deinit(struct proctal_linux *pl)
@@ -24,6 +63,57 @@ void proctal_linux_deinit(struct proctal_linux *pl)
 		fclose(pl->mem);
 	}
 
+	// The breakpoints must not be left behind in the process.
+	if (pl->watch.started) {
+		proctal_linux_watch_end(pl);
+	}
+
+	if (pl->watch.threads) {
+		proctal_free(&pl->p, pl->watch.threads);
+		pl->watch.threads = NULL;
+	}
+
+	if (pl->watch.pages) {
+		proctal_free(&pl->p, pl->watch.pages);
+		pl->watch.pages = NULL;
+	}
+
+	if (pl->watch.events) {
+		proctal_free(&pl->p, pl->watch.events);
+		pl->watch.events = NULL;
+	}
+
+	if (pl->watch.buffers) {
+		proctal_free(&pl->p, pl->watch.buffers);
+		pl->watch.buffers = NULL;
+	}
+
+	if (pl->watch.queue) {
+		proctal_free(&pl->p, pl->watch.queue);
+		pl->watch.queue = NULL;
+	}
+
+	// Every thread must be let go no matter how many times it was frozen.
+	if (pl->freeze.count) {
+		pl->freeze.count = 1;
+		proctal_linux_unfreeze(pl);
+	}
+
+	if (pl->freeze.threads) {
+		proctal_free(&pl->p, pl->freeze.threads);
+		pl->freeze.threads = NULL;
+	}
+
+	if (pl->sample.threads) {
+		proctal_free(&pl->p, pl->sample.threads);
+		pl->sample.threads = NULL;
+	}
+
+	if (pl->sample.frames) {
+		proctal_free(&pl->p, pl->sample.frames);
+		pl->sample.frames = NULL;
+	}
+
 	if (pl->ptrace) {
 		pl->ptrace = 1;
 		proctal_linux_ptrace_detach(pl);
@@ -47,6 +137,15 @@ void proctal_linux_set_pid(struct proctal_linux *pl, pid_t pid)
 		pl->mem = NULL;
 	}
 
+	if (pl->watch.started) {
+		proctal_linux_watch_end(pl);
+	}
+
+	if (pl->freeze.count) {
+		pl->freeze.count = 1;
+		proctal_linux_unfreeze(pl);
+	}
+
 	if (pl->ptrace) {
 		pl->ptrace = 1;
 		proctal_linux_ptrace_detach(pl);
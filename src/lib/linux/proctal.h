@@ -2,6 +2,7 @@
 #define LIB_LINUX_PROCTAL_H
 
 #include <stdio.h>
+#include <stdint.h>
 #include <sys/types.h>
 
 #include "lib/proctal.h"
@@ -47,6 +48,150 @@ struct proctal_linux {
 		// Current region.
 		struct proctal_linux_mem_region curr;
 	} region;
+
+	struct proctal_linux_freeze {
+		// Number of times the process was frozen and not unfrozen
+		// yet. Every thread is attached to while it's not 0.
+		int count;
+
+		// Threads of the process that are frozen.
+		struct proctal_linux_freeze_thread {
+			pid_t tid;
+
+			// Signal to deliver when the thread is let go.
+			int signal;
+		} *threads;
+
+		size_t thread_count;
+		size_t thread_capacity;
+	} freeze;
+
+	struct proctal_linux_sample {
+		// Threads in the last sample.
+		struct proctal_linux_sample_thread {
+			pid_t tid;
+
+			// Where the addresses found for it start in frames
+			// and how many there are.
+			size_t first;
+			size_t frame_count;
+		} *threads;
+
+		size_t thread_count;
+		size_t thread_capacity;
+
+		// Addresses found for every thread, one after the other.
+		void **frames;
+		size_t frame_count;
+		size_t frame_capacity;
+	} sample;
+
+	struct proctal_linux_watch {
+		// Whether a session was begun and not ended yet. The threads
+		// stay attached and the breakpoints stay set in between.
+		int started;
+
+		// How accesses are detected in the session.
+		int method;
+
+		// Threads of the process that are being watched.
+		struct proctal_linux_watch_thread {
+			pid_t tid;
+
+			// Whether the thread is in a ptrace stop and waits to
+			// be continued.
+			int stopped;
+
+			// Whether the breakpoints were set on the thread.
+			int armed;
+
+			// Signal to deliver when the thread is continued.
+			int signal;
+		} *threads;
+
+		size_t thread_count;
+		size_t thread_capacity;
+
+		// Runs of pages that are protected when watching with page
+		// protection, in order and without overlapping.
+		struct proctal_linux_watch_pages {
+			char *start;
+			char *end;
+
+			// Protection of the pages before watching and while
+			// watching.
+			int prot;
+			int guard;
+		} *pages;
+
+		size_t page_count;
+		size_t page_capacity;
+
+		// Whether the pages are protected.
+		int protected;
+
+		// Page of the process that holds the instruction the calls to
+		// mprotect are made with, mapped when the session begins so
+		// that no code is ever overwritten while threads run.
+		void *syscall_page;
+
+		// Events that count accesses when watching with perf events,
+		// one for every watchpoint and thread, and for every processor
+		// as well when sampling. Threads that are created later on
+		// inherit them.
+		struct proctal_linux_watch_event {
+			int fd;
+
+			// What samples of the event are identified by.
+			uint64_t id;
+
+			// Watchpoint that it counts accesses to.
+			size_t point;
+
+			// Whether its thread and every thread that inherited
+			// it are gone.
+			int hup;
+		} *events;
+
+		size_t event_count;
+		size_t event_capacity;
+
+		// Buffers that samples are written to, one for every
+		// processor, along with the event they belong to.
+		struct proctal_linux_watch_buffer {
+			struct perf_event_mmap_page *page;
+			int fd;
+		} *buffers;
+
+		size_t buffer_count;
+		size_t buffer_capacity;
+
+		// Process file descriptor and epoll instance that tell when
+		// perf events wrote samples or the process exited. Both are
+		// -1 until they are needed.
+		int pidfd;
+		int epoll;
+
+		// Changes in the state of threads that were waited for ahead
+		// of time, in the order they came, to be dealt with by the
+		// next calls to proctal_linux_watch_next.
+		struct proctal_linux_watch_status {
+			pid_t tid;
+			int status;
+		} *queue;
+
+		size_t queue_start;
+		size_t queue_count;
+		size_t queue_capacity;
+
+		// Whether the session was chosen by a poller, in which case
+		// proctal_linux_watch_next does not block.
+		int dispatched;
+
+		// Tells which of the sessions given to a poller was chosen
+		// the longest time ago.
+		unsigned long long turn;
+	} watch;
 };
 
 /*
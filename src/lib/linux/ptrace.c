@@ -84,6 +84,9 @@ static inline int user_register_offset(int reg)
 	case PROCTAL_LINUX_PTRACE_X86_REG_R15:
 		return OFFSET_INTO_REGS(r15);
 
+	case PROCTAL_LINUX_PTRACE_X86_REG_ORIG_RAX:
+		return OFFSET_INTO_REGS(orig_rax);
+
 	default:
 		// Not implemented.
 		return -1;
@@ -271,6 +274,16 @@ int proctal_linux_ptrace_set_instruction_address(struct proctal_linux *pl, void
 }
 
 int proctal_linux_ptrace_get_x86_reg(struct proctal_linux *pl, int reg, unsigned long long *v)
+{
+	return proctal_linux_ptrace_thread_get_x86_reg(pl, pl->pid, reg, v);
+}
+
+int proctal_linux_ptrace_set_x86_reg(struct proctal_linux *pl, int reg, unsigned long long v)
+{
+	return proctal_linux_ptrace_thread_set_x86_reg(pl, pl->pid, reg, v);
+}
+
+int proctal_linux_ptrace_thread_get_x86_reg(struct proctal_linux *pl, pid_t tid, int reg, unsigned long long *v)
 {
 	int offset = user_register_offset(reg);
 
@@ -281,7 +294,7 @@ int proctal_linux_ptrace_get_x86_reg(struct proctal_linux *pl, int reg, unsigned
 
 	errno = 0;
 
-	*v = ptrace(PTRACE_PEEKUSER, pl->pid, offset, 0);
+	*v = ptrace(PTRACE_PEEKUSER, tid, offset, 0);
 
 	if (check_errno_ptrace_stop_state(pl)) {
 		return 0;
@@ -290,7 +303,7 @@ int proctal_linux_ptrace_get_x86_reg(struct proctal_linux *pl, int reg, unsigned
 	return 1;
 }
 
-int proctal_linux_ptrace_set_x86_reg(struct proctal_linux *pl, int reg, unsigned long long v)
+int proctal_linux_ptrace_thread_set_x86_reg(struct proctal_linux *pl, pid_t tid, int reg, unsigned long long v)
 {
 	int offset = user_register_offset(reg);
 
@@ -301,7 +314,7 @@ int proctal_linux_ptrace_set_x86_reg(struct proctal_linux *pl, int reg, unsigned
 
 	errno = 0;
 
-	ptrace(PTRACE_POKEUSER, pl->pid, offset, v);
+	ptrace(PTRACE_POKEUSER, tid, offset, v);
 
 	if (check_errno_ptrace_stop_state(pl)) {
 		return 0;
@@ -310,6 +323,130 @@ int proctal_linux_ptrace_set_x86_reg(struct proctal_linux *pl, int reg, unsigned
 	return 1;
 }
 
+int proctal_linux_ptrace_thread_get_x86_regs(struct proctal_linux *pl, pid_t tid, struct user_regs_struct *regs)
+{
+	if (ptrace(PTRACE_GETREGS, tid, 0L, regs) == -1) {
+		check_errno_ptrace_stop_state(pl);
+		return 0;
+	}
+
+	return 1;
+}
+
+int proctal_linux_ptrace_thread_set_x86_regs(struct proctal_linux *pl, pid_t tid, const struct user_regs_struct *regs)
+{
+	if (ptrace(PTRACE_SETREGS, tid, 0L, regs) == -1) {
+		check_errno_ptrace_stop_state(pl);
+		return 0;
+	}
+
+	return 1;
+}
+
+int proctal_linux_ptrace_thread_seize(struct proctal_linux *pl, pid_t tid, long options)
+{
+	if (ptrace(PTRACE_SEIZE, tid, 0L, options) == -1) {
+		check_errno_ptrace_run_state(pl);
+		return 0;
+	}
+
+	return 1;
+}
+
+int proctal_linux_ptrace_thread_interrupt(struct proctal_linux *pl, pid_t tid)
+{
+	if (ptrace(PTRACE_INTERRUPT, tid, 0L, 0L) == -1) {
+		check_errno_ptrace_run_state(pl);
+		return 0;
+	}
+
+	return 1;
+}
+
+int proctal_linux_ptrace_thread_cont(struct proctal_linux *pl, pid_t tid, int signal)
+{
+	if (ptrace(PTRACE_CONT, tid, 0L, (long) signal) == -1) {
+		check_errno_ptrace_stop_state(pl);
+		return 0;
+	}
+
+	return 1;
+}
+
+int proctal_linux_ptrace_thread_listen(struct proctal_linux *pl, pid_t tid)
+{
+	if (ptrace(PTRACE_LISTEN, tid, 0L, 0L) == -1) {
+		check_errno_ptrace_stop_state(pl);
+		return 0;
+	}
+
+	return 1;
+}
+
+int proctal_linux_ptrace_thread_detach(struct proctal_linux *pl, pid_t tid, int signal)
+{
+	if (ptrace(PTRACE_DETACH, tid, 0L, (long) signal) == -1) {
+		check_errno_ptrace_stop_state(pl);
+		return 0;
+	}
+
+	return 1;
+}
+
+int proctal_linux_ptrace_thread_event_message(struct proctal_linux *pl, pid_t tid, unsigned long *message)
+{
+	if (ptrace(PTRACE_GETEVENTMSG, tid, 0L, message) == -1) {
+		check_errno_ptrace_stop_state(pl);
+		return 0;
+	}
+
+	return 1;
+}
+
+int proctal_linux_ptrace_thread_siginfo(struct proctal_linux *pl, pid_t tid, siginfo_t *info)
+{
+	if (ptrace(PTRACE_GETSIGINFO, tid, 0L, info) == -1) {
+		check_errno_ptrace_stop_state(pl);
+		return 0;
+	}
+
+	return 1;
+}
+
+int proctal_linux_ptrace_thread_step(struct proctal_linux *pl, pid_t tid, int *signal)
+{
+	*signal = 0;
+
+	for (;;) {
+		if (ptrace(PTRACE_SINGLESTEP, tid, 0L, 0L) == -1) {
+			check_errno_ptrace_stop_state(pl);
+			return 0;
+		}
+
+		int wstatus;
+
+		if (waitpid(tid, &wstatus, __WALL) != tid) {
+			proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+			return 0;
+		}
+
+		if (WIFSTOPPED(wstatus) && (wstatus >> 16) != 0) {
+			continue;
+		}
+
+		if (WIFSTOPPED(wstatus)) {
+			*signal = WSTOPSIG(wstatus);
+
+			if (*signal == SIGTRAP) {
+				return 1;
+			}
+		}
+
+		bad_signal(pl, wstatus);
+		return 0;
+	}
+}
+
 int proctal_linux_ptrace_stop(struct proctal_linux *pl)
 {
 	kill(pl->pid, SIGSTOP);
@@ -323,7 +460,12 @@ int proctal_linux_ptrace_stop(struct proctal_linux *pl)
 
 int proctal_linux_ptrace_cont(struct proctal_linux *pl)
 {
-	if (ptrace(PTRACE_CONT, pl->pid, 0, 0) != 0) {
+	return proctal_linux_ptrace_cont_signal(pl, 0);
+}
+
+int proctal_linux_ptrace_cont_signal(struct proctal_linux *pl, int signal)
+{
+	if (ptrace(PTRACE_CONT, pl->pid, 0, (long) signal) != 0) {
 		check_errno_ptrace_stop_state(pl);
 		return 0;
 	}
@@ -1,6 +1,9 @@
 #ifndef LIB_LINUX_PTRACE_H
 #define LIB_LINUX_PTRACE_H
 
+#include <signal.h>
+#include <sys/user.h>
+
 #include "lib/linux/proctal.h"
 
 #define PROCTAL_LINUX_PTRACE_X86_REG_RAX 0x0
@@ -21,6 +24,7 @@
 #define PROCTAL_LINUX_PTRACE_X86_REG_R13 0xF
 #define PROCTAL_LINUX_PTRACE_X86_REG_R14 0x10
 #define PROCTAL_LINUX_PTRACE_X86_REG_R15 0x11
+#define PROCTAL_LINUX_PTRACE_X86_REG_ORIG_RAX 0x12
 
 #define PROCTAL_LINUX_PTRACE_X86_REG_DR0 0x8000
 #define PROCTAL_LINUX_PTRACE_X86_REG_DR1 0x8001
@@ -36,6 +40,7 @@ int proctal_linux_ptrace_detach(struct proctal_linux *pl);
 
 int proctal_linux_ptrace_stop(struct proctal_linux *pl);
 int proctal_linux_ptrace_cont(struct proctal_linux *pl);
+int proctal_linux_ptrace_cont_signal(struct proctal_linux *pl, int signal);
 int proctal_linux_ptrace_step(struct proctal_linux *pl);
 
 int proctal_linux_ptrace_wait_trap(struct proctal_linux *pl);
@@ -46,4 +51,46 @@ int proctal_linux_ptrace_set_instruction_address(struct proctal_linux *pl, void
 int proctal_linux_ptrace_set_x86_reg(struct proctal_linux *pl, int reg, unsigned long long v);
 int proctal_linux_ptrace_get_x86_reg(struct proctal_linux *pl, int reg, unsigned long long *v);
 
+/*
+ * Functions that work on a single thread of the process instead of the main
+ * thread. Threads are attached to with PTRACE_SEIZE, which does not stop them
+ * and does not keep count. Waiting on them is left to the caller.
+ */
+int proctal_linux_ptrace_thread_seize(struct proctal_linux *pl, pid_t tid, long options);
+int proctal_linux_ptrace_thread_interrupt(struct proctal_linux *pl, pid_t tid);
+int proctal_linux_ptrace_thread_cont(struct proctal_linux *pl, pid_t tid, int signal);
+
+/*
+ * Leaves a thread that is in a stop of the whole process stopped while
+ * letting the caller be told when the process is continued.
+ */
+int proctal_linux_ptrace_thread_listen(struct proctal_linux *pl, pid_t tid);
+
+int proctal_linux_ptrace_thread_detach(struct proctal_linux *pl, pid_t tid, int signal);
+int proctal_linux_ptrace_thread_event_message(struct proctal_linux *pl, pid_t tid, unsigned long *message);
+int proctal_linux_ptrace_thread_siginfo(struct proctal_linux *pl, pid_t tid, siginfo_t *info);
+
+/*
+ * Lets a stopped thread run a single instruction and waits until it stops
+ * again. Stops that come before the instruction runs, such as the stop of the
+ * whole process, are stepped over.
+ *
+ * Fails if the thread stops because of any other signal than SIGTRAP, in
+ * which case the thread is left in that stop and the signal is put in signal.
+ */
+int proctal_linux_ptrace_thread_step(struct proctal_linux *pl, pid_t tid, int *signal);
+
+int proctal_linux_ptrace_thread_set_x86_reg(struct proctal_linux *pl, pid_t tid, int reg, unsigned long long v);
+int proctal_linux_ptrace_thread_get_x86_reg(struct proctal_linux *pl, pid_t tid, int reg, unsigned long long *v);
+
+/*
+ * Reads all general purpose registers of a stopped thread at once.
+ */
+int proctal_linux_ptrace_thread_get_x86_regs(struct proctal_linux *pl, pid_t tid, struct user_regs_struct *regs);
+
+/*
+ * Writes all general purpose registers of a stopped thread at once.
+ */
+int proctal_linux_ptrace_thread_set_x86_regs(struct proctal_linux *pl, pid_t tid, const struct user_regs_struct *regs);
+
 #endif /* LIB_LINUX_PTRACE_H */
@@ -122,3 +122,8 @@ int proctal_linux_region(struct proctal_linux *pl, void **start, void **end)
 		return 0;
 	}
 }
+
+const char *proctal_linux_region_path(struct proctal_linux *pl)
+{
+	return pl->region.curr.path;
+}
@@ -7,4 +7,6 @@ void proctal_linux_region_new(struct proctal_linux *pl);
 
 int proctal_linux_region(struct proctal_linux *pl, void **start, void **end);
 
+const char *proctal_linux_region_path(struct proctal_linux *pl);
+
 #endif /* LIB_LINUX_REGION_H */
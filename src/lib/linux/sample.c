@@ -0,0 +1,152 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "lib/linux/sample.h"
+#include "lib/linux/freeze.h"
+#include "lib/linux/mem.h"
+#include "lib/linux/ptrace.h"
+
+/*
+ * Starts a thread in the sample.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int add_thread(struct proctal_linux *pl, pid_t tid)
+{
+	struct proctal_linux_sample *s = &pl->sample;
+
+	if (s->thread_count == s->thread_capacity) {
+		size_t capacity = s->thread_capacity ? s->thread_capacity * 2 : 16;
+		struct proctal_linux_sample_thread *threads = proctal_malloc(&pl->p, capacity * sizeof(*threads));
+
+		if (threads == NULL) {
+			return 0;
+		}
+
+		if (s->threads) {
+			memcpy(threads, s->threads, s->thread_count * sizeof(*threads));
+			proctal_free(&pl->p, s->threads);
+		}
+
+		s->threads = threads;
+		s->thread_capacity = capacity;
+	}
+
+	s->threads[s->thread_count].tid = tid;
+	s->threads[s->thread_count].first = s->frame_count;
+	s->threads[s->thread_count].frame_count = 0;
+	++s->thread_count;
+
+	return 1;
+}
+
+/*
+ * Adds an address to the last thread in the sample.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int add_frame(struct proctal_linux *pl, void *addr)
+{
+	struct proctal_linux_sample *s = &pl->sample;
+
+	if (s->frame_count == s->frame_capacity) {
+		size_t capacity = s->frame_capacity ? s->frame_capacity * 2 : 64;
+		void **frames = proctal_malloc(&pl->p, capacity * sizeof(*frames));
+
+		if (frames == NULL) {
+			return 0;
+		}
+
+		if (s->frames) {
+			memcpy(frames, s->frames, s->frame_count * sizeof(*frames));
+			proctal_free(&pl->p, s->frames);
+		}
+
+		s->frames = frames;
+		s->frame_capacity = capacity;
+	}
+
+	s->frames[s->frame_count++] = addr;
+	++s->threads[s->thread_count - 1].frame_count;
+
+	return 1;
+}
+
+/*
+ * Adds the return addresses of the last thread in the sample by following its
+ * frame pointers, until there are as many addresses as the depth or the chain
+ * stops looking like one.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int walk_stack(struct proctal_linux *pl, uintptr_t sp, uintptr_t fp)
+{
+	struct proctal_linux_sample_thread *thread = &pl->sample.threads[pl->sample.thread_count - 1];
+
+	while (thread->frame_count < pl->p.sample.depth) {
+		// The frame pointer of the caller is saved right below the
+		// return address, both further up the stack than the frame
+		// of the callee.
+		void *frame[2];
+
+		if (fp < sp || fp % sizeof(frame[0]) != 0) {
+			break;
+		}
+
+		if (!proctal_linux_mem_read(pl, (void *) fp, (char *) frame, sizeof(frame))) {
+			// Was not a frame pointer after all.
+			proctal_error_ack(&pl->p);
+			break;
+		}
+
+		if (frame[1] == NULL) {
+			break;
+		}
+
+		if (!add_frame(pl, frame[1])) {
+			return 0;
+		}
+
+		sp = fp + sizeof(frame);
+		fp = (uintptr_t) frame[0];
+	}
+
+	return 1;
+}
+
+int proctal_linux_sample(struct proctal_linux *pl)
+{
+	pl->sample.thread_count = 0;
+	pl->sample.frame_count = 0;
+
+	if (!proctal_linux_freeze(pl)) {
+		return 0;
+	}
+
+	int ok = 1;
+
+	for (size_t i = 0; ok && i < pl->freeze.thread_count; ++i) {
+		pid_t tid = pl->freeze.threads[i].tid;
+
+		// All registers at once take a single call.
+		struct user_regs_struct regs;
+
+		ok = proctal_linux_ptrace_thread_get_x86_regs(pl, tid, &regs)
+			&& add_thread(pl, tid)
+			&& add_frame(pl, (void *) regs.rip)
+			&& walk_stack(pl, regs.rsp, regs.rbp);
+	}
+
+	if (!ok) {
+		int error = proctal_error(&pl->p);
+		proctal_linux_unfreeze(pl);
+		proctal_set_error(&pl->p, error);
+
+		pl->sample.thread_count = 0;
+		pl->sample.frame_count = 0;
+
+		return 0;
+	}
+
+	return proctal_linux_unfreeze(pl);
+}
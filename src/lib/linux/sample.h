@@ -0,0 +1,8 @@
+#ifndef LIB_LINUX_SAMPLE_H
+#define LIB_LINUX_SAMPLE_H
+
+#include "lib/linux/proctal.h"
+
+int proctal_linux_sample(struct proctal_linux *pl);
+
+#endif /* LIB_LINUX_SAMPLE_H */
@@ -1,163 +1,1422 @@
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include <stdio.h>
 #include <errno.h>
+#include <signal.h>
+#include <time.h>
 #include <sys/ptrace.h>
 #include <sys/user.h>
 #include <sys/wait.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include "lib/linux/proctal.h"
 #include "lib/linux/watch.h"
 #include "lib/linux/address.h"
+#include "lib/linux/execute.h"
+#include "lib/linux/proc.h"
+#include "lib/linux/perf.h"
 #include "lib/x86/dr.h"
 
-static int enable_breakpoint(struct proctal_linux *pl)
+static const int address_registers[] = {
+	PROCTAL_LINUX_PTRACE_X86_REG_DR0,
+	PROCTAL_LINUX_PTRACE_X86_REG_DR1,
+	PROCTAL_LINUX_PTRACE_X86_REG_DR2,
+	PROCTAL_LINUX_PTRACE_X86_REG_DR3,
+};
+
+static const int debug_registers[] = {
+	PROCTAL_X86_DR_0,
+	PROCTAL_X86_DR_1,
+	PROCTAL_X86_DR_2,
+	PROCTAL_X86_DR_3,
+};
+
+static int len_of_size(size_t size, unsigned int *len)
 {
-	if (!proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_DR0, (unsigned long long) pl->p.watch.addr)) {
+	switch (size) {
+	case 1:
+		*len = PROCTAL_X86_DR_LEN_1B;
+		return 1;
+
+	case 2:
+		*len = PROCTAL_X86_DR_LEN_2B;
+		return 1;
+
+	case 4:
+		*len = PROCTAL_X86_DR_LEN_4B;
+		return 1;
+
+	case 8:
+		*len = PROCTAL_X86_DR_LEN_8B;
+		return 1;
+
+	default:
 		return 0;
 	}
+}
 
-	unsigned long long dr7;
+static int check_point(struct proctal_linux *pl, struct proctal_watch_point *point)
+{
+	if (point->read && !point->write && !point->execute) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED_WATCH_READ);
+		return 0;
+	}
+
+	if (point->read && !point->write && point->execute) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED_WATCH_READ_EXECUTE);
+		return 0;
+	}
 
-	if (!proctal_linux_ptrace_get_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_DR7, &dr7)) {
+	if (!point->read && point->write && point->execute) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED_WATCH_WRITE_EXECUTE);
+		return 0;
+	}
+
+	if (point->read && point->write && point->execute) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED_WATCH_READ_WRITE_EXECUTE);
 		return 0;
 	}
 
-	proctal_x86_dr_set_len(&dr7, PROCTAL_X86_DR_0, PROCTAL_X86_DR_LEN_1B);
+	if (pl->p.watch.method == PROCTAL_WATCH_METHOD_PAGE_PROTECTION) {
+		// Pages cannot be protected from execution alone.
+		if (point->execute) {
+			proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED);
+			return 0;
+		}
 
-	if (proctal_watch_execute(&pl->p)) {
-		proctal_x86_dr_set_rw(&dr7, PROCTAL_X86_DR_0, PROCTAL_X86_DR_RW_X);
-	} else if (proctal_watch_read(&pl->p) && proctal_watch_write(&pl->p)) {
-		proctal_x86_dr_set_rw(&dr7, PROCTAL_X86_DR_0, PROCTAL_X86_DR_RW_RW);
-	} else {
-		proctal_x86_dr_set_rw(&dr7, PROCTAL_X86_DR_0, PROCTAL_X86_DR_RW_W);
+		if (point->size == 0) {
+			proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED_WATCH_SIZE);
+			return 0;
+		}
+
+		return 1;
+	}
+
+	// Perf events end up in the debug registers as well.
+	if (pl->p.watch.method != PROCTAL_WATCH_METHOD_DEBUG_REGISTERS
+		&& pl->p.watch.method != PROCTAL_WATCH_METHOD_PERF_EVENTS) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED);
+		return 0;
 	}
 
-	proctal_x86_dr_enable_l(&dr7, PROCTAL_X86_DR_0, 1);
+	unsigned int len;
 
-	if (!proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_DR7, dr7)) {
+	// The processor ignores the lowest bits of the address so it must be
+	// aligned to the size.
+	if (!len_of_size(point->size, &len)
+		|| (uintptr_t) point->addr % point->size != 0
+		|| (point->execute && point->size != 1)) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED_WATCH_SIZE);
 		return 0;
 	}
 
 	return 1;
 }
 
-static int disable_breakpoint(struct proctal_linux *pl)
+static int enable_breakpoints(struct proctal_linux *pl, pid_t tid)
 {
 	unsigned long long dr7;
 
-	if (!proctal_linux_ptrace_get_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_DR7, &dr7)) {
+	if (!proctal_linux_ptrace_thread_get_x86_reg(pl, tid, PROCTAL_LINUX_PTRACE_X86_REG_DR7, &dr7)) {
 		return 0;
 	}
 
-	proctal_x86_dr_enable_l(&dr7, PROCTAL_X86_DR_0, 0);
+	for (size_t i = 0; i < pl->p.watch.count; ++i) {
+		struct proctal_watch_point *point = &pl->p.watch.points[i];
+		int r = debug_registers[i];
+
+		if (!proctal_linux_ptrace_thread_set_x86_reg(pl, tid, address_registers[i], (unsigned long long) point->addr)) {
+			return 0;
+		}
+
+		unsigned int len;
+		len_of_size(point->size, &len);
+
+		proctal_x86_dr_set_len(&dr7, r, len);
+
+		if (point->execute) {
+			proctal_x86_dr_set_rw(&dr7, r, PROCTAL_X86_DR_RW_X);
+		} else if (point->read && point->write) {
+			proctal_x86_dr_set_rw(&dr7, r, PROCTAL_X86_DR_RW_RW);
+		} else {
+			proctal_x86_dr_set_rw(&dr7, r, PROCTAL_X86_DR_RW_W);
+		}
+
+		proctal_x86_dr_enable_l(&dr7, r, 1);
+	}
 
-	if (!proctal_linux_ptrace_set_x86_reg(pl, PROCTAL_LINUX_PTRACE_X86_REG_DR7, dr7)) {
+	// All breakpoints are turned on at once.
+	if (!proctal_linux_ptrace_thread_set_x86_reg(pl, tid, PROCTAL_LINUX_PTRACE_X86_REG_DR7, dr7)) {
 		return 0;
 	}
 
 	return 1;
 }
 
-static int start(struct proctal_linux *pl)
+static int disable_breakpoints(struct proctal_linux *pl, pid_t tid)
 {
-	if (pl->p.watch.read && !pl->p.watch.write && !pl->p.watch.execute) {
-		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED_WATCH_READ);
+	unsigned long long dr7;
+
+	if (!proctal_linux_ptrace_thread_get_x86_reg(pl, tid, PROCTAL_LINUX_PTRACE_X86_REG_DR7, &dr7)) {
 		return 0;
 	}
 
-	if (pl->p.watch.read && !pl->p.watch.write && pl->p.watch.execute) {
-		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED_WATCH_READ_EXECUTE);
-		return 0;
+	for (size_t i = 0; i < pl->p.watch.count; ++i) {
+		proctal_x86_dr_enable_l(&dr7, debug_registers[i], 0);
 	}
 
-	if (!pl->p.watch.read && pl->p.watch.write && pl->p.watch.execute) {
-		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED_WATCH_WRITE_EXECUTE);
+	if (!proctal_linux_ptrace_thread_set_x86_reg(pl, tid, PROCTAL_LINUX_PTRACE_X86_REG_DR7, dr7)) {
 		return 0;
 	}
 
-	if (pl->p.watch.read && pl->p.watch.write && pl->p.watch.execute) {
-		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED_WATCH_READ_WRITE_EXECUTE);
+	return 1;
+}
+
+/*
+ * Finds out from DR6 which breakpoint was hit by a thread. DR6 is cleared
+ * afterwards because the processor never does it.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int find_hit(struct proctal_linux *pl, pid_t tid)
+{
+	unsigned long long dr6;
+
+	pl->p.watch.hit = -1;
+
+	if (!proctal_linux_ptrace_thread_get_x86_reg(pl, tid, PROCTAL_LINUX_PTRACE_X86_REG_DR6, &dr6)) {
 		return 0;
 	}
 
-	if (!proctal_linux_ptrace_attach(pl)) {
+	for (size_t i = 0; i < pl->p.watch.count; ++i) {
+		if (proctal_x86_dr_is_hit(dr6, debug_registers[i])) {
+			pl->p.watch.hit = i;
+			break;
+		}
+	}
+
+	return proctal_linux_ptrace_thread_set_x86_reg(pl, tid, PROCTAL_LINUX_PTRACE_X86_REG_DR6, 0);
+}
+
+static struct proctal_linux_watch_thread *find_thread(struct proctal_linux *pl, pid_t tid)
+{
+	for (size_t i = 0; i < pl->watch.thread_count; ++i) {
+		if (pl->watch.threads[i].tid == tid) {
+			return &pl->watch.threads[i];
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Starts keeping track of a thread. New threads are yet to stop.
+ *
+ * Returns NULL on failure.
+ */
+static struct proctal_linux_watch_thread *add_thread(struct proctal_linux *pl, pid_t tid)
+{
+	struct proctal_linux_watch *w = &pl->watch;
+
+	if (w->thread_count == w->thread_capacity) {
+		size_t capacity = w->thread_capacity ? w->thread_capacity * 2 : 16;
+		struct proctal_linux_watch_thread *threads = proctal_malloc(&pl->p, capacity * sizeof(*threads));
+
+		if (threads == NULL) {
+			return NULL;
+		}
+
+		if (w->threads) {
+			memcpy(threads, w->threads, w->thread_count * sizeof(*threads));
+			proctal_free(&pl->p, w->threads);
+		}
+
+		w->threads = threads;
+		w->thread_capacity = capacity;
+	}
+
+	struct proctal_linux_watch_thread *thread = &w->threads[w->thread_count++];
+	thread->tid = tid;
+	thread->stopped = 0;
+	thread->armed = 0;
+	thread->signal = 0;
+
+	return thread;
+}
+
+static void remove_thread(struct proctal_linux *pl, struct proctal_linux_watch_thread *thread)
+{
+	*thread = pl->watch.threads[--pl->watch.thread_count];
+}
+
+static int prot_of_region(struct proctal_linux_mem_region *region)
+{
+	return (region->read ? PROT_READ : 0)
+		| (region->write ? PROT_WRITE : 0)
+		| (region->execute ? PROT_EXEC : 0);
+}
+
+/*
+ * Adds a run of pages to the end of the list.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int add_pages(struct proctal_linux *pl, char *start, char *end, int prot, int guard)
+{
+	struct proctal_linux_watch *w = &pl->watch;
+
+	if (w->page_count == w->page_capacity) {
+		size_t capacity = w->page_capacity ? w->page_capacity * 2 : 16;
+		struct proctal_linux_watch_pages *pages = proctal_malloc(&pl->p, capacity * sizeof(*pages));
+
+		if (pages == NULL) {
+			return 0;
+		}
+
+		if (w->pages) {
+			memcpy(pages, w->pages, w->page_count * sizeof(*pages));
+			proctal_free(&pl->p, w->pages);
+		}
+
+		w->pages = pages;
+		w->page_capacity = capacity;
+	}
+
+	struct proctal_linux_watch_pages *pages = &w->pages[w->page_count++];
+	pages->start = start;
+	pages->end = end;
+	pages->prot = prot;
+	pages->guard = guard;
+
+	return 1;
+}
+
+static int compare_addresses(const void *a, const void *b)
+{
+	char *x = *(char **) a;
+	char *y = *(char **) b;
+
+	return (x > y) - (x < y);
+}
+
+/*
+ * Finds the pages that watchpoints are in along with their protection. Where
+ * watchpoints share pages, the pages get the protection that stops both
+ * kinds of accesses.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int find_pages(struct proctal_linux *pl)
+{
+	struct proctal_linux_watch *w = &pl->watch;
+	uintptr_t page_size = sysconf(_SC_PAGESIZE);
+
+	w->page_count = 0;
+
+	FILE *maps = fopen(proctal_linux_proc_path(pl->pid, "maps"), "r");
+
+	if (maps == NULL) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_PERMISSION_DENIED);
 		return 0;
 	}
 
-	if (!enable_breakpoint(pl)) {
-		proctal_linux_ptrace_detach(pl);
+	struct proctal_linux_mem_region region;
+
+	// Every part of a watchpoint that is in a different region is added
+	// on its own first.
+	while (proctal_linux_read_mem_region(&region, maps) == 0) {
+		for (size_t i = 0; i < pl->p.watch.count; ++i) {
+			struct proctal_watch_point *point = &pl->p.watch.points[i];
+
+			uintptr_t start = (uintptr_t) point->addr & ~(page_size - 1);
+			uintptr_t end = ((uintptr_t) point->addr + point->size + page_size - 1) & ~(page_size - 1);
+
+			if (start < (uintptr_t) region.start_addr) {
+				start = (uintptr_t) region.start_addr;
+			}
+
+			if (end > (uintptr_t) region.end_addr) {
+				end = (uintptr_t) region.end_addr;
+			}
+
+			if (start >= end) {
+				continue;
+			}
+
+			int prot = prot_of_region(&region);
+			int guard = point->read ? PROT_NONE : prot & ~PROT_WRITE;
+
+			if (!add_pages(pl, (char *) start, (char *) end, prot, guard)) {
+				fclose(maps);
+				return 0;
+			}
+		}
+	}
+
+	fclose(maps);
+
+	size_t count = w->page_count;
+
+	if (count == 0) {
+		return 1;
+	}
+
+	// Then the parts are split where any of them start or end and put
+	// back together without overlapping.
+	char **bounds = proctal_malloc(&pl->p, count * 2 * sizeof(*bounds));
+	struct proctal_linux_watch_pages *parts = proctal_malloc(&pl->p, count * sizeof(*parts));
+
+	if (bounds == NULL || parts == NULL) {
+		if (bounds) {
+			proctal_free(&pl->p, bounds);
+		}
+
+		if (parts) {
+			proctal_free(&pl->p, parts);
+		}
+
 		return 0;
 	}
 
-	return 1;
+	for (size_t i = 0; i < count; ++i) {
+		parts[i] = w->pages[i];
+		bounds[i * 2] = parts[i].start;
+		bounds[i * 2 + 1] = parts[i].end;
+	}
+
+	qsort(bounds, count * 2, sizeof(*bounds), compare_addresses);
+
+	w->page_count = 0;
+
+	int ok = 1;
+
+	for (size_t i = 0; ok && i + 1 < count * 2; ++i) {
+		char *start = bounds[i];
+		char *end = bounds[i + 1];
+		int prot = 0;
+		int guard = -1;
+
+		if (start == end) {
+			continue;
+		}
+
+		for (size_t j = 0; j < count; ++j) {
+			if (parts[j].start <= start && parts[j].end >= end) {
+				prot = parts[j].prot;
+				guard &= parts[j].guard;
+			}
+		}
+
+		if (guard == -1) {
+			continue;
+		}
+
+		struct proctal_linux_watch_pages *last = w->page_count ? &w->pages[w->page_count - 1] : NULL;
+
+		if (last != NULL && last->end == start && last->prot == prot && last->guard == guard) {
+			last->end = end;
+		} else {
+			ok = add_pages(pl, start, end, prot, guard);
+		}
+	}
+
+	proctal_free(&pl->p, bounds);
+	proctal_free(&pl->p, parts);
+
+	return ok;
+}
+
+static struct proctal_linux_watch_pages *find_pages_of(struct proctal_linux *pl, void *addr)
+{
+	for (size_t i = 0; i < pl->watch.page_count; ++i) {
+		struct proctal_linux_watch_pages *pages = &pl->watch.pages[i];
+
+		if ((char *) addr >= pages->start && (char *) addr < pages->end) {
+			return pages;
+		}
+	}
+
+	return NULL;
 }
 
-static int end(struct proctal_linux *pl)
+/*
+ * Changes the protection of a run of pages by making a stopped thread call
+ * mprotect. A signal that comes in the mean time is delivered when the thread
+ * is resumed.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int set_protection(struct proctal_linux *pl, struct proctal_linux_watch_thread *thread, struct proctal_linux_watch_pages *pages, int prot)
 {
-	// Assuming process is stopped.
+	unsigned long long ret;
+	int signal = 0;
+
+	// mprotect x86-64 system call.
+	int ok = proctal_linux_execute_thread_syscall(pl, thread->tid, pl->watch.syscall_page, &signal, 10, &ret, (unsigned long long) pages->start, pages->end - pages->start, prot, 0, 0, 0);
+
+	if (signal != 0) {
+		thread->signal = signal;
+	}
+
+	if (!ok) {
+		return 0;
+	}
 
-	if (!disable_breakpoint(pl)) {
+	if (ret != 0) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
 		return 0;
 	}
 
-	return proctal_linux_ptrace_detach(pl);
+	return 1;
 }
 
-int proctal_linux_watch(struct proctal_linux *pl, void **addr)
+/*
+ * Makes a stopped thread unmap the page that the calls to mprotect are made
+ * from. A signal that comes in the mean time is delivered when the thread is
+ * resumed.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int unmap_syscall_page(struct proctal_linux *pl, struct proctal_linux_watch_thread *thread)
 {
-	if (!start(pl)) {
+	void *page = pl->watch.syscall_page;
+	unsigned long long ret;
+	int signal = 0;
+
+	pl->watch.syscall_page = NULL;
+
+	// munmap x86-64 system call.
+	int ok = proctal_linux_execute_thread_syscall(pl, thread->tid, page, &signal, 11, &ret, (unsigned long long) page, sysconf(_SC_PAGESIZE), 0, 0, 0, 0);
+
+	if (signal != 0) {
+		thread->signal = signal;
+	}
+
+	if (!ok) {
 		return 0;
 	}
 
-	if (!proctal_linux_ptrace_cont(pl)) {
-		return end(pl);
+	if (ret != 0) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+		return 0;
 	}
 
-	int wstatus;
+	return 1;
+}
 
-	for (;;) {
-		if (waitpid(pl->pid, &wstatus, WUNTRACED) != pl->pid) {
-			// If it failed due to an interrupt, we're not going to
-			// consider this an error.
-			if (errno != EINTR) {
-				proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+/*
+ * Protects every run of pages, or gives them back their protection.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int protect_pages(struct proctal_linux *pl, struct proctal_linux_watch_thread *thread, int protect)
+{
+	int ok = 1;
+
+	for (size_t i = 0; i < pl->watch.page_count; ++i) {
+		struct proctal_linux_watch_pages *pages = &pl->watch.pages[i];
+
+		if (!set_protection(pl, thread, pages, protect ? pages->guard : pages->prot)) {
+			ok = 0;
+		}
+	}
+
+	return ok;
+}
+
+/*
+ * Attaches to every thread of the process that is not attached to yet and
+ * asks them to stop. Threads that are created while this happens are either
+ * found by going over the list again or are attached to automatically
+ * because of PTRACE_O_TRACECLONE.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int attach_threads(struct proctal_linux *pl)
+{
+	int found;
+
+	do {
+		DIR *dir = proctal_linux_proc_tasks(pl->pid);
+
+		if (dir == NULL) {
+			proctal_set_error(&pl->p, PROCTAL_ERROR_PROCESS_NOT_FOUND);
+			return 0;
+		}
+
+		found = 0;
+
+		pid_t tid;
+
+		while ((tid = proctal_linux_proc_next_task(dir)) != 0) {
+			if (find_thread(pl, tid) != NULL) {
+				continue;
+			}
+
+			if (!proctal_linux_ptrace_thread_seize(pl, tid, PTRACE_O_TRACECLONE)) {
+				// Threads other than the main one may have
+				// exited or been attached to on creation in
+				// the mean time.
+				if (tid == pl->pid) {
+					closedir(dir);
+					return 0;
+				}
+
+				proctal_error_ack(&pl->p);
+				continue;
+			}
+
+			if (add_thread(pl, tid) == NULL) {
+				proctal_linux_ptrace_thread_detach(pl, tid, 0);
+				closedir(dir);
+				return 0;
+			}
+
+			if (!proctal_linux_ptrace_thread_interrupt(pl, tid)) {
+				// Exited already, which is found out when
+				// waiting for it.
+				proctal_error_ack(&pl->p);
 			}
 
-			proctal_linux_ptrace_stop(pl);
-			end(pl);
+			found = 1;
+		}
+
+		closedir(dir);
+	} while (found);
+
+	return 1;
+}
+
+/*
+ * Lets a stopped thread run, setting the breakpoints on it first if it's the
+ * first time it stopped.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int resume_thread(struct proctal_linux *pl, struct proctal_linux_watch_thread *thread)
+{
+	if (!thread->armed && pl->p.watch.method == PROCTAL_WATCH_METHOD_DEBUG_REGISTERS) {
+		if (!enable_breakpoints(pl, thread->tid)) {
 			return 0;
 		}
 
-		if (WIFEXITED(wstatus) || WIFSIGNALED(wstatus)) {
-			// Process is gone, nothing to do anymore.
-			break;
-		} else if (WIFSTOPPED(wstatus)) {
-			int signal = WSTOPSIG(wstatus);
+		thread->armed = 1;
+	}
+
+	if (!proctal_linux_ptrace_thread_cont(pl, thread->tid, thread->signal)) {
+		return 0;
+	}
+
+	thread->stopped = 0;
+	thread->signal = 0;
+
+	return 1;
+}
+
+/*
+ * Tells whether a thread stopped because it accessed pages that were
+ * protected for watching.
+ */
+static int is_protection_fault(struct proctal_linux *pl, pid_t tid)
+{
+	siginfo_t info;
+
+	if (!proctal_linux_ptrace_thread_siginfo(pl, tid, &info)) {
+		proctal_error_ack(&pl->p);
+		return 0;
+	}
+
+	return info.si_code == SEGV_ACCERR && find_pages_of(pl, info.si_addr) != NULL;
+}
+
+/*
+ * Takes note of a thread stopping on the way to being detached from. Threads
+ * that it creates in the mean time are added to the list and a signal that was
+ * on its way to it is kept for later, unless it's a fault caused by protecting
+ * pages, which happens again once the instruction is retried.
+ *
+ * Returns 1 when the thread stopped, 0 when it's gone, in which case it's
+ * taken off the list, and -1 when it stopped but a new thread could not be
+ * added to the list.
+ */
+static int note_stop(struct proctal_linux *pl, struct proctal_linux_watch_thread *thread, int wstatus)
+{
+	if (WIFEXITED(wstatus) || WIFSIGNALED(wstatus)) {
+		remove_thread(pl, thread);
+		return 0;
+	}
+
+	thread->stopped = 1;
+
+	int event = wstatus >> 16;
+	int signal = WSTOPSIG(wstatus);
 
-			switch (signal) {
-			case SIGTRAP: {
-				void *rip;
+	if (event == PTRACE_EVENT_CLONE) {
+		unsigned long tid;
 
-				proctal_linux_ptrace_get_instruction_address(pl, &rip);
+		// New threads start in a stop of their own.
+		if (proctal_linux_ptrace_thread_event_message(pl, thread->tid, &tid)
+			&& find_thread(pl, tid) == NULL
+			&& add_thread(pl, tid) == NULL) {
+			return -1;
+		}
+	} else if (event == 0 && signal != SIGTRAP) {
+		if (signal != SIGSEGV || !is_protection_fault(pl, thread->tid)) {
+			// A signal that was on its way to the process.
+			thread->signal = signal;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Waits for a thread that was asked to stop to stop.
+ *
+ * Returns the same as note_stop.
+ */
+static int wait_stop(struct proctal_linux *pl, size_t i)
+{
+	struct proctal_linux_watch_thread *thread = &pl->watch.threads[i];
+	int wstatus;
+
+	if (waitpid(thread->tid, &wstatus, __WALL) != thread->tid) {
+		remove_thread(pl, thread);
+		return 0;
+	}
+
+	return note_stop(pl, thread, wstatus);
+}
+
+/*
+ * Takes the oldest change in the state of a thread that was waited for ahead
+ * of time.
+ *
+ * Returns 1 when there was one, 0 when there are none.
+ */
+static int take_queued(struct proctal_linux *pl, pid_t *tid, int *wstatus)
+{
+	struct proctal_linux_watch *w = &pl->watch;
 
-				*addr = rip;
+	if (w->queue_count == 0) {
+		return 0;
+	}
+
+	*tid = w->queue[w->queue_start].tid;
+	*wstatus = w->queue[w->queue_start].status;
+
+	++w->queue_start;
+
+	if (--w->queue_count == 0) {
+		w->queue_start = 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Takes note of the changes that were waited for ahead of time before
+ * detaching, since they are not reported again.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int note_queued(struct proctal_linux *pl)
+{
+	int ok = 1;
+	pid_t tid;
+	int wstatus;
 
-				break;
+	while (take_queued(pl, &tid, &wstatus)) {
+		struct proctal_linux_watch_thread *thread = find_thread(pl, tid);
+
+		if (thread == NULL) {
+			if (!WIFSTOPPED(wstatus)) {
+				continue;
 			}
 
-			case SIGINT:
-			default:
-				// Process sent signal to be stopped. We're letting go.
-				kill(pl->pid, signal);
+			// A new thread whose first stop came before the event
+			// of its creation.
+			thread = add_thread(pl, tid);
 
-				end(pl);
-				return 0;
+			if (thread == NULL) {
+				ok = 0;
+				continue;
 			}
+		}
 
-			break;
+		if (note_stop(pl, thread, wstatus) == -1) {
+			ok = 0;
 		}
 	}
 
-	return end(pl);
+	return ok;
+}
+
+/*
+ * Waits for any of the threads that were asked to stop to stop.
+ *
+ * Returns NULL when they're all gone.
+ */
+static struct proctal_linux_watch_thread *wait_any_stop(struct proctal_linux *pl)
+{
+	for (size_t i = 0; i < pl->watch.thread_count;) {
+		if (!pl->watch.threads[i].stopped && wait_stop(pl, i) == 0) {
+			continue;
+		}
+
+		return &pl->watch.threads[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * Waits for every thread that was asked to stop to stop, including threads
+ * that they create in the mean time.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int wait_all_stop(struct proctal_linux *pl)
+{
+	int ok = 1;
+
+	for (size_t i = 0; i < pl->watch.thread_count;) {
+		if (!pl->watch.threads[i].stopped) {
+			int stopped = wait_stop(pl, i);
+
+			if (stopped == 0) {
+				continue;
+			} else if (stopped == -1) {
+				ok = 0;
+			}
+		}
+
+		++i;
+	}
+
+	return ok;
+}
+
+/*
+ * Stops every thread and takes the breakpoints away from them before
+ * detaching. Pages get their protection back. Threads that are created in
+ * the mean time are dealt with as well.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int detach_threads(struct proctal_linux *pl)
+{
+	int ok = note_queued(pl);
+
+	for (size_t i = 0; i < pl->watch.thread_count; ++i) {
+		struct proctal_linux_watch_thread *thread = &pl->watch.threads[i];
+
+		if (!thread->stopped && !proctal_linux_ptrace_thread_interrupt(pl, thread->tid)) {
+			// Exited already, which is found out when waiting for
+			// it.
+			proctal_error_ack(&pl->p);
+		}
+	}
+
+	if (pl->watch.protected) {
+		struct proctal_linux_watch_thread *thread = wait_any_stop(pl);
+
+		if (thread != NULL && !protect_pages(pl, thread, 0)) {
+			ok = 0;
+		}
+
+		if (thread != NULL && !unmap_syscall_page(pl, thread)) {
+			ok = 0;
+		}
+
+		pl->watch.protected = 0;
+	}
+
+	for (size_t i = 0; i < pl->watch.thread_count;) {
+		if (!pl->watch.threads[i].stopped) {
+			int stopped = wait_stop(pl, i);
+
+			if (stopped == 0) {
+				continue;
+			} else if (stopped == -1) {
+				ok = 0;
+			}
+		}
+
+		struct proctal_linux_watch_thread *thread = &pl->watch.threads[i];
+
+		if (thread->armed && !disable_breakpoints(pl, thread->tid)) {
+			ok = 0;
+		}
+
+		if (!proctal_linux_ptrace_thread_detach(pl, thread->tid, thread->signal)) {
+			ok = 0;
+		}
+
+		remove_thread(pl, thread);
+	}
+
+	return ok;
+}
+
+/*
+ * Lets a stopped thread run the instruction it stopped at. Signals other than
+ * SIGSEGV that come in the mean time are delivered when the thread is
+ * resumed.
+ *
+ * Returns 1 on success, 0 on failure, which includes the instruction causing
+ * a fault, in which case signal is SIGSEGV.
+ */
+static int step_thread(struct proctal_linux *pl, struct proctal_linux_watch_thread *thread, int *signal)
+{
+	for (;;) {
+		if (proctal_linux_ptrace_thread_step(pl, thread->tid, signal)) {
+			return 1;
+		}
+
+		if (*signal == 0 || *signal == SIGSEGV) {
+			return 0;
+		}
+
+		proctal_error_ack(&pl->p);
+		thread->signal = *signal;
+	}
+}
+
+/*
+ * Deals with a thread that stopped because of a fault. If the fault was
+ * caused by protecting pages, the instruction is carried out with the
+ * protection of its pages lifted and the watchpoint it accessed, if any, is
+ * put in hit.
+ *
+ * Returns 1 if the fault was caused by protecting pages, 0 if it wasn't and
+ * -1 on failure.
+ */
+static int handle_fault(struct proctal_linux *pl, struct proctal_linux_watch_thread *thread)
+{
+	siginfo_t info;
+
+	pl->p.watch.hit = -1;
+
+	if (!proctal_linux_ptrace_thread_siginfo(pl, thread->tid, &info)) {
+		return -1;
+	}
+
+	struct proctal_linux_watch_pages *pages = find_pages_of(pl, info.si_addr);
+
+	if (info.si_code != SEGV_ACCERR || pages == NULL) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < pl->p.watch.count; ++i) {
+		struct proctal_watch_point *point = &pl->p.watch.points[i];
+
+		if ((char *) info.si_addr >= (char *) point->addr
+			&& (char *) info.si_addr < (char *) point->addr + point->size) {
+			pl->p.watch.hit = i;
+			break;
+		}
+	}
+
+	if (!set_protection(pl, thread, pages, pages->prot)) {
+		return -1;
+	}
+
+	int signal;
+	int stepped = step_thread(pl, thread, &signal);
+
+	if (!stepped && signal == SIGSEGV) {
+		// The instruction may have accessed other protected pages as
+		// well, so it's given one more try with every page unprotected.
+		proctal_error_ack(&pl->p);
+
+		stepped = protect_pages(pl, thread, 0)
+			&& step_thread(pl, thread, &signal);
+
+		if (!protect_pages(pl, thread, 1)) {
+			return -1;
+		}
+	}
+
+	if (!set_protection(pl, thread, pages, pages->guard)) {
+		return -1;
+	}
+
+	if (!stepped) {
+		if (signal != SIGSEGV) {
+			return -1;
+		}
+
+		// A fault of the process's own making.
+		proctal_error_ack(&pl->p);
+		thread->signal = SIGSEGV;
+		pl->p.watch.hit = -1;
+	}
+
+	return 1;
+}
+
+int proctal_linux_watch_begin(struct proctal_linux *pl)
+{
+	for (size_t i = 0; i < pl->p.watch.count; ++i) {
+		if (!check_point(pl, &pl->p.watch.points[i])) {
+			return 0;
+		}
+	}
+
+	pl->watch.method = pl->p.watch.method;
+	pl->watch.queue_start = 0;
+	pl->watch.queue_count = 0;
+	pl->watch.dispatched = 0;
+
+	if (pl->watch.method == PROCTAL_WATCH_METHOD_PERF_EVENTS) {
+		return proctal_linux_perf_watch_begin(pl);
+	}
+
+	// Threads cannot be seized while they are attached to the old way.
+	if (pl->ptrace) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED);
+		return 0;
+	}
+
+	pl->p.watch.hit = -1;
+	pl->p.watch.thread = 0;
+	pl->watch.started = 1;
+
+	if (!attach_threads(pl)) {
+		detach_threads(pl);
+		pl->watch.started = 0;
+		return 0;
+	}
+
+	if (pl->p.watch.method == PROCTAL_WATCH_METHOD_PAGE_PROTECTION) {
+		// Code is overwritten for a moment to map the page that the
+		// calls to mprotect are made from, so every thread has to be
+		// stopped first.
+		if (!find_pages(pl) || !wait_all_stop(pl)) {
+			detach_threads(pl);
+			pl->watch.started = 0;
+			return 0;
+		}
+
+		// The calls to mprotect are made by one of the threads.
+		struct proctal_linux_watch_thread *thread = wait_any_stop(pl);
+
+		if (thread == NULL) {
+			pl->watch.started = 0;
+			proctal_set_error(&pl->p, PROCTAL_ERROR_PROCESS_EXITED);
+			return 0;
+		}
+
+		int signal = 0;
+
+		pl->watch.syscall_page = proctal_linux_execute_syscall_page(pl, thread->tid, &signal);
+
+		if (signal != 0) {
+			thread->signal = signal;
+		}
+
+		if (pl->watch.syscall_page == NULL) {
+			detach_threads(pl);
+			pl->watch.started = 0;
+			return 0;
+		}
+
+		pl->watch.protected = 1;
+
+		if (!protect_pages(pl, thread, 1)) {
+			detach_threads(pl);
+			pl->watch.started = 0;
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Stops keeping track of a thread that is gone. The session is over when it
+ * was the last one.
+ *
+ * Returns 0 when the process is gone and -1 otherwise.
+ */
+static int forget_thread(struct proctal_linux *pl, struct proctal_linux_watch_thread *thread)
+{
+	if (thread != NULL) {
+		remove_thread(pl, thread);
+	}
+
+	if (pl->watch.thread_count == 0) {
+		// Process is gone, there's nothing left to clean up.
+		pl->watch.started = 0;
+		pl->watch.protected = 0;
+		proctal_set_error(&pl->p, PROCTAL_ERROR_PROCESS_EXITED);
+		return 0;
+	}
+
+	return -1;
+}
+
+/*
+ * Tells whether a failure was caused by the thread that was being dealt with
+ * going away. Only SIGKILL takes a thread out of a stop, in which case its
+ * exit may have been reported to a step already.
+ */
+static int is_gone(struct proctal_linux *pl)
+{
+	int error = proctal_error(&pl->p);
+
+	return error == PROCTAL_ERROR_PROCESS_UNTAMEABLE
+		|| error == PROCTAL_ERROR_PROCESS_EXITED;
+}
+
+/*
+ * Deals with a change in the state of a thread. Stops that are not accesses
+ * to watchpoints are handled and the thread is let go.
+ *
+ * Returns 1 when an access was detected, 0 on failure and -1 when there was
+ * nothing to report.
+ */
+static int handle_stop(struct proctal_linux *pl, pid_t tid, int wstatus, void **addr)
+{
+	struct proctal_linux_watch_thread *thread = find_thread(pl, tid);
+
+	if (WIFEXITED(wstatus) || WIFSIGNALED(wstatus)) {
+		return forget_thread(pl, thread);
+	}
+
+	if (!WIFSTOPPED(wstatus)) {
+		return -1;
+	}
+
+	if (thread == NULL) {
+		// A new thread whose first stop came before the event of
+		// its creation.
+		thread = add_thread(pl, tid);
+
+		if (thread == NULL) {
+			return 0;
+		}
+	}
+
+	thread->stopped = 1;
+
+	int event = wstatus >> 16;
+	int signal = WSTOPSIG(wstatus);
+
+	if (event == PTRACE_EVENT_CLONE) {
+		unsigned long new_tid;
+
+		if (!proctal_linux_ptrace_thread_event_message(pl, tid, &new_tid)) {
+			return 0;
+		}
+
+		// The new thread is attached to already and will stop
+		// before running, which is when it gets the breakpoints.
+		if (find_thread(pl, new_tid) == NULL && add_thread(pl, new_tid) == NULL) {
+			return 0;
+		}
+
+		// Could have moved.
+		thread = find_thread(pl, tid);
+	} else if (event == PTRACE_EVENT_STOP) {
+		if (signal != SIGTRAP) {
+			// A stop of the whole process, as with SIGSTOP. The
+			// thread has to stay stopped until the process is
+			// continued, which is reported as another stop.
+			if (!proctal_linux_ptrace_thread_listen(pl, tid)) {
+				return 0;
+			}
+
+			thread->stopped = 0;
+
+			return -1;
+		}
+
+		// Either a stop we asked for or the first stop of a new
+		// thread.
+	} else if (signal == SIGTRAP && pl->p.watch.method == PROCTAL_WATCH_METHOD_DEBUG_REGISTERS) {
+		if (!find_hit(pl, tid)) {
+			return 0;
+		}
+
+		if (pl->p.watch.hit != -1) {
+			pl->p.watch.thread = tid;
+
+			// The thread stays stopped until the next call.
+			return proctal_linux_ptrace_thread_get_x86_reg(
+				pl,
+				tid,
+				PROCTAL_LINUX_PTRACE_X86_REG_RIP,
+				(unsigned long long *) addr);
+		}
+
+		// Not one of ours.
+		thread->signal = signal;
+	} else if (signal == SIGSEGV && pl->watch.protected) {
+		int fault = handle_fault(pl, thread);
+
+		if (fault == -1) {
+			return 0;
+		} else if (fault == 0) {
+			// Not one of ours.
+			thread->signal = signal;
+		} else if (pl->p.watch.hit != -1) {
+			pl->p.watch.thread = tid;
+
+			// The access is done, so this points to the
+			// instruction after it.
+			return proctal_linux_ptrace_thread_get_x86_reg(
+				pl,
+				tid,
+				PROCTAL_LINUX_PTRACE_X86_REG_RIP,
+				(unsigned long long *) addr);
+		}
+	} else {
+		// Any other signal belongs to the process and is
+		// delivered on the way out.
+		thread->signal = signal;
+	}
+
+	if (!resume_thread(pl, thread)) {
+		return 0;
+	}
+
+	return -1;
+}
+
+/*
+ * Waits for a change in the state of a thread of the process. Changes of other
+ * children of the calling thread are left for whoever started them.
+ *
+ * Returns the ID of the thread, 0 when none changed state yet and -1 on
+ * failure, in which case errno tells why.
+ */
+static pid_t wait_thread(struct proctal_linux *pl, int *wstatus)
+{
+	pid_t child = proctal_linux_watch_peek(1);
+
+	if (child == -1) {
+		return -1;
+	}
+
+	if (proctal_linux_watch_has_thread(pl, child)) {
+		return waitpid(child, wstatus, __WALL);
+	}
+
+	// The other child is the one that keeps being reported until it's
+	// waited for, so the threads are looked at one by one instead.
+	for (size_t i = 0; i < pl->watch.thread_count; ++i) {
+		struct proctal_linux_watch_thread *thread = &pl->watch.threads[i];
+
+		if (!thread->stopped && waitpid(thread->tid, wstatus, WNOHANG | __WALL) == thread->tid) {
+			return thread->tid;
+		}
+	}
+
+	// There's no way to block until one of them changes state without
+	// waiting for the other child as well.
+	struct timespec delay = { 0, 1000000 };
+	nanosleep(&delay, NULL);
+
+	return 0;
+}
+
+int proctal_linux_watch_next(struct proctal_linux *pl, void **addr)
+{
+	if (pl->watch.method == PROCTAL_WATCH_METHOD_PERF_EVENTS) {
+		return proctal_linux_perf_watch_next(pl, addr);
+	}
+
+	if (!pl->watch.started) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+		return 0;
+	}
+
+	for (size_t i = 0; i < pl->watch.thread_count; ++i) {
+		struct proctal_linux_watch_thread *thread = &pl->watch.threads[i];
+
+		if (thread->stopped && !resume_thread(pl, thread)) {
+			if (!is_gone(pl)) {
+				return 0;
+			}
+
+			// Killed while it was stopped. Its exit is reported
+			// later.
+			proctal_error_ack(&pl->p);
+			thread->stopped = 0;
+		}
+	}
+
+	int nonblocking = pl->watch.dispatched;
+	pl->watch.dispatched = 0;
+
+	for (;;) {
+		int wstatus;
+		pid_t tid;
+
+		if (take_queued(pl, &tid, &wstatus)) {
+			// Waited for ahead of time.
+		} else if (nonblocking) {
+			return 0;
+		} else {
+			tid = wait_thread(pl, &wstatus);
+
+			if (tid == 0) {
+				return 0;
+			}
+
+			if (tid == -1) {
+				// If it failed due to an interrupt, we're not
+				// going to consider this an error. The threads
+				// keep running until the next call or the end
+				// of the session.
+				if (errno != EINTR) {
+					proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+				}
+
+				return 0;
+			}
+
+			// Blocking again would keep the caller from seeing
+			// a signal that comes in while this is dealt with.
+			nonblocking = 1;
+		}
+
+		int handled = handle_stop(pl, tid, wstatus, addr);
+
+		if (handled == 0 && pl->watch.started && is_gone(pl)) {
+			// The process was killed while the stop was being
+			// dealt with, which takes the thread out of it.
+			proctal_error_ack(&pl->p);
+			handled = forget_thread(pl, find_thread(pl, tid));
+		}
+
+		if (handled != -1) {
+			return handled;
+		}
+	}
+}
+
+int proctal_linux_watch_end(struct proctal_linux *pl)
+{
+	if (pl->watch.method == PROCTAL_WATCH_METHOD_PERF_EVENTS) {
+		return proctal_linux_perf_watch_end(pl);
+	}
+
+	if (!pl->watch.started) {
+		return 1;
+	}
+
+	pl->watch.started = 0;
+
+	return detach_threads(pl);
+}
+
+unsigned long long proctal_linux_watch_accesses(struct proctal_linux *pl)
+{
+	if (!pl->watch.started || pl->watch.method != PROCTAL_WATCH_METHOD_PERF_EVENTS) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNSUPPORTED);
+		return 0;
+	}
+
+	return proctal_linux_perf_watch_accesses(pl);
+}
+
+int proctal_linux_watch_fd(struct proctal_linux *pl)
+{
+	if (pl->watch.method == PROCTAL_WATCH_METHOD_PERF_EVENTS) {
+		return proctal_linux_perf_watch_fd(pl);
+	}
+
+	// Stops of traced threads are told by SIGCHLD instead.
+	return -1;
+}
+
+int proctal_linux_watch_ready(struct proctal_linux *pl)
+{
+	if (pl->watch.method == PROCTAL_WATCH_METHOD_PERF_EVENTS) {
+		return proctal_linux_perf_watch_ready(pl);
+	}
+
+	if (!pl->watch.started) {
+		proctal_set_error(&pl->p, PROCTAL_ERROR_UNKNOWN);
+		return -1;
+	}
+
+	if (pl->watch.queue_count) {
+		return 1;
+	}
+
+	for (size_t i = 0; i < pl->watch.thread_count; ++i) {
+		struct proctal_linux_watch_thread *thread = &pl->watch.threads[i];
+
+		if (thread->stopped && !resume_thread(pl, thread)) {
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+int proctal_linux_watch_queue(struct proctal_linux *pl, pid_t tid, int wstatus)
+{
+	struct proctal_linux_watch *w = &pl->watch;
+
+	if (w->queue_start + w->queue_count == w->queue_capacity) {
+		if (w->queue_start > 0) {
+			// What was taken already makes room at the front.
+			memmove(w->queue, w->queue + w->queue_start, w->queue_count * sizeof(*w->queue));
+			w->queue_start = 0;
+		} else {
+			size_t capacity = w->queue_capacity ? w->queue_capacity * 2 : 16;
+			struct proctal_linux_watch_status *queue = proctal_malloc(&pl->p, capacity * sizeof(*queue));
+
+			if (queue == NULL) {
+				return 0;
+			}
+
+			if (w->queue) {
+				memcpy(queue, w->queue, w->queue_count * sizeof(*queue));
+				proctal_free(&pl->p, w->queue);
+			}
+
+			w->queue = queue;
+			w->queue_capacity = capacity;
+		}
+	}
+
+	struct proctal_linux_watch_status *entry = &w->queue[w->queue_start + w->queue_count++];
+	entry->tid = tid;
+	entry->status = wstatus;
+
+	return 1;
+}
+
+pid_t proctal_linux_watch_peek(int block)
+{
+	siginfo_t info;
+	info.si_pid = 0;
+
+	// Stops of traced threads are reported without WSTOPPED.
+	if (waitid(P_ALL, 0, &info, WEXITED | WNOWAIT | __WALL | (block ? 0 : WNOHANG)) == -1) {
+		return -1;
+	}
+
+	return info.si_pid;
+}
+
+int proctal_linux_watch_has_thread(struct proctal_linux *pl, pid_t tid)
+{
+	if (find_thread(pl, tid) != NULL) {
+		return 1;
+	}
+
+	char task[32];
+	snprintf(task, sizeof(task), "task/%d", (int) tid);
+
+	return access(proctal_linux_proc_path(pl->pid, task), F_OK) == 0;
 }
@@ -4,6 +4,55 @@
 #include "lib/linux/proctal.h"
 #include "lib/linux/ptrace.h"
 
-int proctal_linux_watch(struct proctal_linux *pl, void **addr);
+int proctal_linux_watch_begin(struct proctal_linux *pl);
+
+int proctal_linux_watch_next(struct proctal_linux *pl, void **addr);
+
+int proctal_linux_watch_end(struct proctal_linux *pl);
+
+unsigned long long proctal_linux_watch_accesses(struct proctal_linux *pl);
+
+/*
+ * Returns a file descriptor that becomes readable when the session may have
+ * something for proctal_linux_watch_next, or -1 when stops of threads are
+ * told by SIGCHLD. Also returns -1 on failure, in which case the error is
+ * set.
+ */
+int proctal_linux_watch_fd(struct proctal_linux *pl);
+
+/*
+ * Checks without blocking whether the session has something for
+ * proctal_linux_watch_next. Threads that were kept stopped are let go first.
+ * Changes in the state of threads are not waited for here but given to
+ * proctal_linux_watch_queue by whoever waits for them.
+ *
+ * Returns 1 if so, 0 if not and -1 on failure.
+ */
+int proctal_linux_watch_ready(struct proctal_linux *pl);
+
+/*
+ * Hands over a change in the state of a thread of the session that was waited
+ * for ahead of time, to be dealt with by proctal_linux_watch_next.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int proctal_linux_watch_queue(struct proctal_linux *pl, pid_t tid, int wstatus);
+
+/*
+ * Finds a child of the calling thread whose change in state can be waited for,
+ * without waiting for it, so that children that are not watched are left for
+ * whoever started them. Blocks until there is one if block is not 0.
+ *
+ * Returns the ID of the child, 0 when there is none and -1 on failure, in
+ * which case errno tells why.
+ */
+pid_t proctal_linux_watch_peek(int block);
+
+/*
+ * Tells whether a thread belongs to the process of the session. The threads
+ * of the session are looked at first and then the threads the kernel lists,
+ * since a new thread may change state before the session knows about it.
+ */
+int proctal_linux_watch_has_thread(struct proctal_linux *pl, pid_t tid);
 
 #endif /* LIB_LINUX_WATCH_H */
@@ -0,0 +1,926 @@
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "lib/proctal.h"
+#include "hash/hash.h"
+#include "jobs/jobs.h"
+
+// Largest amount of memory a thread reads at once.
+#define CHUNK_SIZE (1024 * 1024)
+
+// Sorting fewer pointers than this is not worth starting threads for.
+#define SORT_THREAD_MIN 65536
+
+/*
+ * A pointer found in memory.
+ */
+struct pointer {
+	// Address it points to.
+	uintptr_t pointee;
+
+	// Address where it is stored.
+	uintptr_t location;
+};
+
+/*
+ * A memory region of the address space. Pointers are only indexed if they
+ * point to one.
+ */
+struct region {
+	uintptr_t start;
+	uintptr_t end;
+};
+
+/*
+ * A page of memory that was searched for pointers.
+ */
+struct page {
+	uintptr_t start;
+	size_t size;
+
+	// Hash of the contents of the page when it was last read.
+	uint64_t hash;
+
+	// Whether the contents had not changed since the previous time the
+	// page was read.
+	int unchanged;
+};
+
+struct proctal_pointer_index {
+	// Number of threads that go over memory and sort. 0 means one per
+	// processor.
+	int threads;
+
+	// Sorted by pointee.
+	struct pointer *pointers;
+	size_t count;
+
+	// Sorted by start address.
+	struct region *regions;
+	size_t region_count;
+
+	// Sorted by start address.
+	struct page *pages;
+	size_t page_count;
+};
+
+/*
+ * A chunk of memory to be read by a thread.
+ */
+struct job {
+	uintptr_t start;
+	uintptr_t end;
+
+	// Index of the first page of the chunk.
+	size_t page;
+};
+
+/*
+ * State shared by the threads that go over memory.
+ */
+struct scan {
+	proctal p;
+
+	struct proctal_pointer_index *index;
+
+	// Memory regions as they are now.
+	struct region *regions;
+	size_t region_count;
+
+	// Pages as they are now. Filled in by the threads.
+	struct page *pages;
+	size_t page_count;
+
+	// Whether pointers found in pages that did not change can be kept.
+	int reuse;
+
+	struct job *jobs;
+	size_t job_count;
+
+	struct jobs queue;
+};
+
+/*
+ * Options of the memory region iterator of the caller's instance, which are
+ * changed while going over memory and put back afterwards.
+ */
+struct region_options {
+	long mask;
+	int read;
+	int write;
+	int execute;
+};
+
+struct worker {
+	struct scan *scan;
+
+	// Pointers found by this thread.
+	struct pointer *pointers;
+	size_t count;
+	size_t capacity;
+
+	// Whether the thread failed.
+	int error;
+};
+
+struct sort_job {
+	pthread_t thread;
+
+	// Whether the job runs in its own thread.
+	int started;
+
+	struct pointer *src;
+	struct pointer *dst;
+
+	// Range of src this job takes care of.
+	size_t begin;
+	size_t end;
+
+	// Position of the digit.
+	int shift;
+
+	// Starts as the number of times each digit shows up and ends up being
+	// where the next pointer with that digit goes.
+	size_t counts[256];
+};
+
+/*
+ * Grows an array to hold at least the given number of items. There's no
+ * reallocation function that respects the allocator of the instance so this
+ * copies.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int grow(proctal p, void **items, size_t *capacity, size_t count, size_t item_size, size_t needed)
+{
+	if (needed <= *capacity) {
+		return 1;
+	}
+
+	size_t capacity_new = *capacity ? *capacity * 2 : 1024;
+
+	while (capacity_new < needed) {
+		capacity_new *= 2;
+	}
+
+	void *items_new = proctal_malloc(p, capacity_new * item_size);
+
+	if (items_new == NULL) {
+		return 0;
+	}
+
+	if (*items != NULL) {
+		memcpy(items_new, *items, count * item_size);
+		proctal_free(p, *items);
+	}
+
+	*items = items_new;
+	*capacity = capacity_new;
+
+	return 1;
+}
+
+/*
+ * Runs a function once per job, each in its own thread. Jobs whose thread
+ * could not be started run in the calling thread.
+ */
+static void run_sort_jobs(void *(*f)(void *), struct sort_job *jobs, int count)
+{
+	for (int i = 0; i < count; ++i) {
+		jobs[i].started = count > 1 && pthread_create(&jobs[i].thread, NULL, f, &jobs[i]) == 0;
+
+		if (!jobs[i].started) {
+			f(&jobs[i]);
+		}
+	}
+
+	for (int i = 0; i < count; ++i) {
+		if (jobs[i].started) {
+			pthread_join(jobs[i].thread, NULL);
+		}
+	}
+}
+
+static void *sort_count(void *data)
+{
+	struct sort_job *job = data;
+
+	memset(job->counts, 0, sizeof(job->counts));
+
+	for (size_t i = job->begin; i < job->end; ++i) {
+		job->counts[(job->src[i].pointee >> job->shift) & 0xFF] += 1;
+	}
+
+	return NULL;
+}
+
+static void *sort_scatter(void *data)
+{
+	struct sort_job *job = data;
+
+	for (size_t i = job->begin; i < job->end; ++i) {
+		size_t digit = (job->src[i].pointee >> job->shift) & 0xFF;
+
+		job->dst[job->counts[digit]++] = job->src[i];
+	}
+
+	return NULL;
+}
+
+/*
+ * Sorts pointers by pointee, one byte at a time starting from the least
+ * significant. Every pass splits the pointers among threads which first count
+ * how many times each byte value shows up in their part and then move their
+ * part to the place the counts of all threads add up to.
+ *
+ * Bytes that are the same in all pointees are skipped, which for addresses is
+ * usually the case for the most significant ones.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int radix_sort(proctal p, struct pointer *pointers, size_t count, int threads)
+{
+	if (count < 2) {
+		return 1;
+	}
+
+	if (count < SORT_THREAD_MIN) {
+		threads = 1;
+	}
+
+	struct pointer *tmp = proctal_malloc(p, count * sizeof(*tmp));
+
+	if (tmp == NULL) {
+		return 0;
+	}
+
+	struct sort_job *jobs = proctal_malloc(p, threads * sizeof(*jobs));
+
+	if (jobs == NULL) {
+		proctal_free(p, tmp);
+		return 0;
+	}
+
+	uintptr_t all_or = 0;
+	uintptr_t all_and = ~(uintptr_t) 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		all_or |= pointers[i].pointee;
+		all_and &= pointers[i].pointee;
+	}
+
+	uintptr_t varying = all_or ^ all_and;
+
+	struct pointer *src = pointers;
+	struct pointer *dst = tmp;
+
+	for (int shift = 0; shift < (int) sizeof(uintptr_t) * 8; shift += 8) {
+		if (((varying >> shift) & 0xFF) == 0) {
+			continue;
+		}
+
+		for (int i = 0; i < threads; ++i) {
+			jobs[i].src = src;
+			jobs[i].dst = dst;
+			jobs[i].begin = count / threads * i;
+			jobs[i].end = i == threads - 1 ? count : count / threads * (i + 1);
+			jobs[i].shift = shift;
+		}
+
+		run_sort_jobs(sort_count, jobs, threads);
+
+		size_t offset = 0;
+
+		for (int digit = 0; digit < 256; ++digit) {
+			for (int i = 0; i < threads; ++i) {
+				size_t c = jobs[i].counts[digit];
+				jobs[i].counts[digit] = offset;
+				offset += c;
+			}
+		}
+
+		run_sort_jobs(sort_scatter, jobs, threads);
+
+		struct pointer *swap = src;
+		src = dst;
+		dst = swap;
+	}
+
+	if (src != pointers) {
+		memcpy(pointers, src, count * sizeof(*pointers));
+	}
+
+	proctal_free(p, jobs);
+	proctal_free(p, tmp);
+
+	return 1;
+}
+
+static struct region *find_region(struct region *regions, size_t count, uintptr_t addr)
+{
+	size_t lo = 0;
+	size_t hi = count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (addr < regions[mid].start) {
+			hi = mid;
+		} else if (addr >= regions[mid].end) {
+			lo = mid + 1;
+		} else {
+			return &regions[mid];
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Returns the page that contains the address or NULL if none does.
+ */
+static struct page *find_page(struct page *pages, size_t count, uintptr_t addr)
+{
+	size_t lo = 0;
+	size_t hi = count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (addr < pages[mid].start) {
+			hi = mid;
+		} else if (addr >= pages[mid].start + pages[mid].size) {
+			lo = mid + 1;
+		} else {
+			return &pages[mid];
+		}
+	}
+
+	return NULL;
+}
+
+static void save_region_options(proctal p, struct region_options *o)
+{
+	o->mask = proctal_region_mask(p);
+	o->read = proctal_region_read(p);
+	o->write = proctal_region_write(p);
+	o->execute = proctal_region_execute(p);
+}
+
+static void restore_region_options(proctal p, struct region_options *o)
+{
+	proctal_region_new(p);
+
+	proctal_region_set_mask(p, o->mask);
+	proctal_region_set_read(p, o->read);
+	proctal_region_set_write(p, o->write);
+	proctal_region_set_execute(p, o->execute);
+}
+
+/*
+ * Reads the table of every memory region.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int read_regions(struct scan *s)
+{
+	proctal p = s->p;
+	size_t capacity = 0;
+
+	proctal_region_set_mask(p, 0);
+	proctal_region_set_read(p, 0);
+	proctal_region_set_write(p, 0);
+	proctal_region_set_execute(p, 0);
+
+	proctal_region_new(p);
+
+	void *start, *end;
+
+	while (proctal_region(p, &start, &end)) {
+		if (!grow(p, (void **) &s->regions, &capacity, s->region_count, sizeof(*s->regions), s->region_count + 1)) {
+			proctal_region_new(p);
+			return 0;
+		}
+
+		struct region *r = &s->regions[s->region_count++];
+		r->start = (uintptr_t) start;
+		r->end = (uintptr_t) end;
+	}
+
+	return !proctal_error(p);
+}
+
+static int same_regions(struct proctal_pointer_index *index, struct scan *s)
+{
+	return index->regions != NULL
+		&& index->region_count == s->region_count
+		&& memcmp(index->regions, s->regions, s->region_count * sizeof(*s->regions)) == 0;
+}
+
+/*
+ * Splits writable memory in chunks for the threads to read and in pages to
+ * keep track of changes.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int plan_jobs(struct scan *s)
+{
+	proctal p = s->p;
+	size_t page_size = sysconf(_SC_PAGESIZE);
+	size_t job_capacity = 0;
+	size_t page_capacity = 0;
+
+	// Pointers that change at run time can only be stored in writable
+	// memory.
+	proctal_region_set_mask(p, 0);
+	proctal_region_set_read(p, 1);
+	proctal_region_set_write(p, 1);
+	proctal_region_set_execute(p, 0);
+
+	proctal_region_new(p);
+
+	void *start, *end;
+
+	while (proctal_region(p, &start, &end)) {
+		for (uintptr_t chunk = (uintptr_t) start; chunk < (uintptr_t) end; chunk += CHUNK_SIZE) {
+			uintptr_t chunk_end = (uintptr_t) end - chunk > CHUNK_SIZE
+				? chunk + CHUNK_SIZE
+				: (uintptr_t) end;
+
+			if (!grow(p, (void **) &s->jobs, &job_capacity, s->job_count, sizeof(*s->jobs), s->job_count + 1)) {
+				proctal_region_new(p);
+				return 0;
+			}
+
+			struct job *job = &s->jobs[s->job_count++];
+			job->start = chunk;
+			job->end = chunk_end;
+			job->page = s->page_count;
+
+			for (uintptr_t page = chunk; page < chunk_end; page += page_size) {
+				if (!grow(p, (void **) &s->pages, &page_capacity, s->page_count, sizeof(*s->pages), s->page_count + 1)) {
+					proctal_region_new(p);
+					return 0;
+				}
+
+				struct page *pg = &s->pages[s->page_count++];
+				pg->start = page;
+				pg->size = chunk_end - page > page_size ? page_size : chunk_end - page;
+				pg->hash = 0;
+				pg->unchanged = 0;
+			}
+		}
+	}
+
+	return !proctal_error(p);
+}
+
+/*
+ * Collects the pointers of a page.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int collect(proctal p, struct worker *w, const char *data, struct page *pg)
+{
+	struct scan *s = w->scan;
+	uintptr_t lowest = s->regions[0].start;
+	uintptr_t highest = s->regions[s->region_count - 1].end;
+
+	for (size_t i = 0; i + sizeof(uintptr_t) <= pg->size; i += sizeof(uintptr_t)) {
+		uintptr_t pointee;
+		memcpy(&pointee, data + i, sizeof(pointee));
+
+		// Most values can be ruled out without a lookup.
+		if (pointee < lowest || pointee >= highest) {
+			continue;
+		}
+
+		if (find_region(s->regions, s->region_count, pointee) == NULL) {
+			continue;
+		}
+
+		if (!grow(p, (void **) &w->pointers, &w->capacity, w->count, sizeof(*w->pointers), w->count + 1)) {
+			return 0;
+		}
+
+		struct pointer *ptr = &w->pointers[w->count++];
+		ptr->pointee = pointee;
+		ptr->location = pg->start + i;
+	}
+
+	return 1;
+}
+
+/*
+ * Reads chunks of memory and hashes their pages. Pointers are only collected
+ * from pages that changed. Each thread has its own instance because an
+ * instance cannot be shared.
+ */
+static void *worker_run(void *data)
+{
+	struct worker *w = data;
+	struct scan *s = w->scan;
+	struct proctal_pointer_index *index = s->index;
+
+	proctal p = proctal_create();
+
+	if (proctal_error(p)) {
+		proctal_destroy(p);
+		w->error = 1;
+		return NULL;
+	}
+
+	proctal_set_malloc(p, s->p->malloc);
+	proctal_set_free(p, s->p->free);
+	proctal_set_pid(p, proctal_pid(s->p));
+
+	char *buffer = proctal_malloc(p, CHUNK_SIZE);
+
+	if (buffer == NULL) {
+		proctal_destroy(p);
+		w->error = 1;
+		return NULL;
+	}
+
+	size_t next;
+
+	while (!w->error && jobs_take(&s->queue, &next)) {
+		struct job *job = &s->jobs[next];
+
+		proctal_read(p, (void *) job->start, buffer, job->end - job->start);
+
+		if (proctal_error(p)) {
+			// Memory can go away while we're looking. Its pages
+			// will be looked at again on the next refresh.
+			proctal_error_ack(p);
+			continue;
+		}
+
+		for (size_t i = job->page; i < s->page_count && s->pages[i].start < job->end; ++i) {
+			struct page *pg = &s->pages[i];
+			const char *page_data = buffer + (pg->start - job->start);
+
+			pg->hash = hash64(page_data, pg->size, 0);
+
+			if (s->reuse) {
+				struct page *old = find_page(index->pages, index->page_count, pg->start);
+
+				pg->unchanged = old != NULL
+					&& old->start == pg->start
+					&& old->size == pg->size
+					&& old->hash == pg->hash;
+			}
+
+			if (!pg->unchanged && !collect(p, w, page_data, pg)) {
+				w->error = 1;
+				break;
+			}
+		}
+	}
+
+	proctal_free(p, buffer);
+	proctal_destroy(p);
+
+	return NULL;
+}
+
+/*
+ * Goes over memory with multiple threads.
+ *
+ * Returns the pointers found in pages that changed, unsorted, or NULL on
+ * failure.
+ */
+static struct pointer *run_workers(struct scan *s, int threads, size_t *count)
+{
+	proctal p = s->p;
+
+	struct worker *workers = proctal_malloc(p, threads * sizeof(*workers));
+
+	if (workers == NULL) {
+		return NULL;
+	}
+
+	pthread_t *handles = proctal_malloc(p, threads * sizeof(*handles));
+
+	if (handles == NULL) {
+		proctal_free(p, workers);
+		return NULL;
+	}
+
+	for (int i = 0; i < threads; ++i) {
+		struct worker *w = &workers[i];
+		w->scan = s;
+		w->pointers = NULL;
+		w->count = 0;
+		w->capacity = 0;
+		w->error = 0;
+	}
+
+	int started = jobs_start(handles, threads, worker_run, workers, sizeof(*workers));
+
+	jobs_join(handles, started);
+
+	proctal_free(p, handles);
+
+	int error = started == 0;
+	size_t total = 0;
+
+	for (int i = 0; i < started; ++i) {
+		error |= workers[i].error;
+		total += workers[i].count;
+	}
+
+	struct pointer *pointers = NULL;
+
+	if (!error) {
+		pointers = proctal_malloc(p, (total ? total : 1) * sizeof(*pointers));
+	}
+
+	*count = 0;
+
+	for (int i = 0; i < started; ++i) {
+		if (pointers != NULL) {
+			memcpy(pointers + *count, workers[i].pointers, workers[i].count * sizeof(*pointers));
+			*count += workers[i].count;
+		}
+
+		if (workers[i].pointers) {
+			proctal_free(p, workers[i].pointers);
+		}
+	}
+
+	proctal_free(p, workers);
+
+	if (error && !proctal_error(p)) {
+		proctal_set_error(p, PROCTAL_ERROR_OUT_OF_MEMORY);
+	}
+
+	return pointers;
+}
+
+/*
+ * Tells whether a pointer of the index can be kept as is.
+ */
+static inline int keep(struct scan *s, struct pointer *ptr)
+{
+	if (!s->reuse) {
+		return 0;
+	}
+
+	struct page *pg = find_page(s->pages, s->page_count, ptr->location);
+
+	return pg != NULL && pg->unchanged;
+}
+
+/*
+ * Finds the pointers of the pages that changed and merges them with the ones
+ * that can be kept.
+ *
+ * Returns the new list of pointers or NULL on failure.
+ */
+static struct pointer *merge_changes(struct scan *s, size_t *count)
+{
+	proctal p = s->p;
+	struct proctal_pointer_index *index = s->index;
+	int threads = jobs_threads(index->threads);
+	size_t fresh_count;
+
+	jobs_init(&s->queue, s->job_count);
+
+	struct pointer *fresh = run_workers(s, threads, &fresh_count);
+
+	jobs_deinit(&s->queue);
+
+	if (fresh == NULL) {
+		return NULL;
+	}
+
+	if (!radix_sort(p, fresh, fresh_count, threads)) {
+		proctal_free(p, fresh);
+		return NULL;
+	}
+
+	size_t kept_count = 0;
+
+	for (size_t i = 0; i < index->count; ++i) {
+		kept_count += keep(s, &index->pointers[i]);
+	}
+
+	size_t total = kept_count + fresh_count;
+	struct pointer *merged = proctal_malloc(p, (total ? total : 1) * sizeof(*merged));
+
+	if (merged == NULL) {
+		proctal_free(p, fresh);
+		return NULL;
+	}
+
+	// Both the pointers that are kept and the fresh ones are sorted so they
+	// can be merged in one go.
+	size_t i = 0, j = 0, k = 0;
+
+	while (i < index->count || j < fresh_count) {
+		if (i < index->count && !keep(s, &index->pointers[i])) {
+			i += 1;
+			continue;
+		}
+
+		if (j == fresh_count
+			|| (i < index->count && index->pointers[i].pointee <= fresh[j].pointee)) {
+			merged[k++] = index->pointers[i++];
+		} else {
+			merged[k++] = fresh[j++];
+		}
+	}
+
+	proctal_free(p, fresh);
+
+	*count = k;
+
+	return merged;
+}
+
+/*
+ * Brings the index up to date. A full update throws away everything that was
+ * known.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int update(proctal p, struct proctal_pointer_index *index, int full)
+{
+	struct scan s;
+	s.p = p;
+	s.index = index;
+	s.regions = NULL;
+	s.region_count = 0;
+	s.pages = NULL;
+	s.page_count = 0;
+	s.reuse = 0;
+	s.jobs = NULL;
+	s.job_count = 0;
+
+	struct pointer *pointers = NULL;
+	size_t count = 0;
+
+	struct region_options options;
+	save_region_options(p, &options);
+
+	int ok = read_regions(&s);
+
+	if (ok) {
+		// Pages that did not change may hold pointers to memory that
+		// appeared or went away in the meantime, so they can only be
+		// trusted if the regions are the same.
+		s.reuse = !full && same_regions(index, &s);
+
+		ok = plan_jobs(&s);
+	}
+
+	if (ok && s.region_count > 0) {
+		pointers = merge_changes(&s, &count);
+		ok = pointers != NULL;
+	}
+
+	restore_region_options(p, &options);
+
+	if (s.jobs) {
+		proctal_free(p, s.jobs);
+	}
+
+	if (!ok) {
+		if (s.regions) {
+			proctal_free(p, s.regions);
+		}
+
+		if (s.pages) {
+			proctal_free(p, s.pages);
+		}
+
+		return 0;
+	}
+
+	if (index->pointers) {
+		proctal_free(p, index->pointers);
+	}
+
+	if (index->regions) {
+		proctal_free(p, index->regions);
+	}
+
+	if (index->pages) {
+		proctal_free(p, index->pages);
+	}
+
+	index->pointers = pointers;
+	index->count = count;
+	index->regions = s.regions;
+	index->region_count = s.region_count;
+	index->pages = s.pages;
+	index->page_count = s.page_count;
+
+	return 1;
+}
+
+proctal_pointer_index proctal_pointer_index_create(proctal p)
+{
+	struct proctal_pointer_index *index = proctal_malloc(p, sizeof(*index));
+
+	if (index == NULL) {
+		return NULL;
+	}
+
+	index->threads = 0;
+	index->pointers = NULL;
+	index->count = 0;
+	index->regions = NULL;
+	index->region_count = 0;
+	index->pages = NULL;
+	index->page_count = 0;
+
+	return index;
+}
+
+void proctal_pointer_index_destroy(proctal p, proctal_pointer_index index)
+{
+	if (index == NULL) {
+		return;
+	}
+
+	if (index->pointers) {
+		proctal_free(p, index->pointers);
+	}
+
+	if (index->regions) {
+		proctal_free(p, index->regions);
+	}
+
+	if (index->pages) {
+		proctal_free(p, index->pages);
+	}
+
+	proctal_free(p, index);
+}
+
+int proctal_pointer_index_threads(proctal_pointer_index index)
+{
+	return index->threads;
+}
+
+void proctal_pointer_index_set_threads(proctal_pointer_index index, int threads)
+{
+	index->threads = threads > 0 ? threads : 0;
+}
+
+int proctal_pointer_index_build(proctal p, proctal_pointer_index index)
+{
+	return update(p, index, 1);
+}
+
+int proctal_pointer_index_refresh(proctal p, proctal_pointer_index index)
+{
+	return update(p, index, 0);
+}
+
+size_t proctal_pointer_index_size(proctal_pointer_index index)
+{
+	return index->count;
+}
+
+/*
+ * Returns the position of the first pointer that points to an address greater
+ * than or equal to the given one.
+ */
+static size_t lower_bound(struct proctal_pointer_index *index, uintptr_t pointee)
+{
+	size_t lo = 0;
+	size_t hi = index->count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (index->pointers[mid].pointee < pointee) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+size_t proctal_pointer_index_find(proctal_pointer_index index, void *start, void *end, size_t *first)
+{
+	size_t lo = lower_bound(index, (uintptr_t) start);
+	size_t hi = lower_bound(index, (uintptr_t) end);
+
+	*first = lo;
+
+	return hi > lo ? hi - lo : 0;
+}
+
+void proctal_pointer_index_get(proctal_pointer_index index, size_t i, void **pointee, void **location)
+{
+	*pointee = (void *) index->pointers[i].pointee;
+	*location = (void *) index->pointers[i].location;
+}
@@ -81,18 +81,51 @@ struct proctal {
 	 * Watch specific options.
 	 */
 	struct {
-		// Address to watch.
-		void *addr;
+		struct proctal_watch_point {
+			// Address to watch.
+			void *addr;
 
-		// Whether to watch for reads.
-		int read;
+			// Number of bytes to watch.
+			size_t size;
 
-		// Whether to watch for writes.
-		int write;
+			// Whether to watch for reads.
+			int read;
 
-		// Whether to watch for instruction execution.
-		int execute;
+			// Whether to watch for writes.
+			int write;
+
+			// Whether to watch for instruction execution.
+			int execute;
+		} points[PROCTAL_WATCH_MAX];
+
+		// How accesses are detected.
+		int method;
+
+		// One out of how many accesses are sampled when watching
+		// with perf events.
+		unsigned long long sample_period;
+
+		// Number of watchpoints in use.
+		size_t count;
+
+		// Watchpoint that options are set on.
+		size_t selected;
+
+		// Watchpoint that was hit last, or -1 if it's not known.
+		int hit;
+
+		// Thread that hit it.
+		int thread;
 	} watch;
+
+	/*
+	 * Sampling specific options.
+	 */
+	struct {
+		// Largest number of addresses found for a thread, counting
+		// the instruction it is at.
+		size_t depth;
+	} sample;
 };
 
 /*
@@ -53,3 +53,8 @@ int proctal_region(proctal p, void **start, void **end)
 {
 	return proctal_impl_region(p, start, end);
 }
+
+const char *proctal_region_path(proctal p)
+{
+	return proctal_impl_region_path(p);
+}
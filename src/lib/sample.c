@@ -0,0 +1,40 @@
+#include "lib/proctal.h"
+
+int proctal_sample(proctal p)
+{
+	return proctal_impl_sample(p);
+}
+
+size_t proctal_sample_thread_count(proctal p)
+{
+	return proctal_impl_sample_thread_count(p);
+}
+
+int proctal_sample_thread(proctal p, size_t thread)
+{
+	return proctal_impl_sample_thread(p, thread);
+}
+
+size_t proctal_sample_frame_count(proctal p, size_t thread)
+{
+	return proctal_impl_sample_frame_count(p, thread);
+}
+
+void *proctal_sample_frame(proctal p, size_t thread, size_t frame)
+{
+	return proctal_impl_sample_frame(p, thread, frame);
+}
+
+size_t proctal_sample_depth(proctal p)
+{
+	return p->sample.depth;
+}
+
+void proctal_sample_set_depth(proctal p, size_t depth)
+{
+	if (depth < 1) {
+		depth = 1;
+	}
+
+	p->sample.depth = depth;
+}
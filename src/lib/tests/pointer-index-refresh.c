@@ -0,0 +1,165 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "lib/include/proctal.h"
+
+#define PAGE_SIZE 4096
+
+// Words in a page.
+#define WORDS (PAGE_SIZE / sizeof(uintptr_t))
+
+static int find(proctal_pointer_index index, uintptr_t pointee, uintptr_t location)
+{
+	size_t first;
+	size_t count = proctal_pointer_index_find(index, (void *) pointee, (void *) (pointee + 1), &first);
+
+	for (size_t i = first; i < first + count; ++i) {
+		void *found_pointee, *found_location;
+		proctal_pointer_index_get(index, i, &found_pointee, &found_location);
+
+		if ((uintptr_t) found_location == location) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int change(proctal p, uintptr_t *location, uintptr_t value)
+{
+	proctal_write(p, location, (char *) &value, sizeof(value));
+
+	if (proctal_error(p)) {
+		fprintf(stderr, "Failed to write to memory.\n");
+		return 0;
+	}
+
+	return 1;
+}
+
+static int run(proctal p, proctal_pointer_index index, uintptr_t *pages, char *target)
+{
+	uintptr_t a = (uintptr_t) target;
+	uintptr_t b = (uintptr_t) (target + 8);
+	uintptr_t c = (uintptr_t) (target + 16);
+
+	if (!proctal_pointer_index_build(p, index)) {
+		fprintf(stderr, "Failed to build the index.\n");
+		return 0;
+	}
+
+	if (!find(index, a, (uintptr_t) &pages[0])
+		|| !find(index, b, (uintptr_t) &pages[2 * WORDS])) {
+		fprintf(stderr, "Build did not find the pointers.\n");
+		return 0;
+	}
+
+	// Adds a pointer to a page that had none and takes one out of another.
+	if (!change(p, &pages[WORDS], c) || !change(p, &pages[2 * WORDS], 0)) {
+		return 0;
+	}
+
+	proctal_region_new(p);
+	proctal_region_set_mask(p, PROCTAL_REGION_STACK);
+	proctal_region_set_read(p, 0);
+	proctal_region_set_execute(p, 1);
+
+	if (!proctal_pointer_index_refresh(p, index)) {
+		fprintf(stderr, "Failed to refresh the index.\n");
+		return 0;
+	}
+
+	if (proctal_region_mask(p) != PROCTAL_REGION_STACK
+		|| !proctal_region_execute(p)
+		|| proctal_region_read(p)
+		|| proctal_region_write(p)) {
+		fprintf(stderr, "Options of the memory region iterator were not kept.\n");
+		return 0;
+	}
+
+	if (!find(index, a, (uintptr_t) &pages[0])) {
+		fprintf(stderr, "Pointer of the page that did not change is gone.\n");
+		return 0;
+	}
+
+	if (!find(index, c, (uintptr_t) &pages[WORDS])) {
+		fprintf(stderr, "Pointer that was added is missing.\n");
+		return 0;
+	}
+
+	if (find(index, b, (uintptr_t) &pages[2 * WORDS])) {
+		fprintf(stderr, "Pointer that was taken out is still there.\n");
+		return 0;
+	}
+
+	return 1;
+}
+
+int main(void)
+{
+	char *target = malloc(PAGE_SIZE);
+	uintptr_t *pages = aligned_alloc(PAGE_SIZE, 3 * PAGE_SIZE);
+
+	if (target == NULL || pages == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		return 1;
+	}
+
+	for (size_t i = 0; i < 3 * WORDS; ++i) {
+		pages[i] = 0;
+	}
+
+	pages[0] = (uintptr_t) target;
+	pages[2 * WORDS] = (uintptr_t) (target + 8);
+
+	pid_t pid = fork();
+
+	if (pid == -1) {
+		fprintf(stderr, "Failed to fork.\n");
+		return 1;
+	}
+
+	if (pid == 0) {
+		for (;;) {
+			pause();
+		}
+	}
+
+	proctal p = proctal_create();
+
+	if (proctal_error(p)) {
+		fprintf(stderr, "Failed to create a Proctal instance.\n");
+		proctal_destroy(p);
+		kill(pid, SIGKILL);
+		waitpid(pid, NULL, 0);
+		return 1;
+	}
+
+	proctal_set_pid(p, pid);
+
+	proctal_pointer_index index = proctal_pointer_index_create(p);
+
+	int ret = 0;
+
+	if (index == NULL) {
+		fprintf(stderr, "Failed to create the index.\n");
+		ret = 1;
+	} else if (!run(p, index, pages, target)) {
+		ret = 1;
+	}
+
+	proctal_pointer_index_destroy(p, index);
+	proctal_destroy(p);
+
+	kill(pid, SIGKILL);
+	waitpid(pid, NULL, 0);
+
+	free(pages);
+	free(target);
+
+	return ret;
+}
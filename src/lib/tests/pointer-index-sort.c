@@ -0,0 +1,140 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "lib/include/proctal.h"
+
+// Enough pointers for the sort to be split among threads.
+#define COUNT 200000
+
+#define TARGET_SIZE (1024 * 1024)
+
+static int find(proctal_pointer_index index, uintptr_t pointee, uintptr_t location)
+{
+	size_t first;
+	size_t count = proctal_pointer_index_find(index, (void *) pointee, (void *) (pointee + 1), &first);
+
+	for (size_t i = first; i < first + count; ++i) {
+		void *found_pointee, *found_location;
+		proctal_pointer_index_get(index, i, &found_pointee, &found_location);
+
+		if ((uintptr_t) found_location == location) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int check(proctal p, proctal_pointer_index index, uintptr_t *table)
+{
+	if (!proctal_pointer_index_build(p, index)) {
+		fprintf(stderr, "Failed to build the index.\n");
+		return 0;
+	}
+
+	size_t size = proctal_pointer_index_size(index);
+
+	if (size < COUNT) {
+		fprintf(stderr, "Expected at least %d pointers, got %zu.\n", COUNT, size);
+		return 0;
+	}
+
+	void *previous = NULL;
+
+	for (size_t i = 0; i < size; ++i) {
+		void *pointee, *location;
+		proctal_pointer_index_get(index, i, &pointee, &location);
+
+		if (pointee < previous) {
+			fprintf(stderr, "Pointer %zu is out of order.\n", i);
+			return 0;
+		}
+
+		previous = pointee;
+	}
+
+	for (size_t i = 0; i < COUNT; ++i) {
+		if (!find(index, table[i], (uintptr_t) &table[i])) {
+			fprintf(stderr, "Pointer %zu is missing.\n", i);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+int main(void)
+{
+	char *target = malloc(TARGET_SIZE);
+	uintptr_t *table = malloc(COUNT * sizeof(*table));
+
+	if (target == NULL || table == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		return 1;
+	}
+
+	// Spreads the pointees so that several bytes of them vary.
+	for (size_t i = 0; i < COUNT; ++i) {
+		table[i] = (uintptr_t) (target + (i * 7919 % TARGET_SIZE & ~(size_t) 7));
+	}
+
+	pid_t pid = fork();
+
+	if (pid == -1) {
+		fprintf(stderr, "Failed to fork.\n");
+		return 1;
+	}
+
+	if (pid == 0) {
+		for (;;) {
+			pause();
+		}
+	}
+
+	proctal p = proctal_create();
+
+	if (proctal_error(p)) {
+		fprintf(stderr, "Failed to create a Proctal instance.\n");
+		proctal_destroy(p);
+		kill(pid, SIGKILL);
+		waitpid(pid, NULL, 0);
+		return 1;
+	}
+
+	proctal_set_pid(p, pid);
+
+	proctal_pointer_index index = proctal_pointer_index_create(p);
+
+	int ret = 0;
+
+	if (index == NULL) {
+		fprintf(stderr, "Failed to create the index.\n");
+		ret = 1;
+	}
+
+	int threads[] = { 1, 4 };
+
+	for (size_t i = 0; ret == 0 && i < sizeof(threads) / sizeof(threads[0]); ++i) {
+		proctal_pointer_index_set_threads(index, threads[i]);
+
+		if (!check(p, index, table)) {
+			fprintf(stderr, "Failed with %d threads.\n", threads[i]);
+			ret = 1;
+		}
+	}
+
+	proctal_pointer_index_destroy(p, index);
+	proctal_destroy(p);
+
+	kill(pid, SIGKILL);
+	waitpid(pid, NULL, 0);
+
+	free(table);
+	free(target);
+
+	return ret;
+}
@@ -1,46 +1,177 @@
 #include "lib/proctal.h"
 
+static inline struct proctal_watch_point *selected(proctal p)
+{
+	return &p->watch.points[p->watch.selected];
+}
+
+size_t proctal_watch_count(proctal p)
+{
+	return p->watch.count;
+}
+
+void proctal_watch_set_count(proctal p, size_t count)
+{
+	if (count < 1) {
+		count = 1;
+	} else if (count > PROCTAL_WATCH_MAX) {
+		count = PROCTAL_WATCH_MAX;
+	}
+
+	p->watch.count = count;
+}
+
+int proctal_watch_method(proctal p)
+{
+	return p->watch.method;
+}
+
+void proctal_watch_set_method(proctal p, int method)
+{
+	p->watch.method = method;
+}
+
+unsigned long long proctal_watch_sample_period(proctal p)
+{
+	return p->watch.sample_period;
+}
+
+void proctal_watch_set_sample_period(proctal p, unsigned long long period)
+{
+	p->watch.sample_period = period;
+}
+
+size_t proctal_watch_selected(proctal p)
+{
+	return p->watch.selected;
+}
+
+void proctal_watch_select(proctal p, size_t index)
+{
+	if (index >= PROCTAL_WATCH_MAX) {
+		index = PROCTAL_WATCH_MAX - 1;
+	}
+
+	p->watch.selected = index;
+}
+
 void *proctal_watch_address(proctal p)
 {
-	return p->watch.addr;
+	return selected(p)->addr;
 }
 
 void proctal_watch_set_address(proctal p, void *addr)
 {
-	p->watch.addr = addr;
+	selected(p)->addr = addr;
+}
+
+size_t proctal_watch_size(proctal p)
+{
+	return selected(p)->size;
+}
+
+void proctal_watch_set_size(proctal p, size_t size)
+{
+	selected(p)->size = size;
 }
 
 int proctal_watch_read(proctal p)
 {
-	return p->watch.read;
+	return selected(p)->read;
 }
 
 void proctal_watch_set_read(proctal p, int r)
 {
-	p->watch.read = r != 0;
+	selected(p)->read = r != 0;
 }
 
 int proctal_watch_write(proctal p)
 {
-	return p->watch.write;
+	return selected(p)->write;
 }
 
 void proctal_watch_set_write(proctal p, int w)
 {
-	p->watch.write = w != 0;
+	selected(p)->write = w != 0;
 }
 
 int proctal_watch_execute(proctal p)
 {
-	return p->watch.execute;
+	return selected(p)->execute;
 }
 
 void proctal_watch_set_execute(proctal p, int x)
 {
-	p->watch.execute = x != 0;
+	selected(p)->execute = x != 0;
+}
+
+int proctal_watch_hit(proctal p)
+{
+	return p->watch.hit;
+}
+
+int proctal_watch_thread(proctal p)
+{
+	return p->watch.thread;
+}
+
+int proctal_watch_begin(proctal p)
+{
+	return proctal_impl_watch_begin(p);
+}
+
+int proctal_watch_next(proctal p, void **addr)
+{
+	return proctal_impl_watch_next(p, addr);
+}
+
+int proctal_watch_end(proctal p)
+{
+	return proctal_impl_watch_end(p);
+}
+
+unsigned long long proctal_watch_accesses(proctal p)
+{
+	return proctal_impl_watch_accesses(p);
+}
+
+int proctal_watch_poll(proctal *instances, size_t count, size_t *ready)
+{
+	return proctal_impl_watch_poll(instances, count, ready);
+}
+
+proctal_watch_poller proctal_watch_poller_create(proctal p)
+{
+	return proctal_impl_watch_poller_create(p);
+}
+
+void proctal_watch_poller_destroy(proctal p, proctal_watch_poller poller)
+{
+	proctal_impl_watch_poller_destroy(p, poller);
+}
+
+int proctal_watch_poller_wait(proctal_watch_poller poller, proctal *instances, size_t count, size_t *ready)
+{
+	return proctal_impl_watch_poller_wait(poller, instances, count, ready);
 }
 
 int proctal_watch(proctal p, void **addr)
 {
-	return proctal_impl_watch(p, addr);
+	if (!proctal_watch_begin(p)) {
+		return 0;
+	}
+
+	int ret;
+
+	// Stops that are not accesses are let go until one is.
+	do {
+		ret = proctal_watch_next(p, addr);
+	} while (ret == 0 && !proctal_error(p));
+
+	// The session may already be over if the process went away.
+	if (!proctal_watch_end(p)) {
+		return 0;
+	}
+
+	return ret;
 }
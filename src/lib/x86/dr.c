@@ -14,6 +14,26 @@ static inline int is_address_register(int r)
 	}
 }
 
+static inline int get_b_offset(int r)
+{
+	switch (r) {
+	case PROCTAL_X86_DR_0:
+		return 0;
+
+	case PROCTAL_X86_DR_1:
+		return 1;
+
+	case PROCTAL_X86_DR_2:
+		return 2;
+
+	case PROCTAL_X86_DR_3:
+		return 3;
+
+	default:
+		return -1;
+	}
+}
+
 static inline int get_rw_offset(int r)
 {
 	switch (r) {
@@ -160,3 +180,16 @@ int proctal_x86_dr_is_l_enabled(unsigned long long dr7, int r)
 
 	return (dr7 & mask) >> offset;
 }
+
+int proctal_x86_dr_is_hit(unsigned long long dr6, int r)
+{
+	int offset = get_b_offset(r);
+
+	if (offset == -1) {
+		return 0;
+	}
+
+	unsigned int mask = 1u << offset;
+
+	return (dr6 & mask) >> offset;
+}
@@ -98,4 +98,11 @@ void proctal_x86_dr_enable_l(unsigned long long *dr7, int r, int enable);
  */
 int proctal_x86_dr_is_l_enabled(unsigned long long dr7, int r);
 
+/*
+ * Checks in DR6 whether a breakpoint was hit.
+ *
+ * If the return value is 0 it was not hit, if 1 it was.
+ */
+int proctal_x86_dr_is_hit(unsigned long long dr6, int r);
+
 #endif /* LIB_X86_DR_H */
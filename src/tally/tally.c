@@ -0,0 +1,205 @@
+#include <string.h>
+
+#include "tally/tally.h"
+#include "hash/hash.h"
+
+void tally_init(struct tally *t, size_t value_size)
+{
+	t->value_size = value_size;
+	t->slots = NULL;
+	t->mask = 0;
+	t->entries = NULL;
+	t->count = 0;
+	t->capacity = 0;
+	t->values = NULL;
+	t->keys = NULL;
+	t->keys_size = 0;
+	t->keys_capacity = 0;
+}
+
+void tally_deinit(struct tally *t)
+{
+	free(t->slots);
+	free(t->entries);
+	free(t->values);
+	free(t->keys);
+}
+
+/*
+ * Doubles the size of the hash table.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int grow_slots(struct tally *t)
+{
+	size_t size = t->slots ? (t->mask + 1) * 2 : 1024;
+	size_t *slots = calloc(size, sizeof(*slots));
+
+	if (slots == NULL) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < t->count; ++i) {
+		size_t slot = t->entries[i].hash & (size - 1);
+
+		while (slots[slot] != 0) {
+			slot = (slot + 1) & (size - 1);
+		}
+
+		slots[slot] = i + 1;
+	}
+
+	free(t->slots);
+
+	t->slots = slots;
+	t->mask = size - 1;
+
+	return 1;
+}
+
+/*
+ * Makes room for one more entry and the bytes of its key.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int reserve(struct tally *t, size_t key_size)
+{
+	if (t->count == t->capacity) {
+		size_t capacity = t->capacity ? t->capacity * 2 : 1024;
+
+		struct tally_entry *entries = realloc(t->entries, capacity * sizeof(*entries));
+
+		if (entries == NULL) {
+			return 0;
+		}
+
+		t->entries = entries;
+
+		if (t->value_size) {
+			char *values = realloc(t->values, capacity * t->value_size);
+
+			if (values == NULL) {
+				return 0;
+			}
+
+			t->values = values;
+		}
+
+		t->capacity = capacity;
+	}
+
+	if (t->keys_size + key_size > t->keys_capacity) {
+		size_t capacity = t->keys_capacity ? t->keys_capacity * 2 : 4096;
+
+		while (t->keys_size + key_size > capacity) {
+			capacity *= 2;
+		}
+
+		char *keys = realloc(t->keys, capacity);
+
+		if (keys == NULL) {
+			return 0;
+		}
+
+		t->keys = keys;
+		t->keys_capacity = capacity;
+	}
+
+	return 1;
+}
+
+int tally_add(struct tally *t, const void *key, size_t size, size_t *i)
+{
+	if ((t->count + 1) * 2 > (t->slots ? t->mask + 1 : 0) && !grow_slots(t)) {
+		return 0;
+	}
+
+	uint64_t hash = hash64(key, size, 0);
+	size_t slot = hash & t->mask;
+
+	while (t->slots[slot] != 0) {
+		struct tally_entry *e = &t->entries[t->slots[slot] - 1];
+
+		if (e->hash == hash
+			&& e->key_size == size
+			&& memcmp(t->keys + e->key, key, size) == 0) {
+			++e->count;
+			*i = t->slots[slot] - 1;
+			return 1;
+		}
+
+		slot = (slot + 1) & t->mask;
+	}
+
+	if (!reserve(t, size)) {
+		return 0;
+	}
+
+	struct tally_entry *e = &t->entries[t->count];
+	e->hash = hash;
+	e->key = t->keys_size;
+	e->key_size = size;
+	e->count = 1;
+
+	memcpy(t->keys + t->keys_size, key, size);
+	t->keys_size += size;
+
+	if (t->value_size) {
+		memset(t->values + t->count * t->value_size, 0, t->value_size);
+	}
+
+	*i = t->count++;
+	t->slots[slot] = *i + 1;
+
+	return 1;
+}
+
+const void *tally_key(struct tally *t, size_t i)
+{
+	return t->keys + t->entries[i].key;
+}
+
+void *tally_value(struct tally *t, size_t i)
+{
+	return t->values + i * t->value_size;
+}
+
+static int compare_entries(const void *a, const void *b)
+{
+	const struct tally_entry *x = *(const struct tally_entry **) a;
+	const struct tally_entry *y = *(const struct tally_entry **) b;
+
+	if (x->count != y->count) {
+		return x->count < y->count ? 1 : -1;
+	}
+
+	// Entries are in the order their keys first came up.
+	return x < y ? -1 : x > y;
+}
+
+size_t *tally_sort(struct tally *t)
+{
+	size_t n = t->count ? t->count : 1;
+	struct tally_entry **sorted = malloc(n * sizeof(*sorted));
+	size_t *positions = malloc(n * sizeof(*positions));
+
+	if (sorted == NULL || positions == NULL) {
+		free(sorted);
+		free(positions);
+		return NULL;
+	}
+
+	for (size_t i = 0; i < t->count; ++i) {
+		sorted[i] = &t->entries[i];
+	}
+
+	qsort(sorted, t->count, sizeof(*sorted), compare_entries);
+
+	for (size_t i = 0; i < t->count; ++i) {
+		positions[i] = sorted[i] - t->entries;
+	}
+
+	free(sorted);
+
+	return positions;
+}
@@ -0,0 +1,91 @@
+#ifndef TALLY_TALLY_H
+#define TALLY_TALLY_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+/*
+ * A key that came up and how many times it did.
+ */
+struct tally_entry {
+	uint64_t hash;
+
+	// Where the bytes of the key start among the keys of the tally.
+	size_t key;
+	size_t key_size;
+
+	unsigned long long count;
+};
+
+/*
+ * Counts how many times keys come up. A key is any sequence of bytes and can
+ * have a value of a fixed size that is left to the caller. Call tally_init to
+ * initialize the struct.
+ *
+ * Entries are kept in the order their keys first came up and are found through
+ * a hash table with linear probing whose size is a power of 2.
+ */
+struct tally {
+	size_t value_size;
+
+	// Position of an entry plus 1, or 0 when the slot is free.
+	size_t *slots;
+	size_t mask;
+
+	struct tally_entry *entries;
+	size_t count;
+	size_t capacity;
+
+	// Value of every entry, one after the other.
+	char *values;
+
+	// Bytes of every key, one after the other.
+	char *keys;
+	size_t keys_size;
+	size_t keys_capacity;
+};
+
+/*
+ * Initializes an empty tally whose entries have values of the given size,
+ * which can be 0.
+ */
+void tally_init(struct tally *t, size_t value_size);
+
+/*
+ * Deinitializes a tally.
+ */
+void tally_deinit(struct tally *t);
+
+/*
+ * Counts a key. The value of a key that comes up for the first time is
+ * filled with zeros.
+ *
+ * Returns 1 on success and puts the position of the entry of the key in i, or
+ * 0 when memory ran out.
+ */
+int tally_add(struct tally *t, const void *key, size_t size, size_t *i);
+
+/*
+ * Returns the bytes of the key of an entry. The size is in the entry.
+ *
+ * Only valid until the next call to tally_add.
+ */
+const void *tally_key(struct tally *t, size_t i);
+
+/*
+ * Returns the value of an entry.
+ *
+ * Only valid until the next call to tally_add.
+ */
+void *tally_value(struct tally *t, size_t i);
+
+/*
+ * Returns the positions of every entry, the most counted first and those
+ * counted the same number of times in the order their keys first came up.
+ * The array must be freed with free.
+ *
+ * Returns NULL when memory ran out.
+ */
+size_t *tally_sort(struct tally *t);
+
+#endif /* TALLY_TALLY_H */
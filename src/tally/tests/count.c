@@ -0,0 +1,96 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "tally/tally.h"
+
+// Enough keys for the table to grow a few times.
+#define KEY_COUNT 5000
+
+int main(void)
+{
+	struct tally t;
+	tally_init(&t, sizeof(int));
+
+	// Key k is made of k % 7 + 1 copies of k and comes up k % 3 + 1 times.
+	for (int round = 0; round < 3; ++round) {
+		for (int k = 0; k < KEY_COUNT; ++k) {
+			if (k % 3 < round) {
+				continue;
+			}
+
+			int key[7];
+			size_t size = (k % 7 + 1) * sizeof(key[0]);
+
+			for (int j = 0; j < k % 7 + 1; ++j) {
+				key[j] = k;
+			}
+
+			size_t i;
+
+			if (!tally_add(&t, key, size, &i)) {
+				fprintf(stderr, "Ran out of memory.\n");
+				tally_deinit(&t);
+				return 1;
+			}
+
+			int *value = tally_value(&t, i);
+
+			if (round == 0 && *value != 0) {
+				fprintf(stderr, "Value of key %d did not start out as 0.\n", k);
+				tally_deinit(&t);
+				return 1;
+			}
+
+			*value += 1;
+		}
+	}
+
+	if (t.count != KEY_COUNT) {
+		fprintf(stderr, "Expected %d keys, got %zu.\n", KEY_COUNT, t.count);
+		tally_deinit(&t);
+		return 1;
+	}
+
+	for (size_t i = 0; i < t.count; ++i) {
+		int k;
+		memcpy(&k, tally_key(&t, i), sizeof(k));
+
+		if (i != (size_t) k || t.entries[i].key_size != (k % 7 + 1) * sizeof(k)) {
+			fprintf(stderr, "Key of entry %zu is not correct.\n", i);
+			tally_deinit(&t);
+			return 1;
+		}
+
+		if (t.entries[i].count != (unsigned long long) (k % 3 + 1) || *(int *) tally_value(&t, i) != k % 3 + 1) {
+			fprintf(stderr, "Key %d was not counted correctly.\n", k);
+			tally_deinit(&t);
+			return 1;
+		}
+	}
+
+	size_t *sorted = tally_sort(&t);
+
+	if (sorted == NULL) {
+		fprintf(stderr, "Ran out of memory.\n");
+		tally_deinit(&t);
+		return 1;
+	}
+
+	for (size_t i = 1; i < t.count; ++i) {
+		struct tally_entry *a = &t.entries[sorted[i - 1]];
+		struct tally_entry *b = &t.entries[sorted[i]];
+
+		if (a->count < b->count || (a->count == b->count && sorted[i - 1] > sorted[i])) {
+			fprintf(stderr, "Entries %zu and %zu are out of order.\n", sorted[i - 1], sorted[i]);
+			free(sorted);
+			tally_deinit(&t);
+			return 1;
+		}
+	}
+
+	free(sorted);
+	tally_deinit(&t);
+
+	return 0;
+}
@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#include "vset/vset.h"
+
+int main(void)
+{
+	struct vset s;
+	vset_init(&s, sizeof(uint64_t));
+
+	for (uint64_t v = 0; v < 50000; ++v) {
+		uint64_t value = v * 2654435761u;
+
+		if (!vset_add(&s, &value)) {
+			fprintf(stderr, "Failed to add value.\n");
+			vset_deinit(&s);
+			return 1;
+		}
+	}
+
+	if (!vset_seal(&s)) {
+		fprintf(stderr, "Failed to seal set.\n");
+		vset_deinit(&s);
+		return 1;
+	}
+
+	// Values that are not in the set should rarely get past the filter.
+	size_t passed = 0;
+	size_t tries = 1000000;
+
+	for (uint64_t v = 0; v < tries; ++v) {
+		uint64_t value = (v << 1) | 1;
+
+		if (vset_contains(&s, &value)) {
+			continue;
+		}
+
+		passed += vset_maybe_contains(&s, &value);
+	}
+
+	if (passed > tries / 100) {
+		fprintf(stderr, "%zu out of %zu values got past the filter.\n", passed, tries);
+		vset_deinit(&s);
+		return 1;
+	}
+
+	vset_deinit(&s);
+	return 0;
+}
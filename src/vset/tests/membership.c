@@ -0,0 +1,46 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#include "vset/vset.h"
+
+int main(void)
+{
+	struct vset s;
+	vset_init(&s, sizeof(uint32_t));
+
+	// Every multiple of 3 below 30000, added backwards and twice.
+	for (int round = 0; round < 2; ++round) {
+		for (uint32_t v = 30000; v-- > 0;) {
+			if (v % 3 == 0 && !vset_add(&s, &v)) {
+				fprintf(stderr, "Failed to add value.\n");
+				vset_deinit(&s);
+				return 1;
+			}
+		}
+	}
+
+	if (!vset_seal(&s)) {
+		fprintf(stderr, "Failed to seal set.\n");
+		vset_deinit(&s);
+		return 1;
+	}
+
+	if (vset_count(&s) != 10000) {
+		fprintf(stderr, "Expected 10000 distinct values but got %zu.\n", vset_count(&s));
+		vset_deinit(&s);
+		return 1;
+	}
+
+	for (uint32_t v = 0; v < 60000; ++v) {
+		int expected = v < 30000 && v % 3 == 0;
+
+		if (vset_contains(&s, &v) != expected) {
+			fprintf(stderr, "Wrong answer for %u.\n", v);
+			vset_deinit(&s);
+			return 1;
+		}
+	}
+
+	vset_deinit(&s);
+	return 0;
+}
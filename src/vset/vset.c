@@ -0,0 +1,159 @@
+#include <string.h>
+
+#include "vset/vset.h"
+
+size_t vset_count(struct vset *s);
+
+int vset_error(struct vset *s);
+
+uint64_t vset_hash(struct vset *s, const void *value);
+
+int vset_maybe_contains(struct vset *s, const void *value);
+
+int vset_contains(struct vset *s, const void *value);
+
+/*
+ * Sorts values by their bytes. qsort can't be told the size of a value at run
+ * time through its comparison function so this is a bottom up merge sort
+ * instead.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+static int sort(struct vset *s)
+{
+	size_t size = s->value_size;
+	char *tmp = malloc(s->count * size);
+
+	if (tmp == NULL) {
+		return 0;
+	}
+
+	char *src = s->values;
+	char *dst = tmp;
+
+	for (size_t width = 1; width < s->count; width *= 2) {
+		for (size_t lo = 0; lo < s->count; lo += 2 * width) {
+			size_t mid = lo + width < s->count ? lo + width : s->count;
+			size_t hi = lo + 2 * width < s->count ? lo + 2 * width : s->count;
+			size_t i = lo, j = mid, k = lo;
+
+			while (i < mid && j < hi) {
+				if (memcmp(src + j * size, src + i * size, size) < 0) {
+					memcpy(dst + k++ * size, src + j++ * size, size);
+				} else {
+					memcpy(dst + k++ * size, src + i++ * size, size);
+				}
+			}
+
+			memcpy(dst + k * size, src + i * size, (mid - i) * size);
+			k += mid - i;
+			memcpy(dst + k * size, src + j * size, (hi - j) * size);
+		}
+
+		char *swap = src;
+		src = dst;
+		dst = swap;
+	}
+
+	if (src != s->values) {
+		memcpy(s->values, src, s->count * size);
+	}
+
+	free(tmp);
+
+	return 1;
+}
+
+void vset_init(struct vset *s, size_t value_size)
+{
+	s->value_size = value_size;
+	s->values = NULL;
+	s->count = 0;
+	s->capacity = 0;
+	s->bloom = NULL;
+	s->bloom_mask = 0;
+	s->error = 0;
+}
+
+void vset_deinit(struct vset *s)
+{
+	free(s->values);
+	free(s->bloom);
+}
+
+int vset_add(struct vset *s, const void *value)
+{
+	if (s->count == s->capacity) {
+		size_t capacity = s->capacity ? s->capacity * 2 : 1024;
+		char *values = realloc(s->values, capacity * s->value_size);
+
+		if (values == NULL) {
+			s->error = 1;
+			return 0;
+		}
+
+		s->values = values;
+		s->capacity = capacity;
+	}
+
+	memcpy(s->values + s->count * s->value_size, value, s->value_size);
+	s->count += 1;
+
+	return 1;
+}
+
+int vset_seal(struct vset *s)
+{
+	size_t size = s->value_size;
+
+	if (s->count > 1 && !sort(s)) {
+		s->error = 1;
+		return 0;
+	}
+
+	// Duplicates are next to each other now.
+	size_t unique = 0;
+
+	for (size_t i = 0; i < s->count; ++i) {
+		if (unique > 0 && memcmp(s->values + (unique - 1) * size, s->values + i * size, size) == 0) {
+			continue;
+		}
+
+		if (unique != i) {
+			memcpy(s->values + unique * size, s->values + i * size, size);
+		}
+
+		unique += 1;
+	}
+
+	s->count = unique;
+
+	size_t bits = 64;
+
+	while (bits < s->count * 16) {
+		bits *= 2;
+	}
+
+	s->bloom = calloc(bits / 64, sizeof(*s->bloom));
+
+	if (s->bloom == NULL) {
+		s->error = 1;
+		return 0;
+	}
+
+	s->bloom_mask = bits - 1;
+
+	for (size_t i = 0; i < s->count; ++i) {
+		uint64_t h = vset_hash(s, s->values + i * size);
+		uint64_t h1 = h;
+		uint64_t h2 = (h >> 32) | 1;
+
+		for (int j = 0; j < 3; ++j) {
+			size_t bit = (h1 + j * h2) & s->bloom_mask;
+
+			s->bloom[bit / 64] |= (uint64_t) 1 << (bit % 64);
+		}
+	}
+
+	return 1;
+}
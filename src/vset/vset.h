@@ -0,0 +1,153 @@
+#ifndef VSET_VSET_H
+#define VSET_VSET_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Value set. Tells whether a value of fixed size is one of a potentially
+ * large number of known values. Values are told apart by their bytes alone.
+ *
+ * Values are kept in a contiguous block of memory sorted by their bytes so
+ * that looking one up is a binary search. Since most values being looked up
+ * are not in the set, a Bloom filter is checked first. It takes 16 bits per
+ * value and is checked at 3 positions, which rules out all but about 1 in 200
+ * of the values that are not in the set without touching the sorted values.
+ *
+ * Values are added first and then the set is sealed. Only then can values be
+ * looked up.
+ */
+
+/*
+ * The vset struct. Call vset_init to initialize it.
+ */
+struct vset {
+	// Size of a value.
+	size_t value_size;
+
+	// Values, sorted and without duplicates once sealed.
+	char *values;
+	size_t count;
+	size_t capacity;
+
+	// Bloom filter. The number of bits is a power of 2.
+	uint64_t *bloom;
+	size_t bloom_mask;
+
+	// Whether we failed to allocate memory.
+	int error;
+};
+
+/*
+ * Initializes a vset struct. Each value takes value_size bytes.
+ */
+void vset_init(struct vset *s, size_t value_size);
+
+/*
+ * Deinitializes a vset struct, releasing all memory.
+ */
+void vset_deinit(struct vset *s);
+
+/*
+ * Adds a value to the set. The value is copied.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int vset_add(struct vset *s, const void *value);
+
+/*
+ * Sorts the values and builds the Bloom filter. No more values can be added
+ * afterwards.
+ *
+ * Returns 1 on success, 0 on failure.
+ */
+int vset_seal(struct vset *s);
+
+/*
+ * Returns the number of distinct values. Only accurate after sealing.
+ */
+inline size_t vset_count(struct vset *s)
+{
+	return s->count;
+}
+
+/*
+ * Returns 1 if an error ocurred, 0 if everything is ok.
+ */
+inline int vset_error(struct vset *s)
+{
+	return s->error;
+}
+
+/*
+ * Hashes a value 8 bytes at a time. Values are expected to be small so this is
+ * cheaper than a general purpose hash function.
+ */
+inline uint64_t vset_hash(struct vset *s, const void *value)
+{
+	const unsigned char *bytes = value;
+	uint64_t h = s->value_size;
+
+	for (size_t i = 0; i < s->value_size; i += sizeof(uint64_t)) {
+		uint64_t word = 0;
+		size_t left = s->value_size - i;
+
+		memcpy(&word, bytes + i, left < sizeof(word) ? left : sizeof(word));
+
+		h = (h ^ word) * 0x9E3779B97F4A7C15ULL;
+		h ^= h >> 29;
+	}
+
+	return h;
+}
+
+/*
+ * Checks the Bloom filter. A value that fails it is certainly not in the set.
+ */
+inline int vset_maybe_contains(struct vset *s, const void *value)
+{
+	uint64_t h = vset_hash(s, value);
+	uint64_t h1 = h;
+	uint64_t h2 = (h >> 32) | 1;
+
+	for (int i = 0; i < 3; ++i) {
+		size_t bit = (h1 + i * h2) & s->bloom_mask;
+
+		if (!(s->bloom[bit / 64] & ((uint64_t) 1 << (bit % 64)))) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Checks whether the value is in the set. The set must be sealed.
+ */
+inline int vset_contains(struct vset *s, const void *value)
+{
+	if (s->count == 0 || !vset_maybe_contains(s, value)) {
+		return 0;
+	}
+
+	size_t lo = 0;
+	size_t hi = s->count;
+
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		int cmp = memcmp(value, s->values + mid * s->value_size, s->value_size);
+
+		if (cmp == 0) {
+			return 1;
+		} else if (cmp < 0) {
+			hi = mid;
+		} else {
+			lo = mid + 1;
+		}
+	}
+
+	return 0;
+}
+
+#endif /* VSET_VSET_H */